@@ -70,19 +70,25 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/core/objectscache.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/plist.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/tools.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/transformable.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/profiler.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/animation.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/instancebatcher.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/baseelement.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/cameraelement.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/material.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/mesh.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/particlesystem.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/helpers/particles.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scene3d.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/serialization.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/storage.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/supportmesh.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/spatialindex.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/primitives/primitives.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/primitives/meshoptimizer.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/primitives/meshsimplifier.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/locale/locale.cpp
 
@@ -103,6 +109,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pvrdecompressor.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/textureloader.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/taskpool.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/jobsystem.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/notifytimer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/sequence.cpp
@@ -130,6 +137,10 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/renderer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/rendering.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/renderstate.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/rendercontext.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/rendercommandbuffer.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/programuniforms.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/renderframe.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/textureresidency.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/opengl/opengl.common.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/opengl/openglcaps.cpp
@@ -143,9 +154,12 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/app/runloop.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/app/pathresolver.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/collision.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/bvh.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/aabbtree.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/criticalsection.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/mutex.unix.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/mappedfile.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/atomiccounter.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/thread.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/threading.unix.cpp
@@ -159,6 +173,10 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/sound.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/streamingthread.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/track.cpp
 
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rt/raytracebvh.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rt/raytracescene.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rt/raytracer.cpp
+
 LOCAL_STATIC_LIBRARIES := android_native_app_glue openal libpng libzip libxml libcurl libvorbis libjpeg
 
 include $(BUILD_STATIC_LIBRARY)
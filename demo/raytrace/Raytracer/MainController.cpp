@@ -8,11 +8,12 @@
 
 #include <ctime>
 #include <et/imaging/imagewriter.h>
-#include "raytracer/Raytracer.h"
+#include <et/imaging/textureloader.h>
+#include <et/models/objloader.h>
 #include "MainController.h"
 
 using namespace et;
-using namespace rt;
+using namespace demo;
 
 const vec2i frameSize = vec2i(1280, 800);
 
@@ -22,12 +23,6 @@ const vec2i frameParts = vec2i(frameSize.x / rectSize.x, frameSize.y / rectSize.
 
 const vec2 samplesPerScreen = vec2(static_cast<float>(frameParts.x), static_cast<float>(frameParts.y));
 
-#if (ET_DEBUG)
-	const size_t numThreads = 1;
-#else
-	const size_t numThreads = 4;
-#endif
-
 et::IApplicationDelegate* Application::initApplicationDelegate()
 	{ return sharedObjectFactory().createObject<MainController>(); }
 
@@ -70,7 +65,7 @@ void MainController::applicationDidLoad(et::RenderContext* rc)
 	rc->renderState().setDepthMask(false);
 	rc->renderState().setDepthTest(false);
 	
-	_scene.load(rc);
+	loadScene(rc);
 	
 	ObjectsCache localCache;
 	_mainProgram = rc->programFactory().loadProgram("programs/main.program", localCache);
@@ -119,8 +114,7 @@ void MainController::applicationDidLoad(et::RenderContext* rc)
 		_cameraAngles.finishInterpolation();
 	});
 	
-	for (size_t i = 0; i < numThreads; ++i)
-		_threads.push_back(sharedObjectFactory().createObject<RaytraceThread>(this));
+	_renderer = sharedObjectFactory().createObject<rt::TileRenderer>(jobSystem());
 	
 	_scale = vec2(1.0f) / samplesPerScreen;
 	_offset = vec2(-1.0f) + _scale;
@@ -134,49 +128,49 @@ void MainController::applicationDidLoad(et::RenderContext* rc)
 
 void MainController::applicationWillTerminate()
 {
-	for (auto t : _threads)
-	{
-		t->stop();
-		t->waitForTermination();
-		sharedObjectFactory().deleteObject(t);
-	}
+	sharedObjectFactory().deleteObject(_renderer);
+	_renderer = nullptr;
 }
 
-bool MainController::fetchNewRenderRect(et::vec2i& origin, et::vec2i& size, bool& preview)
+void MainController::loadScene(et::RenderContext* rc)
 {
-	CriticalSectionScope lock(_csLock);
-	if (_renderRects.empty()) return false;
-	
-	preview = (_scene.options.bounces == _previewBounces);
-	
-	int remainingRects = static_cast<int>(_renderRects.size());
-	int randomOffset = remainingRects / 2 + rand() % (2 * frameParts.x) - frameParts.x;
-	randomOffset = clamp(randomOffset, 0, remainingRects - 1);
-
-	auto i = _renderRects.begin();
-	std::advance(i, static_cast<size_t>(randomOffset));
+	_scene.apertureSize = 0.0f;
+	_scene.ambientColor = vec4(3.0f);
+	_scene.environmentMap = loadTexture(application().resolveFileName("background.hdr"));
+	_scene.camera.perspectiveProjection(QUARTER_PI, 1.0f, 1.0f, 1024.0f);
 	
-	origin = i->origin();
-	size = i->size();
+	ObjectsCache cache;
+	OBJLoader loader(rc, "shaderart.obj");
+	auto loadedModel = loader.load(cache, OBJLoader::Option_SupportMeshes);
+	auto meshes = loadedModel->childrenOfType(s3d::ElementType_SupportMesh);
 	
-	_renderRects.erase(i);
+	for (s3d::SupportMesh::Pointer m : meshes)
+	{
+		if (m->triangles().size() > 0)
+		{
+			auto mat = m->material();
+			
+			vec4 kD = mat->getVector(MaterialParameter_DiffuseColor);
+			vec4 kS = mat->getVector(MaterialParameter_SpecularColor);
+			vec4 kE = mat->getVector(MaterialParameter_EmissiveColor);
+			float Ns = etMin(1.0f, mat->getFloat(MaterialParameter_Roughness));
+			float Tr = mat->getFloat(MaterialParameter_Transparency);
+			
+			log::info("Mesh: %s, triangles: %llu, material: %s :", m->name().c_str(), (uint64_t)m->triangles().size(), mat->name().c_str());
+			log::info("{");
+			log::info("\tdiffuse = %.3f, %.3f, %.3f", kD.x, kD.y, kD.z);
+			log::info("\tspecular = %.3f, %.3f, %.3f", kS.x, kS.y, kS.z);
+			log::info("\temissive = %.3f, %.3f, %.3f", kE.x, kE.y, kE.z);
+			log::info("\troughness = %.3f", Ns);
+			log::info("\ttransparency = %.3f", Tr);
+			log::info("}");
+			
+			size_t materialIndex = _scene.addMaterial(rt::SceneMaterial(kD, kS, kE, Ns, Tr));
+			_scene.addTriangles(m->triangles().data(), m->triangles().size(), materialIndex);
+		}
+	}
 	
-	return true;
-}
-
-et::vec2i MainController::imageSize()
-{
-	return frameSize;
-}
-
-const RaytraceScene& MainController::scene()
-{
-	return _scene;
-}
-
-OutputFunction MainController::outputFunction()
-{
-	return _outputFunction;
+	_scene.buildAccelerationStructure();
 }
 
 void MainController::applicationWillResizeContext(const et::vec2i& sz)
@@ -293,39 +287,36 @@ void MainController::restartOfflineRendering()
 
 void MainController::startCPUTracing()
 {
-	CriticalSectionScope lock(_csLock);
-	_renderRects.clear();
+	if (_renderer == nullptr) return;
 	
-	for (int y = 0; y < frameParts.y; ++y)
-	{
-		for (int x = 0; x < frameParts.x; ++x)
-			_renderRects.push_back(recti(vec2i(x, y) * rectSize, rectSize));
-	}
+	bool preview = (_scene.options.bounces == _previewBounces);
+	
+	_renderer->cancel();
+	
+	_maxElapsedTime = 0;
+	_estimatedTime = 0;
+	
+	_renderer->render(_scene, frameSize, rectSize, preview, _outputFunction,
+		[this](const recti&, uint64_t elapsedTime) { tileFinished(elapsedTime); });
 }
 
-void MainController::renderFinished(uint64_t elapsedTime)
+void MainController::tileFinished(uint64_t elapsedTime)
 {
 	CriticalSectionScope lock(_csLock);
 
 	_maxElapsedTime += elapsedTime;
 
-	size_t remainingRects = _renderRects.size();
-	size_t totalRects = frameParts.square();
+	size_t remainingRects = _renderer->remainingTiles();
+	size_t totalRects = _renderer->totalTiles();
 
 	if (totalRects != remainingRects)
 	{
 		uint64_t averageTime = _maxElapsedTime / (totalRects - remainingRects);
-		_estimatedTime = remainingRects * averageTime;
+		_estimatedTime = remainingRects * averageTime / etMax(size_t(1), jobSystem().workersCount());
 		updateTitle();
 	}
 
-	if (!_renderRects.empty()) return;
-	
-	for (auto rt : _threads)
-	{
-		if (rt->rendering())
-			return;
-	}
+	if (remainingRects > 0) return;
 	
 	auto renderTime = floatToStr(mainTimerPool()->actualTime() - _startTime, 2);
 	
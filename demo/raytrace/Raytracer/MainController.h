@@ -15,12 +15,11 @@
 #include <et/app/application.h>
 #include <et/timers/interpolationvalue.h>
 
-#include "raytracer/RaytraceScene.h"
-#include "raytracer/RaytraceThread.h"
+#include <et/rt/raytracer.h>
 
-namespace rt
+namespace demo
 {
-	class MainController : public et::IApplicationDelegate, public et::InputHandler, public RaytraceThreadDelegate
+	class MainController : public et::IApplicationDelegate, public et::InputHandler
 	{
 		et::ApplicationIdentifier applicationIdentifier() const;
 		void setRenderContextParameters(et::RenderContextParameters&);
@@ -41,16 +40,9 @@ namespace rt
 		
 		void updateTextureData();
 		
+		void loadScene(et::RenderContext*);
 		void startCPUTracing();
-		void renderFinished(uint64_t);
-		bool shouldAntialias();
-		
-	private:
-		et::vec2i imageSize();
-		const RaytraceScene& scene();
-		OutputFunction outputFunction();
-		
-		bool fetchNewRenderRect(et::vec2i& origin, et::vec2i& size, bool& preview);
+		void tileFinished(uint64_t);
 		
 	private:
 		et::GesturesRecognizer _gestures;
@@ -67,10 +59,9 @@ namespace rt
 		et::Texture::Pointer _result;
 		et::DataStorage<et::vec4ub> _textureData;
 		
-		RaytraceScene _scene;
-		std::vector<RaytraceThread*, et::SharedBlockAllocatorSTDProxy<RaytraceThread*>> _threads;
-		std::vector<et::recti, et::SharedBlockAllocatorSTDProxy<et::recti>> _renderRects;
-		OutputFunction _outputFunction;
+		et::rt::RaytraceScene _scene;
+		et::rt::TileRenderer* _renderer = nullptr;
+		et::rt::OutputFunction _outputFunction;
 		et::CriticalSection _csLock;
 		
 		float _startTime = 0.0f;
@@ -138,6 +138,10 @@ void SceneRenderer::init(et::RenderContext* rc)
 void SceneRenderer::setScene(et::s3d::Scene::Pointer aScene)
 {
 	_allObjects.clear();
+	_materialIdentifiers.clear();
+	_instanceBatcher.clear();
+	_commandBuffer.clear();
+	_commandBuffer.removeMaterials();
 	
 	_scene = aScene;
 	
@@ -189,39 +193,64 @@ void SceneRenderer::renderToGeometryBuffer(const et::Camera& cam)
 	rs.setWireframeRendering(false);
 */	
 
-	for (s3d::SupportMesh::Pointer& e : _allObjects)
+	_allObjectsBounds.resize(_allObjects.size());
+	for (size_t i = 0, count = _allObjects.size(); i < count; ++i)
+		_allObjectsBounds.set(i, _allObjects.at(i)->aabb());
+	
+	cam.frustum().cullAABBs(_allObjectsBounds, _visibleObjects, et::jobSystem());
+	
+	_instanceBatcher.clear();
+	for (size_t i = 0, count = _allObjects.size(); i < count; ++i)
 	{
-		if (cam.frustum().containsAABB(e->aabb()))
+		if (isVisible(_visibleObjects, i))
 		{
-			const auto& mat = e->material();
-			
-			programs.prepass->setTransformMatrix(e->finalTransform());
-			programs.prepass->setUniform("diffuseColor", mat->getVector(MaterialParameter_DiffuseColor));
-			
-			rs.bindVertexArray(e->vertexArrayObject());
-			
-			if (mat->hasTexture(MaterialParameter_DiffuseMap))
-				rs.bindTexture(diffuseTextureUnit, mat->getTexture(MaterialParameter_DiffuseMap));
-			else
-				rs.bindTexture(diffuseTextureUnit, _defaultTexture);
-			
-			if (mat->hasTexture(MaterialParameter_NormalMap))
-				rs.bindTexture(normalTextureUnit, mat->getTexture(MaterialParameter_NormalMap));
-			else
-				rs.bindTexture(normalTextureUnit, _defaultNormalTexture);
-			
-			if (mat->hasTexture(MaterialParameter_TransparencyMap))
-				rs.bindTexture(transparencyTextureUnit, mat->getTexture(MaterialParameter_TransparencyMap));
-			else
-				rs.bindTexture(transparencyTextureUnit, _defaultTexture);
-			
-			rn->drawElements(e->indexBuffer(), e->startIndex(), e->numIndexes());
+			auto& e = _allObjects.at(i);
+			e->selectLod(cam);
+			_instanceBatcher.add(e.ptr(), (e->aabb().center - cam.position()).length());
 		}
 	}
+	_instanceBatcher.build();
+	
+	_commandBuffer.clear();
+	_instanceBatcher.record(_commandBuffer, 0, programs.prepass, [this](const s3d::Material::Pointer& mat)
+		{ return materialIdentifier(mat); });
+	_commandBuffer.submit(_rc);
+	
+#if (ENABLE_DEBUG_RENDERING)
+	const auto& stats = _commandBuffer.statistics();
+	log::info("%llu meshes, %llu packets, %llu state changes, %llu saved by sorting",
+		static_cast<uint64_t>(_instanceBatcher.meshesCount()), static_cast<uint64_t>(stats.packets),
+		static_cast<uint64_t>(stats.stateChanges()), static_cast<uint64_t>(stats.savedStateChanges()));
+#endif
+	
 // */
 	rs.setSampleAlphaToCoverage(false);
 }
 
+RenderCommandBuffer::Identifier SceneRenderer::materialIdentifier(const s3d::Material::Pointer& mat)
+{
+	auto i = _materialIdentifiers.find(mat.ptr());
+	if (i != _materialIdentifiers.end())
+		return i->second;
+	
+	RenderCommandBuffer::Material material;
+	
+	material.textures.emplace_back(diffuseTextureUnit, mat->hasTexture(MaterialParameter_DiffuseMap) ?
+		mat->getTexture(MaterialParameter_DiffuseMap) : _defaultTexture);
+	
+	material.textures.emplace_back(normalTextureUnit, mat->hasTexture(MaterialParameter_NormalMap) ?
+		mat->getTexture(MaterialParameter_NormalMap) : _defaultNormalTexture);
+	
+	material.textures.emplace_back(transparencyTextureUnit, mat->hasTexture(MaterialParameter_TransparencyMap) ?
+		mat->getTexture(MaterialParameter_TransparencyMap) : _defaultTexture);
+	
+	material.uniforms.set(ET_UNIFORM_NAME("diffuseColor"), mat->getVector(MaterialParameter_DiffuseColor));
+	
+	auto identifier = _commandBuffer.addMaterial(material);
+	_materialIdentifiers.insert(std::make_pair(mat.ptr(), identifier));
+	return identifier;
+}
+
 void SceneRenderer::computeAmbientOcclusion(const et::Camera& cam)
 {
 	auto& rs = _rc->renderState();
@@ -239,29 +268,29 @@ void SceneRenderer::computeAmbientOcclusion(const et::Camera& cam)
 	rs.bindTexture(depthTextureUnit, _geometryBuffer->depthBuffer());
 	
 	rs.bindProgram(programs.ambientOcclusion);
-	programs.ambientOcclusion->setUniform("clipPlanes", vec2(cam.zNear(), cam.zFar()));
-	programs.ambientOcclusion->setUniform("texCoordScales", vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
+	programs.ambientOcclusion->setUniform(ET_UNIFORM_NAME("clipPlanes"), vec2(cam.zNear(), cam.zFar()));
+	programs.ambientOcclusion->setUniform(ET_UNIFORM_NAME("texCoordScales"), vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
 	rn->fullscreenPass();
 	
 	rs.bindProgram(programs.ambientOcclusionBlur);
-	programs.ambientOcclusionBlur->setUniform("clipPlanes", vec2(cam.zNear(), cam.zFar()));
-	programs.ambientOcclusionBlur->setUniform("texCoordScales", vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
+	programs.ambientOcclusionBlur->setUniform(ET_UNIFORM_NAME("clipPlanes"), vec2(cam.zNear(), cam.zFar()));
+	programs.ambientOcclusionBlur->setUniform(ET_UNIFORM_NAME("texCoordScales"), vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
 	
 	_downsampledBuffer->setCurrentRenderTarget(1);
 	rs.bindTexture(diffuseTextureUnit, _downsampledBuffer->renderTarget(0));
-	programs.ambientOcclusionBlur->setUniform("direction", _downsampledBuffer->renderTarget(0)->texel() * vec2(1.0, 0.0));
+	programs.ambientOcclusionBlur->setUniform(ET_UNIFORM_NAME("direction"), _downsampledBuffer->renderTarget(0)->texel() * vec2(1.0, 0.0));
 	rn->fullscreenPass();
 	
 	_downsampledBuffer->setCurrentRenderTarget(0);
 	rs.bindTexture(diffuseTextureUnit, _downsampledBuffer->renderTarget(1));
-	programs.ambientOcclusionBlur->setUniform("direction", _downsampledBuffer->renderTarget(0)->texel() * vec2(0.0, 1.0));
+	programs.ambientOcclusionBlur->setUniform(ET_UNIFORM_NAME("direction"), _downsampledBuffer->renderTarget(0)->texel() * vec2(0.0, 1.0));
 	rn->fullscreenPass();
 	
 	_downsampledBuffer->setCurrentRenderTarget(1);
 	rs.bindTexture(diffuseTextureUnit, _downsampledBuffer->renderTarget(0));
 	
 	rs.bindProgram(programs.fxaa);
-	programs.fxaa->setUniform("texel", _downsampledBuffer->renderTarget(0)->texel());
+	programs.fxaa->setUniform(ET_UNIFORM_NAME("texel"), _downsampledBuffer->renderTarget(0)->texel());
 	rn->fullscreenPass();
 }
 
@@ -302,11 +331,11 @@ void SceneRenderer::render(const et::Camera& cam, const et::Camera& observer, bo
 	rs.bindProgram(programs.final);
 		
 	programs.final->setCameraProperties(cam);
-	programs.final->setUniform("mProjection", cam.projectionMatrix());
-	programs.final->setUniform<vec3>("lightPositions[0]", viewSpaceLightPosition.data(), viewSpaceLightPosition.size());
-	programs.final->setUniform("lightsCount", viewSpaceLightPosition.size());
-	programs.final->setUniform("clipPlanes", vec2(cam.zNear(), cam.zFar()));
-	programs.final->setUniform("texCoordScales", vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
+	programs.final->setUniform(ET_UNIFORM_NAME("mProjection"), cam.projectionMatrix());
+	programs.final->setUniform<vec3>(ET_UNIFORM_NAME("lightPositions"), viewSpaceLightPosition.data(), viewSpaceLightPosition.size());
+	programs.final->setUniform(ET_UNIFORM_NAME("lightsCount"), viewSpaceLightPosition.size());
+	programs.final->setUniform(ET_UNIFORM_NAME("clipPlanes"), vec2(cam.zNear(), cam.zFar()));
+	programs.final->setUniform(ET_UNIFORM_NAME("texCoordScales"), vec2(-cam.inverseProjectionMatrix()[0][0], -cam.inverseProjectionMatrix()[1][1]));
 	
 	rs.bindTexture(diffuseTextureUnit, _geometryBuffer->renderTarget(0));
 	rs.bindTexture(normalTextureUnit, _geometryBuffer->renderTarget(1));
@@ -320,15 +349,15 @@ void SceneRenderer::render(const et::Camera& cam, const et::Camera& observer, bo
 	rs.bindProgram(programs.motionBlur);
 	rs.bindTexture(diffuseTextureUnit, _finalBuffers[_finalBufferIndex]->renderTarget());
 	rs.bindTexture(depthTextureUnit, _geometryBuffer->depthBuffer());
-	programs.motionBlur->setUniform("mModelViewInverseToPrevious", cam.inverseModelViewProjectionMatrix() * _previousProjectionMatrix);
-	programs.motionBlur->setUniform("motionDistanceScale", 0.5f * (currentTime - _updateTime) / (1.0f / 30.0f));
+	programs.motionBlur->setUniform(ET_UNIFORM_NAME("mModelViewInverseToPrevious"), cam.inverseModelViewProjectionMatrix() * _previousProjectionMatrix);
+	programs.motionBlur->setUniform(ET_UNIFORM_NAME("motionDistanceScale"), 0.5f * (currentTime - _updateTime) / (1.0f / 30.0f));
 	rn->fullscreenPass();
 // */
 	
 	rs.bindDefaultFramebuffer();
 	rs.bindProgram(programs.fxaa);
 	rs.bindTexture(diffuseTextureUnit, _finalBuffers[_finalBufferIndex]->renderTarget());
-	programs.fxaa->setUniform("texel", _finalBuffers[_finalBufferIndex]->renderTarget()->texel());
+	programs.fxaa->setUniform(ET_UNIFORM_NAME("texel"), _finalBuffers[_finalBufferIndex]->renderTarget()->texel());
 	rn->fullscreenPass();
 
 	_previousProjectionMatrix = cam.modelViewProjectionMatrix();
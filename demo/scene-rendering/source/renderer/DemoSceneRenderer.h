@@ -9,6 +9,7 @@
 #pragma once
 
 #include <et/scene3d/scene3d.h>
+#include <et/scene3d/instancebatcher.h>
 
 namespace demo
 {
@@ -25,6 +26,7 @@ namespace demo
 	private:
 		void renderToGeometryBuffer(const et::Camera&);
 		void computeAmbientOcclusion(const et::Camera&);
+		et::RenderCommandBuffer::Identifier materialIdentifier(const et::s3d::Material::Pointer&);
 		
 	private:
 		struct
@@ -45,6 +47,11 @@ namespace demo
 		
 		et::s3d::Scene::Pointer _scene;
 		std::vector<et::s3d::SupportMesh::Pointer> _allObjects;
+		et::AABBStream _allObjectsBounds;
+		et::VisibilityMask _visibleObjects;
+		et::RenderCommandBuffer _commandBuffer;
+		et::s3d::InstanceBatcher _instanceBatcher;
+		std::map<const et::s3d::Material*, et::RenderCommandBuffer::Identifier> _materialIdentifiers;
 		std::vector<et::vec3> _lightPositions;
 		
 		et::Texture::Pointer _noiseTexture;
@@ -21,6 +21,7 @@ namespace et
 	extern const std::string kSystemEventRemoteNotificationStatusChanged;
 	
 	class ApplicationNotifier;
+	class RenderThread;
 	class Application : public Singleton<Application>,  public EventReceiver
 	{
 	public:
@@ -48,6 +49,19 @@ namespace et
 		RunLoop& backgroundRunLoop()
 			{ return _backgroundThread.runLoop(); }
 		
+		/*
+		 * Updated on the rendering thread before each frame (asynchronously loaded textures
+		 * are updated there), the same as main run loop when frames are rendered on the main thread
+		 */
+		RunLoop& renderRunLoop()
+			{ return (_renderThread == nullptr) ? _runLoop : _renderRunLoop; }
+		
+		bool renderingOnSeparateThread() const
+			{ return _renderThread != nullptr; }
+		
+		JobSystem& jobSystem()
+			{ return _jobSystem; }
+		
 		size_t renderingContextHandle() const
 			{ return _renderingContextHandle; }
 
@@ -101,6 +115,7 @@ namespace et
 		
 	private:
 		friend class RenderContext;
+		friend class RenderThread;
 
 		RenderContext* renderContext() 
 			{ return _renderContext; }
@@ -133,6 +148,17 @@ namespace et
 		bool shouldPerformRendering();
 		void performUpdateAndRender();
 		
+		void startRenderThread();
+		void stopRenderThread();
+		void waitForRenderThread();
+		
+		/*
+		 * Moves render context to the calling thread when the render thread is idle,
+		 * used by the main thread to access rendering API between frames
+		 */
+		void acquireRenderContext();
+		void releaseRenderContext();
+		
 		void updateTimers(float dt);
 		
 	private:
@@ -159,6 +185,9 @@ namespace et
 		PathResolver::Pointer _customPathResolver;
 		
 		RunLoop _runLoop;
+		RunLoop _renderRunLoop;
+		RenderThread* _renderThread = nullptr;
+		JobSystem _jobSystem;
 		BackgroundThread _backgroundThread;
 
 		std::string _emptyParamter;
@@ -192,6 +221,9 @@ namespace et
 	inline RunLoop& backgroundRunLoop()
 		{ return Application::instance().backgroundRunLoop(); }
 	
+	inline JobSystem& jobSystem()
+		{ return Application::instance().jobSystem(); }
+	
 	inline TimerPool::Pointer& mainTimerPool()
 		{ return Application::instance().mainRunLoop().firstTimerPool(); }
 }
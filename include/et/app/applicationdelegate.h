@@ -50,14 +50,21 @@ namespace et
 		bool shouldSuspendOnDeactivate;
 		bool keepWindowAspectOnResize;
 
+		/*
+		 * IApplicationDelegate::render is called on the dedicated thread, while idle of the next frame
+		 * runs on the main thread (see RenderFramePipeline). Render context is moved to that thread,
+		 * platforms which could not move it (see RenderContext::makeCurrent) render on the main thread.
+		 */
+		bool renderThread;
+
 #if (ET_PLATFORM_IOS || ET_PLATFORM_ANDROID)
 		ApplicationParameters() :
 			windowStyle(WindowStyle_Borderless), windowSize(WindowSize_Predefined),
-			shouldSuspendOnDeactivate(true), keepWindowAspectOnResize(false) { }
+			shouldSuspendOnDeactivate(true), keepWindowAspectOnResize(false), renderThread(false) { }
 #else
 		ApplicationParameters() :
 			windowStyle(WindowStyle_Caption), windowSize(WindowSize_Predefined),
-			shouldSuspendOnDeactivate(false), keepWindowAspectOnResize(false) { }
+			shouldSuspendOnDeactivate(false), keepWindowAspectOnResize(false), renderThread(false) { }
 #endif
 	};
 	
@@ -80,6 +87,12 @@ namespace et
 
 		virtual void applicationWillResizeContext(const et::vec2i&) { }
 
+		/*
+		 * With ApplicationParameters::renderThread render runs on the render thread concurrently
+		 * with idle and other callbacks on the main thread, so it should only use data which is not
+		 * modified there (for example, frame recorded in the previous idle, see RenderFramePipeline).
+		 * applicationWillResizeContext is invoked between frames, when render is not running.
+		 */
 		virtual void render(et::RenderContext*) { }
 		virtual void idle(float) { }
 	};
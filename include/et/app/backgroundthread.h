@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/threading/thread.h>
+#include <et/tasks/jobsystem.h>
 #include <et/app/runloop.h>
 
 namespace et
@@ -20,11 +21,13 @@ namespace et
 		BackgroundRunLoop();
 		
 		void setOwner(BackgroundThread* owner);
+		void setJobSystem(JobSystem* jobSystem);
 		void addTask(Task* t, float);
 		
 	private:
 		friend class BackgroundThread;
 		BackgroundThread* _owner;
+		JobSystem* _jobSystem;
 	};
 	
 	class BackgroundThread : public Thread
@@ -35,6 +38,13 @@ namespace et
 		RunLoop& runLoop()
 			{ return _runLoop; }
 		
+		/*
+		 * When job system is set, background tasks are executed on its workers
+		 * and this thread only handles timers and delayed tasks
+		 */
+		void setJobSystem(JobSystem* jobSystem)
+			{ _runLoop.setJobSystem(jobSystem); }
+		
 	private:
 		ThreadResult main();
 		
@@ -12,6 +12,80 @@
 
 namespace et
 {
+	class JobSystem;
+
+	/*
+	 * Structure-of-arrays bounding volumes for batch culling.
+	 * Components are padded to a multiple of batchSize elements.
+	 */
+	class AABBStream
+	{
+	public:
+		enum : size_t
+		{
+			batchSize = 8
+		};
+
+	public:
+		void resize(size_t);
+		void set(size_t index, const AABB&);
+		void push_back(const AABB&);
+
+		size_t size() const
+			{ return _size; }
+
+		void clear()
+			{ resize(0); }
+
+	public:
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> extentX;
+		std::vector<float> extentY;
+		std::vector<float> extentZ;
+
+	private:
+		size_t _size = 0;
+	};
+
+	class SphereStream
+	{
+	public:
+		enum : size_t
+		{
+			batchSize = 8
+		};
+
+	public:
+		void resize(size_t);
+		void set(size_t index, const Sphere&);
+		void push_back(const Sphere&);
+
+		size_t size() const
+			{ return _size; }
+
+		void clear()
+			{ resize(0); }
+
+	public:
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> radius;
+
+	private:
+		size_t _size = 0;
+	};
+
+	/*
+	 * One bit per volume, bit (i % 32) of word (i / 32) is set for visible volumes
+	 */
+	typedef std::vector<uint32_t> VisibilityMask;
+
+	inline bool isVisible(const VisibilityMask& mask, size_t index)
+		{ return (mask[index / 32] & (1u << (index % 32))) != 0; }
+
 	enum FrustumPlane
 	{
 		FrustumPlane_Right,
@@ -31,8 +105,22 @@ namespace et
 
 		bool containsSphere(const Sphere& sphere) const;
 		bool containsAABB(const AABB& aabb) const;
+		bool containsBox(const vec3& minVertex, const vec3& maxVertex) const;
 		bool containsOBB(const OBB& obb) const;
 
+		/*
+		 * Batch versions of containsAABB / containsSphere, mask is resized to fit stream.
+		 * Overloads with JobSystem split large streams across workers.
+		 */
+		void cullAABBs(const AABBStream&, VisibilityMask&) const;
+		void cullAABBs(const AABBStream&, VisibilityMask&, JobSystem&) const;
+		void cullSpheres(const SphereStream&, VisibilityMask&) const;
+		void cullSpheres(const SphereStream&, VisibilityMask&, JobSystem&) const;
+
+	private:
+		void cullAABBs(const AABBStream&, uint32_t* mask, size_t firstWord, size_t lastWord) const;
+		void cullSpheres(const SphereStream&, uint32_t* mask, size_t firstWord, size_t lastWord) const;
+
 	private:
 		StaticDataStorage<vec4, FrustumPlane_max> _planes;
 		StaticDataStorage<vec4, 8> _corners;
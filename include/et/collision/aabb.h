@@ -56,4 +56,9 @@ namespace et
 			{ return corners[AABBCorner_RightUpNear]; }
 	};
 
+	/*
+	 * Bounding boxes of affinely transformed boxes, input and output may point to the same array
+	 */
+	void transformAABBs(const mat4& m, const AABB* input, AABB* output, size_t count);
+
 }
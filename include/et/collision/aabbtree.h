@@ -0,0 +1,135 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/collision/collision.h>
+
+namespace et
+{
+	/*
+	 * Dynamic bounding volume tree over moving objects.
+	 * Leaves store enlarged (fat) boxes, so small movements do not change the tree;
+	 * insertion picks the sibling with the smallest area growth and the tree
+	 * is kept balanced with rotations. Proxies are node indices and stay valid until removed.
+	 */
+	class AABBTree
+	{
+	public:
+		enum : uint32_t
+		{
+			InvalidIndex = static_cast<uint32_t>(-1),
+		};
+
+		struct Node
+		{
+			vec3 minVertex;
+			vec3 maxVertex;
+			void* userData = nullptr;
+			uint32_t parent = InvalidIndex; /* next free node for unused nodes */
+			uint32_t left = InvalidIndex;
+			uint32_t right = InvalidIndex;
+			int32_t height = -1; /* 0 for leaves, -1 for unused nodes */
+
+			bool leaf() const
+				{ return left == InvalidIndex; }
+		};
+
+	public:
+		AABBTree(float margin = 0.1f);
+
+		uint32_t insert(const AABB&, void* userData);
+		void remove(uint32_t proxy);
+
+		/*
+		 * Returns true if proxy was reinserted because box left its fat bounds
+		 */
+		bool update(uint32_t proxy, const AABB&);
+
+		void clear();
+
+		size_t size() const
+			{ return _leavesCount; }
+
+		bool empty() const
+			{ return _leavesCount == 0; }
+
+		void* userData(uint32_t proxy) const
+			{ return _nodes[proxy].userData; }
+
+		const Node& node(uint32_t proxy) const
+			{ return _nodes[proxy]; }
+
+		/*
+		 * Descends into nodes which pass test(minVertex, maxVertex),
+		 * calls callback(proxy, userData) for leaves, stops when callback returns false
+		 */
+		template <typename Test, typename Callback>
+		void query(Test test, Callback callback) const;
+
+	private:
+		uint32_t allocateNode();
+		void freeNode(uint32_t);
+
+		void insertLeaf(uint32_t);
+		void removeLeaf(uint32_t);
+		void refit(uint32_t);
+		uint32_t balance(uint32_t);
+
+	private:
+		std::vector<Node> _nodes;
+		uint32_t _root = InvalidIndex;
+		uint32_t _freeList = InvalidIndex;
+		size_t _leavesCount = 0;
+		float _margin = 0.1f;
+	};
+
+	template <typename Test, typename Callback>
+	void AABBTree::query(Test test, Callback callback) const
+	{
+		if (_root == InvalidIndex) return;
+
+		uint32_t stack[64];
+		std::vector<uint32_t> overflow;
+
+		size_t stackSize = 0;
+		stack[stackSize++] = _root;
+
+		while ((stackSize > 0) || !overflow.empty())
+		{
+			uint32_t index = InvalidIndex;
+			if (overflow.empty())
+			{
+				index = stack[--stackSize];
+			}
+			else
+			{
+				index = overflow.back();
+				overflow.pop_back();
+			}
+
+			const Node& n = _nodes[index];
+			if (!test(n.minVertex, n.maxVertex)) continue;
+
+			if (n.leaf())
+			{
+				if (!callback(index, n.userData))
+					return;
+			}
+			else if (stackSize + 2 <= 64)
+			{
+				stack[stackSize++] = n.right;
+				stack[stackSize++] = n.left;
+			}
+			else
+			{
+				overflow.push_back(n.right);
+				overflow.push_back(n.left);
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/collision/collision.h>
+
+namespace et
+{
+	/*
+	 * Bounding volume hierarchy over an external array of triangles.
+	 * Built with binned surface area heuristic, nodes are stored depth-first:
+	 * left child immediately follows its parent, right child is referenced by index.
+	 * Triangles are never reordered, leaves reference them through index table,
+	 * so all queries report indices in the original array.
+	 */
+	class TriangleBVH
+	{
+	public:
+		struct Node
+		{
+			vec3 minVertex;
+			uint32_t offset = 0; /* first index for leaves, right child for interior nodes */
+			vec3 maxVertex;
+			uint32_t count = 0; /* 0 for interior nodes */
+
+			bool leaf() const
+				{ return count > 0; }
+		};
+
+		struct RayHit
+		{
+			vec3 point;
+			float distance = std::numeric_limits<float>::max();
+			uint32_t triangleIndex = InvalidIndex;
+		};
+
+		struct SweepHit
+		{
+			vec3 point;
+			vec3 normal;
+			float penetration = 0.0f;
+			float time = std::numeric_limits<float>::max(); /* fraction of velocity, 0 for initial contact */
+			uint32_t triangleIndex = InvalidIndex;
+		};
+
+		enum : uint32_t
+		{
+			InvalidIndex = static_cast<uint32_t>(-1),
+			MaxTrianglesPerLeaf = 4,
+		};
+
+	public:
+		void build(const triangle* triangles, size_t triangleCount);
+		void clear();
+
+		bool empty() const
+			{ return _nodes.empty(); }
+
+		const std::vector<Node>& nodes() const
+			{ return _nodes; }
+
+		const std::vector<uint32_t>& indices() const
+			{ return _indices; }
+
+		/*
+		 * Queries expect the same triangles array which was used to build hierarchy
+		 */
+		bool rayNearest(const ray3d&, const triangle*, RayHit&, bool twoSided = false) const;
+		bool rayAny(const ray3d&, const triangle*, float maxDistance, bool twoSided = false) const;
+
+		bool sphereSweep(const Sphere&, const vec3& velocity, const triangle*, SweepHit&) const;
+
+		size_t aabbOverlap(const AABB&, const triangle*, std::vector<uint32_t>& result) const;
+
+		void serialize(std::ostream&) const;
+		void deserialize(std::istream&);
+
+	private:
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _indices;
+	};
+}
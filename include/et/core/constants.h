@@ -96,7 +96,7 @@
 #	define ET_KEY_D						'D'	
 #	define ET_KEY_W						'W'	
 #
-#elif (ET_PLATFORM_ANDROID)
+#elif (ET_PLATFORM_ANDROID || ET_PLATFORM_LINUX)
 #
 #	define ET_KEY_RETURN				13
 #	define ET_KEY_TAB					9
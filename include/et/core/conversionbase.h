@@ -23,6 +23,13 @@ namespace et
 		return buffer;
 	}
 
+	inline std::string intToStr(long value)
+	{
+		char buffer[32] = { };
+		sprintf(buffer, "%ld", value);
+		return buffer;
+	}
+
 	inline std::string intToStr(unsigned long value)
 	{
 		char buffer[32] = { };
@@ -37,14 +44,14 @@ namespace et
 		return buffer;
 	}
 
-	inline std::string intToStr(int64_t value)
+	inline std::string intToStr(long long value)
 	{
 		char buffer[64] = { };
 		sprintf(buffer, "%lld", value);
 		return buffer;
 	}
 	
-	inline std::string intToStr(uint64_t value)
+	inline std::string intToStr(unsigned long long value)
 	{
 		char buffer[64] = { };
 		sprintf(buffer, "%llu", value);
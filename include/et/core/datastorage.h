@@ -203,7 +203,10 @@ namespace et
 			if (ownsData())
 				sharedObjectFactory().allocator()->release(_mutableData);
 			
-			_flags |= DataStorageFlag_Mutable;
+			/*
+			 * Storage always owns reallocated data, even if it was referencing external memory
+			 */
+			_flags |= DataStorageFlag_OwnsMutableData;
 			_mutableData = new_data;
 		}
 		
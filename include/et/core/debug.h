@@ -35,6 +35,7 @@
 #
 #	define ET_DEPRECATED					__declspec(deprecated)
 #	define ET_ALIGNED(A)					__declspec(align(A))
+#	define ET_THREAD_LOCAL					__declspec(thread)
 #
 #elif (ET_PLATFORM_APPLE)
 #
@@ -49,6 +50,7 @@
 #	define ET_FORMAT_FUNCTION				__attribute__((format(printf, 1, 2)))
 #	define ET_FORMAT_FUNCTION_IN_CLASS		__attribute__((format(printf, 2, 3)))
 #	define ET_ALIGNED(A)					__attribute__((aligned(A)))
+#	define ET_THREAD_LOCAL					__thread
 #
 #elif (ET_PLATFORM_ANDROID)
 #
@@ -64,6 +66,23 @@
 #	define ET_FORMAT_FUNCTION				__attribute__((format(printf, 1, 2)))
 #	define ET_FORMAT_FUNCTION_IN_CLASS		__attribute__((format(printf, 2, 3)))
 #	define ET_ALIGNED(A)					__attribute__((aligned(A)))
+#	define ET_THREAD_LOCAL					__thread
+#
+#elif (ET_PLATFORM_LINUX)
+#
+#	define ET_CALL_FUNCTION					__PRETTY_FUNCTION__
+#
+#	define ET_SUPPORT_RANGE_BASED_FOR		1
+#	define ET_SUPPORT_INITIALIZER_LIST		1
+#	define ET_SUPPORT_VARIADIC_TEMPLATES	1
+#
+#	define ET_OBJC_ARC_ENABLED				0
+#
+#	define ET_DEPRECATED					__attribute__((deprecated))
+#	define ET_FORMAT_FUNCTION				__attribute__((format(printf, 1, 2)))
+#	define ET_FORMAT_FUNCTION_IN_CLASS		__attribute__((format(printf, 2, 3)))
+#	define ET_ALIGNED(A)					__attribute__((aligned(A)))
+#	define ET_THREAD_LOCAL					__thread
 #
 #else
 #
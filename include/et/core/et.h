@@ -88,6 +88,7 @@ namespace et
 #include <et/core/conversionbase.h>
 #include <et/core/object.h>
 #include <et/core/stream.h>
+#include <et/core/mappedfile.h>
 #include <et/core/hierarchy.h>
 #include <et/core/dictionary.h>
 
@@ -32,6 +32,10 @@ namespace et
 		virtual void sendToBack(T*);
 
 	protected:
+		/*
+		 * Called for the parent, child may be not fully constructed yet
+		 */
+		virtual void childAdded(T*) { }
 		virtual void childRemoved(T*) { }
 		void removeChildren();
 
@@ -79,7 +83,10 @@ namespace et
 
 	template <typename T, typename BASE>
 	void Hierarchy<T, BASE>::pushChild(T* c)
-		{ _children.push_back(typename Hierarchy<T, BASE>::BasePointer(c)); }
+	{
+		_children.push_back(typename Hierarchy<T, BASE>::BasePointer(c));
+		childAdded(c);
+	}
 
 	template <typename T, typename BASE>
 	bool Hierarchy<T, BASE>::addChild(T* c)
@@ -160,7 +167,10 @@ namespace et
 	void Hierarchy<T, BASE>::removeChildren()
 	{
 		for (auto c : _children)
+		{
+			childRemoved(c.ptr());
 			c->removeParent();
+		}
 		
 		_children.clear();
 	}
@@ -0,0 +1,46 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+namespace et
+{
+	/*
+	 * Read-only file mapped into memory, pages are loaded on first access.
+	 * Mapping is copy-on-write: content could be modified in memory, file stays unchanged.
+	 */
+	class MappedFilePrivate;
+	class MappedFile : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(MappedFile)
+		
+	public:
+		MappedFile(const std::string& fileName);
+		~MappedFile();
+
+		bool valid() const
+			{ return _data != nullptr; }
+
+		char* data()
+			{ return _data; }
+
+		const char* data() const
+			{ return _data; }
+
+		size_t size() const
+			{ return _size; }
+
+	private:
+		ET_DENY_COPY(MappedFile)
+		ET_DECLARE_PIMPL(MappedFile, 32)
+
+	private:
+		char* _data = nullptr;
+		size_t _size = 0;
+	};
+}
@@ -93,6 +93,10 @@ namespace et
 			{ log::info("Not available for DefaultMemoryAllocator"); }
 	};
 	
+	/*
+	 * Allocations up to 2048 bytes are served from size-class slabs through per-thread caches,
+	 * larger ones are placed into shared memory chunks
+	 */
 	class BlockMemoryAllocatorPrivate;
 	class BlockMemoryAllocator : public MemoryAllocatorBase
 	{
@@ -110,8 +114,7 @@ namespace et
 		void flushUnusedBlocks();
 				
 	private:
-		BlockMemoryAllocatorPrivate* _private = nullptr;
-		char _privateData[256];
+		ET_DECLARE_PIMPL(BlockMemoryAllocator, 4096)
 	};
 	
 }
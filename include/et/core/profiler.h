@@ -0,0 +1,123 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/singleton.h>
+#include <et/core/tools.h>
+#include <et/threading/criticalsection.h>
+
+#if !defined(ET_ENABLE_PROFILER)
+#	define ET_ENABLE_PROFILER	1
+#endif
+
+namespace et
+{
+	struct ProfilerEvent
+	{
+		const char* name = nullptr;
+		uint64_t startTime = 0;
+		uint64_t duration = 0;
+	};
+
+	class ProfilerThreadBuffer;
+	struct ProfilerThreadBufferReleaser;
+
+	/*
+	 * Collects CPU scopes from all threads while capture is active.
+	 * Every thread writes completed scopes into its own ring buffer without locks,
+	 * oldest events are overwritten when ring buffer is full. Ring buffer is allocated
+	 * by the first scope submitted during capture, buffers of exited threads are reused.
+	 * Scope names should be string literals (or strings that outlive the capture).
+	 */
+	class Profiler : public Singleton<Profiler>
+	{
+	public:
+		enum : size_t
+		{
+			EventsPerThread = 16384
+		};
+
+	public:
+		~Profiler();
+
+		void beginCapture();
+		void endCapture();
+
+		bool capturing() const
+			{ return _capturing; }
+
+		void submit(const char* name, uint64_t startTime, uint64_t duration);
+
+		/*
+		 * Name displayed for the calling thread in exported trace
+		 */
+		void setThreadName(const std::string&);
+
+		/*
+		 * Exports events of the last capture in Chrome trace format
+		 * (chrome://tracing, Perfetto UI)
+		 */
+		void writeChromeTrace(std::ostream&);
+		bool saveChromeTrace(const std::string& fileName);
+
+	private:
+		ET_SINGLETON_CONSTRUCTORS(Profiler)
+
+		ProfilerThreadBuffer* threadBuffer();
+		void releaseThreadBuffer(ProfilerThreadBuffer*);
+		bool holdsCapturedEvents(ProfilerThreadBuffer*);
+
+		friend struct ProfilerThreadBufferReleaser;
+
+	private:
+		CriticalSection _csBuffers;
+		ProfilerThreadBuffer* _buffers = nullptr;
+		size_t _buffersCount = 0;
+
+		uint64_t _captureStartTime = 0;
+		uint64_t _captureEndTime = 0;
+		AtomicBool _capturing;
+	};
+
+	class ProfilerScope
+	{
+	public:
+		ProfilerScope(const char* name) :
+			_name(name), _active(Profiler::instance().capturing())
+		{
+			if (_active)
+				_startTime = queryCurrentTimeInMicroSeconds();
+		}
+
+		~ProfilerScope()
+		{
+			if (_active)
+				Profiler::instance().submit(_name, _startTime, queryCurrentTimeInMicroSeconds() - _startTime);
+		}
+
+	private:
+		ET_DENY_COPY(ProfilerScope)
+
+	private:
+		const char* _name = nullptr;
+		uint64_t _startTime = 0;
+		bool _active = false;
+	};
+}
+
+#if (ET_ENABLE_PROFILER)
+#	define ET_PROFILER_CONCAT_IMPL(A, B)	A##B
+#	define ET_PROFILER_CONCAT(A, B)			ET_PROFILER_CONCAT_IMPL(A, B)
+#	define ET_PROFILE_SCOPE(NAME)			et::ProfilerScope ET_PROFILER_CONCAT(profilerScope, __LINE__)(NAME)
+#	define ET_PROFILE_FUNCTION()			ET_PROFILE_SCOPE(ET_CALL_FUNCTION)
+#	define ET_PROFILE_THREAD(NAME)			et::Profiler::instance().setThreadName(NAME)
+#else
+#	define ET_PROFILE_SCOPE(NAME)			(void)0
+#	define ET_PROFILE_FUNCTION()			(void)0
+#	define ET_PROFILE_THREAD(NAME)			(void)0
+#endif
@@ -29,14 +29,20 @@ namespace et
 		{ serializeInt(stream, static_cast<int32_t>(value & 0xffffffff)); }
 	
 	inline void serializeInt(std::ostream& stream, unsigned long value)
-		{ serializeInt(stream, static_cast<uint32_t>(value & 0xfffffff)); }
+		{ serializeInt(stream, static_cast<uint32_t>(value & 0xffffffff)); }
 	
-	inline void serializeInt(std::ostream& stream, int64_t value)
+	inline void serializeInt(std::ostream& stream, long long value)
 		{ serializeInt(stream, static_cast<int32_t>(value & 0xffffffff)); }
 
-	inline void serializeInt(std::ostream& stream, uint64_t value)
+	inline void serializeInt(std::ostream& stream, unsigned long long value)
 		{ serializeInt(stream, static_cast<uint32_t>(value & 0xffffffff)); }
 
+	inline void serializeUInt64(std::ostream& stream, uint64_t value)
+	{
+		ET_ASSERT(stream.good());
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
 	inline int32_t deserializeInt(std::istream& stream)
 	{
 		ET_ASSERT(stream.good());
@@ -55,6 +61,15 @@ namespace et
 		return value;
 	}
 	
+	inline uint64_t deserializeUInt64(std::istream& stream)
+	{
+		ET_ASSERT(stream.good());
+		
+		uint64_t value = 0;
+		stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+	
 	inline size_t deserializeSizeT(std::istream& stream)
 	{
 		ET_ASSERT(stream.good());
@@ -483,6 +483,12 @@ namespace et
 
 	vec3 removeMatrixScale(mat3& m);
 	void decomposeMatrix(const mat4& mat, vec3& translation, quaternion& rotation, vec3& scale);
+
+	/*
+	 * Batch versions of m * v, input and output may point to the same array
+	 */
+	void transformPoints(const mat4& m, const vec3* input, vec3* output, size_t count);
+	void transformPoints(const mat4& m, const vec4* input, vec4* output, size_t count);
 	
 	vec3 randVector(float sx = 1.0f, float sy = 1.0f, float sz = 1.0f);
 	
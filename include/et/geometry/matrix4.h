@@ -341,5 +341,47 @@ namespace et
 			return matrix4(r1, r2, r3, mat[3]);
 		}
 	};
+
+	/*
+	 * Float matrices use SIMD kernels from simd.h
+	 */
+	template <>
+	inline matrix4<float> matrix4<float>::operator * (const matrix4<float>& m) const
+	{
+		matrix4<float> result;
+		simd::multiplyMatrices(data(), m.data(), result.data());
+		return result;
+	}
+
+	template <>
+	inline matrix4<float>& matrix4<float>::operator *= (const matrix4<float>& m)
+	{
+		simd::multiplyMatrices(data(), m.data(), data());
+		return *this;
+	}
+
+	template <>
+	inline vector4<float> matrix4<float>::operator * (const vector4<float>& v) const
+	{
+		vector4<float> result;
+		simd::transformVector(data(), v.data(), result.data());
+		return result;
+	}
+
+	template <>
+	inline vector3<float> matrix4<float>::operator * (const vector3<float>& v) const
+	{
+		vector4<float> result;
+		simd::transformVector(data(), vector4<float>(v, 1.0f).data(), result.data());
+		return (result.w * result.w > 0.0f) ? result.xyz() / result.w : result.xyz();
+	}
+
+	template <>
+	inline matrix4<float> matrix4<float>::inverse() const
+	{
+		matrix4<float> result;
+		simd::invertMatrix(data(), result.data());
+		return result;
+	}
 }
 
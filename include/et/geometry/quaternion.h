@@ -125,4 +125,21 @@ namespace et
 	template <typename T>
 	inline Quaternion<T> operator * (T value, const Quaternion<T>& q)
 		{ return q * value; }
+
+	static_assert(sizeof(Quaternion<float>) == 4 * sizeof(float), "Quaternion<float> should be tightly packed");
+
+	template <>
+	inline Quaternion<float> Quaternion<float>::operator * (const Quaternion<float>& q) const
+	{
+		Quaternion<float> result;
+		simd::multiplyQuaternions(&scalar, &q.scalar, &result.scalar);
+		return result;
+	}
+
+	template <>
+	inline Quaternion<float>& Quaternion<float>::operator *= (const Quaternion<float>& q)
+	{
+		simd::multiplyQuaternions(&scalar, &q.scalar, &scalar);
+		return *this;
+	}
 }
@@ -0,0 +1,409 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#if (ET_SIMD_AVX)
+#	include <immintrin.h>
+#elif (ET_SIMD_SSE41)
+#	include <smmintrin.h>
+#elif (ET_SIMD_SSE)
+#	include <emmintrin.h>
+#elif (ET_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
+namespace et
+{
+	/*
+	 * Kernels behind float specializations of vector4, matrix4 and Quaternion.
+	 * Matrices are 16 floats stored row by row (as matrix4::mat), quaternions
+	 * are stored as (scalar, x, y, z). Pointers are not required to be aligned.
+	 * Implementation is selected at compile time: AVX, SSE4.1, SSE2, NEON or scalar.
+	 */
+	namespace simd
+	{
+#	if (ET_SIMD_SSE)
+#		define ET_SIMD_SHUFFLE_MASK(X, Y, Z, W)	((X) | ((Y) << 2) | ((Z) << 4) | ((W) << 6))
+#		define ET_SIMD_SWIZZLE(V, X, Y, Z, W)	_mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(V), ET_SIMD_SHUFFLE_MASK(X, Y, Z, W)))
+#		define ET_SIMD_SHUFFLE(A, B, X, Y, Z, W)	_mm_shuffle_ps(A, B, ET_SIMD_SHUFFLE_MASK(X, Y, Z, W))
+
+		inline __m128 linearCombination(__m128 a, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+		{
+			__m128 r = _mm_mul_ps(ET_SIMD_SWIZZLE(a, 0, 0, 0, 0), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(ET_SIMD_SWIZZLE(a, 1, 1, 1, 1), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(ET_SIMD_SWIZZLE(a, 2, 2, 2, 2), b2));
+			return _mm_add_ps(r, _mm_mul_ps(ET_SIMD_SWIZZLE(a, 3, 3, 3, 3), b3));
+		}
+
+		/*
+		 * 2x2 blocks stored as (m00, m01, m10, m11): A * B, adj(A) * B, A * adj(B)
+		 */
+		inline __m128 mat2Mul(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(_mm_mul_ps(a, ET_SIMD_SWIZZLE(b, 0, 3, 0, 3)),
+				_mm_mul_ps(ET_SIMD_SWIZZLE(a, 1, 0, 3, 2), ET_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+		}
+
+		inline __m128 mat2AdjMul(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(ET_SIMD_SWIZZLE(a, 3, 3, 0, 0), b),
+				_mm_mul_ps(ET_SIMD_SWIZZLE(a, 1, 1, 2, 2), ET_SIMD_SWIZZLE(b, 2, 3, 0, 1)));
+		}
+
+		inline __m128 mat2MulAdj(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(a, ET_SIMD_SWIZZLE(b, 3, 0, 3, 0)),
+				_mm_mul_ps(ET_SIMD_SWIZZLE(a, 1, 0, 3, 2), ET_SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+		}
+#	endif
+
+		inline void multiplyMatrices(const float* a, const float* b, float* r)
+		{
+#		if (ET_SIMD_AVX)
+			__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+			__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+			__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+			__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+			for (int i = 0; i < 16; i += 8)
+			{
+				__m256 rows = _mm256_loadu_ps(a + i);
+				__m256 result = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xaa), b2));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xff), b3));
+				_mm256_storeu_ps(r + i, result);
+			}
+#		elif (ET_SIMD_SSE)
+			__m128 b0 = _mm_loadu_ps(b);
+			__m128 b1 = _mm_loadu_ps(b + 4);
+			__m128 b2 = _mm_loadu_ps(b + 8);
+			__m128 b3 = _mm_loadu_ps(b + 12);
+			__m128 r0 = linearCombination(_mm_loadu_ps(a), b0, b1, b2, b3);
+			__m128 r1 = linearCombination(_mm_loadu_ps(a + 4), b0, b1, b2, b3);
+			__m128 r2 = linearCombination(_mm_loadu_ps(a + 8), b0, b1, b2, b3);
+			__m128 r3 = linearCombination(_mm_loadu_ps(a + 12), b0, b1, b2, b3);
+			_mm_storeu_ps(r, r0);
+			_mm_storeu_ps(r + 4, r1);
+			_mm_storeu_ps(r + 8, r2);
+			_mm_storeu_ps(r + 12, r3);
+#		elif (ET_SIMD_NEON)
+			float32x4_t b0 = vld1q_f32(b);
+			float32x4_t b1 = vld1q_f32(b + 4);
+			float32x4_t b2 = vld1q_f32(b + 8);
+			float32x4_t b3 = vld1q_f32(b + 12);
+			float32x4_t rows[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				float32x4_t row = vld1q_f32(a + 4 * i);
+				rows[i] = vmulq_lane_f32(b0, vget_low_f32(row), 0);
+				rows[i] = vmlaq_lane_f32(rows[i], b1, vget_low_f32(row), 1);
+				rows[i] = vmlaq_lane_f32(rows[i], b2, vget_high_f32(row), 0);
+				rows[i] = vmlaq_lane_f32(rows[i], b3, vget_high_f32(row), 1);
+			}
+			for (int i = 0; i < 4; ++i)
+				vst1q_f32(r + 4 * i, rows[i]);
+#		else
+			float result[16];
+			for (int i = 0; i < 16; i += 4)
+			{
+				for (int j = 0; j < 4; ++j)
+					result[i + j] = a[i] * b[j] + a[i+1] * b[4+j] + a[i+2] * b[8+j] + a[i+3] * b[12+j];
+			}
+			for (int i = 0; i < 16; ++i)
+				r[i] = result[i];
+#		endif
+		}
+
+		/*
+		 * r = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w
+		 */
+		inline void transformVector(const float* m, const float* v, float* r)
+		{
+#		if (ET_SIMD_SSE)
+			_mm_storeu_ps(r, linearCombination(_mm_loadu_ps(v), _mm_loadu_ps(m),
+				_mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12)));
+#		elif (ET_SIMD_NEON)
+			float32x4_t vec = vld1q_f32(v);
+			float32x4_t result = vmulq_lane_f32(vld1q_f32(m), vget_low_f32(vec), 0);
+			result = vmlaq_lane_f32(result, vld1q_f32(m + 4), vget_low_f32(vec), 1);
+			result = vmlaq_lane_f32(result, vld1q_f32(m + 8), vget_high_f32(vec), 0);
+			result = vmlaq_lane_f32(result, vld1q_f32(m + 12), vget_high_f32(vec), 1);
+			vst1q_f32(r, result);
+#		else
+			float x = v[0];
+			float y = v[1];
+			float z = v[2];
+			float w = v[3];
+			for (int i = 0; i < 4; ++i)
+				r[i] = m[i] * x + m[4+i] * y + m[8+i] * z + m[12+i] * w;
+#		endif
+		}
+
+		/*
+		 * Returns false and fills result with zeros for singular matrices
+		 */
+		inline bool invertMatrix(const float* m, float* r)
+		{
+#		if (ET_SIMD_SSE)
+			__m128 r0 = _mm_loadu_ps(m);
+			__m128 r1 = _mm_loadu_ps(m + 4);
+			__m128 r2 = _mm_loadu_ps(m + 8);
+			__m128 r3 = _mm_loadu_ps(m + 12);
+
+			__m128 a = _mm_movelh_ps(r0, r1);
+			__m128 b = _mm_movehl_ps(r1, r0);
+			__m128 c = _mm_movelh_ps(r2, r3);
+			__m128 d = _mm_movehl_ps(r3, r2);
+
+			__m128 detSub = _mm_sub_ps(
+				_mm_mul_ps(ET_SIMD_SHUFFLE(r0, r2, 0, 2, 0, 2), ET_SIMD_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+				_mm_mul_ps(ET_SIMD_SHUFFLE(r0, r2, 1, 3, 1, 3), ET_SIMD_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+			__m128 detA = ET_SIMD_SWIZZLE(detSub, 0, 0, 0, 0);
+			__m128 detB = ET_SIMD_SWIZZLE(detSub, 1, 1, 1, 1);
+			__m128 detC = ET_SIMD_SWIZZLE(detSub, 2, 2, 2, 2);
+			__m128 detD = ET_SIMD_SWIZZLE(detSub, 3, 3, 3, 3);
+
+			__m128 dc = mat2AdjMul(d, c);
+			__m128 ab = mat2AdjMul(a, b);
+			__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+			__m128 trace = _mm_mul_ps(ab, ET_SIMD_SWIZZLE(dc, 0, 2, 1, 3));
+			trace = _mm_add_ps(trace, ET_SIMD_SWIZZLE(trace, 2, 3, 0, 1));
+			trace = _mm_add_ps(trace, ET_SIMD_SWIZZLE(trace, 1, 0, 3, 2));
+
+			__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+			float detValue = _mm_cvtss_f32(det);
+			if (!(detValue * detValue > 0.0f))
+			{
+				for (int i = 0; i < 16; ++i)
+					r[i] = 0.0f;
+				return false;
+			}
+
+			__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+			x = _mm_mul_ps(x, invDet);
+			y = _mm_mul_ps(y, invDet);
+			z = _mm_mul_ps(z, invDet);
+			w = _mm_mul_ps(w, invDet);
+
+			_mm_storeu_ps(r, ET_SIMD_SHUFFLE(x, y, 3, 1, 3, 1));
+			_mm_storeu_ps(r + 4, ET_SIMD_SHUFFLE(x, y, 2, 0, 2, 0));
+			_mm_storeu_ps(r + 8, ET_SIMD_SHUFFLE(z, w, 3, 1, 3, 1));
+			_mm_storeu_ps(r + 12, ET_SIMD_SHUFFLE(z, w, 2, 0, 2, 0));
+			return true;
+#		else
+			float s0 = m[0] * m[5] - m[4] * m[1];
+			float s1 = m[0] * m[6] - m[4] * m[2];
+			float s2 = m[0] * m[7] - m[4] * m[3];
+			float s3 = m[1] * m[6] - m[5] * m[2];
+			float s4 = m[1] * m[7] - m[5] * m[3];
+			float s5 = m[2] * m[7] - m[6] * m[3];
+			float c5 = m[10] * m[15] - m[14] * m[11];
+			float c4 = m[9] * m[15] - m[13] * m[11];
+			float c3 = m[9] * m[14] - m[13] * m[10];
+			float c2 = m[8] * m[15] - m[12] * m[11];
+			float c1 = m[8] * m[14] - m[12] * m[10];
+			float c0 = m[8] * m[13] - m[12] * m[9];
+
+			float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (!(det * det > 0.0f))
+			{
+				for (int i = 0; i < 16; ++i)
+					r[i] = 0.0f;
+				return false;
+			}
+
+			float invDet = 1.0f / det;
+			float result[16] =
+			{
+				( m[5] * c5 - m[6] * c4 + m[7] * c3) * invDet,
+				(-m[1] * c5 + m[2] * c4 - m[3] * c3) * invDet,
+				( m[13] * s5 - m[14] * s4 + m[15] * s3) * invDet,
+				(-m[9] * s5 + m[10] * s4 - m[11] * s3) * invDet,
+				(-m[4] * c5 + m[6] * c2 - m[7] * c1) * invDet,
+				( m[0] * c5 - m[2] * c2 + m[3] * c1) * invDet,
+				(-m[12] * s5 + m[14] * s2 - m[15] * s1) * invDet,
+				( m[8] * s5 - m[10] * s2 + m[11] * s1) * invDet,
+				( m[4] * c4 - m[5] * c2 + m[7] * c0) * invDet,
+				(-m[0] * c4 + m[1] * c2 - m[3] * c0) * invDet,
+				( m[12] * s4 - m[13] * s2 + m[15] * s0) * invDet,
+				(-m[8] * s4 + m[9] * s2 - m[11] * s0) * invDet,
+				(-m[4] * c3 + m[5] * c1 - m[6] * c0) * invDet,
+				( m[0] * c3 - m[1] * c1 + m[2] * c0) * invDet,
+				(-m[12] * s3 + m[13] * s1 - m[14] * s0) * invDet,
+				( m[8] * s3 - m[9] * s1 + m[10] * s0) * invDet,
+			};
+			for (int i = 0; i < 16; ++i)
+				r[i] = result[i];
+			return true;
+#		endif
+		}
+
+		/*
+		 * Hamilton product of quaternions stored as (scalar, x, y, z)
+		 */
+		inline void multiplyQuaternions(const float* a, const float* b, float* r)
+		{
+#		if (ET_SIMD_SSE)
+			__m128 qa = _mm_loadu_ps(a);
+			__m128 qb = _mm_loadu_ps(b);
+			__m128 result = _mm_mul_ps(ET_SIMD_SWIZZLE(qa, 0, 0, 0, 0), qb);
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(ET_SIMD_SWIZZLE(qa, 1, 1, 1, 1),
+				ET_SIMD_SWIZZLE(qb, 1, 0, 3, 2)), _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f)));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(ET_SIMD_SWIZZLE(qa, 2, 2, 2, 2),
+				ET_SIMD_SWIZZLE(qb, 2, 3, 0, 1)), _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f)));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_mul_ps(ET_SIMD_SWIZZLE(qa, 3, 3, 3, 3),
+				ET_SIMD_SWIZZLE(qb, 3, 2, 1, 0)), _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f)));
+			_mm_storeu_ps(r, result);
+#		elif (ET_SIMD_NEON)
+			static const float signs[12] = { -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f };
+			float32x4_t qa = vld1q_f32(a);
+			float32x4_t qb = vld1q_f32(b);
+			float32x4_t qb1032 = vrev64q_f32(qb);
+			float32x4_t qb2301 = vcombine_f32(vget_high_f32(qb), vget_low_f32(qb));
+			float32x4_t qb3210 = vrev64q_f32(qb2301);
+			float32x4_t result = vmulq_lane_f32(qb, vget_low_f32(qa), 0);
+			result = vmlaq_lane_f32(result, vmulq_f32(qb1032, vld1q_f32(signs)), vget_low_f32(qa), 1);
+			result = vmlaq_lane_f32(result, vmulq_f32(qb2301, vld1q_f32(signs + 4)), vget_high_f32(qa), 0);
+			result = vmlaq_lane_f32(result, vmulq_f32(qb3210, vld1q_f32(signs + 8)), vget_high_f32(qa), 1);
+			vst1q_f32(r, result);
+#		else
+			float s = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+			float x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+			float y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+			float z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+			r[0] = s;
+			r[1] = x;
+			r[2] = y;
+			r[3] = z;
+#		endif
+		}
+
+		inline float dot4(const float* a, const float* b)
+		{
+#		if (ET_SIMD_SSE41)
+			return _mm_cvtss_f32(_mm_dp_ps(_mm_loadu_ps(a), _mm_loadu_ps(b), 0xf1));
+#		elif (ET_SIMD_NEON)
+			float32x4_t p = vmulq_f32(vld1q_f32(a), vld1q_f32(b));
+			float32x2_t s = vadd_f32(vget_low_f32(p), vget_high_f32(p));
+			return vget_lane_f32(vpadd_f32(s, s), 0);
+#		else
+			return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+#		endif
+		}
+
+		/*
+		 * Four cross products at once, vectors are stored as x[4], y[4], z[4]
+		 */
+		inline void crossProducts4(const float* a, const float* b, float* r)
+		{
+#		if (ET_SIMD_SSE)
+			__m128 ax = _mm_loadu_ps(a);
+			__m128 ay = _mm_loadu_ps(a + 4);
+			__m128 az = _mm_loadu_ps(a + 8);
+			__m128 bx = _mm_loadu_ps(b);
+			__m128 by = _mm_loadu_ps(b + 4);
+			__m128 bz = _mm_loadu_ps(b + 8);
+			_mm_storeu_ps(r, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)));
+			_mm_storeu_ps(r + 4, _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)));
+			_mm_storeu_ps(r + 8, _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+#		elif (ET_SIMD_NEON)
+			float32x4_t ax = vld1q_f32(a);
+			float32x4_t ay = vld1q_f32(a + 4);
+			float32x4_t az = vld1q_f32(a + 8);
+			float32x4_t bx = vld1q_f32(b);
+			float32x4_t by = vld1q_f32(b + 4);
+			float32x4_t bz = vld1q_f32(b + 8);
+			vst1q_f32(r, vmlsq_f32(vmulq_f32(ay, bz), az, by));
+			vst1q_f32(r + 4, vmlsq_f32(vmulq_f32(az, bx), ax, bz));
+			vst1q_f32(r + 8, vmlsq_f32(vmulq_f32(ax, by), ay, bx));
+#		else
+			for (int i = 0; i < 4; ++i)
+			{
+				float x = a[4 + i] * b[8 + i] - a[8 + i] * b[4 + i];
+				float y = a[8 + i] * b[i] - a[i] * b[8 + i];
+				float z = a[i] * b[4 + i] - a[4 + i] * b[i];
+				r[i] = x;
+				r[4 + i] = y;
+				r[8 + i] = z;
+			}
+#		endif
+		}
+
+		/*
+		 * Integrates one coordinate of four particles: v += dt * a, p += dt * v
+		 */
+		inline void integrate4(float* p, float* v, const float* a, float dt)
+		{
+#		if (ET_SIMD_SSE)
+			__m128 d = _mm_set1_ps(dt);
+			__m128 vv = _mm_add_ps(_mm_loadu_ps(v), _mm_mul_ps(d, _mm_loadu_ps(a)));
+			_mm_storeu_ps(v, vv);
+			_mm_storeu_ps(p, _mm_add_ps(_mm_loadu_ps(p), _mm_mul_ps(d, vv)));
+#		elif (ET_SIMD_NEON)
+			float32x4_t vv = vmlaq_n_f32(vld1q_f32(v), vld1q_f32(a), dt);
+			vst1q_f32(v, vv);
+			vst1q_f32(p, vmlaq_n_f32(vld1q_f32(p), vv, dt));
+#		else
+			for (int i = 0; i < 4; ++i)
+			{
+				v[i] += dt * a[i];
+				p[i] += dt * v[i];
+			}
+#		endif
+		}
+
+		/*
+		 * Fades four particles: alpha = clamp(1 - (t - emitTime) / lifeTime, 0, 1),
+		 * returns mask of the particles which are still alive, bit per particle
+		 */
+		inline uint32_t fade4(float* alpha, const float* emitTime, const float* lifeTime, float t)
+		{
+#		if (ET_SIMD_SSE)
+			__m128 one = _mm_set1_ps(1.0f);
+			__m128 age = _mm_sub_ps(_mm_set1_ps(t), _mm_loadu_ps(emitTime));
+			__m128 life = _mm_loadu_ps(lifeTime);
+			__m128 a = _mm_sub_ps(one, _mm_div_ps(age, life));
+			_mm_storeu_ps(alpha, _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), one));
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(age, life)));
+#		elif (ET_SIMD_NEON)
+			static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+			float32x4_t one = vdupq_n_f32(1.0f);
+			float32x4_t age = vsubq_f32(vdupq_n_f32(t), vld1q_f32(emitTime));
+			float32x4_t life = vld1q_f32(lifeTime);
+			float32x4_t inv = vrecpeq_f32(life);
+			inv = vmulq_f32(inv, vrecpsq_f32(life, inv));
+			inv = vmulq_f32(inv, vrecpsq_f32(life, inv));
+			float32x4_t a = vmlsq_f32(one, age, inv);
+			vst1q_f32(alpha, vminq_f32(vmaxq_f32(a, vdupq_n_f32(0.0f)), one));
+			uint32x4_t bits = vandq_u32(vcleq_f32(age, life), vld1q_u32(laneBits));
+			uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+			return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#		else
+			uint32_t mask = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				float age = t - emitTime[i];
+				float a = 1.0f - age / lifeTime[i];
+				alpha[i] = (a < 0.0f) ? 0.0f : ((a > 1.0f) ? 1.0f : a);
+				mask |= static_cast<uint32_t>(age <= lifeTime[i]) << i;
+			}
+			return mask;
+#		endif
+		}
+
+#	if (ET_SIMD_SSE)
+#		undef ET_SIMD_SHUFFLE
+#		undef ET_SIMD_SWIZZLE
+#		undef ET_SIMD_SHUFFLE_MASK
+#	endif
+	}
+}
@@ -9,6 +9,7 @@
 
 #include <et/geometry/vector2.h>
 #include <et/geometry/vector3.h>
+#include <et/geometry/simd.h>
 
 namespace et
 {
@@ -176,4 +177,12 @@ namespace et
 	template <typename T>
 	inline vector4<T> operator * (T value, const vector4<T>& vec)
 		{ return vector4<T>(vec.x * value, vec.y * value, vec.z * value, vec.w * value); }
+
+	template <>
+	inline float vector4<float>::dot(const vector4<float>& vector) const
+		{ return simd::dot4(c, vector.c); }
+
+	template <>
+	inline float vector4<float>::dotSelf() const
+		{ return simd::dot4(c, c); }
 }
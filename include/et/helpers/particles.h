@@ -9,9 +9,12 @@
 #pragma once
 
 #include <et/core/et.h>
+#include <et/vertexbuffer/vertexarray.h>
 
 namespace et
 {
+	class JobSystem;
+	
 	vec3 randVector(float, float, float);
 	float randomFloat(float, float);
 
@@ -202,5 +205,120 @@ namespace et
 		
 		typedef Emitter<PointSprite> PointSpriteEmitter;
 		
+		/*
+		 * Point sprites emitter, which stores each attribute in the separate array (structure of arrays)
+		 * and updates them with SIMD, four particles at once. Movement is the same as in
+		 * defaultMovementFunction and could not be customized, so no functions are called per particle.
+		 * Dead particles are removed without branching, large emitters are split between worker threads.
+		 */
+		class PointSpriteStreamEmitter
+		{
+		public:
+			ET_DECLARE_POINTER(PointSpriteStreamEmitter)
+			
+		public:
+			PointSpriteStreamEmitter(size_t capacity);
+			
+			size_t capacity() const
+				{ return _capacity; }
+			
+			size_t activeParticlesCount() const
+				{ return _activeParticles; }
+			
+			PointSprite particle(size_t) const;
+			void setParticle(size_t, const PointSprite&);
+			
+			void setShouldAutoRenewParticles(bool a)
+				{ _autoRenewParticles = a; }
+			
+			PointSprite& base()
+				{ return _base; }
+			
+			const PointSprite& base() const
+				{ return _base; }
+			
+			PointSprite& variation()
+				{ return _variation; }
+			
+			const PointSprite& variation() const
+				{ return _variation; }
+			
+			void setBase(const PointSprite& p)
+				{ _base = p; }
+			
+			void setVariation(const PointSprite& v)
+				{ _variation = v; }
+			
+			bool emit(const PointSprite&);
+			size_t emit(size_t count, float t);
+			size_t emit(size_t count, float t, const PointSprite& base, const PointSprite& var);
+			size_t emitMissingParticles(float t);
+			
+			void clear()
+				{ _activeParticles = 0; }
+			
+			void update(float t);
+			void update(float t, JobSystem&);
+			
+			/*
+			 * Writes position (Vec3, or Vec4 with size in w) and color (Vec3 or Vec4) of the active particles
+			 * into the interleaved vertex data, other attributes are not touched
+			 */
+			void writeVertices(const VertexDeclaration&, void* data, size_t dataSize) const;
+			void writeVertices(const VertexDeclaration&, void* data, size_t dataSize, JobSystem&) const;
+			void writeVertices(VertexArray::Description&, JobSystem&) const;
+			
+		private:
+			enum Stream : size_t
+			{
+				Stream_PositionX,
+				Stream_PositionY,
+				Stream_PositionZ,
+				Stream_VelocityX,
+				Stream_VelocityY,
+				Stream_VelocityZ,
+				Stream_AccelerationX,
+				Stream_AccelerationY,
+				Stream_AccelerationZ,
+				Stream_ColorR,
+				Stream_ColorG,
+				Stream_ColorB,
+				Stream_ColorA,
+				Stream_Size,
+				Stream_EmitTime,
+				Stream_LifeTime,
+				
+				Stream_max
+			};
+			
+			float* stream(size_t s)
+				{ return _streams.data() + s * _streamSize; }
+			
+			const float* stream(size_t s) const
+				{ return _streams.data() + s * _streamSize; }
+			
+			static void particleValues(const PointSprite&, float*);
+			
+			void update(float t, JobSystem*);
+			size_t updateRange(size_t first, size_t last, float t, float dt);
+			void writeVertices(const VertexDeclaration&, void*, size_t, JobSystem*) const;
+			
+		private:
+			std::vector<float> _streams;
+			std::vector<uint8_t> _aliveFlags;
+			std::vector<uint32_t> _compactionIndices;
+			std::vector<size_t> _aliveInRange;
+			
+			PointSprite _base;
+			PointSprite _variation;
+			
+			size_t _capacity = 0;
+			size_t _streamSize = 0;
+			size_t _activeParticles = 0;
+			uint32_t _randomState = 0;
+			float _updateTime = 0.0f;
+			bool _autoRenewParticles = true;
+		};
+		
 	};
 }
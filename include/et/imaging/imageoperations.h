@@ -11,6 +11,8 @@
 
 namespace et
 {
+	class JobSystem;
+
 	class PixelFilter
 	{
 	public:
@@ -27,7 +29,8 @@ namespace et
 	enum ImageBlurType
 	{
 		ImageBlurType_Average,
-		ImageBlurType_Linear
+		ImageBlurType_Linear,
+		ImageBlurType_Gaussian
 	};
 
 	enum ImageFilteringType
@@ -53,12 +56,27 @@ namespace et
 		static void fill(BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const recti& r, const vec4ub& color);
 
 		static void applyPixelFilter(BinaryDataStorage& data, const vec2i& size, int components, PixelFilter* filter, void* context);
+
 		static void applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m);
+		static void applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m, JobSystem&);
 
+		/*
+		 * Sliding window blur along the direction, constant time per pixel for any radius.
+		 * Linear is a triangle filter (two box passes), Gaussian (sigma = radius / 2) is approximated
+		 * with three box passes. Rows and columns are blurred in place, without copying the image.
+		 */
 		static void blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius, ImageBlurType type);
+		static void blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+			ImageBlurType type, JobSystem&);
+
+		/*
+		 * Median of each component in the (2 * radius + 1) square, histogram based (Perreault, Hebert),
+		 * constant time per pixel for any radius
+		 */
 		static void median(BinaryDataStorage& data, const vec2i& size, int components, int radius);
+		static void median(BinaryDataStorage& data, const vec2i& size, int components, int radius, JobSystem&);
 
 		static void normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale);
-
+		static void normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale, JobSystem&);
 	};
 }
@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <queue>
+#include <deque>
 #include <et/threading/thread.h>
 #include <et/threading/criticalsection.h>
 #include <et/rendering/texture.h>
@@ -39,44 +39,136 @@ namespace et
 		TextureLoadingRequestList _requests;
 	};
 
+	/*
+	 * Requests are decoded in order of priority, FIFO within the same priority
+	 */
+	enum class TextureLoadingPriority : uint32_t
+	{
+		Visible,
+		Prefetch,
+		Background,
+
+		max
+	};
+
+	class TextureLoadingPool;
 	struct TextureLoadingRequest
 	{
 		std::string fileName;
 		TextureDescription::Pointer textureDescription;
 		Texture::Pointer texture;
-		TextureLoaderDelegate* delegate = nullptr;
+		std::vector<TextureLoaderDelegate*> delegates;
+		TextureLoadingPriority priority = TextureLoadingPriority::Visible;
+		TextureLoadingPool* owner = nullptr;
+
+		/*
+		 * Timestamps in milliseconds, see queryContiniousTimeInMilliSeconds
+		 */
+		uint64_t queuedTime = 0;
+		uint64_t decodeStartTime = 0;
+		uint64_t decodeEndTime = 0;
+
+		bool queued = false;
+		bool cancelled = false;
 
 		TextureLoadingRequest(const std::string& name, const Texture::Pointer& tex, TextureLoaderDelegate* d);
 		~TextureLoadingRequest();
 		
-		void discardDelegate();
+		void addDelegate(TextureLoaderDelegate*);
+		void discardDelegate(TextureLoaderDelegate*);
 	};
 	
-	typedef std::queue<TextureLoadingRequest*> TextureLoadingRequestQueue;
+	typedef std::deque<TextureLoadingRequest*> TextureLoadingRequestQueue;
+
+	struct TextureLoadingStatistics
+	{
+		size_t requestsCompleted = 0;
+		size_t requestsCoalesced = 0;
+		size_t requestsCancelled = 0;
+
+		/*
+		 * Milliseconds spent in queue and in decoding
+		 */
+		uint64_t totalWaitTime = 0;
+		uint64_t maxWaitTime = 0;
+		uint64_t totalDecodeTime = 0;
+		uint64_t maxDecodeTime = 0;
+	};
 
-	class TextureLoadingThread;
 	class TextureLoadingThreadDelegate
 	{
 	public:
 		virtual ~TextureLoadingThreadDelegate() { }
+
+		/*
+		 * Loaded data is delivered in render run loop (texture data is uploaded there),
+		 * cancelled requests are delivered in main run loop.
+		 * In both cases receiver takes ownership of the request
+		 */
 		virtual void textureLoadingThreadDidLoadTextureData(TextureLoadingRequest* request) = 0;
+		virtual void textureLoadingThreadDidCancelRequest(TextureLoadingRequest* request) = 0;
 	};
 
-	class TextureLoadingThread : public Thread
+	/*
+	 * Decodes textures on a pool of worker threads.
+	 * Requests for the file which is already pending are merged into the existing one,
+	 * request is cancelled when all of its delegates are destroyed before decoding started.
+	 */
+	class TextureLoadingWorker;
+	class TextureLoadingPool
 	{
 	public:
-		TextureLoadingThread(TextureLoadingThreadDelegate* delegate);
-		~TextureLoadingThread();
+		/*
+		 * workersCount = 0 means one worker per core, except the calling one
+		 */
+		TextureLoadingPool(TextureLoadingThreadDelegate* delegate, size_t workersCount = 0);
+		~TextureLoadingPool();
 
-		void addRequest(const std::string& fileName, Texture::Pointer texture, TextureLoaderDelegate* delegate);
+		void addRequest(const std::string& fileName, Texture::Pointer texture, TextureLoaderDelegate* delegate,
+			TextureLoadingPriority priority = TextureLoadingPriority::Visible);
+
+		/*
+		 * Attaches delegate to the pending request for the file,
+		 * returns false if there is no such request
+		 */
+		bool attachToPendingRequest(const std::string& fileName, TextureLoaderDelegate* delegate,
+			TextureLoadingPriority priority);
+
+		void setPriority(const std::string& fileName, TextureLoadingPriority priority);
+
+		/*
+		 * Should be called by delegate when texture data is uploaded,
+		 * notify is called for each of the request delegates while requests lock is held,
+		 * so delegates could not be discarded (destroyed) on another thread in the meantime.
+		 * No more delegates could be attached to the request after this call
+		 */
+		void completeRequest(TextureLoadingRequest* request, const std::function<void(TextureLoaderDelegate*)>& notify);
+
+		TextureLoadingStatistics statistics();
+
+		void stop();
 
 	private:
-		ThreadResult main();
+		friend class TextureLoadingWorker;
+		friend struct TextureLoadingRequest;
+
 		TextureLoadingRequest* dequeRequest();
+		void processRequest(TextureLoadingRequest*);
+		void discardDelegate(TextureLoadingRequest*, TextureLoaderDelegate*);
+		void promoteRequest(TextureLoadingRequest*, TextureLoadingPriority);
+		void wakeWorker();
+
+		ET_DENY_COPY(TextureLoadingPool)
 
 	private:
-		TextureLoadingThreadDelegate* _delegate;
-		TextureLoadingRequestQueue _requests;
+		TextureLoadingThreadDelegate* _delegate = nullptr;
+		std::vector<TextureLoadingWorker*> _workers;
+		size_t _workersCount = 0;
+		size_t _nextWorkerToWake = 0;
+
 		CriticalSection _requestsCriticalSection;
+		TextureLoadingRequestQueue _requests[static_cast<uint32_t>(TextureLoadingPriority::max)];
+		std::map<std::string, TextureLoadingRequest*> _pendingRequests;
+		TextureLoadingStatistics _statistics;
 	};
 }
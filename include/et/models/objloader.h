@@ -12,6 +12,7 @@
 #include <et/scene3d/material.h>
 #include <et/scene3d/storage.h>
 #include <et/rendering/rendercontext.h>
+#include <et/primitives/meshsimplifier.h>
 
 namespace et
 {
@@ -24,6 +25,8 @@ namespace et
 			Option_SupportMeshes = 0x01,
 			Option_SwapYwithZ = 0x02,
 			Option_ReverseTriangles = 0x04,
+			Option_OptimizeMeshes = 0x08,
+			Option_GenerateLods = 0x10,
 			Option_CalculateTransforms = 0x80,
 		};
 
@@ -37,21 +40,6 @@ namespace et
 		ET_DECLARE_EVENT1(loaded, s3d::ElementContainer::Pointer)
 
 	private:
-		struct OBJVertex
-		{
-			size_t numVertices = 0;
-			StaticDataStorage<size_t, 3> vertices;
-
-			size_t& operator [] (size_t i)
-				{ ET_ASSERT(i < numVertices); return vertices[i]; }
-
-			const size_t& operator [] (size_t i) const
-				{ ET_ASSERT(i < numVertices); return vertices[i]; }
-			
-			OBJVertex() : numVertices(0)
-				{ vertices.fill(0); }
-		};
-
 		struct OBJMeshIndexBounds
 		{
 			std::string name;
@@ -64,24 +52,17 @@ namespace et
 				name(n), start(s), count(c), material(m), center(aCenter) { }
 		};
 		typedef std::vector<OBJMeshIndexBounds> OBJMeshIndexBoundsList;
-		typedef std::vector<OBJVertex> VertexList;
-
-		struct OBJFace
-		{
-			int smoothingGroupIndex;
-
-			VertexList vertices;
-
-			OBJFace() : 
-				smoothingGroupIndex(0) { }
-		};
-		typedef std::vector<OBJFace> FaceList;
 
 		struct OBJGroup
 		{
 			std::string name;
 			std::string material;
-			FaceList faces;
+
+			/*
+			 * Triangulated faces, three corners per triangle,
+			 * each corner is (position, texcoord, normal) index triple
+			 */
+			std::vector<uint32_t> corners;
 			
 			OBJGroup()
 				{ }
@@ -96,6 +77,8 @@ namespace et
 	private:
 		void loadData(bool async, ObjectsCache& cache);
 		void processLoadedData();
+		void optimizeLoadedMeshes();
+		void generateLevelsOfDetail();
 		s3d::ElementContainer::Pointer generateVertexBuffers();
 
 		void loadMaterials(const std::string& fileName, bool async, ObjectsCache& cache);
@@ -109,13 +92,14 @@ namespace et
 
 		std::string inputFileName;
 		std::string inputFilePath;
-		std::ifstream inputFile;
+		MappedFile::Pointer inputFile;
 		std::ifstream materialFile;
 
 		s3d::Scene3dStorage::Pointer _storage;
 		s3d::Material::Pointer _lastMaterial;
 		s3d::Material::List _materials;
 		OBJMeshIndexBoundsList _meshes;
+		primitives::LevelOfDetailList _levelsOfDetail;
         IndexArray::Pointer _indices;
 		VertexArray::Pointer _vertexData;
 
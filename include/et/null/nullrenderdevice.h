@@ -0,0 +1,148 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/singleton.h>
+#include <et/core/containers.h>
+#include <et/rendering/renderstate.h>
+
+namespace et
+{
+	enum class NullCommandType : uint32_t
+	{
+		Clear,
+		Draw,
+		DrawInstanced,
+		BindProgram,
+		BindTexture,
+		BindBuffer,
+		BindVertexArray,
+		BindFramebuffer,
+		Viewport,
+		State,
+		BufferData,
+		TextureData,
+		Uniform,
+		ReadPixels,
+
+		max
+	};
+
+	struct NullCommand
+	{
+		NullCommandType type = NullCommandType::max;
+		PrimitiveType primitiveType = PrimitiveType::Triangles;
+		uint32_t object = 0;
+		size_t first = 0;
+		size_t count = 0;
+		size_t instances = 0;
+
+		NullCommand()
+			{ }
+
+		NullCommand(NullCommandType t, uint32_t o) :
+			type(t), object(o) { }
+	};
+
+	struct NullRenderStatistics
+	{
+		size_t commands = 0;
+		size_t drawCalls = 0;
+		size_t primitives = 0;
+		size_t stateChanges = 0;
+		size_t uploadedBytes = 0;
+	};
+
+	/*
+	 * Rendering device used by the null backend (src/null).
+	 * Does not touch any GPU API, records commands and accumulates statistics instead,
+	 * so frame loop could be run and measured on machines without GPU.
+	 * Should be accessed from the thread owning render context.
+	 */
+	class NullRenderDevice : public Singleton<NullRenderDevice>
+	{
+	public:
+		typedef std::vector<NullCommand> CommandList;
+
+	public:
+		uint32_t generateHandle();
+
+		void beginFrame();
+		void endFrame();
+
+		void record(NullCommandType, uint32_t object = 0);
+		void recordDraw(PrimitiveType, uint32_t indexBuffer, size_t first, size_t count, size_t instances);
+		void recordUpload(NullCommandType, uint32_t object, size_t dataSize);
+
+		/*
+		 * Commands recorded since the last beginFrame call
+		 */
+		const CommandList& commands() const
+			{ return _commands; }
+
+		/*
+		 * When disabled only statistics are collected
+		 */
+		void setRecordingEnabled(bool e)
+			{ _recordingEnabled = e; }
+
+		bool recordingEnabled() const
+			{ return _recordingEnabled; }
+
+		/*
+		 * Statistics of the frame being recorded, after endFrame it is reset
+		 */
+		const NullRenderStatistics& currentFrameStatistics() const
+			{ return _currentFrame; }
+
+		const NullRenderStatistics& lastFrameStatistics() const
+			{ return _lastFrame; }
+
+		const NullRenderStatistics& totalStatistics() const
+			{ return _total; }
+
+		size_t framesRendered() const
+			{ return _framesRendered; }
+
+		void resetStatistics();
+
+		/*
+		 * State reported to RenderState::currentState, taken from the active render context
+		 */
+		void setActiveRenderState(const RenderState* rs)
+			{ _activeRenderState = rs; }
+
+		RenderState::State deviceState() const
+			{ return (_activeRenderState == nullptr) ? RenderState::State() : _activeRenderState->actualState(); }
+
+		/*
+		 * Backing storage for mapped buffers
+		 */
+		void* mapBuffer(uint32_t, size_t);
+		void unmapBuffer(uint32_t);
+
+	private:
+		ET_SINGLETON_CONSTRUCTORS(NullRenderDevice)
+
+		void addCommand(const NullCommand&);
+		void accumulateStatistics();
+
+	private:
+		CommandList _commands;
+		const RenderState* _activeRenderState = nullptr;
+		std::map<uint32_t, BinaryDataStorage> _mappedBuffers;
+
+		NullRenderStatistics _currentFrame;
+		NullRenderStatistics _lastFrame;
+		NullRenderStatistics _total;
+
+		AtomicCounter _handleCounter;
+		size_t _framesRendered = 0;
+		bool _recordingEnabled = true;
+	};
+}
@@ -38,6 +38,11 @@
 #	define ET_PLATFORM_ANDROID			1
 #	define CurrentPlatform				Platform_Android
 #
+#elif defined(__linux__)
+#
+#	define ET_PLATFORM_LINUX			1
+#	define CurrentPlatform				Platform_Linux
+#
 #else
 #
 #	error Unable to determine current platform
@@ -68,6 +73,46 @@
 #
 #endif
 
+#if defined(__AVX__)
+#
+#	define ET_SIMD_AVX	1
+#
+#else
+#
+#	define ET_SIMD_AVX	0
+#
+#endif
+
+#if (ET_SIMD_AVX || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#
+#	define ET_SIMD_SSE	1
+#
+#else
+#
+#	define ET_SIMD_SSE	0
+#
+#endif
+
+#if (ET_SIMD_AVX || defined(__SSE4_1__))
+#
+#	define ET_SIMD_SSE41	1
+#
+#else
+#
+#	define ET_SIMD_SSE41	0
+#
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#
+#	define ET_SIMD_NEON	1
+#
+#else
+#
+#	define ET_SIMD_NEON	0
+#
+#endif
+
 #define ET_TO_CONST_CHAR_IMPL(a)	#a
 #define ET_TO_CONST_CHAR(a)			ET_TO_CONST_CHAR_IMPL(a)
 
@@ -78,7 +123,8 @@ namespace et
 		Platform_Windows,
 		Platform_iOS,
 		Platform_Mac,
-		Platform_Android
+		Platform_Android,
+		Platform_Linux
 	};
 	
 	enum Architecture
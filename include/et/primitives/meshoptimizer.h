@@ -0,0 +1,60 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/vertexbuffer/indexarray.h>
+#include <et/vertexbuffer/vertexarray.h>
+
+namespace et
+{
+	namespace primitives
+	{
+		const size_t defaultVertexCacheSize = 16;
+		const float defaultOverdrawThreshold = 1.05f;
+
+		struct VertexCacheStatistics
+		{
+			size_t trianglesCount = 0;
+			size_t verticesCount = 0;
+			size_t verticesTransformed = 0;
+
+			/*
+			 * Average cache miss ratio - transformed vertices per triangle (0.5 ... 3.0)
+			 * Average transformed vertex ratio - transformed vertices per unique vertex (1.0 ... 6.0)
+			 */
+			float acmr = 0.0f;
+			float atvr = 0.0f;
+		};
+
+		/*
+		 * Simulates FIFO post-transform cache for the triangles in the range of indices
+		 */
+		VertexCacheStatistics analyzeVertexCache(const IndexArray::Pointer& indexArray, size_t firstIndex,
+			size_t indexCount, size_t cacheSize = defaultVertexCacheSize);
+
+		/*
+		 * Reorders triangles in the range of indices for the post-transform cache
+		 * (Tom Forsyth, Linear-speed vertex cache optimisation)
+		 */
+		void optimizeVertexCache(IndexArray::Pointer indexArray, size_t firstIndex, size_t indexCount);
+
+		/*
+		 * Splits range of indices, optimized for vertex cache, into clusters and sorts them
+		 * from the outer to the inner ones, to reduce overdraw. Threshold limits ACMR degradation.
+		 * (Sander, Nehab, Barczak, Fast triangle reordering for vertex locality and reduced overdraw)
+		 */
+		void optimizeOverdraw(const VertexArray::Pointer& vertexArray, IndexArray::Pointer indexArray,
+			size_t firstIndex, size_t indexCount, float threshold = defaultOverdrawThreshold);
+
+		/*
+		 * Reorders vertices in order of the first use in the whole index array,
+		 * remaps all data chunks and indices. Unused vertices are moved to the end.
+		 */
+		void optimizeVertexFetch(VertexArray::Pointer vertexArray, IndexArray::Pointer indexArray);
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/vertexbuffer/indexarray.h>
+#include <et/vertexbuffer/vertexarray.h>
+
+namespace et
+{
+	namespace primitives
+	{
+		struct IndexRange
+		{
+			uint32_t start = 0;
+			uint32_t count = 0;
+
+			IndexRange()
+				{ }
+
+			IndexRange(uint32_t s, uint32_t c) :
+				start(s), count(c) { }
+		};
+		typedef std::vector<IndexRange> IndexRangeList;
+
+		struct SimplificationOptions
+		{
+			/*
+			 * Weights of the squared attribute differences, added to the squared geometric error.
+			 * Positions are normalized, so geometric error is relative to the diagonal of the mesh bounds.
+			 */
+			float normalWeight = 0.01f;
+			float texCoordWeight = 0.01f;
+			float colorWeight = 0.01f;
+
+			/*
+			 * Collapses with the larger (relative) error are not performed
+			 */
+			float maxError = 0.05f;
+
+			/*
+			 * Keeps open borders (for example, between separately indexed materials) in place
+			 */
+			bool lockBorders = false;
+		};
+
+		struct SimplificationResult
+		{
+			IndexRangeList ranges;
+			size_t trianglesCount = 0;
+
+			/*
+			 * Estimated error, relative to the diagonal of the mesh bounds
+			 */
+			float error = 0.0f;
+		};
+
+		struct LevelOfDetail : public SimplificationResult
+		{
+			/*
+			 * Fraction of the screen height, occupied by the mesh bounds,
+			 * below which level could be used without visible difference
+			 */
+			float screenCoverage = 0.0f;
+		};
+		typedef std::vector<LevelOfDetail> LevelOfDetailList;
+
+		/*
+		 * Collapses edges of the triangles in the ranges (quadric error metrics with attribute weights)
+		 * until triangles count reaches targetRatio of the source one or maxError is exceeded.
+		 * Vertices are never moved or added, so resulting triangles are appended to the same index array
+		 * and could be rendered with the same vertex buffer. Vertices shared between ranges (materials),
+		 * vertices on the attribute seams and on the complex borders are not collapsed.
+		 */
+		SimplificationResult simplify(const VertexArray::Pointer& vertexArray, IndexArray::Pointer indexArray,
+			const IndexRangeList& ranges, float targetRatio, const SimplificationOptions& options = SimplificationOptions());
+
+		/*
+		 * Builds level of detail for each ratio (of the source triangles count), each level is simplified
+		 * from the previous one. Screen coverage is estimated so error projects to screenError of the screen height.
+		 */
+		LevelOfDetailList buildLevelsOfDetail(const VertexArray::Pointer& vertexArray, IndexArray::Pointer indexArray,
+			const IndexRangeList& ranges, const std::vector<float>& ratios, float screenError = 0.001f,
+			const SimplificationOptions& options = SimplificationOptions());
+	}
+}
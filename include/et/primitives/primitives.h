@@ -13,8 +13,34 @@
 
 namespace et
 {
+	class JobSystem;
+	
 	namespace primitives
 	{
+		/*
+		 * Vertices are smoothed together when closer than this distance,
+		 * sqrt(1.0e-3) keeps the former squared distance threshold of 1.0e-3
+		 */
+		const float defaultSmoothingDistance = 0.0316227766f;
+		
+		/*
+		 * Maximal per-component difference of attributes for vertices to be merged,
+		 * attributes with negative tolerance are not compared (value of the first vertex is kept)
+		 */
+		struct VertexWeldingOptions
+		{
+			float tolerance[static_cast<uint32_t>(VertexAttributeUsage::max)];
+			
+			VertexWeldingOptions(float defaultTolerance = 1.0e-6f)
+				{ std::fill(tolerance, tolerance + static_cast<uint32_t>(VertexAttributeUsage::max), defaultTolerance); }
+			
+			float& operator [] (VertexAttributeUsage usage)
+				{ return tolerance[static_cast<uint32_t>(usage)]; }
+			
+			float operator [] (VertexAttributeUsage usage) const
+				{ return tolerance[static_cast<uint32_t>(usage)]; }
+		};
+		
 		size_t primitiveCountForIndexCount(size_t numIndexes, PrimitiveType geometryType);
 		
 		uint32_t indexCountForRegularMesh(const vec2i& meshSize, PrimitiveType geometryType);
@@ -50,14 +76,37 @@ namespace et
 			size_t density, const vec3& center = vec3(0.0f), const vec2& texCoordScale = vec2(1.0f),
 			const vec2& texCoordOffset = vec2(0.0f));
 		
+		/*
+		 * Normals and tangents are averaged over the triangles (in range of primitives) sharing vertex,
+		 * weighted by triangle area
+		 */
 		void calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
 			size_t first, size_t last);
 		
+		void calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+			size_t first, size_t last, JobSystem& jobs);
+		
 		void calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
 			uint32_t first, uint32_t last);
 		
+		void calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+			uint32_t first, uint32_t last, JobSystem& jobs);
+		
+		/*
+		 * Averages normals (tangents) of the vertices in range [first, last) closer than distance to each other,
+		 * if smoothing groups (bit masks) of the vertices are equal or intersect
+		 */
+		void smoothNormals(VertexArray::Pointer data, uint32_t first, uint32_t last,
+			float distance = defaultSmoothingDistance);
+		
+		void smoothNormals(VertexArray::Pointer data, uint32_t first, uint32_t last,
+			float distance, JobSystem& jobs);
+		
 		void smoothTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
-			uint32_t first, uint32_t last);
+			uint32_t first, uint32_t last, float distance = defaultSmoothingDistance);
+		
+		void smoothTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+			uint32_t first, uint32_t last, float distance, JobSystem& jobs);
 		
 		void createCube(VertexArray::Pointer data, float radius, const vec3& center = vec3(0.0f));
 		void createOctahedron(VertexArray::Pointer data, float radius);
@@ -67,6 +116,19 @@ namespace et
 		void tesselateTriangles(VertexArray::Pointer data, const vec3& aspect = vec3(0.5f));
 		void tesselateTriangles(VertexArray::Pointer data, IndexArray::Pointer indexArray, const vec3& aspect = vec3(0.5f));
 		
+		/*
+		 * Merges vertices with equal (within tolerance) attributes, returns array of unique vertices
+		 * and rewrites indices. Empty index array is considered to be linear and filled.
+		 */
+		VertexArray::Pointer weldVertices(VertexArray::Pointer data, IndexArray::Pointer indexArray,
+			const VertexWeldingOptions& options = VertexWeldingOptions());
+		
+		VertexArray::Pointer weldVertices(VertexArray::Pointer data, IndexArray::Pointer indexArray,
+			const VertexWeldingOptions& options, JobSystem& jobs);
+		
+		/*
+		 * Merges vertices by position only, normals and colors of merged vertices are averaged
+		 */
 		VertexArray::Pointer buildLinearIndexArray(VertexArray::Pointer data, IndexArray::Pointer indexArray);
 		
 		VertexArray::Pointer linearizeTrianglesIndexArray(VertexArray::Pointer data, IndexArray::Pointer indexArray);
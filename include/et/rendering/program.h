@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <et/rendering/apiobject.h>
 #include <et/rendering/rendering.h>
+#include <et/rendering/programuniforms.h>
 
 namespace et
 {
@@ -21,11 +22,7 @@ namespace et
 	public:
 		ET_DECLARE_POINTER(Program)
 
-		struct Uniform
-		{
-			uint32_t type = 0;
-			int location = -1;
-		};
+		typedef ProgramUniform Uniform;
 		
 		struct Attribute
 		{
@@ -71,6 +68,9 @@ namespace et
 		int transformMatrixLocation() const
 			{ return _mTransformLocation; }
 
+		int instanceTransformsLocation() const
+			{ return _mInstanceTransformLocation; }
+
 		void setModelViewMatrix(const mat4 &m, bool force = false);
 		void setMVPMatrix(const mat4 &m, bool force = false);
 		void setCameraPosition(const vec3& p, bool force = false);
@@ -78,6 +78,12 @@ namespace et
 		void setLightProjectionMatrix(const mat4 &m, bool force = false);
 		void setTransformMatrix(const mat4 &m, bool force = false);
 
+		/*
+		 * Sets first elements of the mInstanceTransform array, indexed by gl_InstanceID
+		 * in the shaders used for instanced rendering
+		 */
+		void setInstanceTransforms(const mat4* m, size_t count);
+
 		void setCameraProperties(const Camera& cam);
 
 		const Program::UniformMap& uniforms() const 
@@ -85,8 +91,8 @@ namespace et
 
 		void setUniform(int, uint32_t, const int32_t, bool);
 		void setUniform(int, uint32_t, const uint32_t, bool);
-		void setUniform(int, uint32_t, const int64_t, bool);
-		void setUniform(int, uint32_t, const uint64_t, bool);
+		void setUniform(int, uint32_t, const long long, bool);
+		void setUniform(int, uint32_t, const unsigned long long, bool);
 		void setUniform(int, uint32_t, const unsigned long, bool);
 		
 		void setUniform(int, uint32_t, const float, bool force = false);
@@ -107,20 +113,28 @@ namespace et
 		void setUniformDirectly(int, uint32_t, const mat4& value);
 		
 		template <typename T>
-		void setUniform(const std::string& name, const T& value, bool force = false)
+		void setUniform(UniformName name, const T& value, bool force = false)
 		{
-			auto i = findUniform(name);
-			if (i != _uniforms.end())
-				setUniform(i->second.location, i->second.type, value, force);
+			const Uniform* u = _uniformCache.findUniform(name);
+			if (u != nullptr)
+				setUniform(u->location, u->type, value, force);
 		}
 
 		template <typename T>
-		void setUniform(const std::string& name, const T* value, size_t amount)
+		void setUniform(UniformName name, const T* value, size_t amount)
 		{
-			auto i = findUniform(name);
-			if (i != _uniforms.end())
-				setUniform(i->second.location, i->second.type, value, amount);
+			const Uniform* u = _uniformCache.findUniform(name);
+			if (u != nullptr)
+				setUniform(u->location, u->type, value, amount);
 		}
+
+		template <typename T>
+		void setUniform(const std::string& name, const T& value, bool force = false)
+			{ setUniform(UniformName(name), value, force); }
+
+		template <typename T>
+		void setUniform(const std::string& name, const T* value, size_t amount)
+			{ setUniform(UniformName(name), value, amount); }
 		
 		template <typename T>
 		void setUniform(const Program::Uniform& u, const T& value, bool force = false)
@@ -133,6 +147,11 @@ namespace et
 		template <typename T>
 		void setUniform(const Program::Uniform& u, const T* value, size_t amount)
 			{ setUniform(u.location, u.type, value, amount); }
+
+		/*
+		 * Sets values of the block, which are declared in the program and differ from the current ones
+		 */
+		void setUniforms(const UniformBlock&);
 		
 		void buildProgram(const std::string& vertex_source, const std::string& geom_source,
 			const std::string& frag_source);
@@ -157,13 +176,9 @@ namespace et
 		int _vPrimaryLightLocation;
 		int _mLightProjectionMatrixLocation;
 		int _mTransformLocation;
+		int _mInstanceTransformLocation;
 
-		std::map<int, float> _floatCache;
-		std::map<int, vec2> _vec2Cache;
-		std::map<int, vec3> _vec3Cache;
-		std::map<int, vec4> _vec4Cache;
-		std::map<int, mat3> _mat3Cache;
-		std::map<int, mat4> _mat4Cache;
+		UniformCache _uniformCache;
 		
 		StringList _defines;
 	};
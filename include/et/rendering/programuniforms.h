@@ -0,0 +1,181 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <et/geometry/geometry.h>
+
+namespace et
+{
+	/*
+	 * FNV-1a hash of the uniform name. Hash of string literal is computed at compile time
+	 * when used in constant expression, ET_UNIFORM_NAME guarantees that:
+	 *   program->setUniform(ET_UNIFORM_NAME("texel"), value);
+	 */
+	struct UniformName
+	{
+		uint32_t hash = 0;
+
+		static constexpr uint32_t computeHash(const char* s, uint32_t h = 2166136261u)
+			{ return (*s == 0) ? h : computeHash(s + 1, (h ^ static_cast<uint8_t>(*s)) * 16777619u); }
+
+		constexpr UniformName() { }
+
+		constexpr explicit UniformName(uint32_t h) :
+			hash(h) { }
+
+		template <size_t N>
+		constexpr explicit UniformName(const char (&name)[N]) :
+			hash(computeHash(name)) { }
+
+		explicit UniformName(const std::string& name)
+		{
+			hash = 2166136261u;
+			for (char c : name)
+				hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+		}
+
+		bool operator == (const UniformName& n) const
+			{ return hash == n.hash; }
+
+		bool operator < (const UniformName& n) const
+			{ return hash < n.hash; }
+	};
+
+	struct ProgramUniform
+	{
+		uint32_t type = 0;
+		int location = -1;
+	};
+
+	/*
+	 * Uniforms of the linked program, looked up by hashed names,
+	 * and shadow copy of the values sent to the program, indexed by location
+	 */
+	class UniformCache
+	{
+	public:
+		void clear();
+
+		/*
+		 * Arrays ("name[0]") could be also found by name without index
+		 */
+		void addUniform(const std::string& name, const ProgramUniform&);
+
+		const ProgramUniform* findUniform(UniformName) const;
+
+		/*
+		 * Returns true if value differs from the previously sent one (and stores it)
+		 */
+		bool update(int location, const void* data, size_t size, bool force);
+
+		/*
+		 * Values will be sent again, for example when program is relinked
+		 */
+		void invalidate();
+
+	private:
+		/*
+		 * Name is kept to tell hash collision from the same name added twice
+		 */
+		struct HashedUniform
+		{
+			UniformName hashedName;
+			std::string name;
+			ProgramUniform uniform;
+		};
+
+		void addHashedUniform(const std::string&, const ProgramUniform&);
+
+	private:
+		struct Value
+		{
+			uint32_t offset = 0;
+			uint32_t size = 0;
+			bool valid = false;
+		};
+
+		std::vector<HashedUniform> _uniforms;
+		std::vector<Value> _values;
+		std::vector<uint8_t> _storage;
+	};
+
+	/*
+	 * Contiguous block of uniform values (for example, parameters of material),
+	 * applied with Program::setUniforms. Values are resolved by names in each program
+	 * and sent only if they differ from ones already set to the program.
+	 */
+	class UniformBlock
+	{
+	public:
+		enum class ValueType : uint32_t
+		{
+			Int,
+			Float,
+			Vec2,
+			Vec3,
+			Vec4,
+			Mat3,
+			Mat4
+		};
+
+		struct Entry
+		{
+			UniformName name;
+			ValueType type = ValueType::Int;
+			uint32_t offset = 0;
+		};
+
+	public:
+		void set(UniformName name, int32_t value)
+			{ setValue(name, ValueType::Int, &value, sizeof(value)); }
+
+		void set(UniformName name, float value)
+			{ setValue(name, ValueType::Float, &value, sizeof(value)); }
+
+		void set(UniformName name, const vec2& value)
+			{ setValue(name, ValueType::Vec2, &value, sizeof(value)); }
+
+		void set(UniformName name, const vec3& value)
+			{ setValue(name, ValueType::Vec3, &value, sizeof(value)); }
+
+		void set(UniformName name, const vec4& value)
+			{ setValue(name, ValueType::Vec4, &value, sizeof(value)); }
+
+		void set(UniformName name, const mat3& value)
+			{ setValue(name, ValueType::Mat3, &value, sizeof(value)); }
+
+		void set(UniformName name, const mat4& value)
+			{ setValue(name, ValueType::Mat4, &value, sizeof(value)); }
+
+		void clear();
+
+		bool empty() const
+			{ return _entries.empty(); }
+
+		const std::vector<Entry>& entries() const
+			{ return _entries; }
+
+		template <typename T>
+		T value(const Entry& e) const
+		{
+			T result;
+			etCopyMemory(&result, _data.data() + e.offset, sizeof(T));
+			return result;
+		}
+
+	private:
+		void setValue(UniformName, ValueType, const void*, size_t);
+
+	private:
+		std::vector<Entry> _entries;
+		std::vector<uint8_t> _data;
+	};
+}
+
+#define ET_UNIFORM_NAME(NAME)	et::UniformName(std::integral_constant<uint32_t, et::UniformName::computeHash(NAME)>::value)
@@ -0,0 +1,224 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <et/threading/criticalsection.h>
+#include <et/rendering/renderstate.h>
+
+namespace et
+{
+	class JobSystem;
+	class RenderContext;
+
+	/*
+	 * Collects draw packets of the frame, sorts them by 64-bit keys and submits in the order
+	 * requiring the minimal amount of state changes. Key layout (from the most significant bits):
+	 *   pass (8) | program (12) | material (16) | vertex array (12) | depth (16)
+	 * in passes sorted back to front depth goes right after the pass. Programs and vertex arrays
+	 * are identified by the order of the first use within the frame, materials by addMaterial.
+	 * Buffer does not touch rendering API until submit, so recording and sorting could be
+	 * done (and measured) without render context, on any thread.
+	 */
+	class RenderCommandBuffer
+	{
+	public:
+		typedef uint32_t Identifier;
+		static const Identifier InvalidIdentifier = static_cast<Identifier>(-1);
+
+		static const uint32_t MaxPasses = 256;
+		static const uint32_t MaxPrograms = 4096;
+		static const uint32_t MaxMaterials = 65536;
+		static const uint32_t MaxVertexArrays = 4096;
+
+		enum class DepthOrder : uint32_t
+		{
+			FrontToBack,
+			BackToFront
+		};
+
+		struct TextureBinding
+		{
+			uint32_t unit = 0;
+			Texture::Pointer texture;
+
+			TextureBinding(uint32_t u, const Texture::Pointer& t) :
+				unit(u), texture(t) { }
+		};
+
+		struct Material
+		{
+			std::vector<TextureBinding> textures;
+
+			/*
+			 * Parameters of the material, set to the program (only changed values)
+			 * each time material or program changes
+			 */
+			UniformBlock uniforms;
+
+			/*
+			 * Sets uniforms of the material, called after program is bound and uniforms are set,
+			 * each time material or program changes
+			 */
+			std::function<void(Program::Pointer&)> apply;
+		};
+
+		struct Statistics
+		{
+			size_t packets = 0;
+			size_t programChanges = 0;
+			size_t materialChanges = 0;
+			size_t vertexArrayChanges = 0;
+
+			/*
+			 * State changes required to submit packets in the order of recording
+			 */
+			size_t unsortedStateChanges = 0;
+
+			size_t stateChanges() const
+				{ return programChanges + materialChanges + vertexArrayChanges; }
+
+			size_t savedStateChanges() const
+				{ return (unsortedStateChanges > stateChanges()) ? unsortedStateChanges - stateChanges() : 0; }
+		};
+
+		typedef std::function<void(RenderCommandBuffer&, size_t, size_t)> RecordFunction;
+
+	public:
+		RenderCommandBuffer();
+		~RenderCommandBuffer();
+
+		/*
+		 * Materials are kept between frames, until removeMaterials is called.
+		 * Could be added while buffers sharing them are recorded or submitted.
+		 */
+		Identifier addMaterial(const Material&);
+		void removeMaterials();
+
+		/*
+		 * Makes buffer use (and add) materials of another buffer
+		 */
+		void shareMaterials(const RenderCommandBuffer&);
+
+		void setDepthOrder(uint32_t pass, DepthOrder);
+
+		/*
+		 * Depth is a distance from the camera, negative values are clamped to zero
+		 */
+		void draw(uint32_t pass, const Program::Pointer& program, Identifier material, const VertexArrayObject& vao,
+			uint32_t first, uint32_t count, const mat4& transform, float depth);
+
+		/*
+		 * Draws instances of the same geometry in one call, transforms are copied into
+		 * the buffer and set to the program using setInstanceTransforms
+		 */
+		void drawInstanced(uint32_t pass, const Program::Pointer& program, Identifier material, const VertexArrayObject& vao,
+			uint32_t first, uint32_t count, const mat4* transforms, uint32_t instances, float depth);
+
+		/*
+		 * Appends packets of the buffer sharing materials with this one
+		 */
+		void append(const RenderCommandBuffer&);
+
+		/*
+		 * Splits [0, count) into ranges, which are recorded on the workers into separate buffers
+		 * (sharing materials with this one) and appended in the order of ranges, so result
+		 * is the same as if the whole range was recorded by the calling thread
+		 */
+		void record(size_t count, size_t minimumRange, JobSystem&, RecordFunction);
+
+		/*
+		 * Sorts packets and computes statistics, called by submit if needed
+		 */
+		void sort();
+
+		/*
+		 * Should be called from the thread owning render context,
+		 * transform of each packet is set to the program using setTransformMatrix
+		 */
+		void submit(RenderContext*);
+
+		/*
+		 * Removes packets, programs and vertex arrays recorded within the frame
+		 */
+		void clear();
+
+		size_t packetsCount() const
+			{ return _packets.size(); }
+
+		size_t instancesCount() const
+			{ return _instanceTransforms.size(); }
+
+		const Statistics& statistics() const
+			{ return _statistics; }
+
+		/*
+		 * Indices of the packets (in the order of recording) sorted for submission
+		 */
+		std::vector<uint32_t> submissionOrder();
+
+	private:
+		struct MaterialTable : public Shared
+		{
+			ET_DECLARE_POINTER(MaterialTable)
+
+			CriticalSection lock;
+			std::vector<Material> materials;
+		};
+
+		struct Packet
+		{
+			mat4 transform;
+			Identifier program = 0;
+			Identifier material = 0;
+			Identifier vertexArray = 0;
+			uint32_t first = 0;
+			uint32_t count = 0;
+			uint32_t pass = 0;
+			float depth = 0.0f;
+
+			/*
+			 * Range in the instance transforms, packets with zero instances use transform
+			 */
+			uint32_t firstInstance = 0;
+			uint32_t instances = 0;
+		};
+
+		struct SortEntry
+		{
+			uint64_t key = 0;
+			uint32_t index = 0;
+		};
+
+		void addPacket(Packet&, const Program::Pointer&, const VertexArrayObject&);
+		uint64_t sortKey(const Packet&) const;
+		Statistics countStateChanges(const std::vector<SortEntry>&) const;
+
+	private:
+		std::vector<Packet> _packets;
+		std::vector<mat4> _instanceTransforms;
+		std::vector<SortEntry> _sortEntries;
+		std::vector<SortEntry> _sortScratch;
+
+		std::vector<RenderCommandBuffer*> _workerBuffers;
+
+		MaterialTable::Pointer _materials;
+		std::vector<Program::Pointer> _programs;
+		std::vector<VertexArrayObject> _vertexArrays;
+		std::unordered_map<const Program*, Identifier> _programIdentifiers;
+		std::unordered_map<const VertexArrayObjectData*, Identifier> _vertexArrayIdentifiers;
+
+		DepthOrder _depthOrder[MaxPasses];
+		Statistics _statistics;
+		bool _sorted = true;
+
+	private:
+		ET_DENY_COPY(RenderCommandBuffer)
+	};
+}
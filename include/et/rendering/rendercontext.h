@@ -81,6 +81,14 @@ namespace et
 		void beginRender();
 		void endRender();
 
+		/*
+		 * Context is made current on the thread which is going to use it and released
+		 * from the thread which is not (see ApplicationParameters::renderThread).
+		 * Both return false if context could not be moved between threads on this platform
+		 */
+		bool makeCurrent();
+		bool releaseCurrent();
+
 		size_t renderingContextHandle();
 
 	public:
@@ -0,0 +1,148 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/threading/mutex.h>
+#include <et/rendering/rendercommandbuffer.h>
+
+namespace et
+{
+	/*
+	 * Monotonic counter signaled by the thread completing the work (for example, render thread
+	 * after frame submission), other threads could wait for the value without touching rendering API
+	 */
+	class RenderFence
+	{
+	public:
+		void signal(uint64_t value);
+
+		uint64_t value() const;
+
+		bool reached(uint64_t v) const
+			{ return value() >= v; }
+
+		/*
+		 * Waiting thread is blocked until value is reached
+		 */
+		void wait(uint64_t v) const;
+
+	private:
+		mutable Condition _condition;
+		uint64_t _value = 0;
+	};
+
+	class RenderFramePipeline;
+
+	/*
+	 * Frame recorded on the main thread (and workers) and executed on the thread owning render context.
+	 * Commands, resource updates and command buffers are executed in the order they were added.
+	 */
+	class RenderFrame
+	{
+	public:
+		typedef std::function<void(RenderContext*)> Command;
+
+	public:
+		RenderFrame();
+		~RenderFrame();
+
+		uint64_t index() const
+			{ return _index; }
+
+		void execute(Command);
+
+		/*
+		 * Returns empty buffer sharing materials of the pipeline,
+		 * it will be submitted after the commands added before this call
+		 */
+		RenderCommandBuffer& commandBuffer();
+
+		/*
+		 * VertexBufferData::map and Texture::updateData are called on the render thread,
+		 * data is owned by the frame until it is submitted (see RenderFramePipeline::fence)
+		 */
+		void updateVertexBuffer(const VertexBuffer&, size_t offset, BinaryDataStorage&& data);
+		void updateTexture(const Texture::Pointer&, TextureDescription::Pointer);
+
+	private:
+		friend class RenderFramePipeline;
+
+		void reset(uint64_t index, RenderCommandBuffer* materials);
+		void execute(RenderContext*);
+
+		ET_DENY_COPY(RenderFrame)
+
+	private:
+		struct Entry
+		{
+			Command command;
+			RenderCommandBuffer* buffer = nullptr;
+		};
+
+		std::vector<Entry> _entries;
+		std::vector<RenderCommandBuffer*> _buffers;
+		std::vector<BinaryDataStorage> _uploads;
+		RenderCommandBuffer* _materials = nullptr;
+		size_t _usedBuffers = 0;
+		uint64_t _index = 0;
+	};
+
+	/*
+	 * Double buffered frames: frame N + 1 is recorded while frame N is submitted by the render thread.
+	 * Frames are submitted in the order of recording, beginFrame waits (on the fence) until
+	 * frame previously recorded into the same slot is submitted.
+	 */
+	class RenderFramePipeline
+	{
+	public:
+		static const size_t FramesCount = 2;
+
+	public:
+		RenderFramePipeline();
+
+		RenderCommandBuffer::Identifier addMaterial(const RenderCommandBuffer::Material&);
+
+		/*
+		 * Recording thread, waits until all recorded frames are submitted
+		 */
+		void removeMaterials();
+
+		/*
+		 * Recording thread
+		 */
+		RenderFrame& beginFrame();
+		void endFrame();
+
+		/*
+		 * Render thread, executes the next recorded frame, returns false if it is not recorded yet
+		 */
+		bool submit(RenderContext*);
+
+		/*
+		 * Value is the index of the last submitted frame
+		 */
+		const RenderFence& fence() const
+			{ return _fence; }
+
+		uint64_t recordedFrames() const
+			{ return _recordedFrames; }
+
+	private:
+		ET_DENY_COPY(RenderFramePipeline)
+
+	private:
+		RenderCommandBuffer _materials;
+		RenderFrame _frames[FramesCount];
+		RenderFence _fence;
+
+		CriticalSection _lock;
+		uint64_t _recordedFrames = 0;
+		uint64_t _submittedFrames = 0;
+		bool _recording = false;
+	};
+}
@@ -44,6 +44,14 @@ namespace et
 		void updatePartialDataDirectly(RenderContext*, const vec2i& offset, const vec2i& size,
 			const char* data, size_t dataSize);
 
+		/*
+		 * Per-level access for the progressive streaming of 2D textures,
+		 * levels outside of [base lod, max lod] range are never sampled
+		 */
+		void updateMipLevel(RenderContext*, size_t level, const char* data, size_t dataSize);
+		void releaseMipLevel(RenderContext*, size_t level);
+		void setBaseLod(RenderContext*, size_t value);
+
 		TextureFormat internalFormat() const
 			{ return _desc->internalformat; }
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <set>
 #include <et/app/events.h>
 #include <et/rendering/texture.h>
 #include <et/rendering/apiobjectfactory.h>
@@ -26,7 +27,14 @@ namespace et
 		~TextureFactory();
 		
 		Texture::Pointer loadTexture(const std::string& file, ObjectsCache& cache, bool async = false,
-			TextureLoaderDelegate* delegate = nullptr);
+			TextureLoaderDelegate* delegate = nullptr, TextureLoadingPriority priority = TextureLoadingPriority::Visible);
+
+		/*
+		 * Moves pending asynchronous request for the texture to the higher priority
+		 */
+		void setTextureLoadingPriority(Texture::Pointer texture, TextureLoadingPriority priority);
+
+		TextureLoadingStatistics textureLoadingStatistics();
 
 		Texture::Pointer loadTexturesToCubemap(const std::string& posx, const std::string& negx,
 			const std::string& posy, const std::string& negy, const std::string& posz,
@@ -59,9 +67,11 @@ namespace et
 		
 		void reloadObject(LoadableObject::Pointer, ObjectsCache&);
 		void textureLoadingThreadDidLoadTextureData(TextureLoadingRequest* request);
+		void textureLoadingThreadDidCancelRequest(TextureLoadingRequest* request);
 		
 	private:
-		AutoPtr<TextureLoadingThread> _loadingThread;
+		AutoPtr<TextureLoadingPool> _loadingPool;
+		std::set<std::string> _cancelledTextures;
 		
 		ET_DECLARE_PIMPL(TextureFactory, 64)
 
@@ -0,0 +1,181 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/threading/criticalsection.h>
+#include <et/rendering/texture.h>
+
+namespace et
+{
+	class ObjectsCache;
+	class RenderContext;
+
+	/*
+	 * Decides which mip levels of the streamed textures should be loaded or evicted,
+	 * does not touch rendering API, so could be used (and tested) without GPU.
+	 * Level 0 is the finest one, resident levels are always contiguous range
+	 * [residentLevel, levelsCount - 1], the coarsest level is never evicted.
+	 */
+	class TextureResidencyPolicy
+	{
+	public:
+		typedef uint32_t Handle;
+		static const Handle InvalidHandle = static_cast<Handle>(-1);
+
+		enum class ActionType : uint32_t
+		{
+			Load,
+			Evict
+		};
+
+		struct Action
+		{
+			ActionType type = ActionType::Load;
+			Handle handle = InvalidHandle;
+			uint32_t level = 0;
+
+			Action(ActionType t, Handle h, uint32_t l) :
+				type(t), handle(h), level(l) { }
+		};
+		typedef std::vector<Action> ActionList;
+
+	public:
+		TextureResidencyPolicy(size_t budget);
+
+		Handle add(const vec2i& size, const std::vector<size_t>& levelSizes);
+		void remove(Handle);
+
+		/*
+		 * Size (in pixels) which texture occupies on screen in the specified frame,
+		 * the largest size reported within the frame is used
+		 */
+		void reportScreenSize(Handle, float pixels, uint64_t frame);
+
+		/*
+		 * Returns evictions first and loads after them. Evictions are considered to be done
+		 * immediately, loads reserve memory until levelDidLoad / levelDidFailToLoad is called.
+		 */
+		ActionList update(uint64_t frame);
+
+		void levelDidLoad(Handle, uint32_t level);
+		void levelDidFailToLoad(Handle, uint32_t level);
+
+		size_t budget() const
+			{ return _budget; }
+
+		void setBudget(size_t value)
+			{ _budget = value; }
+
+		size_t maxPendingLoads() const
+			{ return _maxPendingLoads; }
+
+		void setMaxPendingLoads(size_t value)
+			{ _maxPendingLoads = value; }
+
+		size_t residentSize() const
+			{ return _residentSize; }
+
+		uint32_t levelsCount(Handle) const;
+		uint32_t residentLevel(Handle) const;
+		uint32_t desiredLevel(Handle) const;
+		bool hasPendingLoad(Handle) const;
+
+	private:
+		struct Entry
+		{
+			std::vector<size_t> levelSizes;
+			uint64_t lastUsedFrame = 0;
+			float maxDimension = 0.0f;
+			uint32_t levelsCount = 0;
+			uint32_t residentLevel = 0;
+			uint32_t pendingLevel = 0;
+			uint32_t desiredLevel = 0;
+			bool active = false;
+			bool pending = false;
+			bool failed = false;
+		};
+
+		bool evictLevel(uint64_t olderThanFrame, ActionList&);
+
+	private:
+		std::vector<Entry> _entries;
+		std::vector<Handle> _freeHandles;
+		size_t _budget = 0;
+		size_t _residentSize = 0;
+		size_t _pendingLoads = 0;
+		size_t _maxPendingLoads = 4;
+	};
+
+	/*
+	 * Streams mip levels of the DDS and PVR textures from the files, starting from the coarsest level.
+	 * Finer levels are loaded in background, according to screen sizes reported each frame,
+	 * finest levels of the least recently used textures are evicted when budget exceeded.
+	 */
+	class TextureResidencyManager
+	{
+	public:
+		TextureResidencyManager(RenderContext*, size_t budget);
+		~TextureResidencyManager();
+
+		/*
+		 * Textures which could not be streamed (cube maps, other file formats, etc)
+		 * are loaded entirely using TextureFactory
+		 */
+		Texture::Pointer loadTexture(const std::string& fileName, ObjectsCache& cache);
+		void releaseTexture(const Texture::Pointer&);
+
+		void reportScreenSize(const Texture::Pointer&, float pixels);
+
+		/*
+		 * Should be called from the rendering thread once per frame
+		 */
+		void update();
+
+		TextureResidencyPolicy& policy()
+			{ return _policy; }
+
+		const TextureResidencyPolicy& policy() const
+			{ return _policy; }
+
+	private:
+		ET_DENY_COPY(TextureResidencyManager)
+
+		struct StreamedTexture
+		{
+			Texture::Pointer texture;
+			std::string fileName;
+			uint64_t dataOffset = 0;
+			uint64_t pendingRequest = 0;
+		};
+
+		struct LoadedLevel
+		{
+			BinaryDataStorage data;
+			uint64_t request = 0;
+			TextureResidencyPolicy::Handle handle = TextureResidencyPolicy::InvalidHandle;
+			uint32_t level = 0;
+			bool succeeded = false;
+		};
+
+		void processLoadedLevels();
+		void requestLevel(TextureResidencyPolicy::Handle, uint32_t level);
+
+	private:
+		RenderContext* _rc = nullptr;
+		TextureResidencyPolicy _policy;
+		std::map<TextureResidencyPolicy::Handle, StreamedTexture> _textures;
+		std::map<std::string, TextureResidencyPolicy::Handle> _handles;
+
+		CriticalSection _csLoadedLevels;
+		std::vector<LoadedLevel> _loadedLevels;
+		AtomicCounter _pendingReads;
+
+		uint64_t _frame = 0;
+		uint64_t _requestCounter = 0;
+	};
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/datastorage.h>
+#include <et/collision/bvh.h>
+
+namespace et
+{
+	namespace rt
+	{
+		struct SceneTriangle
+		{
+			triangle tri;
+			size_t materialIndex = 0;
+
+			SceneTriangle()
+				{ }
+
+			SceneTriangle(const triangle& t, size_t m) :
+				tri(t), materialIndex(m) { }
+		};
+
+		typedef DataStorage<SceneTriangle> SceneTriangleList;
+
+		enum : uint32_t
+		{
+			InvalidTriangleIndex = TriangleBVH::InvalidIndex
+		};
+
+		/*
+		 * Rays in structure-of-arrays layout, traced together.
+		 * distance is used as input (maximal distance, negative value disables ray)
+		 * and as output (distance to the nearest hit).
+		 */
+		template <size_t N>
+		struct ET_ALIGNED(32) RayPacket
+		{
+			enum : size_t
+			{
+				Size = N
+			};
+
+			float originX[N];
+			float originY[N];
+			float originZ[N];
+			float directionX[N];
+			float directionY[N];
+			float directionZ[N];
+			float distance[N];
+			uint32_t triangleIndex[N];
+
+			RayPacket()
+			{
+				for (size_t i = 0; i < N; ++i)
+					disable(i);
+			}
+
+			void set(size_t i, const ray3d& r, float maxDistance = std::numeric_limits<float>::max())
+			{
+				ET_ASSERT(i < N);
+				originX[i] = r.origin.x;
+				originY[i] = r.origin.y;
+				originZ[i] = r.origin.z;
+				directionX[i] = r.direction.x;
+				directionY[i] = r.direction.y;
+				directionZ[i] = r.direction.z;
+				distance[i] = maxDistance;
+				triangleIndex[i] = InvalidTriangleIndex;
+			}
+
+			void disable(size_t i)
+			{
+				set(i, ray3d(vec3(0.0f), vec3(0.0f, 0.0f, 1.0f)), -1.0f);
+			}
+
+			ray3d ray(size_t i) const
+			{
+				return ray3d(vec3(originX[i], originY[i], originZ[i]),
+					vec3(directionX[i], directionY[i], directionZ[i]));
+			}
+
+			bool hit(size_t i) const
+				{ return triangleIndex[i] != InvalidTriangleIndex; }
+		};
+
+		typedef RayPacket<4> RayPacket4;
+		typedef RayPacket<8> RayPacket8;
+
+#	if (ET_SIMD_AVX)
+		typedef RayPacket8 PreferredRayPacket;
+#	else
+		typedef RayPacket4 PreferredRayPacket;
+#	endif
+
+		/*
+		 * Hierarchy is built with TriangleBVH, triangles are then copied in leaf order
+		 * in a compact form suitable for Moller-Trumbore test. Packet queries use SSE for
+		 * 4-wide and AVX for 8-wide packets when available, scalar code otherwise.
+		 * All triangle tests are two-sided.
+		 */
+		class BVH
+		{
+		public:
+			struct Hit
+			{
+				float distance = std::numeric_limits<float>::max();
+				uint32_t triangleIndex = InvalidTriangleIndex;
+			};
+
+		public:
+			/*
+			 * Uses triangles added with push_back, i.e. first lastElementIndex() elements
+			 */
+			void build(const SceneTriangleList&);
+			void clear();
+
+			bool empty() const
+				{ return _nodes.empty(); }
+
+			bool intersect(const ray3d&, Hit&) const;
+
+			/*
+			 * Stops traversal at the first hit closer than maxDistance
+			 */
+			bool occluded(const ray3d&, float maxDistance) const;
+
+			void intersect(RayPacket4&) const;
+			void intersect(RayPacket8&) const;
+
+			/*
+			 * Returns mask with bits set for occluded rays, disabled rays are never occluded
+			 */
+			uint32_t occluded(const RayPacket4&) const;
+			uint32_t occluded(const RayPacket8&) const;
+
+		private:
+			template <bool anyHit>
+			bool traverseRay(const ray3d&, Hit&) const;
+
+			template <size_t N, bool anyHit>
+			uint32_t traversePacket(RayPacket<N>&) const;
+
+		private:
+			struct PackedTriangle
+			{
+				vec3 v0;
+				uint32_t index = 0;
+				vec3 e1;
+				vec3 e2;
+			};
+
+			std::vector<TriangleBVH::Node> _nodes;
+			std::vector<PackedTriangle> _triangles;
+		};
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/tasks/jobsystem.h>
+#include <et/rt/raytracescene.h>
+
+namespace et
+{
+	namespace rt
+	{
+		typedef std::function<void(const vec2i& location, const vec4& color)> OutputFunction;
+
+		void raytrace(const RaytraceScene&, const vec2i& imageSize,
+			const vec2i& origin, const vec2i& size, OutputFunction);
+
+		void raytracePreview(const RaytraceScene&, const vec2i& imageSize,
+			const vec2i& origin, const vec2i& size, OutputFunction);
+
+		/*
+		 * Fraction of unoccluded hemisphere around the point, rays are traced in packets.
+		 * Thread safe, intended to be called from parallelFor when baking.
+		 */
+		float ambientOcclusion(const RaytraceScene&, const vec3& point, const vec3& normal,
+			size_t samples, float maxDistance);
+
+		/*
+		 * Splits image into tiles and renders them on the job system,
+		 * tiles closer to the image center are rendered first.
+		 * Output and tileFinished functions are called from worker threads.
+		 */
+		class TileRenderer
+		{
+		public:
+			typedef std::function<void(const recti& tile, uint64_t elapsedTime)> TileFinishedFunction;
+
+		public:
+			TileRenderer(JobSystem&);
+			~TileRenderer();
+
+			void render(const RaytraceScene&, const vec2i& imageSize, const vec2i& tileSize, bool preview,
+				OutputFunction, TileFinishedFunction);
+
+			/*
+			 * Drops pending tiles and waits for ones being rendered
+			 */
+			void cancel();
+			void wait();
+
+			size_t totalTiles() const;
+			size_t remainingTiles() const;
+
+			bool rendering() const
+				{ return remainingTiles() > 0; }
+
+		private:
+			ET_DENY_COPY(TileRenderer)
+
+		private:
+			struct RenderState : public Shared
+			{
+				const RaytraceScene* scene = nullptr;
+				vec2i imageSize;
+				bool preview = false;
+				OutputFunction output;
+				TileFinishedFunction tileFinished;
+
+				std::vector<recti> tiles;
+				AtomicCounter nextTile;
+				AtomicCounter completedTiles;
+				AtomicBool cancelled;
+			};
+
+			static void renderTiles(IntrusivePtr<RenderState>);
+
+		private:
+			JobSystem& _jobSystem;
+			IntrusivePtr<RenderState> _state;
+			JobList _jobs;
+		};
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/camera/camera.h>
+#include <et/imaging/texturedescription.h>
+#include <et/rt/raytracebvh.h>
+
+namespace et
+{
+	namespace rt
+	{
+		struct SceneMaterial
+		{
+		public:
+			vec4 diffuseColor = vec4(1.0f);
+			vec4 reflectiveColor = vec4(1.0f);
+			vec4 emissiveColor = vec4(0.0f);
+
+			float refractiveIndex = 0.0f;
+			float roughness = 1.0f;
+
+		public:
+			SceneMaterial()
+				{ }
+
+			SceneMaterial(const vec4& kD, const vec4& kR, const vec4& kE, float rg, float ior = 0.0f) :
+				diffuseColor(kD), reflectiveColor(kR), emissiveColor(kE), refractiveIndex(ior), roughness(rg) { }
+		};
+
+		struct SceneIntersection
+		{
+		public:
+			SceneIntersection()
+				{ }
+
+			SceneIntersection(size_t m) :
+				materialIndex(m) { }
+
+		public:
+			vec3 hitPoint;
+			vec3 hitNormal;
+
+			size_t materialIndex = 0;
+			uint32_t triangleIndex = InvalidTriangleIndex;
+
+			float rayDistance = std::numeric_limits<float>::max();
+
+			bool objectHit = false;
+		};
+
+		class RaytraceScene
+		{
+		public:
+			size_t addMaterial(const SceneMaterial&);
+			void addTriangles(const triangle* triangles, size_t count, size_t materialIndex);
+
+			/*
+			 * Should be called after all triangles were added and before tracing any rays
+			 */
+			void buildAccelerationStructure();
+
+			const SceneMaterial& materialAtIndex(size_t) const;
+
+			const SceneTriangleList& triangles() const
+				{ return _triangles; }
+
+			const BVH& bvh() const
+				{ return _bvh; }
+
+			SceneIntersection findNearestIntersection(const ray3d&) const;
+			bool occluded(const ray3d&, float maxDistance) const;
+
+			void findNearestIntersections(RayPacket4&, SceneIntersection*) const;
+			void findNearestIntersections(RayPacket8&, SceneIntersection*) const;
+
+		public:
+			struct
+			{
+				size_t samples = 16;
+				size_t bounces = 10;
+				float exposure = 1.5f;
+			} options;
+
+			vec4 ambientColor = vec4(0.0f);
+			TextureDescription::Pointer environmentMap;
+
+			Camera camera;
+			float apertureSize = 1.0f / 2.8f;
+			uint32_t apertureBlades = 5;
+
+		private:
+			template <typename P>
+			void resolvePacket(const P&, SceneIntersection*) const;
+
+		private:
+			SceneTriangleList _triangles;
+			BVH _bvh;
+
+			std::vector<SceneMaterial, SharedBlockAllocatorSTDProxy<SceneMaterial>> _materials;
+		};
+	}
+}
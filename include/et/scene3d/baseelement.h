@@ -116,6 +116,14 @@ namespace et
 
 			void duplicateChildrenToObject(Element* object);
 			void duplicateBasePropertiesToObject(Element* object);
+
+			/*
+			 * Hierarchy changes are passed up to the root element
+			 */
+			void childAdded(Element*) override;
+			void childRemoved(Element*) override;
+			virtual void descendantAdded(Element*);
+			virtual void descendantRemoved(Element*);
 			
 		private:
 			Pointer childWithNameCallback(const std::string& name, Pointer root, ElementType ofType);
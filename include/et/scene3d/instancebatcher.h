@@ -0,0 +1,128 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/rendering/rendercommandbuffer.h>
+#include <et/scene3d/mesh.h>
+
+namespace et
+{
+	namespace s3d
+	{
+		/*
+		 * Groups meshes added within the frame by vertex array, index range and material
+		 * (for example, ones created with Mesh::duplicate) and packs their final transforms
+		 * into contiguous per-instance ranges, so each group is drawn with one instanced call.
+		 * Grouping does not touch rendering API, batches are submitted through RenderCommandBuffer.
+		 */
+		class InstanceBatcher
+		{
+		public:
+			/*
+			 * Should not exceed the size of mInstanceTransform array declared in the shaders
+			 */
+			static const uint32_t DefaultMaxInstancesPerBatch = 32;
+
+			struct Batch
+			{
+				VertexArrayObject vao;
+				Material::Pointer material;
+				uint32_t startIndex = 0;
+				uint32_t numIndexes = 0;
+				uint32_t firstInstance = 0;
+				uint32_t instancesCount = 0;
+
+				/*
+				 * The smallest depth of the instances
+				 */
+				float depth = 0.0f;
+			};
+
+			typedef std::function<RenderCommandBuffer::Identifier(const Material::Pointer&)> MaterialIdentifierFunction;
+
+		public:
+			InstanceBatcher(uint32_t maxInstancesPerBatch = DefaultMaxInstancesPerBatch);
+
+			/*
+			 * Current level of details of the mesh is used, transform is copied here
+			 */
+			void add(Mesh*, float depth = 0.0f);
+
+			/*
+			 * Groups meshes added since the last clear, batches of the same group are
+			 * ordered by the first addition, instances keep the order of addition
+			 */
+			void build();
+
+			void clear();
+
+			/*
+			 * Records one instanced draw per batch
+			 */
+			void record(RenderCommandBuffer&, uint32_t pass, const Program::Pointer&, MaterialIdentifierFunction);
+
+			size_t meshesCount() const
+				{ return _entries.size(); }
+
+			const std::vector<Batch>& batches() const
+				{ return _batches; }
+
+			const std::vector<mat4>& instanceTransforms() const
+				{ return _instanceTransforms; }
+
+		private:
+			struct Entry
+			{
+				mat4 transform;
+				float depth = 0.0f;
+				uint32_t group = 0;
+			};
+
+			struct GroupKey
+			{
+				const VertexArrayObjectData* vao = nullptr;
+				const Material* material = nullptr;
+				uint32_t startIndex = 0;
+				uint32_t numIndexes = 0;
+
+				bool operator == (const GroupKey& k) const
+				{
+					return (vao == k.vao) && (material == k.material) &&
+						(startIndex == k.startIndex) && (numIndexes == k.numIndexes);
+				}
+			};
+
+			struct GroupKeyHash
+			{
+				size_t operator()(const GroupKey&) const;
+			};
+
+			struct Group
+			{
+				VertexArrayObject vao;
+				Material::Pointer material;
+				uint32_t startIndex = 0;
+				uint32_t numIndexes = 0;
+				uint32_t instancesCount = 0;
+			};
+
+		private:
+			std::vector<Entry> _entries;
+			std::vector<Group> _groups;
+			std::unordered_map<GroupKey, uint32_t, GroupKeyHash> _groupIndices;
+			std::vector<Batch> _batches;
+			std::vector<mat4> _instanceTransforms;
+			std::vector<float> _instanceDepths;
+			std::vector<uint32_t> _groupOffsets;
+			uint32_t _maxInstancesPerBatch = DefaultMaxInstancesPerBatch;
+
+		private:
+			ET_DENY_COPY(InstanceBatcher)
+		};
+	}
+}
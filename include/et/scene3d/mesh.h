@@ -12,6 +12,8 @@
 
 namespace et
 {
+	class Camera;
+	
 	namespace s3d
 	{
 		class Mesh : public RenderableElement
@@ -56,10 +58,28 @@ namespace et
 			void deserialize(std::istream& stream, ElementFactory* factory, SceneVersion version);
 
 			void cleanupLodChildren();
-			void attachLod(size_t level, Mesh::Pointer mesh);
+			
+			/*
+			 * Level could be selected automatically when mesh occupies less than
+			 * screenCoverage of the screen height (see selectLod)
+			 */
+			void attachLod(size_t level, Mesh::Pointer mesh, float screenCoverage = 0.0f);
 
 			void setLod(size_t level);
 			
+			/*
+			 * Selects the coarsest level, which screen coverage is not less than specified one
+			 */
+			void selectLod(float screenCoverage);
+			
+			size_t selectedLod() const
+				{ return _selectedLod; }
+			
+			/*
+			 * Fraction of the screen height, occupied by the bounding sphere
+			 */
+			static float screenCoverage(const Camera& camera, const vec3& center, float radius);
+			
 			const std::string& vaoName() const
 				{ return _vaoName; }
 			
@@ -76,6 +96,7 @@ namespace et
 		private:
 			VertexArrayObject _vao;
 			LodMap _lods;
+			std::map<size_t, float> _lodScreenCoverage;
 			uint32_t _startIndex;
 			size_t _numIndexes;
 			size_t _selectedLod;
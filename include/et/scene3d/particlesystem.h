@@ -36,16 +36,12 @@ namespace et
 			size_t activeParticlesCount() const
 				{ return _emitter.activeParticlesCount(); }
 			
-			particles::PointSpriteEmitter& emitter()
+			particles::PointSpriteStreamEmitter& emitter()
 				{ return _emitter; }
 			
-			const particles::PointSpriteEmitter& emitter() const
+			const particles::PointSpriteStreamEmitter& emitter() const
 				{ return _emitter; }
 			
-			template <typename F>
-			void setUpdateFunction(const F& func)
-				{ _emitter.setUpdateFunction(func); }
-			
 		private:
 			void onTimerUpdated(NotifyTimer*);
 						
@@ -56,7 +52,7 @@ namespace et
 			VertexDeclaration _decl;
 			VertexArray::Description _vertexData;
 			
-			particles::PointSpriteEmitter _emitter;
+			particles::PointSpriteStreamEmitter _emitter;
 			NotifyTimer _timer;
 		};
 	}
@@ -9,6 +9,7 @@
 
 #include <et/app/events.h>
 #include <et/core/objectscache.h>
+#include <et/core/mappedfile.h>
 #include <et/scene3d/baseelement.h>
 #include <et/scene3d/storage.h>
 #include <et/scene3d/mesh.h>
@@ -16,6 +17,7 @@
 #include <et/scene3d/cameraelement.h>
 #include <et/scene3d/lightelement.h>
 #include <et/scene3d/particlesystem.h>
+#include <et/scene3d/spatialindex.h>
 
 namespace et
 {
@@ -59,6 +61,12 @@ namespace et
 			IndexBuffer indexBufferWithId(const std::string& id);
 			
 			VertexArrayObject vaoWithIdentifiers(const std::string& vbid, const std::string& ibid);
+
+			/*
+			 * Bounding volumes of all support meshes in the scene
+			 */
+			SpatialIndex& spatialIndex()
+				{ return _spatialIndex; }
 			
 		public:
 			ET_DECLARE_EVENT1(deserializationFinished, bool)
@@ -71,6 +79,9 @@ namespace et
 
 			Scene3dStorage::Pointer deserializeStorage(std::istream& stream, RenderContext* rc,
 				ObjectsCache& tc, const std::string& basePath, StorageFormat fmt, bool async);
+
+			void serializeMappedArrays(std::ostream& stream, Scene3dStorage::Pointer s);
+			void deserializeMappedArrays(std::istream& stream, Scene3dStorage::Pointer s);
 			
 			Element::Pointer createElementOfType(size_t type, Element* parent);
 			Material::Pointer materialWithId(int id);
@@ -78,7 +89,12 @@ namespace et
 			void onMaterialLoaded(Material*);
 			void allMaterialsLoaded();
 
+			void descendantAdded(Element*) override;
+			void descendantRemoved(Element*) override;
+
 		private:
+			SpatialIndex _spatialIndex;
+			MappedFile::Pointer _mappedFile;
 			ElementFactory* _externalFactory;
 			std::vector<VertexBuffer> _vertexBuffers;
 			std::vector<IndexBuffer> _indexBuffers;
@@ -16,7 +16,8 @@ namespace et
 	{
 		enum SerializationParameters
 		{
-			SerializationChunkLength = 6 
+			SerializationChunkLength = 6,
+			MappedArraysDataAlignment = 64,
 		};
 
 		enum SceneVersion
@@ -26,6 +27,8 @@ namespace et
 			SceneVersion_1_0_2 = 102,
 			SceneVersion_1_0_3 = 103,
 			SceneVersion_1_0_4 = 104,
+			SceneVersion_1_0_5 = 105,
+			SceneVersion_1_0_6 = 106,
 		};
 
 		enum StorageVersion
@@ -38,6 +41,12 @@ namespace et
 		{
 			StorageFormat_Binary,
 			StorageFormat_HumanReadableMaterials,
+
+			/*
+			 * Binary materials, vertex and index data stored as aligned raw blocks
+			 * which could be referenced directly from memory-mapped file
+			 */
+			StorageFormat_MappedBinary,
 		};
 
 		extern const SceneVersion SceneVersionLatest;
@@ -50,6 +59,7 @@ namespace et
 		extern ChunkId HeaderMaterials;
 		extern ChunkId HeaderVertexArrays;
 		extern ChunkId HeaderIndexArrays;
+		extern ChunkId HeaderMappedArrays;
 
 		inline void serializeChunk(std::ostream& stream, ChunkId chunk)
 			{ stream.write(chunk, SerializationChunkLength); }
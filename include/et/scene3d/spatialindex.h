@@ -0,0 +1,74 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/camera/frustum.h>
+#include <et/collision/aabbtree.h>
+#include <et/scene3d/supportmesh.h>
+
+namespace et
+{
+	namespace s3d
+	{
+		/*
+		 * Dynamic AABB tree over support meshes of the scene.
+		 * Elements are tracked through hierarchy changes and transform invalidation,
+		 * pending changes are applied lazily before each query.
+		 * Results are valid until the hierarchy is changed.
+		 */
+		class SpatialIndex
+		{
+		public:
+			typedef std::vector<SupportMesh*> QueryResult;
+
+		public:
+			SpatialIndex();
+			~SpatialIndex();
+
+			/*
+			 * Subtree is indexed on the next update, element could be not fully constructed here
+			 */
+			void add(Element*);
+			void remove(Element*);
+
+			void invalidate(SupportMesh*);
+			void update();
+
+			void clear();
+
+			size_t size() const
+				{ return _tree.size(); }
+
+			const AABBTree& tree() const
+				{ return _tree; }
+
+			size_t queryFrustum(const Frustum&, QueryResult&);
+			size_t queryAABB(const AABB&, QueryResult&);
+			size_t querySphere(const Sphere&, QueryResult&);
+
+			/*
+			 * Returns meshes which bounding boxes are hit by ray within maxDistance
+			 */
+			size_t queryRay(const ray3d&, QueryResult&, float maxDistance = std::numeric_limits<float>::max());
+
+		private:
+			friend class SupportMesh;
+
+			void addSubtree(Element*);
+			void removeSubtree(Element*);
+			void removeMesh(SupportMesh*);
+
+			ET_DENY_COPY(SpatialIndex)
+
+		private:
+			AABBTree _tree;
+			std::vector<Element*> _pendingElements;
+			std::vector<SupportMesh*> _invalidatedMeshes;
+		};
+	}
+}
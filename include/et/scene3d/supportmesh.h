@@ -8,12 +8,14 @@
 #pragma once
 
 #include <et/scene3d/mesh.h>
-#include <et/collision/collision.h>
+#include <et/collision/bvh.h>
+#include <et/collision/aabbtree.h>
 
 namespace et
 {
 	namespace s3d
 	{
+		class SpatialIndex;
 		class SupportMesh : public Mesh
 		{
 		public:
@@ -26,6 +28,8 @@ namespace et
 			SupportMesh(const std::string& name, const VertexArrayObject& ib, const Material::Pointer& material,
 				uint32_t startIndex, size_t numIndexes, Element* parent = 0);
 
+			~SupportMesh();
+
 			ElementType type() const 
 				{ return ElementType_SupportMesh; }
 
@@ -38,6 +42,24 @@ namespace et
 			const CollisionData& triangles() const
 				{ return _data; }
 
+			const TriangleBVH& bvh() const
+				{ return _bvh; }
+
+			/*
+			 * Queries are performed in mesh local space
+			 */
+			bool rayNearest(const ray3d& r, TriangleBVH::RayHit& hit, bool twoSided = false) const
+				{ return _bvh.rayNearest(r, _data.data(), hit, twoSided); }
+
+			bool rayAny(const ray3d& r, float maxDistance, bool twoSided = false) const
+				{ return _bvh.rayAny(r, _data.data(), maxDistance, twoSided); }
+
+			bool sphereSweep(const Sphere& s, const vec3& velocity, TriangleBVH::SweepHit& hit) const
+				{ return _bvh.sphereSweep(s, velocity, _data.data(), hit); }
+
+			size_t aabbOverlap(const AABB& box, std::vector<uint32_t>& triangleIndices) const
+				{ return _bvh.aabbOverlap(box, _data.data(), triangleIndices); }
+
 			void setNumIndexes(size_t num);
 			void fillCollisionData(const VertexArray::Pointer& v, const IndexArray::Pointer& i);
 
@@ -47,6 +69,12 @@ namespace et
 			const AABB& aabb();
 			OBB obb();
 			
+			/*
+			 * Selects level of detail using bounding sphere, projected by camera
+			 */
+			using Mesh::selectLod;
+			void selectLod(const Camera& camera);
+			
 			const vec3& size() const
 				{ return _size; }
 			
@@ -60,13 +88,20 @@ namespace et
 			void buildInverseTransform();
 
 		private:
+			friend class SpatialIndex;
+
 			CollisionData _data;
+			TriangleBVH _bvh;
 			AABB _cachedAABB;
 			
 			vec3 _size;
 			vec3 _center;
 			float _radius = 0.0f;
 			bool _shouldBuildAABB = true;
+
+			SpatialIndex* _spatialIndex = nullptr;
+			uint32_t _spatialProxy = AABBTree::InvalidIndex;
+			bool _spatialProxyInvalidated = false;
 		};
 	}
 }
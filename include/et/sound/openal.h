@@ -15,6 +15,9 @@
 #elif (ET_PLATFORM_ANDROID)
 #	include <oal/al.h>
 #	include <oal/alc.h>
+#elif (ET_PLATFORM_LINUX)
+#	include <AL/al.h>
+#	include <AL/alc.h>
 #elif (ET_PLATFORM_WIN)
 #	include <external\oal\al.h>
 #	include <external\oal\alc.h>
@@ -14,6 +14,8 @@ namespace et
 {
     namespace audio
     {
+		struct StreamingStatistics;
+		
         class PlayerPrivate;
         class Player : public Object, public EventReceiver
         {
@@ -44,6 +46,16 @@ namespace et
 			
 			unsigned int source() const;
 			
+			/*
+			 * Number of times streamed source was stopped because of the late buffer
+			 */
+			uint64_t underrunsCount() const;
+			
+			/*
+			 * Time (in seconds) between queueing of the last streamed buffer and its playback
+			 */
+			float queueLatency() const;
+			
 			ET_DECLARE_EVENT1(finished, Player*)
 
         private:
@@ -54,15 +66,22 @@ namespace et
 			
 			void setActualVolume(float);
             
-			void handleProcessedBuffers();
+			void handleProcessedBuffers(StreamingStatistics&);
 			void handleProcessedSamples();
+			int unqueueProcessedBuffers();
+			
+			/*
+			 * Time (in seconds) until the first queued buffer is processed
+			 * or non-streamed track is finished
+			 */
+			float nextUpdateInterval() const;
 			
         private:
 			friend class Manager;
 			friend class StreamingThread;
 
 		private:
-			ET_DECLARE_PIMPL(Player, 32)
+			ET_DECLARE_PIMPL(Player, 192)
 			
 			Track::Pointer _track;
 			FloatAnimator _volumeAnimator;
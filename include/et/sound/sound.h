@@ -23,6 +23,12 @@ namespace et
 
 			Player::Pointer genPlayer(Track::Pointer track);
 			Player::Pointer genPlayer();
+			
+			StreamingStatistics streamingStatistics() const
+				{ return _streamingThread.statistics(); }
+			
+			void resetStreamingStatistics()
+				{ _streamingThread.resetStatistics(); }
 
         private:
             Manager();
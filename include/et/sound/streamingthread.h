@@ -17,9 +17,47 @@ namespace et
 		class Player;
 		typedef IntrusivePtr<Player> PlayerPointer;
 		
+		struct StreamingStatistics
+		{
+			/*
+			 * Streamed sources stopped because all queued buffers were played
+			 * before the next one was queued
+			 */
+			uint64_t underruns = 0;
+			
+			/*
+			 * Buffers decoded on demand, because decode-ahead did not keep up
+			 */
+			uint64_t decodeMisses = 0;
+			
+			uint64_t buffersQueued = 0;
+			uint64_t wakeUps = 0;
+			
+			/*
+			 * Time (in seconds) from queueing buffer to the moment it starts playing
+			 */
+			double totalQueueLatency = 0.0;
+			float maximumQueueLatency = 0.0f;
+			
+			float averageQueueLatency() const
+			{
+				return (buffersQueued > 0) ?
+					static_cast<float>(totalQueueLatency / static_cast<double>(buffersQueued)) : 0.0f;
+			}
+		};
+		
 		class StreamingThreadPrivate;
 		class StreamingThread : public Thread
 		{
+		public:
+			/*
+			 * Thread wakes up when the first of queued buffers is expected to be processed
+			 * (or playback of non-streamed track to be finished), but not later than
+			 * MaximumWaitInterval and not earlier than MinimumWaitInterval.
+			 */
+			static const uint64_t MinimumWaitInterval = 5;
+			static const uint64_t MaximumWaitInterval = 250;
+			
 		public:
 			StreamingThread();
 			
@@ -28,6 +66,9 @@ namespace et
 			void addPlayer(PlayerPointer);
 			void removePlayer(PlayerPointer);
 			
+			StreamingStatistics statistics() const;
+			void resetStatistics();
+			
 		private:
 			ThreadResult main();
 			
@@ -32,8 +32,20 @@ namespace et
 			int actualBuffersCount() const;
 			
 			bool streamed() const;
+			
+			/*
+			 * Uploads next decoded chunk into the buffer, decoding it
+			 * on demand if decode-ahead did not keep up
+			 */
 			unsigned int loadNextBuffer();
 			
+			/*
+			 * Decodes one chunk into the decode-ahead ring if it is not full,
+			 * returns true if there are more chunks to decode
+			 */
+			bool decodeAhead();
+			size_t decodedBuffersCount() const;
+			
 			void preloadBuffers();
 			void rewind();
 			
@@ -0,0 +1,135 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <et/tasks/tasks.h>
+#include <et/threading/thread.h>
+#include <et/threading/criticalsection.h>
+
+namespace et
+{
+	class JobSystem;
+	class JobWorker;
+
+	class Job : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(Job)
+
+		typedef std::function<void()> Function;
+
+	public:
+		Job(Function);
+
+		/*
+		 * continuation will be scheduled right after this job completes
+		 */
+		void addContinuation(Job::Pointer);
+
+		bool completed() const
+			{ return _completed; }
+
+	private:
+		void execute();
+
+		ET_DENY_COPY(Job)
+
+	private:
+		friend class JobSystem;
+
+		Function _function;
+
+		CriticalSection _csContinuations;
+		std::vector<Job::Pointer> _continuations;
+
+		JobSystem* _owner = nullptr;
+		AtomicCounter _unresolvedDependencies;
+		AtomicBool _completed;
+	};
+
+	typedef std::vector<Job::Pointer> JobList;
+
+	class JobSystem
+	{
+	public:
+		typedef std::function<void(size_t, size_t)> RangeFunction;
+
+	public:
+		JobSystem();
+		~JobSystem();
+
+		/*
+		 * workersCount = 0 means one worker per core, except the calling one
+		 */
+		void start(size_t workersCount = 0);
+
+		/*
+		 * Jobs which were not taken by the workers are executed by the calling thread
+		 */
+		void stop();
+
+		bool running() const
+			{ return !_workers.empty(); }
+
+		size_t workersCount() const
+			{ return _workers.size(); }
+
+		bool isWorkerThread() const;
+
+		/*
+		 * Jobs created here are not scheduled until submitted.
+		 * Dependencies should be added before submission.
+		 */
+		Job::Pointer createJob(Job::Function);
+		void addDependency(Job::Pointer job, Job::Pointer dependsOn);
+
+		void submit(Job::Pointer);
+		Job::Pointer submit(Job::Function);
+
+		/*
+		 * Takes ownership of the task, it will be deleted after execution
+		 */
+		Job::Pointer submit(Task*);
+
+		/*
+		 * Waiting thread executes pending jobs instead of blocking
+		 */
+		void wait(Job::Pointer);
+		void wait(const JobList&);
+
+		/*
+		 * Splits [begin, end) into ranges of at least minimumRange elements,
+		 * executes them on all workers and the calling thread, returns when all are done
+		 */
+		void parallelFor(size_t begin, size_t end, size_t minimumRange, RangeFunction);
+
+	private:
+		friend class Job;
+		friend class JobWorker;
+
+		void schedule(Job::Pointer);
+		bool executeNextJob(size_t preferredQueue);
+		Job::Pointer takeJob(size_t preferredQueue);
+		size_t currentWorkerIndex() const;
+		void wakeWorker(size_t);
+
+		ET_DENY_COPY(JobSystem)
+
+	private:
+		struct JobQueue
+		{
+			CriticalSection lock;
+			std::deque<Job::Pointer> jobs;
+		};
+
+		std::vector<JobWorker*> _workers;
+		std::vector<JobQueue*> _queues;
+		AtomicCounter _submitCounter;
+	};
+}
@@ -42,4 +42,30 @@ namespace et
 	private:
 		Mutex& _mutex;
 	};
+
+	/*
+	 * Condition variable with its own lock: thread waits (with lock entered) until
+	 * another one changes the state under the same lock and notifies waiting threads
+	 */
+	class ConditionPrivate;
+	class Condition
+	{
+	public:
+		Condition();
+		~Condition();
+
+		void lock();
+		void unlock();
+
+		/*
+		 * Lock is released while waiting and entered again before return,
+		 * could return spuriously, so the state should be checked in a loop
+		 */
+		void wait();
+
+		void notifyAll();
+
+	private:
+		ET_DECLARE_PIMPL(Condition, 128)
+	};
 }
@@ -35,6 +35,13 @@ namespace et
 		void run();
 		void suspend();
 		void resume();
+
+		/*
+		 * Suspends thread until resumed or timeout elapsed,
+		 * returns false on timeout
+		 */
+		bool suspend(uint64_t timeoutMSec);
+
 		void stop();
 
 		void waitForTermination();
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/core/containers.h>
+#include <et/core/mappedfile.h>
 #include <et/rendering/rendering.h>
 
 namespace et
@@ -25,6 +26,12 @@ namespace et
 
 	public:
 		IndexArray(IndexArrayFormat format, size_t size, PrimitiveType primitiveType);
+
+		/*
+		 * References indices inside of the mapped file, without copying
+		 */
+		IndexArray(IndexArrayFormat format, PrimitiveType primitiveType, size_t actualSize,
+			MappedFile::Pointer file, size_t fileOffset, size_t dataSize);
 		
 		void linearize(size_t size);
 		void linearize(size_t indexFrom, size_t indexTo, uint32_t startIndex);
@@ -140,6 +147,7 @@ namespace et
 		
 	private:
 		BinaryDataStorage _data;
+		MappedFile::Pointer _mappedFile;
 		size_t _actualSize = 0;
 		IndexArrayFormat _format = IndexArrayFormat::Format_16bit;
 		PrimitiveType _primitiveType = PrimitiveType::Points;
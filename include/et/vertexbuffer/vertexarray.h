@@ -29,6 +29,12 @@ namespace et
 		VertexArray();
 		VertexArray(const VertexDeclaration& decl, size_t size);
 		VertexArray(const VertexDeclaration& decl, int size);
+
+		/*
+		 * Takes existing chunks, declaration should describe them
+		 */
+		VertexArray(const VertexDeclaration& decl, size_t size, const VertexDataChunkList& chunks,
+			const VertexDataChunk& smoothing);
 		
 		VertexDataChunk& smoothing()
 			{ return _smoothing; }
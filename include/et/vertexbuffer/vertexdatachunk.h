@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/core/containers.h>
+#include <et/core/mappedfile.h>
 #include <et/vertexbuffer/vertexdeclaration.h>
 
 namespace et
@@ -18,6 +19,12 @@ namespace et
 		VertexDataChunkData(std::istream& stream);
 		VertexDataChunkData(VertexAttributeUsage usage, VertexAttributeType type, size_t size);
 
+		/*
+		 * References data inside of the mapped file, without copying
+		 */
+		VertexDataChunkData(VertexAttributeUsage usage, VertexAttributeType type, MappedFile::Pointer file,
+			size_t fileOffset, size_t dataSize, size_t offset);
+
 		void resize(size_t);
 		void fitToSize(size_t);
 
@@ -42,6 +49,12 @@ namespace et
 		VertexAttributeType type() const
 			{ return _type; }
 
+		size_t offset() const
+			{ return _data.lastElementIndex(); }
+
+		void setOffset(size_t value)
+			{ _data.setOffset(value); }
+
 		void serialize(std::ostream& stream);
 		
 		void copyTo(VertexDataChunkData&) const;
@@ -50,6 +63,7 @@ namespace et
 		VertexAttributeUsage _usage = VertexAttributeUsage::Position;
 		VertexAttributeType _type = VertexAttributeType::Float;
 		BinaryDataStorage _data;
+		MappedFile::Pointer _mappedFile;
 	};
 
 	class VertexDataChunk : public IntrusivePtr<VertexDataChunkData>
@@ -64,6 +78,10 @@ namespace et
 		VertexDataChunk(VertexAttributeUsage usage, VertexAttributeType type, size_t size) : 
 			IntrusivePtr<VertexDataChunkData>(sharedObjectFactory().createObject<VertexDataChunkData>(usage, type, size)) { }
 
+		VertexDataChunk(VertexAttributeUsage usage, VertexAttributeType type, MappedFile::Pointer file,
+			size_t fileOffset, size_t dataSize, size_t offset) : IntrusivePtr<VertexDataChunkData>(
+			sharedObjectFactory().createObject<VertexDataChunkData>(usage, type, file, fileOffset, dataSize, offset)) { }
+
 		template <typename T>
 		RawDataAcessor<T> accessData(size_t elementOffset) 
 		{
@@ -5,8 +5,10 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/threading/threading.h>
 #include <et/rendering/rendercontext.h>
+#include <et/rendering/renderframe.h>
 #include <et/app/application.h>
 
 using namespace et;
@@ -14,6 +16,62 @@ using namespace et;
 namespace et
 {
 	uint32_t randomInteger(uint32_t limit);
+	
+	class RenderThread : public Thread
+	{
+	public:
+		RenderThread(Application* app) :
+			Thread(false), _app(app) { }
+		
+		/*
+		 * Called from the main thread, previous frame should be completed
+		 */
+		void renderFrame()
+		{
+			ET_ASSERT(_fence.reached(_requestedFrames));
+			++_requestedFrames;
+			resume();
+		}
+		
+		void waitForFrames()
+			{ _fence.wait(_requestedFrames); }
+		
+		ThreadResult main()
+		{
+			ET_PROFILE_THREAD("Render");
+			Threading::setRenderingThread(Threading::currentThread());
+			
+			uint64_t renderedFrames = 0;
+			while (running())
+			{
+				suspend();
+				
+				if (running())
+				{
+					/*
+					 * Context is released after each frame, so the main thread
+					 * could take it between frames (see Application::acquireRenderContext)
+					 */
+					_app->_renderContext->makeCurrent();
+					Threading::setRenderingThread(Threading::currentThread());
+					
+					_app->_renderRunLoop.update(queryContiniousTimeInMilliSeconds());
+					_app->performRendering();
+					
+					_app->_renderContext->releaseCurrent();
+					_fence.signal(++renderedFrames);
+				}
+			}
+			
+			Threading::setRenderingThread(Threading::mainThread());
+			return 0;
+		}
+		
+	private:
+		Application* _app = nullptr;
+		RenderFence _fence;
+		uint64_t _requestedFrames = 0;
+	};
 }
 
 Application::Application()
@@ -24,21 +82,26 @@ Application::Application()
 	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
 	
 	threading();
+	ET_PROFILE_THREAD("Main");
 
 	delegate()->setApplicationParameters(_parameters);
 
 	platformInit();
 	platformActivate();
 	
+	_jobSystem.start();
+	_backgroundThread.setJobSystem(&_jobSystem);
 	_backgroundThread.run();
 }
 
 Application::~Application()
 {
 	_running = false;
+	stopRenderThread();
 
 	_backgroundThread.stop();
 	_backgroundThread.waitForTermination();
+	_jobSystem.stop();
 	
 	platformDeactivate();
 	platformFinalize();
@@ -93,18 +156,81 @@ void Application::enterRunLoop()
 	
 	_renderContext->init();
 	setActive(true);
+	startRenderThread();
 	
 #endif
 }
 
+void Application::startRenderThread()
+{
+	if (!_parameters.renderThread || (_renderThread != nullptr)) return;
+	
+	if (!_renderContext->releaseCurrent())
+	{
+		log::warning("[Application] Render context could not be moved to another thread on this platform, "
+			"rendering on the main thread.");
+		return;
+	}
+	
+	_renderRunLoop.updateTime(queryContiniousTimeInMilliSeconds());
+	_renderThread = sharedObjectFactory().createObject<RenderThread>(this);
+	_renderThread->run();
+}
+
+void Application::stopRenderThread()
+{
+	if (_renderThread == nullptr) return;
+	
+	_renderThread->waitForFrames();
+	_renderThread->stop();
+	_renderThread->waitForTermination();
+	
+	sharedObjectFactory().deleteObject(_renderThread);
+	_renderThread = nullptr;
+	
+	_renderContext->makeCurrent();
+}
+
+void Application::waitForRenderThread()
+{
+	if (_renderThread != nullptr)
+		_renderThread->waitForFrames();
+}
+
+void Application::acquireRenderContext()
+{
+	if (_renderThread == nullptr) return;
+	
+	_renderThread->waitForFrames();
+	_renderContext->makeCurrent();
+	Threading::setRenderingThread(Threading::currentThread());
+}
+
+void Application::releaseRenderContext()
+{
+	if (_renderThread != nullptr)
+		_renderContext->releaseCurrent();
+}
+
 void Application::performRendering()
 {
 #if defined(ET_CONSOLE_APPLICATION)
 	
 #else
-	_renderContext->beginRender();
-	_delegate->render(_renderContext);
-	_renderContext->endRender();
+	ET_PROFILE_SCOPE("Application::performRendering");
+	
+	{
+		ET_PROFILE_SCOPE("RenderContext::beginRender");
+		_renderContext->beginRender();
+	}
+	{
+		ET_PROFILE_SCOPE("IApplicationDelegate::render");
+		_delegate->render(_renderContext);
+	}
+	{
+		ET_PROFILE_SCOPE("RenderContext::endRender");
+		_renderContext->endRender();
+	}
 #endif
 }
 
@@ -139,12 +265,28 @@ bool Application::shouldPerformRendering()
 void Application::performUpdateAndRender()
 {
 	ET_ASSERT(_running && !_suspended);
+	ET_PROFILE_SCOPE("Frame");
 	
 	_runLoop.update(_lastQueuedTimeMSec);
-	_delegate->idle(_runLoop.firstTimerPool()->actualTime());
+	{
+		ET_PROFILE_SCOPE("IApplicationDelegate::idle");
+		_delegate->idle(_runLoop.firstTimerPool()->actualTime());
+	}
 	
 #if !defined(ET_CONSOLE_APPLICATION)
-	performRendering();
+	if (_renderThread == nullptr)
+	{
+		performRendering();
+	}
+	else
+	{
+		/*
+		 * idle above was running while the previous frame was rendered
+		 */
+		ET_PROFILE_SCOPE("Application::waitForRenderThread");
+		_renderThread->waitForFrames();
+		_renderThread->renderFrame();
+	}
 #endif
 }
 
@@ -169,7 +311,9 @@ void Application::setActive(bool active)
 		
 		if (_postResizeOnActivate)
 		{
+			acquireRenderContext();
 			_delegate->applicationWillResizeContext(_renderContext->sizei());
+			releaseRenderContext();
 			_postResizeOnActivate = false;
 		}
 		
@@ -205,6 +349,7 @@ void Application::suspend()
 {
 	if (_suspended) return;
 
+	waitForRenderThread();
 	delegate()->applicationWillSuspend();
 	_runLoop.pause();
 
@@ -235,6 +380,7 @@ void Application::stop()
 
 void Application::terminated()
 {
+	stopRenderThread();
 	_delegate->applicationWillTerminate();
 }
 
@@ -312,7 +458,7 @@ void Application::setShouldSilentPathResolverErrors(bool e)
  */
 RunLoop& et::currentRunLoop()
 {
-	if (Threading::currentThread() == application().backgroundThread().id())
+	if ((Threading::currentThread() == application().backgroundThread().id()) || application().jobSystem().isWorkerThread())
 		return application().backgroundRunLoop();
 	
 	return mainRunLoop();
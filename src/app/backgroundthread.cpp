@@ -6,18 +6,56 @@
  */
 
 #include <et/core/tools.h>
+#include <et/core/profiler.h>
 #include <et/app/backgroundthread.h>
 
+namespace et
+{
+	class DeferredJobTask : public Task
+	{
+	public:
+		DeferredJobTask(Task* task, JobSystem* jobSystem) :
+			_task(task), _jobSystem(jobSystem) { }
+		
+		~DeferredJobTask()
+			{ sharedObjectFactory().deleteObject(_task); }
+		
+		void execute()
+		{
+			_jobSystem->submit(_task);
+			_task = nullptr;
+		}
+		
+	private:
+		Task* _task = nullptr;
+		JobSystem* _jobSystem = nullptr;
+	};
+}
+
 using namespace et;
 
 BackgroundRunLoop::BackgroundRunLoop() :
-	_owner(nullptr) { }
+	_owner(nullptr), _jobSystem(nullptr) { }
 
 void BackgroundRunLoop::setOwner(BackgroundThread* owner)
 	{ _owner = owner; }
 
+void BackgroundRunLoop::setJobSystem(JobSystem* jobSystem)
+	{ _jobSystem = jobSystem; }
+
 void BackgroundRunLoop::addTask(Task* t, float delay)
 {
+	if ((_jobSystem != nullptr) && _jobSystem->running())
+	{
+		if (delay <= 0.0f)
+		{
+			_jobSystem->submit(t);
+			return;
+		}
+		
+		t = sharedObjectFactory().createObject<DeferredJobTask>(t, _jobSystem);
+	}
+	
 	updateTime(queryContiniousTimeInMilliSeconds());
 	RunLoop::addTask(t, delay);
 	_owner->resume();
@@ -30,6 +68,8 @@ BackgroundThread::BackgroundThread()
 
 ThreadResult BackgroundThread::main()
 {
+	ET_PROFILE_THREAD("Background");
+	
 	while (running())
 	{
 		if (_runLoop.hasTasks() || _runLoop.firstTimerPool()->hasObjects())
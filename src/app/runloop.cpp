@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/app/runloop.h>
 #include <et/tasks/tasks.h>
 
@@ -22,6 +23,8 @@ RunLoop::~RunLoop()
 
 void RunLoop::update(uint64_t t)
 {
+	ET_PROFILE_SCOPE("RunLoop::update");
+	
 	updateTime(t);
 
 	if (_active) 
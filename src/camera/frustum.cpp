@@ -5,10 +5,159 @@
  *
  */
 
+#include <et/tasks/jobsystem.h>
 #include <et/camera/frustum.h>
 
 using namespace et;
 
+namespace et
+{
+	namespace culling
+	{
+		enum : size_t
+		{
+			wordSize = 32,
+			minimumWordsPerJob = 64,
+		};
+
+#	if (ET_SIMD_AVX)
+		typedef __m256 Batch;
+		enum : size_t { batchWidth = 8 };
+		inline Batch load(const float* p) { return _mm256_loadu_ps(p); }
+		inline Batch broadcast(float v) { return _mm256_set1_ps(v); }
+		inline Batch add(Batch a, Batch b) { return _mm256_add_ps(a, b); }
+		inline Batch mul(Batch a, Batch b) { return _mm256_mul_ps(a, b); }
+		inline Batch allVisible() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+		inline Batch greaterEqual(Batch mask, Batch a, Batch b) { return _mm256_and_ps(mask, _mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+		inline Batch greater(Batch mask, Batch a, Batch b) { return _mm256_and_ps(mask, _mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+		inline uint32_t bits(Batch mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+#	elif (ET_SIMD_SSE)
+		typedef __m128 Batch;
+		enum : size_t { batchWidth = 4 };
+		inline Batch load(const float* p) { return _mm_loadu_ps(p); }
+		inline Batch broadcast(float v) { return _mm_set1_ps(v); }
+		inline Batch add(Batch a, Batch b) { return _mm_add_ps(a, b); }
+		inline Batch mul(Batch a, Batch b) { return _mm_mul_ps(a, b); }
+		inline Batch allVisible() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+		inline Batch greaterEqual(Batch mask, Batch a, Batch b) { return _mm_and_ps(mask, _mm_cmpge_ps(a, b)); }
+		inline Batch greater(Batch mask, Batch a, Batch b) { return _mm_and_ps(mask, _mm_cmpgt_ps(a, b)); }
+		inline uint32_t bits(Batch mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask)); }
+#	elif (ET_SIMD_NEON)
+		typedef float32x4_t Batch;
+		enum : size_t { batchWidth = 4 };
+		inline Batch load(const float* p) { return vld1q_f32(p); }
+		inline Batch broadcast(float v) { return vdupq_n_f32(v); }
+		inline Batch add(Batch a, Batch b) { return vaddq_f32(a, b); }
+		inline Batch mul(Batch a, Batch b) { return vmulq_f32(a, b); }
+		inline Batch allVisible() { return vreinterpretq_f32_u32(vdupq_n_u32(0xffffffff)); }
+		inline Batch greaterEqual(Batch mask, Batch a, Batch b)
+			{ return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(mask), vcgeq_f32(a, b))); }
+		inline Batch greater(Batch mask, Batch a, Batch b)
+			{ return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(mask), vcgtq_f32(a, b))); }
+		inline uint32_t bits(Batch mask)
+		{
+			static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+			uint32x4_t r = vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(laneBits));
+			uint32x2_t s = vpadd_u32(vget_low_u32(r), vget_high_u32(r));
+			return vget_lane_u32(vpadd_u32(s, s), 0);
+		}
+#	else
+		typedef float Batch;
+		enum : size_t { batchWidth = 1 };
+		inline Batch load(const float* p) { return *p; }
+		inline Batch broadcast(float v) { return v; }
+		inline Batch add(Batch a, Batch b) { return a + b; }
+		inline Batch mul(Batch a, Batch b) { return a * b; }
+		inline Batch allVisible() { return 1.0f; }
+		inline Batch greaterEqual(Batch mask, Batch a, Batch b) { return (a >= b) ? mask : 0.0f; }
+		inline Batch greater(Batch mask, Batch a, Batch b) { return (a > b) ? mask : 0.0f; }
+		inline uint32_t bits(Batch mask) { return (mask > 0.0f) ? 1u : 0u; }
+#	endif
+
+		static_assert(AABBStream::batchSize % batchWidth == 0, "Stream padding should be a multiple of batch width");
+		static_assert(SphereStream::batchSize % batchWidth == 0, "Stream padding should be a multiple of batch width");
+
+		inline size_t wordsCount(size_t elements)
+			{ return (elements + wordSize - 1) / wordSize; }
+
+		/*
+		 * Clears bits of padding elements in the last word
+		 */
+		inline void trimMask(uint32_t* mask, size_t elements, size_t lastWord)
+		{
+			if ((lastWord == wordsCount(elements)) && (elements % wordSize != 0))
+				mask[lastWord - 1] &= (1u << (elements % wordSize)) - 1u;
+		}
+
+		template <class T>
+		inline void resizeStream(T& stream, size_t size)
+		{
+			size_t padded = T::batchSize * ((size + T::batchSize - 1) / T::batchSize);
+			stream.centerX.resize(padded, 0.0f);
+			stream.centerY.resize(padded, 0.0f);
+			stream.centerZ.resize(padded, 0.0f);
+		}
+	}
+}
+
+/*
+ * AABBStream
+ */
+void AABBStream::resize(size_t size)
+{
+	culling::resizeStream(*this, size);
+	extentX.resize(centerX.size(), 0.0f);
+	extentY.resize(centerX.size(), 0.0f);
+	extentZ.resize(centerX.size(), 0.0f);
+	_size = size;
+}
+
+void AABBStream::set(size_t index, const AABB& aabb)
+{
+	ET_ASSERT(index < _size);
+	centerX[index] = aabb.center.x;
+	centerY[index] = aabb.center.y;
+	centerZ[index] = aabb.center.z;
+	extentX[index] = aabb.dimension.x;
+	extentY[index] = aabb.dimension.y;
+	extentZ[index] = aabb.dimension.z;
+}
+
+void AABBStream::push_back(const AABB& aabb)
+{
+	resize(_size + 1);
+	set(_size - 1, aabb);
+}
+
+/*
+ * SphereStream
+ */
+void SphereStream::resize(size_t size)
+{
+	culling::resizeStream(*this, size);
+	radius.resize(centerX.size(), 0.0f);
+	_size = size;
+}
+
+void SphereStream::set(size_t index, const Sphere& sphere)
+{
+	ET_ASSERT(index < _size);
+	centerX[index] = sphere.center().x;
+	centerY[index] = sphere.center().y;
+	centerZ[index] = sphere.center().z;
+	radius[index] = sphere.radius();
+}
+
+void SphereStream::push_back(const Sphere& sphere)
+{
+	resize(_size + 1);
+	set(_size - 1, sphere);
+}
+
+/*
+ * Frustum
+ */
+
 Frustum::Frustum()
 {
 }
@@ -56,6 +205,142 @@ bool Frustum::containsAABB(const AABB& aabb) const
 	return true;
 }
 
+void Frustum::cullAABBs(const AABBStream& stream, VisibilityMask& mask) const
+{
+	mask.resize(culling::wordsCount(stream.size()));
+	cullAABBs(stream, mask.data(), 0, mask.size());
+}
+
+void Frustum::cullAABBs(const AABBStream& stream, VisibilityMask& mask, JobSystem& jobs) const
+{
+	mask.resize(culling::wordsCount(stream.size()));
+	jobs.parallelFor(0, mask.size(), culling::minimumWordsPerJob, [this, &stream, &mask](size_t begin, size_t end)
+		{ cullAABBs(stream, mask.data(), begin, end); });
+}
+
+void Frustum::cullSpheres(const SphereStream& stream, VisibilityMask& mask) const
+{
+	mask.resize(culling::wordsCount(stream.size()));
+	cullSpheres(stream, mask.data(), 0, mask.size());
+}
+
+void Frustum::cullSpheres(const SphereStream& stream, VisibilityMask& mask, JobSystem& jobs) const
+{
+	mask.resize(culling::wordsCount(stream.size()));
+	jobs.parallelFor(0, mask.size(), culling::minimumWordsPerJob, [this, &stream, &mask](size_t begin, size_t end)
+		{ cullSpheres(stream, mask.data(), begin, end); });
+}
+
+void Frustum::cullAABBs(const AABBStream& stream, uint32_t* mask, size_t firstWord, size_t lastWord) const
+{
+	using namespace culling;
+	
+	Batch px[FrustumPlane_max];
+	Batch py[FrustumPlane_max];
+	Batch pz[FrustumPlane_max];
+	Batch ax[FrustumPlane_max];
+	Batch ay[FrustumPlane_max];
+	Batch az[FrustumPlane_max];
+	Batch negW[FrustumPlane_max];
+	for (size_t p = 0; p < FrustumPlane_max; ++p)
+	{
+		vec3 absNormal = absv(_planes[p].xyz());
+		px[p] = broadcast(_planes[p].x);
+		py[p] = broadcast(_planes[p].y);
+		pz[p] = broadcast(_planes[p].z);
+		ax[p] = broadcast(absNormal.x);
+		ay[p] = broadcast(absNormal.y);
+		az[p] = broadcast(absNormal.z);
+		negW[p] = broadcast(-_planes[p].w);
+	}
+	
+	size_t paddedSize = stream.centerX.size();
+	for (size_t word = firstWord; word < lastWord; ++word)
+	{
+		uint32_t wordBits = 0;
+		size_t base = word * wordSize;
+		size_t end = etMin(base + wordSize, paddedSize);
+		for (size_t i = base; i < end; i += batchWidth)
+		{
+			Batch cx = load(stream.centerX.data() + i);
+			Batch cy = load(stream.centerY.data() + i);
+			Batch cz = load(stream.centerZ.data() + i);
+			Batch ex = load(stream.extentX.data() + i);
+			Batch ey = load(stream.extentY.data() + i);
+			Batch ez = load(stream.extentZ.data() + i);
+			
+			Batch visible = allVisible();
+			for (size_t p = 0; p < FrustumPlane_max; ++p)
+			{
+				Batch d = add(add(mul(cx, px[p]), mul(cy, py[p])), mul(cz, pz[p]));
+				Batch r = add(add(mul(ex, ax[p]), mul(ey, ay[p])), mul(ez, az[p]));
+				visible = greaterEqual(visible, add(d, r), negW[p]);
+			}
+			wordBits |= bits(visible) << (i - base);
+		}
+		mask[word] = wordBits;
+	}
+	
+	trimMask(mask, stream.size(), lastWord);
+}
+
+void Frustum::cullSpheres(const SphereStream& stream, uint32_t* mask, size_t firstWord, size_t lastWord) const
+{
+	using namespace culling;
+	
+	Batch px[FrustumPlane_max];
+	Batch py[FrustumPlane_max];
+	Batch pz[FrustumPlane_max];
+	Batch pw[FrustumPlane_max];
+	for (size_t p = 0; p < FrustumPlane_max; ++p)
+	{
+		px[p] = broadcast(_planes[p].x);
+		py[p] = broadcast(_planes[p].y);
+		pz[p] = broadcast(_planes[p].z);
+		pw[p] = broadcast(_planes[p].w);
+	}
+	
+	Batch zero = broadcast(0.0f);
+	size_t paddedSize = stream.centerX.size();
+	for (size_t word = firstWord; word < lastWord; ++word)
+	{
+		uint32_t wordBits = 0;
+		size_t base = word * wordSize;
+		size_t end = etMin(base + wordSize, paddedSize);
+		for (size_t i = base; i < end; i += batchWidth)
+		{
+			Batch cx = load(stream.centerX.data() + i);
+			Batch cy = load(stream.centerY.data() + i);
+			Batch cz = load(stream.centerZ.data() + i);
+			Batch r = load(stream.radius.data() + i);
+			
+			Batch visible = allVisible();
+			for (size_t p = 0; p < FrustumPlane_max; ++p)
+			{
+				Batch d = add(add(add(mul(cx, px[p]), mul(cy, py[p])), mul(cz, pz[p])), pw[p]);
+				visible = greater(visible, add(d, r), zero);
+			}
+			wordBits |= bits(visible) << (i - base);
+		}
+		mask[word] = wordBits;
+	}
+	
+	trimMask(mask, stream.size(), lastWord);
+}
+
+bool Frustum::containsBox(const vec3& minVertex, const vec3& maxVertex) const
+{
+	vec3 center = 0.5f * (maxVertex + minVertex);
+	vec3 dimension = 0.5f * (maxVertex - minVertex);
+	for (const auto& frustumPlane : _planes)
+	{
+		if (dot(center, frustumPlane.xyz()) + dot(dimension, absv(frustumPlane.xyz())) < -frustumPlane.w)
+			return false;
+	}
+	
+	return true;
+}
+
 bool Frustum::containsOBB(const OBB&) const
 {
 	ET_FAIL("Not implemented")
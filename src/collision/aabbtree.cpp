@@ -0,0 +1,286 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/collision/aabbtree.h>
+
+using namespace et;
+
+namespace
+{
+	inline float boxArea(const vec3& minVertex, const vec3& maxVertex)
+	{
+		vec3 d = maxVertex - minVertex;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	inline bool boxContains(const AABBTree::Node& n, const vec3& minVertex, const vec3& maxVertex)
+	{
+		return (n.minVertex.x <= minVertex.x) && (n.minVertex.y <= minVertex.y) && (n.minVertex.z <= minVertex.z) &&
+			(n.maxVertex.x >= maxVertex.x) && (n.maxVertex.y >= maxVertex.y) && (n.maxVertex.z >= maxVertex.z);
+	}
+}
+
+AABBTree::AABBTree(float margin) :
+	_margin(margin)
+{
+}
+
+void AABBTree::clear()
+{
+	_nodes.clear();
+	_root = InvalidIndex;
+	_freeList = InvalidIndex;
+	_leavesCount = 0;
+}
+
+uint32_t AABBTree::allocateNode()
+{
+	if (_freeList == InvalidIndex)
+	{
+		_nodes.emplace_back();
+		_nodes.back().height = 0;
+		return static_cast<uint32_t>(_nodes.size() - 1);
+	}
+
+	uint32_t index = _freeList;
+	_freeList = _nodes[index].parent;
+	_nodes[index] = Node();
+	_nodes[index].height = 0;
+	return index;
+}
+
+void AABBTree::freeNode(uint32_t index)
+{
+	_nodes[index] = Node();
+	_nodes[index].parent = _freeList;
+	_freeList = index;
+}
+
+uint32_t AABBTree::insert(const AABB& box, void* userData)
+{
+	uint32_t proxy = allocateNode();
+
+	Node& n = _nodes[proxy];
+	n.minVertex = box.minVertex() - vec3(_margin);
+	n.maxVertex = box.maxVertex() + vec3(_margin);
+	n.userData = userData;
+
+	insertLeaf(proxy);
+	++_leavesCount;
+
+	return proxy;
+}
+
+void AABBTree::remove(uint32_t proxy)
+{
+	ET_ASSERT((proxy < _nodes.size()) && _nodes[proxy].leaf() && (_nodes[proxy].height == 0));
+
+	removeLeaf(proxy);
+	freeNode(proxy);
+	--_leavesCount;
+}
+
+bool AABBTree::update(uint32_t proxy, const AABB& box)
+{
+	ET_ASSERT((proxy < _nodes.size()) && _nodes[proxy].leaf() && (_nodes[proxy].height == 0));
+
+	if (boxContains(_nodes[proxy], box.minVertex(), box.maxVertex()))
+		return false;
+
+	removeLeaf(proxy);
+
+	Node& n = _nodes[proxy];
+	n.minVertex = box.minVertex() - vec3(_margin);
+	n.maxVertex = box.maxVertex() + vec3(_margin);
+
+	insertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::insertLeaf(uint32_t leaf)
+{
+	if (_root == InvalidIndex)
+	{
+		_root = leaf;
+		_nodes[leaf].parent = InvalidIndex;
+		return;
+	}
+
+	/*
+	 * Descend towards the sibling which causes the smallest growth of total area
+	 */
+	vec3 leafMin = _nodes[leaf].minVertex;
+	vec3 leafMax = _nodes[leaf].maxVertex;
+
+	uint32_t index = _root;
+	while (!_nodes[index].leaf())
+	{
+		const Node& n = _nodes[index];
+
+		float area = boxArea(n.minVertex, n.maxVertex);
+		float combinedArea = boxArea(minv(n.minVertex, leafMin), maxv(n.maxVertex, leafMax));
+
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2] = { };
+		uint32_t children[2] = { n.left, n.right };
+		for (size_t i = 0; i < 2; ++i)
+		{
+			const Node& c = _nodes[children[i]];
+			float newArea = boxArea(minv(c.minVertex, leafMin), maxv(c.maxVertex, leafMax));
+			childCost[i] = c.leaf() ? newArea + inheritanceCost :
+				newArea - boxArea(c.minVertex, c.maxVertex) + inheritanceCost;
+		}
+
+		if ((cost < childCost[0]) && (cost < childCost[1]))
+			break;
+
+		index = (childCost[0] < childCost[1]) ? children[0] : children[1];
+	}
+
+	uint32_t sibling = index;
+	uint32_t oldParent = _nodes[sibling].parent;
+	uint32_t newParent = allocateNode();
+
+	Node& p = _nodes[newParent];
+	p.parent = oldParent;
+	p.minVertex = minv(leafMin, _nodes[sibling].minVertex);
+	p.maxVertex = maxv(leafMax, _nodes[sibling].maxVertex);
+	p.height = _nodes[sibling].height + 1;
+	p.left = sibling;
+	p.right = leaf;
+
+	if (oldParent == InvalidIndex)
+	{
+		_root = newParent;
+	}
+	else if (_nodes[oldParent].left == sibling)
+	{
+		_nodes[oldParent].left = newParent;
+	}
+	else
+	{
+		_nodes[oldParent].right = newParent;
+	}
+
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent = newParent;
+
+	refit(newParent);
+}
+
+void AABBTree::removeLeaf(uint32_t leaf)
+{
+	if (leaf == _root)
+	{
+		_root = InvalidIndex;
+		return;
+	}
+
+	uint32_t parent = _nodes[leaf].parent;
+	uint32_t grandParent = _nodes[parent].parent;
+	uint32_t sibling = (_nodes[parent].left == leaf) ? _nodes[parent].right : _nodes[parent].left;
+
+	if (grandParent == InvalidIndex)
+	{
+		_root = sibling;
+		_nodes[sibling].parent = InvalidIndex;
+	}
+	else
+	{
+		if (_nodes[grandParent].left == parent)
+			_nodes[grandParent].left = sibling;
+		else
+			_nodes[grandParent].right = sibling;
+
+		_nodes[sibling].parent = grandParent;
+		refit(grandParent);
+	}
+
+	freeNode(parent);
+	_nodes[leaf].parent = InvalidIndex;
+}
+
+void AABBTree::refit(uint32_t index)
+{
+	while (index != InvalidIndex)
+	{
+		index = balance(index);
+
+		Node& n = _nodes[index];
+		const Node& l = _nodes[n.left];
+		const Node& r = _nodes[n.right];
+		n.height = 1 + etMax(l.height, r.height);
+		n.minVertex = minv(l.minVertex, r.minVertex);
+		n.maxVertex = maxv(l.maxVertex, r.maxVertex);
+
+		index = n.parent;
+	}
+}
+
+/*
+ * Rotates subtree if children heights differ by more than one, returns new subtree root
+ */
+uint32_t AABBTree::balance(uint32_t a)
+{
+	Node& nodeA = _nodes[a];
+	if (nodeA.leaf() || (nodeA.height < 2))
+		return a;
+
+	uint32_t b = nodeA.left;
+	uint32_t c = nodeA.right;
+	int32_t difference = _nodes[c].height - _nodes[b].height;
+
+	if ((difference <= 1) && (difference >= -1))
+		return a;
+
+	/*
+	 * Promote the higher child, its shorter grandchild goes down to a
+	 */
+	uint32_t up = (difference > 0) ? c : b;
+	uint32_t stay = (difference > 0) ? b : c;
+
+	Node& nodeUp = _nodes[up];
+	uint32_t f = nodeUp.left;
+	uint32_t g = nodeUp.right;
+
+	nodeUp.left = a;
+	nodeUp.parent = nodeA.parent;
+	nodeA.parent = up;
+
+	if (nodeUp.parent == InvalidIndex)
+	{
+		_root = up;
+	}
+	else if (_nodes[nodeUp.parent].left == a)
+	{
+		_nodes[nodeUp.parent].left = up;
+	}
+	else
+	{
+		_nodes[nodeUp.parent].right = up;
+	}
+
+	uint32_t higher = (_nodes[f].height > _nodes[g].height) ? f : g;
+	uint32_t lower = (higher == f) ? g : f;
+
+	nodeUp.right = higher;
+	nodeA.left = stay;
+	nodeA.right = lower;
+	_nodes[lower].parent = a;
+
+	nodeA.minVertex = minv(_nodes[stay].minVertex, _nodes[lower].minVertex);
+	nodeA.maxVertex = maxv(_nodes[stay].maxVertex, _nodes[lower].maxVertex);
+	nodeA.height = 1 + etMax(_nodes[stay].height, _nodes[lower].height);
+
+	nodeUp.minVertex = minv(nodeA.minVertex, _nodes[higher].minVertex);
+	nodeUp.maxVertex = maxv(nodeA.maxVertex, _nodes[higher].maxVertex);
+	nodeUp.height = 1 + etMax(nodeA.height, _nodes[higher].height);
+
+	return up;
+}
@@ -0,0 +1,558 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/serialization.h>
+#include <et/collision/bvh.h>
+
+using namespace et;
+
+namespace
+{
+	enum : uint32_t
+	{
+		SAHBinsCount = 16,
+		TraverseStackSize = 64,
+		MaxBuildDepth = TraverseStackSize - 2,
+	};
+
+	const float rayEpsilon = 0.00001f;
+
+	/* relative to the cost of a single triangle test */
+	const float SAHTraversalCost = 1.0f;
+
+	struct BuildBounds
+	{
+		vec3 minVertex = vec3(std::numeric_limits<float>::max());
+		vec3 maxVertex = vec3(-std::numeric_limits<float>::max());
+
+		void merge(const vec3& p)
+		{
+			minVertex = minv(minVertex, p);
+			maxVertex = maxv(maxVertex, p);
+		}
+
+		void merge(const BuildBounds& b)
+		{
+			minVertex = minv(minVertex, b.minVertex);
+			maxVertex = maxv(maxVertex, b.maxVertex);
+		}
+
+		float area() const
+		{
+			vec3 d = maxv(maxVertex - minVertex, vec3(0.0f));
+			return d.x * d.y + d.y * d.z + d.z * d.x;
+		}
+	};
+
+	struct BuildContext
+	{
+		std::vector<BuildBounds> bounds;
+		std::vector<vec3> centroids;
+		std::vector<uint32_t>& indices;
+		std::vector<TriangleBVH::Node>& nodes;
+
+		BuildContext(std::vector<uint32_t>& i, std::vector<TriangleBVH::Node>& n) :
+			indices(i), nodes(n) { }
+	};
+
+	struct RayContext
+	{
+		vec3 origin;
+		vec3 direction;
+		vec3 inverseDirection;
+
+		RayContext(const ray3d& r) :
+			origin(r.origin), direction(r.direction)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				inverseDirection[i] = (std::abs(direction[i]) > std::numeric_limits<float>::epsilon()) ?
+					1.0f / direction[i] : std::copysign(std::numeric_limits<float>::max(), direction[i]);
+			}
+		}
+	};
+
+	inline bool rayBox(const RayContext& r, const vec3& minVertex, const vec3& maxVertex,
+		float maxDistance, float& entry)
+	{
+		vec3 t0 = (minVertex - r.origin) * r.inverseDirection;
+		vec3 t1 = (maxVertex - r.origin) * r.inverseDirection;
+		vec3 tMin = minv(t0, t1);
+		vec3 tMax = maxv(t0, t1);
+		entry = etMax(0.0f, etMax(tMin.x, etMax(tMin.y, tMin.z)));
+		float exit = etMin(maxDistance, etMin(tMax.x, etMin(tMax.y, tMax.z)));
+		return entry <= exit;
+	}
+
+	/*
+	 * Moller-Trumbore, front faces are the ones with counter-clockwise winding
+	 * same as in intersect::rayTriangle
+	 */
+	inline bool rayTriangleDistance(const RayContext& r, const triangle& tri, bool twoSided, float& distance)
+	{
+		vec3 h = cross(r.direction, tri.edge3to1());
+		float a = dot(tri.edge2to1(), h);
+
+		if (twoSided ? (std::abs(a) < rayEpsilon) : (a < rayEpsilon))
+			return false;
+
+		float invA = 1.0f / a;
+		vec3 s = r.origin - tri.v1();
+
+		float u = dot(s, h) * invA;
+		if ((u < 0.0f) || (u > 1.0f))
+			return false;
+
+		vec3 q = cross(s, tri.edge2to1());
+		float v = dot(r.direction, q) * invA;
+		if ((v < 0.0f) || (u + v > 1.0f))
+			return false;
+
+		distance = dot(tri.edge3to1(), q) * invA;
+		return distance > rayEpsilon;
+	}
+
+	inline bool boxesOverlap(const vec3& aMin, const vec3& aMax, const vec3& bMin, const vec3& bMax)
+	{
+		return (aMin.x <= bMax.x) && (aMax.x >= bMin.x) && (aMin.y <= bMax.y) &&
+			(aMax.y >= bMin.y) && (aMin.z <= bMax.z) && (aMax.z >= bMin.z);
+	}
+
+	/*
+	 * Separating axis test, box is given as center and half extent
+	 */
+	bool triangleBox(const triangle& t, const vec3& center, const vec3& extent)
+	{
+		vec3 v[3] = { t.v1() - center, t.v2() - center, t.v3() - center };
+		vec3 e[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+		vec3 boxAxes[3] = { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f) };
+
+		auto separated = [&v, &extent](const vec3& axis) -> bool
+		{
+			float p0 = dot(v[0], axis);
+			float p1 = dot(v[1], axis);
+			float p2 = dot(v[2], axis);
+			float r = extent.x * std::abs(axis.x) + extent.y * std::abs(axis.y) + extent.z * std::abs(axis.z);
+			return (etMin(p0, etMin(p1, p2)) > r) || (etMax(p0, etMax(p1, p2)) < -r);
+		};
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				if (separated(cross(boxAxes[i], e[j])))
+					return false;
+			}
+		}
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			if (separated(boxAxes[i]))
+				return false;
+		}
+
+		return !separated(cross(e[0], e[1]));
+	}
+
+	uint32_t buildNode(BuildContext& ctx, uint32_t begin, uint32_t end, uint32_t depth)
+	{
+		uint32_t nodeIndex = static_cast<uint32_t>(ctx.nodes.size());
+		ctx.nodes.emplace_back();
+
+		BuildBounds nodeBounds;
+		BuildBounds centroidBounds;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			uint32_t t = ctx.indices[i];
+			nodeBounds.merge(ctx.bounds[t]);
+			centroidBounds.merge(ctx.centroids[t]);
+		}
+
+		ctx.nodes[nodeIndex].minVertex = nodeBounds.minVertex;
+		ctx.nodes[nodeIndex].maxVertex = nodeBounds.maxVertex;
+
+		uint32_t count = end - begin;
+		float leafCost = static_cast<float>(count) * nodeBounds.area();
+
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		float bestCost = std::numeric_limits<float>::max();
+
+		vec3 centroidExtent = centroidBounds.maxVertex - centroidBounds.minVertex;
+		if ((count > 1) && (depth < MaxBuildDepth))
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (centroidExtent[axis] <= std::numeric_limits<float>::epsilon())
+					continue;
+
+				BuildBounds bins[SAHBinsCount];
+				uint32_t binCounts[SAHBinsCount] = { };
+
+				float scale = static_cast<float>(SAHBinsCount) / centroidExtent[axis];
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					uint32_t t = ctx.indices[i];
+					uint32_t bin = etMin(static_cast<uint32_t>(SAHBinsCount - 1),
+						static_cast<uint32_t>((ctx.centroids[t][axis] - centroidBounds.minVertex[axis]) * scale));
+					bins[bin].merge(ctx.bounds[t]);
+					++binCounts[bin];
+				}
+
+				float rightAreas[SAHBinsCount] = { };
+				uint32_t rightCounts[SAHBinsCount] = { };
+				BuildBounds accumulated;
+				uint32_t accumulatedCount = 0;
+				for (uint32_t i = SAHBinsCount - 1; i > 0; --i)
+				{
+					accumulated.merge(bins[i]);
+					accumulatedCount += binCounts[i];
+					rightAreas[i] = accumulated.area();
+					rightCounts[i] = accumulatedCount;
+				}
+
+				accumulated = BuildBounds();
+				accumulatedCount = 0;
+				for (uint32_t i = 0; i + 1 < SAHBinsCount; ++i)
+				{
+					accumulated.merge(bins[i]);
+					accumulatedCount += binCounts[i];
+					if ((accumulatedCount == 0) || (rightCounts[i + 1] == 0))
+						continue;
+
+					float cost = static_cast<float>(accumulatedCount) * accumulated.area() +
+						static_cast<float>(rightCounts[i + 1]) * rightAreas[i + 1];
+
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i + 1;
+					}
+				}
+			}
+		}
+
+		bool makeLeaf = (bestAxis == -1) || ((count <= TriangleBVH::MaxTrianglesPerLeaf) &&
+			(SAHTraversalCost * nodeBounds.area() + bestCost >= leafCost));
+
+		if (makeLeaf)
+		{
+			ctx.nodes[nodeIndex].offset = begin;
+			ctx.nodes[nodeIndex].count = count;
+			return nodeIndex;
+		}
+
+		float minCentroid = centroidBounds.minVertex[bestAxis];
+		float scale = static_cast<float>(SAHBinsCount) / centroidExtent[bestAxis];
+		auto middle = std::partition(ctx.indices.begin() + begin, ctx.indices.begin() + end,
+			[&ctx, bestAxis, bestSplit, minCentroid, scale](uint32_t t)
+		{
+			uint32_t bin = etMin(static_cast<uint32_t>(SAHBinsCount - 1),
+				static_cast<uint32_t>((ctx.centroids[t][bestAxis] - minCentroid) * scale));
+			return bin < bestSplit;
+		});
+
+		uint32_t split = static_cast<uint32_t>(middle - ctx.indices.begin());
+		ET_ASSERT((split > begin) && (split < end));
+
+		buildNode(ctx, begin, split, depth + 1);
+		uint32_t rightChild = buildNode(ctx, split, end, depth + 1);
+		ctx.nodes[nodeIndex].offset = rightChild;
+		return nodeIndex;
+	}
+}
+
+void TriangleBVH::clear()
+{
+	_nodes.clear();
+	_indices.clear();
+}
+
+void TriangleBVH::build(const triangle* triangles, size_t triangleCount)
+{
+	clear();
+
+	if ((triangles == nullptr) || (triangleCount == 0))
+		return;
+
+	ET_ASSERT(triangleCount < InvalidIndex);
+
+	BuildContext ctx(_indices, _nodes);
+	ctx.bounds.resize(triangleCount);
+	ctx.centroids.resize(triangleCount);
+	_indices.resize(triangleCount);
+
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const triangle& t = triangles[i];
+		ctx.bounds[i].minVertex = minv(t.v1(), minv(t.v2(), t.v3()));
+		ctx.bounds[i].maxVertex = maxv(t.v1(), maxv(t.v2(), t.v3()));
+		ctx.centroids[i] = 0.5f * (ctx.bounds[i].minVertex + ctx.bounds[i].maxVertex);
+		_indices[i] = static_cast<uint32_t>(i);
+	}
+
+	_nodes.reserve(2 * triangleCount / MaxTrianglesPerLeaf + 1);
+	buildNode(ctx, 0, static_cast<uint32_t>(triangleCount), 0);
+	_nodes.shrink_to_fit();
+}
+
+bool TriangleBVH::rayNearest(const ray3d& ray, const triangle* triangles, RayHit& hit, bool twoSided) const
+{
+	if (empty()) return false;
+
+	RayContext r(ray);
+	float nearest = hit.distance;
+	uint32_t nearestIndex = InvalidIndex;
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	float entry = 0.0f;
+	if (!rayBox(r, _nodes.front().minVertex, _nodes.front().maxVertex, nearest, entry))
+		return false;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const Node& node = _nodes[stack[--stackSize]];
+
+		if (node.leaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				float distance = 0.0f;
+				uint32_t t = _indices[i];
+				if (rayTriangleDistance(r, triangles[t], twoSided, distance) && (distance < nearest))
+				{
+					nearest = distance;
+					nearestIndex = t;
+				}
+			}
+			continue;
+		}
+
+		uint32_t left = static_cast<uint32_t>(&node - _nodes.data()) + 1;
+		uint32_t right = node.offset;
+
+		float leftEntry = 0.0f;
+		float rightEntry = 0.0f;
+		bool hitLeft = rayBox(r, _nodes[left].minVertex, _nodes[left].maxVertex, nearest, leftEntry);
+		bool hitRight = rayBox(r, _nodes[right].minVertex, _nodes[right].maxVertex, nearest, rightEntry);
+
+		ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+		if (hitLeft && hitRight)
+		{
+			/* push far child first so the near one is processed next */
+			if (leftEntry <= rightEntry)
+			{
+				stack[stackSize++] = right;
+				stack[stackSize++] = left;
+			}
+			else
+			{
+				stack[stackSize++] = left;
+				stack[stackSize++] = right;
+			}
+		}
+		else if (hitLeft)
+		{
+			stack[stackSize++] = left;
+		}
+		else if (hitRight)
+		{
+			stack[stackSize++] = right;
+		}
+	}
+
+	if (nearestIndex == InvalidIndex)
+		return false;
+
+	hit.distance = nearest;
+	hit.triangleIndex = nearestIndex;
+	hit.point = ray.origin + nearest * ray.direction;
+	return true;
+}
+
+bool TriangleBVH::rayAny(const ray3d& ray, const triangle* triangles, float maxDistance, bool twoSided) const
+{
+	if (empty()) return false;
+
+	RayContext r(ray);
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+
+		float entry = 0.0f;
+		if (!rayBox(r, node.minVertex, node.maxVertex, maxDistance, entry))
+			continue;
+
+		if (node.leaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				float distance = 0.0f;
+				if (rayTriangleDistance(r, triangles[_indices[i]], twoSided, distance) && (distance <= maxDistance))
+					return true;
+			}
+		}
+		else
+		{
+			ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return false;
+}
+
+bool TriangleBVH::sphereSweep(const Sphere& sphere, const vec3& velocity, const triangle* triangles,
+	SweepHit& hit) const
+{
+	if (empty()) return false;
+
+	/*
+	 * Sphere center moves along the segment [center, center + velocity],
+	 * node boxes are inflated by radius and tested against this segment
+	 */
+	RayContext r(ray3d(sphere.center(), velocity));
+	vec3 inflate(sphere.radius());
+
+	float earliest = etMin(hit.time, 1.0f);
+	bool found = false;
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+
+		float entry = 0.0f;
+		if (!rayBox(r, node.minVertex - inflate, node.maxVertex + inflate, earliest, entry))
+			continue;
+
+		if (!node.leaf())
+		{
+			ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+			continue;
+		}
+
+		for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+		{
+			uint32_t t = _indices[i];
+
+			vec3 point;
+			vec3 normal;
+			float penetration = 0.0f;
+			float time = 0.0f;
+
+			if (!intersect::sphereTriangle(sphere, velocity, triangles[t], point, normal, penetration, time))
+				continue;
+
+			if ((time >= 0.0f) && (time <= earliest))
+			{
+				earliest = time;
+				hit.point = point;
+				hit.normal = normal;
+				hit.penetration = penetration;
+				hit.time = time;
+				hit.triangleIndex = t;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+size_t TriangleBVH::aabbOverlap(const AABB& box, const triangle* triangles, std::vector<uint32_t>& result) const
+{
+	if (empty()) return 0;
+
+	size_t initialSize = result.size();
+	vec3 boxMin = box.center - box.dimension;
+	vec3 boxMax = box.center + box.dimension;
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+
+		if (!boxesOverlap(node.minVertex, node.maxVertex, boxMin, boxMax))
+			continue;
+
+		if (node.leaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				uint32_t t = _indices[i];
+				if (triangleBox(triangles[t], box.center, box.dimension))
+					result.push_back(t);
+			}
+		}
+		else
+		{
+			ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return result.size() - initialSize;
+}
+
+void TriangleBVH::serialize(std::ostream& stream) const
+{
+	serializeInt(stream, static_cast<uint32_t>(_nodes.size()));
+	serializeInt(stream, static_cast<uint32_t>(_indices.size()));
+
+	if (!_nodes.empty())
+	{
+		stream.write(reinterpret_cast<const char*>(_nodes.data()),
+			static_cast<std::streamsize>(_nodes.size() * sizeof(Node)));
+	}
+
+	if (!_indices.empty())
+	{
+		stream.write(reinterpret_cast<const char*>(_indices.data()),
+			static_cast<std::streamsize>(_indices.size() * sizeof(uint32_t)));
+	}
+}
+
+void TriangleBVH::deserialize(std::istream& stream)
+{
+	_nodes.resize(deserializeUInt(stream));
+	_indices.resize(deserializeUInt(stream));
+
+	if (!_nodes.empty())
+	{
+		stream.read(reinterpret_cast<char*>(_nodes.data()),
+			static_cast<std::streamsize>(_nodes.size() * sizeof(Node)));
+	}
+
+	if (!_indices.empty())
+	{
+		stream.read(reinterpret_cast<char*>(_indices.data()),
+			static_cast<std::streamsize>(_indices.size() * sizeof(uint32_t)));
+	}
+}
@@ -10,6 +10,27 @@
 
 using namespace et;
 
+void et::transformAABBs(const mat4& m, const AABB* input, AABB* output, size_t count)
+{
+	/*
+	 * Center is transformed as a point, extent is projected onto absolute values of basis vectors
+	 */
+	mat4 transform = m;
+	vec3 basisX = absv(transform[0].xyz());
+	vec3 basisY = absv(transform[1].xyz());
+	vec3 basisZ = absv(transform[2].xyz());
+	
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AABB& source = input[i];
+		vec4 center;
+		simd::transformVector(transform.data(), vec4(source.center, 1.0f).data(), center.data());
+		
+		vec3 extent = basisX * source.dimension.x + basisY * source.dimension.y + basisZ * source.dimension.z;
+		output[i] = AABB(center.xyz(), extent);
+	}
+}
+
 float et::distanceSquareFromPointToLine(const vec3& p, const vec3& l0, const vec3& l1, vec3& projection)
 {
 	vec3 diff = p - l0;
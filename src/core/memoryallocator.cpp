@@ -5,6 +5,7 @@
  *
  */
 
+#include <atomic>
 #include <et/core/et.h>
 #include <et/threading/criticalsection.h>
 #include <et/core/staticdatastorage.h>
@@ -90,7 +91,7 @@ namespace et
 		
 		bool containsPointer(char*);
 		
-		void compress();
+		void compress(MemoryChunkInfo*);
 		
 #	if (ET_DEBUG)
 		void setBreakOnAllocation()
@@ -99,6 +100,7 @@ namespace et
 		
 	private:
 		void init(uint32_t);
+		MemoryChunkInfo* findInfo(char*);
 		
 	private:
 		MemoryChunk(const MemoryChunk&) = delete;
@@ -123,107 +125,80 @@ namespace et
 	};
 	
 	
-	template <int blockSize>
-	class SmallMemoryBlockAllocator
+	enum : uint32_t
 	{
-	public:
-		SmallMemoryBlockAllocator()
-		{
-			auto sizeToAllocate = blocksCount * sizeof(SmallMemoryBlock);
-			blocks = reinterpret_cast<SmallMemoryBlock*>(calloc(1, sizeToAllocate));
-			firstBlock = blocks;
-			currentBlock = firstBlock;
-			lastBlock = firstBlock + blocksCount;
-		}
-		
-		~SmallMemoryBlockAllocator()
-		{
-			log::ConsoleOutput lOut;
-			for (auto i = firstBlock; i != lastBlock; ++i)
-			{
-				if (i->allocated)
-					lOut.info("Memory leak detected: %d bytes, offset %lld", blockSize, (int64_t)(i - firstBlock));
-			}
-			::free(blocks);
-		}
-		
-		bool allocate(void*& result)
-		{
-			auto startBlock = currentBlock;
-			
-			while (currentBlock->allocated)
-			{
-				currentBlock = advance(currentBlock);
-				if (currentBlock == startBlock)
-				{
-					_haveFreeBlocks = false;
-					log::warning("Small memory block (%d) filled.", blockSize);
-					return false;
-				}
-			}
-			
-			currentBlock->allocated = 1;
-			
-			result = currentBlock->data;
-			currentBlock = advance(currentBlock);
-			
-			return true;
-		}
-		
-		void free(void* ptr)
-		{
-			SmallMemoryBlock* block = reinterpret_cast<SmallMemoryBlock*>(reinterpret_cast<char*>(ptr) - 4);
-			
-			if ((ptr < firstBlock) || (ptr > lastBlock))
-				ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
-			
-			block->allocated = 0;
-			
-			if (_haveFreeBlocks == false)
-				currentBlock = block;
-
-			_haveFreeBlocks = true;
-		}
-		
-		bool containsPointer(void* ptr)
-		{
-			SmallMemoryBlock* block = reinterpret_cast<SmallMemoryBlock*>(reinterpret_cast<char*>(ptr) - 4);
-			return (block >= firstBlock) && (block < lastBlock);
-		}
-		
-		bool haveFreeBlocks()
-			{ return _haveFreeBlocks; }
-		
-	private:
-		enum
-		{
-			blocksCount = 8 * megabytes / (blockSize + 4)
-		};
-		
-		struct SmallMemoryBlock
+		slabSize = 256 * 1024,
+		slabShift = 18,
+		slabTableCapacity = 64 * 1024,
+		maximumSlabAllocationSize = 2048,
+		sizeClassesCount = 20,
+		maximumThreadCachedAllocators = 4,
+		threadCacheBatchSize = 16 * 1024,
+	};
+	
+	static_assert((1 << slabShift) == slabSize, "Slab size should match slab shift");
+	
+	static const uint32_t sizeClassBlockSizes[sizeClassesCount] =
+	{
+		32, 64, 96, 128, 160, 192, 224, 256, 320, 384,
+		448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048
+	};
+	
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+	
+	/*
+	 * Slab is an aligned region of memory, divided into blocks of the same size class.
+	 * Blocks are never returned to the slab, they are recycled through free lists.
+	 */
+	struct Slab
+	{
+		char* begin = nullptr;
+		char* end = nullptr;
+		char* current = nullptr;
+		Slab* next = nullptr;
+		uint32_t sizeClass = 0;
+	};
+	
+	struct SizeClass
+	{
+		CriticalSection lock;
+		FreeBlock* freeList = nullptr;
+		Slab* slabs = nullptr;
+		uint32_t blockSize = 0;
+		uint32_t transferBatch = 0;
+		uint32_t freeCount = 0;
+		uint32_t slabsCount = 0;
+		uint64_t allocations = 0;
+		uint64_t deallocations = 0;
+	};
+	
+	/*
+	 * Each thread owns a cache of free blocks per size class,
+	 * which is accessed without any synchronization.
+	 * Blocks are moved between thread cache and size class in batches.
+	 */
+	struct ThreadCache
+	{
+		struct Bin
 		{
-			uint32_t allocated = 0;
-			char data[blockSize];
+			FreeBlock* head;
+			uint32_t count;
+			uint64_t allocations;
+			uint64_t deallocations;
 		};
 		
-		SmallMemoryBlock* advance(SmallMemoryBlock* b)
-		{
-			++b;
-			return (b == lastBlock) ? firstBlock : b;
-		}
-		
-	public:
-		SmallMemoryBlock* blocks = nullptr;
-		SmallMemoryBlock* firstBlock = nullptr;
-		SmallMemoryBlock* lastBlock = nullptr;
-		SmallMemoryBlock* currentBlock = nullptr;
-		bool _haveFreeBlocks = true;
+		Bin bins[sizeClassesCount];
+		ThreadCache* next;
 	};
 	
 	class BlockMemoryAllocatorPrivate
 	{
 	public:
 		BlockMemoryAllocatorPrivate();
+		~BlockMemoryAllocatorPrivate();
 		
 		void* alloc(uint32_t);
 		void free(void*);
@@ -234,17 +209,74 @@ namespace et
 		
 		void printInfo();
 		
+		/*
+		 * Returns all blocks of the exiting thread's cache to the size classes
+		 */
+		void releaseThreadCache(ThreadCache*);
+		
+	private:
+		ThreadCache* threadCache();
+		
+		Slab* findSlab(const void*) const;
+		bool slabContainsBlock(Slab*, const char*);
+		Slab* createSlab(uint32_t sizeClass);
+		
+		FreeBlock* carveBlock(SizeClass&, uint32_t sizeClass);
+		void refillBin(uint32_t sizeClass, ThreadCache::Bin&);
+		void releaseBin(uint32_t sizeClass, ThreadCache::Bin&, uint32_t blocksToKeep);
+		
+		void* allocFromSizeClass(uint32_t sizeClass);
+		void freeToSizeClass(uint32_t sizeClass, void*);
+		
 	private:
 		CriticalSection _csLock;
 		std::list<MemoryChunk> _chunks;
 		
-		SmallMemoryBlockAllocator<48> _allocator48;
-		SmallMemoryBlockAllocator<96> _allocator96;
+		SizeClass _sizeClasses[sizeClassesCount];
+		uint8_t _sizeClassForSize[maximumSlabAllocationSize / minimumAllocationSize];
+		
+		CriticalSection _csSlabs;
+		std::atomic<uintptr_t>* _slabKeys = nullptr;
+		Slab** _slabValues = nullptr;
+		
+		CriticalSection _csThreadCaches;
+		ThreadCache* _threadCaches = nullptr;
+		uint32_t _threadCacheIndex = 0;
 	};
 }
 
 using namespace et;
 
+static ET_THREAD_LOCAL ThreadCache* localThreadCaches[maximumThreadCachedAllocators];
+static ET_THREAD_LOCAL bool threadCachesReleased = false;
+static std::atomic<BlockMemoryAllocatorPrivate*> threadCachedAllocators[maximumThreadCachedAllocators];
+static std::atomic<uint32_t> blockAllocatorsCounter(0);
+
+/*
+ * Destroyed when thread exits, blocks kept in its caches would be lost otherwise
+ */
+struct ThreadCachesReleaser
+{
+	bool registered = false;
+	
+	~ThreadCachesReleaser()
+	{
+		threadCachesReleased = true;
+		for (uint32_t i = 0; i < maximumThreadCachedAllocators; ++i)
+		{
+			if (localThreadCaches[i] == nullptr) continue;
+			
+			BlockMemoryAllocatorPrivate* allocator = threadCachedAllocators[i].load();
+			if (allocator != nullptr)
+				allocator->releaseThreadCache(localThreadCaches[i]);
+			
+			localThreadCaches[i] = nullptr;
+		}
+	}
+};
+
+static thread_local ThreadCachesReleaser threadCachesReleaser;
+
 inline uint32_t alignUpTo(uint32_t sz, uint32_t al)
 {
 	ET_ASSERT(sz > 0)
@@ -258,6 +290,30 @@ inline uint32_t alignDownTo(uint32_t sz, uint32_t al)
 	return sz & (~(al-1));
 }
 
+inline void* alignedAllocate(size_t size, size_t alignment)
+{
+#if (ET_PLATFORM_WIN)
+	return _aligned_malloc(size, alignment);
+#else
+	void* result = nullptr;
+	return (posix_memalign(&result, alignment, size) == 0) ? result : nullptr;
+#endif
+}
+
+inline void alignedFree(void* ptr)
+{
+#if (ET_PLATFORM_WIN)
+	_aligned_free(ptr);
+#else
+	::free(ptr);
+#endif
+}
+
+inline size_t slabTableIndex(uintptr_t key)
+{
+	return static_cast<size_t>((key * 2654435761u) & (slabTableCapacity - 1));
+}
+
 BlockMemoryAllocator::BlockMemoryAllocator()
 {
 	ET_PIMPL_INIT(BlockMemoryAllocator)
@@ -290,42 +346,324 @@ void BlockMemoryAllocator::flushUnusedBlocks()
 BlockMemoryAllocatorPrivate::BlockMemoryAllocatorPrivate()
 {
 	_chunks.emplace_back(defaultChunkSize);
+	
+	uint32_t sizeClass = 0;
+	for (uint32_t i = 0; i < maximumSlabAllocationSize / minimumAllocationSize; ++i)
+	{
+		while ((i + 1) * minimumAllocationSize > sizeClassBlockSizes[sizeClass])
+			++sizeClass;
+		
+		_sizeClassForSize[i] = static_cast<uint8_t>(sizeClass);
+	}
+	
+	for (uint32_t i = 0; i < sizeClassesCount; ++i)
+	{
+		_sizeClasses[i].blockSize = sizeClassBlockSizes[i];
+		_sizeClasses[i].transferBatch = etMax(8u, etMin(128u, threadCacheBatchSize / sizeClassBlockSizes[i]));
+	}
+	
+	_slabKeys = static_cast<std::atomic<uintptr_t>*>(calloc(slabTableCapacity, sizeof(std::atomic<uintptr_t>)));
+	_slabValues = static_cast<Slab**>(calloc(slabTableCapacity, sizeof(Slab*)));
+	
+	_threadCacheIndex = blockAllocatorsCounter++;
+	
+	if (_threadCacheIndex < maximumThreadCachedAllocators)
+		threadCachedAllocators[_threadCacheIndex].store(this);
 }
 
-void* BlockMemoryAllocatorPrivate::alloc(uint32_t allocSize)
+BlockMemoryAllocatorPrivate::~BlockMemoryAllocatorPrivate()
 {
-	CriticalSectionScope lock(_csLock);
+	if (_threadCacheIndex < maximumThreadCachedAllocators)
+		threadCachedAllocators[_threadCacheIndex].store(nullptr);
 	
-	void* result = nullptr;
+	log::ConsoleOutput lOut;
 	
-	auto allocScale = (allocSize - 1) / 48;
-	switch (allocScale)
+	for (uint32_t i = 0; i < sizeClassesCount; ++i)
 	{
-		case 0 :
+		auto& sc = _sizeClasses[i];
+		
+		uint64_t liveBlocks = sc.allocations - sc.deallocations;
+		for (auto cache = _threadCaches; cache != nullptr; cache = cache->next)
+			liveBlocks += cache->bins[i].allocations - cache->bins[i].deallocations;
+		
+		if (liveBlocks > 0)
+			lOut.info("Memory leak detected: %llu blocks of %u bytes", liveBlocks, sc.blockSize);
+		
+		while (sc.slabs != nullptr)
 		{
-			if (_allocator48.haveFreeBlocks() && _allocator48.allocate(result))
-				return result;
+			auto next = sc.slabs->next;
+			alignedFree(sc.slabs->begin);
+			::free(sc.slabs);
+			sc.slabs = next;
 		}
-			
-		case 1 :
+	}
+	
+	while (_threadCaches != nullptr)
+	{
+		auto next = _threadCaches->next;
+		::free(_threadCaches);
+		_threadCaches = next;
+	}
+	
+	::free(_slabValues);
+	::free(_slabKeys);
+}
+
+ThreadCache* BlockMemoryAllocatorPrivate::threadCache()
+{
+	if ((_threadCacheIndex >= maximumThreadCachedAllocators) || threadCachesReleased)
+		return nullptr;
+	
+	ThreadCache* result = localThreadCaches[_threadCacheIndex];
+	if (result == nullptr)
+	{
+		result = static_cast<ThreadCache*>(calloc(1, sizeof(ThreadCache)));
 		{
-			if (_allocator96.haveFreeBlocks() && _allocator96.allocate(result))
-				return result;
+			CriticalSectionScope lock(_csThreadCaches);
+			result->next = _threadCaches;
+			_threadCaches = result;
 		}
-			
-		default:
+		localThreadCaches[_threadCacheIndex] = result;
+		threadCachesReleaser.registered = true;
+	}
+	
+	return result;
+}
+
+void BlockMemoryAllocatorPrivate::releaseThreadCache(ThreadCache* cache)
+{
+	{
+		CriticalSectionScope lock(_csThreadCaches);
+		
+		ThreadCache** link = &_threadCaches;
+		while ((*link != nullptr) && (*link != cache))
+			link = &(*link)->next;
+		
+		if (*link == nullptr) return;
+		*link = cache->next;
+	}
+	
+	for (uint32_t i = 0; i < sizeClassesCount; ++i)
+	{
+		auto& bin = cache->bins[i];
+		releaseBin(i, bin, 0);
+		
+		auto& sc = _sizeClasses[i];
+		CriticalSectionScope lock(sc.lock);
+		sc.allocations += bin.allocations;
+		sc.deallocations += bin.deallocations;
+	}
+	
+	::free(cache);
+}
+
+Slab* BlockMemoryAllocatorPrivate::findSlab(const void* ptr) const
+{
+	uintptr_t key = (reinterpret_cast<uintptr_t>(ptr) >> slabShift) + 1;
+	
+	size_t index = slabTableIndex(key);
+	for (;;)
+	{
+		uintptr_t storedKey = _slabKeys[index].load(std::memory_order_acquire);
+		
+		if (storedKey == key)
+			return _slabValues[index];
+		
+		if (storedKey == 0)
+			return nullptr;
+		
+		index = (index + 1) & (slabTableCapacity - 1);
+	}
+}
+
+bool BlockMemoryAllocatorPrivate::slabContainsBlock(Slab* slab, const char* ptr)
+{
+	uint32_t blockSize = sizeClassBlockSizes[slab->sizeClass];
+	if ((ptr < slab->begin) || (static_cast<uint32_t>(ptr - slab->begin) % blockSize != 0))
+		return false;
+	
+	/*
+	 * Slab's current position is advanced under the lock of its size class
+	 */
+	CriticalSectionScope lock(_sizeClasses[slab->sizeClass].lock);
+	return ptr < slab->current;
+}
+
+Slab* BlockMemoryAllocatorPrivate::createSlab(uint32_t sizeClass)
+{
+	char* memory = static_cast<char*>(alignedAllocate(slabSize, slabSize));
+	if (memory == nullptr)
+	{
+		log::error("[BlockMemoryAllocator] Failed to allocate slab for %u bytes blocks", sizeClassBlockSizes[sizeClass]);
+		return nullptr;
+	}
+	
+	Slab* result = static_cast<Slab*>(calloc(1, sizeof(Slab)));
+	result->begin = memory;
+	result->current = memory;
+	result->end = memory + slabSize;
+	result->sizeClass = sizeClass;
+	
+	uintptr_t key = (reinterpret_cast<uintptr_t>(memory) >> slabShift) + 1;
+	
+	CriticalSectionScope lock(_csSlabs);
+	
+	size_t index = slabTableIndex(key);
+	size_t probes = 0;
+	while (_slabKeys[index].load(std::memory_order_relaxed) != 0)
+	{
+		index = (index + 1) & (slabTableCapacity - 1);
+		if (++probes >= slabTableCapacity)
+			ET_FAIL("Slab table is full")
+	}
+	
+	_slabValues[index] = result;
+	_slabKeys[index].store(key, std::memory_order_release);
+	
+	return result;
+}
+
+FreeBlock* BlockMemoryAllocatorPrivate::carveBlock(SizeClass& sc, uint32_t sizeClass)
+{
+	Slab* slab = sc.slabs;
+	if ((slab == nullptr) || (slab->current + sc.blockSize > slab->end))
+	{
+		slab = createSlab(sizeClass);
+		if (slab == nullptr)
+			return nullptr;
+		
+		slab->next = sc.slabs;
+		sc.slabs = slab;
+		++sc.slabsCount;
+	}
+	
+	auto result = reinterpret_cast<FreeBlock*>(slab->current);
+	slab->current += sc.blockSize;
+	return result;
+}
+
+void BlockMemoryAllocatorPrivate::refillBin(uint32_t sizeClass, ThreadCache::Bin& bin)
+{
+	auto& sc = _sizeClasses[sizeClass];
+	
+	CriticalSectionScope lock(sc.lock);
+	
+	while ((bin.count < sc.transferBatch) && (sc.freeList != nullptr))
+	{
+		FreeBlock* block = sc.freeList;
+		sc.freeList = block->next;
+		--sc.freeCount;
+		
+		block->next = bin.head;
+		bin.head = block;
+		++bin.count;
+	}
+	
+	while (bin.count < sc.transferBatch)
+	{
+		FreeBlock* block = carveBlock(sc, sizeClass);
+		if (block == nullptr) break;
+		
+		block->next = bin.head;
+		bin.head = block;
+		++bin.count;
+	}
+}
+
+void BlockMemoryAllocatorPrivate::releaseBin(uint32_t sizeClass, ThreadCache::Bin& bin, uint32_t blocksToKeep)
+{
+	if (bin.count <= blocksToKeep) return;
+	
+	FreeBlock* first = bin.head;
+	FreeBlock* last = first;
+	
+	uint32_t blocksToRelease = bin.count - blocksToKeep;
+	for (uint32_t i = 1; i < blocksToRelease; ++i)
+		last = last->next;
+	
+	bin.head = last->next;
+	bin.count = blocksToKeep;
+	
+	auto& sc = _sizeClasses[sizeClass];
+	
+	CriticalSectionScope lock(sc.lock);
+	last->next = sc.freeList;
+	sc.freeList = first;
+	sc.freeCount += blocksToRelease;
+}
+
+void* BlockMemoryAllocatorPrivate::allocFromSizeClass(uint32_t sizeClass)
+{
+	auto& sc = _sizeClasses[sizeClass];
+	
+	CriticalSectionScope lock(sc.lock);
+	
+	FreeBlock* result = sc.freeList;
+	if (result == nullptr)
+	{
+		result = carveBlock(sc, sizeClass);
+	}
+	else
+	{
+		sc.freeList = result->next;
+		--sc.freeCount;
+	}
+	
+	if (result != nullptr)
+		++sc.allocations;
+	
+	return result;
+}
+
+void BlockMemoryAllocatorPrivate::freeToSizeClass(uint32_t sizeClass, void* ptr)
+{
+	auto& sc = _sizeClasses[sizeClass];
+	
+	CriticalSectionScope lock(sc.lock);
+	
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	block->next = sc.freeList;
+	sc.freeList = block;
+	++sc.freeCount;
+	++sc.deallocations;
+}
+
+void* BlockMemoryAllocatorPrivate::alloc(uint32_t allocSize)
+{
+	if (allocSize <= maximumSlabAllocationSize)
+	{
+		uint32_t sizeClass = _sizeClassForSize[(allocSize - 1) / minimumAllocationSize];
+		
+		ThreadCache* cache = threadCache();
+		if (cache == nullptr)
+			return allocFromSizeClass(sizeClass);
+		
+		auto& bin = cache->bins[sizeClass];
+		if (bin.head == nullptr)
+			refillBin(sizeClass, bin);
+		
+		FreeBlock* result = bin.head;
+		if (result != nullptr)
 		{
-			for (MemoryChunk& chunk : _chunks)
-			{
-				if (chunk.allocate(allocSize, result))
-					return result;
-			}
-			
-			_chunks.emplace_back(alignUpTo(allocSize, defaultChunkSize));
-			_chunks.back().allocate(allocSize, result);
+			bin.head = result->next;
+			--bin.count;
+			++bin.allocations;
+			return result;
 		}
 	}
 	
+	CriticalSectionScope lock(_csLock);
+	
+	void* result = nullptr;
+	for (MemoryChunk& chunk : _chunks)
+	{
+		if (chunk.allocate(allocSize, result))
+			return result;
+	}
+	
+	_chunks.emplace_back(alignUpTo(allocSize, defaultChunkSize));
+	_chunks.back().allocate(allocSize, result);
+	
 	return result;
 }
 
@@ -334,20 +672,23 @@ bool BlockMemoryAllocatorPrivate::validate(void* ptr, bool abortOnFail)
 	if (ptr == nullptr)
 		return true;
 	
-	CriticalSectionScope lock(_csLock);
-	
-	if (_allocator48.containsPointer(ptr))
-		return true;
-	
-	if (_allocator96.containsPointer(ptr))
-		return true;
-
 	auto charPtr = static_cast<char*>(ptr);
-	for (MemoryChunk& chunk : _chunks)
+	
+	Slab* slab = findSlab(ptr);
+	if (slab != nullptr)
 	{
-		if (chunk.containsPointer(charPtr))
+		if (slabContainsBlock(slab, charPtr))
 			return true;
 	}
+	else
+	{
+		CriticalSectionScope lock(_csLock);
+		for (MemoryChunk& chunk : _chunks)
+		{
+			if (chunk.containsPointer(charPtr))
+				return true;
+		}
+	}
 	
 	if (abortOnFail)
 	{
@@ -402,31 +743,53 @@ void BlockMemoryAllocatorPrivate::free(void* ptr)
 {
 	if (ptr == nullptr) return;
 	
-	CriticalSectionScope lock(_csLock);
-	
-	if (_allocator48.containsPointer(ptr))
-	{
-		_allocator48.free(ptr);
-	}
-	else if (_allocator96.containsPointer(ptr))
-	{
-		_allocator96.free(ptr);
-	}
-	else
+	Slab* slab = findSlab(ptr);
+	if (slab != nullptr)
 	{
-		auto charPtr = static_cast<char*>(ptr);
-		for (MemoryChunk& chunk : _chunks)
+#	if (ET_DEBUG)
+		if (!slabContainsBlock(slab, static_cast<char*>(ptr)))
+			ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
+#	endif
+		
+		uint32_t sizeClass = slab->sizeClass;
+		
+		ThreadCache* cache = threadCache();
+		if (cache == nullptr)
 		{
-			if (chunk.free(charPtr))
-				return;
+			freeToSizeClass(sizeClass, ptr);
+			return;
 		}
 		
-		ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
+		auto& bin = cache->bins[sizeClass];
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		block->next = bin.head;
+		bin.head = block;
+		++bin.count;
+		++bin.deallocations;
+		
+		uint32_t batch = _sizeClasses[sizeClass].transferBatch;
+		if (bin.count > 2 * batch)
+			releaseBin(sizeClass, bin, batch);
+		
+		return;
+	}
+	
+	CriticalSectionScope lock(_csLock);
+	
+	auto charPtr = static_cast<char*>(ptr);
+	for (MemoryChunk& chunk : _chunks)
+	{
+		if (chunk.free(charPtr))
+			return;
 	}
+	
+	ET_FAIL_FMT("Pointer being freed (0x%016llx) was not allocated via this allocator.", (int64_t)ptr);
 }
 
 void BlockMemoryAllocatorPrivate::printInfo()
 {
+	CriticalSectionScope lock(_csLock);
+	
 	log::info("Memory allocator has %zu chunks:", _chunks.size());
 	log::info("{");
 	for (auto& chunk : _chunks)
@@ -465,23 +828,39 @@ void BlockMemoryAllocatorPrivate::printInfo()
 		log::info("\t}");
 	}
 	
-	uint32_t allocatedBlocks = 0;
-
-	log::info("\t0...48 bytes");
-	log::info("\t{");
-	allocatedBlocks = 0;
-	for (auto i = _allocator48.firstBlock; i != _allocator48.lastBlock; ++i) allocatedBlocks += i->allocated;
-	log::info("\t\tallocated blocks : %u of %lld", allocatedBlocks, (int64_t)(_allocator48.lastBlock - _allocator48.firstBlock));
-	log::info("\t\tcurrent offset : %lld", (int64_t)(_allocator48.currentBlock - _allocator48.firstBlock));
-	log::info("\t},");
+	/*
+	 * Thread caches are modified without synchronization,
+	 * so values below could be slightly inaccurate
+	 */
+	CriticalSectionScope cachesLock(_csThreadCaches);
 	
-	log::info("\t48...96");
-	log::info("\t{");
-	allocatedBlocks = 0;
-	for (auto i = _allocator96.firstBlock; i != _allocator96.lastBlock; ++i) allocatedBlocks += i->allocated;
-	log::info("\t\tallocated blocks : %u of %lld", allocatedBlocks,  (int64_t)(_allocator96.lastBlock - _allocator96.firstBlock));
-	log::info("\t\tcurrent offset : %lld", (int64_t)(_allocator96.currentBlock - _allocator96.firstBlock));
-	log::info("\t}");
+	uint32_t previousSize = 0;
+	for (uint32_t i = 0; i < sizeClassesCount; ++i)
+	{
+		auto& sc = _sizeClasses[i];
+		
+		uint64_t allocations = sc.allocations;
+		uint64_t deallocations = sc.deallocations;
+		uint64_t cachedBlocks = 0;
+		for (auto cache = _threadCaches; cache != nullptr; cache = cache->next)
+		{
+			allocations += cache->bins[i].allocations;
+			deallocations += cache->bins[i].deallocations;
+			cachedBlocks += cache->bins[i].count;
+		}
+		
+		if ((sc.slabsCount > 0) || (allocations > 0))
+		{
+			log::info("\t%u...%u bytes", previousSize, sc.blockSize);
+			log::info("\t{");
+			log::info("\t\tslabs : %u (%uKb)", sc.slabsCount, sc.slabsCount * (slabSize / 1024));
+			log::info("\t\tlive blocks : %llu (alloc: %llu, freed: %llu)", allocations - deallocations, allocations, deallocations);
+			log::info("\t\tfree blocks : %u shared, %llu in thread caches", sc.freeCount, cachedBlocks);
+			log::info("\t},");
+		}
+		
+		previousSize = sc.blockSize;
+	}
 	
 	log::info("}");
 }
@@ -501,21 +880,7 @@ MemoryChunk::MemoryChunk(uint32_t capacity)
 	actualDataOffset = alignUpTo((capacity / minimumAllocationSize + 1) * sizeof(MemoryChunkInfo), minimumAllocationSize);
 	size_t sizeToAllocate = alignUpTo(actualDataOffset + capacity, minimumAllocationSize);
 	
-#if (ET_PLATFORM_APPLE)
-	
-	void* allocatedPtr = nullptr;
-	posix_memalign(&allocatedPtr, minimumAllocationSize, sizeToAllocate);
-	allocatedMemoryBegin = static_cast<char*>(allocatedPtr);
-	
-#elif (ET_PLATFORM_WIN)
-	
-	allocatedMemoryBegin = static_cast<char*>(_aligned_malloc(sizeToAllocate, minimumAllocationSize));
-	
-#else
-#
-#	error Use any available aligned malloc
-#
-#endif
+	allocatedMemoryBegin = static_cast<char*>(alignedAllocate(sizeToAllocate, minimumAllocationSize));
 	
 	allocatedMemoryEnd = allocatedMemoryBegin + actualDataOffset + capacity;
 	firstInfo = reinterpret_cast<MemoryChunkInfo*>(allocatedMemoryBegin);
@@ -548,11 +913,7 @@ MemoryChunk::~MemoryChunk()
 			++info;
 		}
 		
-#	if (ET_PLATFORM_WIN)
-		_aligned_free(allocatedMemoryBegin);
-#	else
-		::free(allocatedMemoryBegin);
-#	endif
+		alignedFree(allocatedMemoryBegin);
 	}
 }
 
@@ -607,84 +968,68 @@ bool MemoryChunk::allocate(uint32_t sizeToAllocate, void*& result)
 	return false;
 }
 
-bool MemoryChunk::containsPointer(char* ptr)
+MemoryChunkInfo* MemoryChunk::findInfo(char* ptr)
 {
-	if ((ptr < allocatedMemoryBegin + actualDataOffset) || (ptr >= allocatedMemoryEnd)) return false;
+	if ((ptr < allocatedMemoryBegin + actualDataOffset) || (ptr >= allocatedMemoryEnd)) return nullptr;
 	uint32_t offset = static_cast<uint32_t>(ptr - (allocatedMemoryBegin + actualDataOffset));
 	
-	auto i = firstInfo;
-	while (i < lastInfo)
-	{
-		if (i->begin == offset)
-			return true;
-		++i;
-	}
+	/*
+	 * infos are always sorted by offset
+	 */
+	auto i = std::lower_bound(firstInfo, lastInfo, offset,
+		[](const MemoryChunkInfo& info, uint32_t value) { return info.begin < value; });
 	
-	return false;
+	return ((i < lastInfo) && (i->begin == offset)) ? i : nullptr;
+}
+
+bool MemoryChunk::containsPointer(char* ptr)
+{
+	return findInfo(ptr) != nullptr;
 }
 
 bool MemoryChunk::free(char* ptr)
 {
-	if ((ptr < allocatedMemoryBegin + actualDataOffset) || (ptr >= allocatedMemoryEnd)) return false;
-	uint32_t offset = static_cast<uint32_t>(ptr - (allocatedMemoryBegin + actualDataOffset));
+	auto i = findInfo(ptr);
+	if (i == nullptr)
+		return false;
 	
-	auto i = firstInfo;
-	while (i < lastInfo)
+	if (i->allocated == notAllocatedValue)
 	{
-		if (i->begin == offset)
-		{
-			if (i->allocated == notAllocatedValue)
-			{
-				ET_FAIL_FMT("Pointer being freed (0x%016llx) was already deleted from this memory chunk.", reinterpret_cast<uint64_t>(ptr));
-				return false;
-			}
-			else
-			{
-#			if ET_DEBUG
-				uint32_t deallocIndex = etMin(maximumAllocationStatisticsSize - 1, i->length / minimumAllocationStatisticsSize);
-				++deallocationStatistics[deallocIndex];
-				if (breakOnAllocation)
-					log::info("Deallocated %u bytes (%uKb, %uMb)", i->length, i->length / 1024, i->length / megabytes);
-#			endif
-				
-				i->allocated = notAllocatedValue;
-				compress();
-				return true;
-			}
-		}
-		++i;
+		ET_FAIL_FMT("Pointer being freed (0x%016llx) was already deleted from this memory chunk.", reinterpret_cast<uint64_t>(ptr));
+		return false;
 	}
 	
-	return false;
+#if ET_DEBUG
+	uint32_t deallocIndex = etMin(maximumAllocationStatisticsSize - 1, i->length / minimumAllocationStatisticsSize);
+	++deallocationStatistics[deallocIndex];
+	if (breakOnAllocation)
+		log::info("Deallocated %u bytes (%uKb, %uMb)", i->length, i->length / 1024, i->length / megabytes);
+#endif
+	
+	i->allocated = notAllocatedValue;
+	compress(i);
+	return true;
 }
 
-void MemoryChunk::compress()
+void MemoryChunk::compress(MemoryChunkInfo* freed)
 {
-	auto i = firstInfo;
+	/*
+	 * adjacent free infos are merged on each release,
+	 * so only neighbours of the released one should be checked
+	 */
+	auto next = freed + 1;
+	if ((next < lastInfo) && (next->allocated == notAllocatedValue))
+	{
+		freed->length = next->begin + next->length - freed->begin;
+		memmove(next, next + 1, static_cast<size_t>(lastInfo - next - 1) * sizeof(MemoryChunkInfo));
+		--lastInfo;
+	}
 	
-	while (i < lastInfo)
+	if ((freed > firstInfo) && ((freed - 1)->allocated == notAllocatedValue))
 	{
-		if (i->allocated == notAllocatedValue)
-		{
-			auto nextInfo = i + 1;
-			if ((nextInfo < lastInfo) && (nextInfo->allocated == notAllocatedValue))
-			{
-				i->length += nextInfo->length;
-				
-				auto next = nextInfo + 1;
-				while (nextInfo < lastInfo)
-					(nextInfo++)->swapWith(next++);
-				
-				--lastInfo;
-			}
-			else
-			{
-				++i;
-			}
-		}
-		else
-		{
-			++i;
-		}
+		auto prev = freed - 1;
+		prev->length = freed->begin + freed->length - prev->begin;
+		memmove(freed, freed + 1, static_cast<size_t>(lastInfo - freed - 1) * sizeof(MemoryChunkInfo));
+		--lastInfo;
 	}
 }
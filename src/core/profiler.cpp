@@ -0,0 +1,222 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <atomic>
+#include <et/core/profiler.h>
+
+namespace et
+{
+	class ProfilerThreadBuffer
+	{
+	public:
+		ProfilerThreadBuffer(size_t anIndex) :
+			index(anIndex), written(0) { }
+
+	public:
+		size_t index = 0;
+		std::string name;
+		std::vector<ProfilerEvent> events;
+		std::atomic<uint64_t> written;
+		ProfilerThreadBuffer* next = nullptr;
+		bool threadRunning = true;
+	};
+
+	/*
+	 * Destroyed when thread exits, returns its buffer to the profiler for reuse
+	 */
+	struct ProfilerThreadBufferReleaser
+	{
+		bool registered = false;
+
+		~ProfilerThreadBufferReleaser();
+	};
+}
+
+using namespace et;
+
+static ET_THREAD_LOCAL ProfilerThreadBuffer* localProfilerBuffer = nullptr;
+static thread_local ProfilerThreadBufferReleaser profilerThreadBufferReleaser;
+static std::atomic<bool> profilerDestroyed(false);
+
+ProfilerThreadBufferReleaser::~ProfilerThreadBufferReleaser()
+{
+	if ((localProfilerBuffer != nullptr) && !profilerDestroyed)
+		Profiler::instance().releaseThreadBuffer(localProfilerBuffer);
+
+	localProfilerBuffer = nullptr;
+}
+
+inline void writeJSONString(std::ostream& stream, const char* value)
+{
+	stream << "\"";
+	for (const char* c = value; *c != 0; ++c)
+	{
+		if ((*c == '"') || (*c == '\\'))
+			stream << '\\' << *c;
+		else if (static_cast<unsigned char>(*c) >= 0x20)
+			stream << *c;
+	}
+	stream << "\"";
+}
+
+Profiler::~Profiler()
+{
+	CriticalSectionScope lock(_csBuffers);
+
+	/*
+	 * Buffers referenced by the other threads are not accessed after this point
+	 */
+	profilerDestroyed = true;
+	_capturing = false;
+	localProfilerBuffer = nullptr;
+
+	while (_buffers != nullptr)
+	{
+		ProfilerThreadBuffer* next = _buffers->next;
+		delete _buffers;
+		_buffers = next;
+	}
+}
+
+void Profiler::beginCapture()
+{
+	_captureStartTime = queryCurrentTimeInMicroSeconds();
+	_captureEndTime = 0;
+	_capturing = true;
+}
+
+void Profiler::endCapture()
+{
+	_capturing = false;
+	_captureEndTime = queryCurrentTimeInMicroSeconds();
+}
+
+bool Profiler::holdsCapturedEvents(ProfilerThreadBuffer* buffer)
+{
+	uint64_t written = buffer->written.load(std::memory_order_acquire);
+	return (written > 0) && (buffer->events[(written - 1) % EventsPerThread].startTime >= _captureStartTime);
+}
+
+ProfilerThreadBuffer* Profiler::threadBuffer()
+{
+	if (profilerDestroyed)
+		return nullptr;
+
+	if (localProfilerBuffer == nullptr)
+	{
+		CriticalSectionScope lock(_csBuffers);
+
+		/*
+		 * Buffer of the exited thread is reused, unless it holds events of the last capture
+		 */
+		ProfilerThreadBuffer* buffer = _buffers;
+		while ((buffer != nullptr) && (buffer->threadRunning || holdsCapturedEvents(buffer)))
+			buffer = buffer->next;
+
+		if (buffer == nullptr)
+		{
+			buffer = new ProfilerThreadBuffer(_buffersCount++);
+			buffer->next = _buffers;
+			_buffers = buffer;
+		}
+		else
+		{
+			buffer->index = _buffersCount++;
+			buffer->written.store(0);
+			buffer->threadRunning = true;
+		}
+
+		buffer->name = "Thread " + intToStr(buffer->index);
+		localProfilerBuffer = buffer;
+		profilerThreadBufferReleaser.registered = true;
+	}
+	return localProfilerBuffer;
+}
+
+void Profiler::releaseThreadBuffer(ProfilerThreadBuffer* buffer)
+{
+	CriticalSectionScope lock(_csBuffers);
+	buffer->threadRunning = false;
+}
+
+void Profiler::submit(const char* name, uint64_t startTime, uint64_t duration)
+{
+	ProfilerThreadBuffer* buffer = threadBuffer();
+	if (buffer == nullptr) return;
+
+	if (buffer->events.empty())
+	{
+		CriticalSectionScope lock(_csBuffers);
+		buffer->events.resize(EventsPerThread);
+	}
+
+	uint64_t eventIndex = buffer->written.load(std::memory_order_relaxed);
+
+	ProfilerEvent& evt = buffer->events[eventIndex % EventsPerThread];
+	evt.name = name;
+	evt.startTime = startTime;
+	evt.duration = duration;
+
+	buffer->written.store(eventIndex + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+	ProfilerThreadBuffer* buffer = threadBuffer();
+	if (buffer == nullptr) return;
+
+	CriticalSectionScope lock(_csBuffers);
+	buffer->name = name;
+}
+
+void Profiler::writeChromeTrace(std::ostream& stream)
+{
+	CriticalSectionScope lock(_csBuffers);
+
+	uint64_t captureEndTime = _capturing ? queryCurrentTimeInMicroSeconds() : _captureEndTime;
+
+	bool firstEvent = true;
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	for (ProfilerThreadBuffer* buffer = _buffers; buffer != nullptr; buffer = buffer->next)
+	{
+		stream << (firstEvent ? "\n" : ",\n");
+		stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->index << ",\"args\":{\"name\":";
+		writeJSONString(stream, buffer->name.c_str());
+		stream << "}}";
+		firstEvent = false;
+
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t firstAvailable = (written > EventsPerThread) ? written - EventsPerThread : 0;
+
+		for (uint64_t i = firstAvailable; i < written; ++i)
+		{
+			const ProfilerEvent& evt = buffer->events[i % EventsPerThread];
+			if ((evt.startTime < _captureStartTime) || (evt.startTime > captureEndTime)) continue;
+
+			stream << ",\n{\"name\":";
+			writeJSONString(stream, evt.name);
+			stream << ",\"cat\":\"et\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->index <<
+				",\"ts\":" << (evt.startTime - _captureStartTime) << ",\"dur\":" << evt.duration << "}";
+		}
+	}
+
+	stream << "\n]}\n";
+}
+
+bool Profiler::saveChromeTrace(const std::string& fileName)
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+	if (file.fail())
+	{
+		log::error("Unable to open file for writing profiler trace: %s", fileName.c_str());
+		return false;
+	}
+
+	writeChromeTrace(file);
+	return !file.fail();
+}
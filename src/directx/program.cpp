@@ -16,7 +16,8 @@ static const std::string etNoShader = "none";
 
 Program::Program(RenderContext* rc) : _rc(rc),
 	_mModelViewLocation(-1), _mModelViewProjectionLocation(-1), _vCameraLocation(-1),
-	_vPrimaryLightLocation(-1), _mLightProjectionMatrixLocation(-1), _mTransformLocation(-1)
+	_vPrimaryLightLocation(-1), _mLightProjectionMatrixLocation(-1), _mTransformLocation(-1),
+	_mInstanceTransformLocation(-1)
 {
 #if defined(ET_CONSOLE_APPLICATION)
 	ET_FAIL("Attempt to create Program in console application");
@@ -27,7 +28,7 @@ Program::Program(RenderContext* rc, const std::string& vertexShader, const std::
 	const std::string& fragmentShader, const std::string& objName, const std::string& origin,
 	const StringList& defines) : APIObject(objName, origin), _rc(rc), _mModelViewLocation(-1),
 	_mModelViewProjectionLocation(-1), _vCameraLocation(-1), _vPrimaryLightLocation(-1),
-	_mLightProjectionMatrixLocation(-1), _mTransformLocation(-1), _defines(defines)
+	_mLightProjectionMatrixLocation(-1), _mTransformLocation(-1), _mInstanceTransformLocation(-1), _defines(defines)
 {
 #if defined(ET_CONSOLE_APPLICATION)
 	ET_FAIL("Attempt to create Program in console application");
@@ -91,6 +92,10 @@ void Program::setTransformMatrix(const mat4 &m, bool forced)
 {
 }
 
+void Program::setInstanceTransforms(const mat4*, size_t)
+{
+}
+
 void Program::setCameraProperties(const Camera& cam)
 {
 	setModelViewMatrix(cam.modelViewMatrix());
@@ -101,12 +106,7 @@ void Program::setCameraProperties(const Camera& cam)
 void Program::buildProgram(const std::string& vertex_source, const std::string& geom_source,
 	const std::string& frag_source)
 {
-	_floatCache.clear();
-	_vec2Cache.clear();
-	_vec3Cache.clear();
-	_vec4Cache.clear();
-	_mat3Cache.clear();
-	_mat4Cache.clear();
+	_uniformCache.clear();
 	_uniforms.clear();
 	
 #if !defined(ET_CONSOLE_APPLICATION)
@@ -145,13 +145,13 @@ void Program::setUniform(int nLoc, uint32_t type, uint32_t value, bool)
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, int64_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, long long value, bool)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, uint64_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, unsigned long long value, bool)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 #endif
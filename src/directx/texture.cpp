@@ -166,6 +166,18 @@ void Texture::updatePartialDataDirectly(RenderContext* rc, const vec2i& offset,
 #endif
 }
 
+void Texture::updateMipLevel(RenderContext* rc, size_t level, const char* data, size_t dataSize)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+#endif
+}
+
+void Texture::releaseMipLevel(RenderContext* rc, size_t level)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+#endif
+}
+
 void Texture::generateMipMaps(RenderContext* rc)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
@@ -178,6 +190,12 @@ void Texture::setMaxLod(RenderContext* rc, size_t value)
 #endif
 }
 
+void Texture::setBaseLod(RenderContext* rc, size_t value)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+#endif
+}
+
 void Texture::setAnisotropyLevel(RenderContext* rc, float value)
 {
 #if defined(GL_TEXTURE_MAX_ANISOTROPY_EXT) && !defined(ET_CONSOLE_APPLICATION)
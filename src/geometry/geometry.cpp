@@ -117,6 +117,53 @@ void et::decomposeMatrix(const mat4& mat, vec3& translation, quaternion& rotatio
 	rotation = matrixToQuaternion(rot);
 }
 
+void et::transformPoints(const mat4& m, const vec3* input, vec3* output, size_t count)
+{
+#if (ET_SIMD_SSE)
+	__m128 r0 = _mm_loadu_ps(m[0].data());
+	__m128 r1 = _mm_loadu_ps(m[1].data());
+	__m128 r2 = _mm_loadu_ps(m[2].data());
+	__m128 r3 = _mm_loadu_ps(m[3].data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		__m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(input[i].x), r0), r3);
+		p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(input[i].y), r1));
+		p = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(input[i].z), r2));
+
+		vec4 result;
+		_mm_storeu_ps(result.data(), p);
+		output[i] = (result.w * result.w > 0.0f) ? result.xyz() / result.w : result.xyz();
+	}
+#else
+	mat4 transform = m;
+	for (size_t i = 0; i < count; ++i)
+		output[i] = transform * input[i];
+#endif
+}
+
+void et::transformPoints(const mat4& m, const vec4* input, vec4* output, size_t count)
+{
+#if (ET_SIMD_SSE)
+	__m128 r0 = _mm_loadu_ps(m[0].data());
+	__m128 r1 = _mm_loadu_ps(m[1].data());
+	__m128 r2 = _mm_loadu_ps(m[2].data());
+	__m128 r3 = _mm_loadu_ps(m[3].data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float* p = input[i].data();
+		__m128 result = _mm_mul_ps(_mm_set1_ps(p[0]), r0);
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(p[1]), r1));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(p[2]), r2));
+		result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(p[3]), r3));
+		_mm_storeu_ps(output[i].data(), result);
+	}
+#else
+	mat4 transform = m;
+	for (size_t i = 0; i < count; ++i)
+		output[i] = transform * input[i];
+#endif
+}
+
 vec3 et::removeMatrixScale(mat3& mat)
 {
 	vec3 c0 = mat.column(0);
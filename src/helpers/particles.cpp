@@ -0,0 +1,364 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/tasks/jobsystem.h>
+#include <et/helpers/particles.h>
+
+using namespace et;
+using namespace et::particles;
+
+namespace
+{
+	/*
+	 * Should be multiple of 4, so each range starts at SIMD group
+	 */
+	const size_t particlesPerJob = 4096;
+	const size_t verticesPerJob = 16384;
+
+	template <typename F>
+	void runParallel(JobSystem* jobs, size_t count, size_t minimumRange, F f)
+	{
+		if ((jobs == nullptr) || (count <= minimumRange))
+			f(0, count);
+		else
+			jobs->parallelFor(0, count, minimumRange, f);
+	}
+}
+
+PointSpriteStreamEmitter::PointSpriteStreamEmitter(size_t capacity) :
+	_capacity(capacity), _streamSize((capacity + 3) & ~static_cast<size_t>(3)),
+	_randomState((static_cast<uint32_t>(rand()) << 1) | 1)
+{
+	/*
+	 * Streams are padded to the multiple of 4 particles,
+	 * so the last SIMD group never reads outside of the stream
+	 */
+	_streams.resize(Stream_max * _streamSize, 0.0f);
+	_aliveFlags.resize(_streamSize, 0);
+	_compactionIndices.resize(_streamSize, 0);
+
+	PointSprite defaultParticle;
+	for (size_t i = 0; i < _capacity; ++i)
+		setParticle(i, defaultParticle);
+}
+
+PointSprite PointSpriteStreamEmitter::particle(size_t i) const
+{
+	ET_ASSERT(i < _capacity);
+
+	PointSprite p;
+	p.position = vec3(stream(Stream_PositionX)[i], stream(Stream_PositionY)[i], stream(Stream_PositionZ)[i]);
+	p.velocity = vec3(stream(Stream_VelocityX)[i], stream(Stream_VelocityY)[i], stream(Stream_VelocityZ)[i]);
+	p.acceleration = vec3(stream(Stream_AccelerationX)[i], stream(Stream_AccelerationY)[i], stream(Stream_AccelerationZ)[i]);
+	p.color = vec4(stream(Stream_ColorR)[i], stream(Stream_ColorG)[i], stream(Stream_ColorB)[i], stream(Stream_ColorA)[i]);
+	p.size = stream(Stream_Size)[i];
+	p.emitTime = stream(Stream_EmitTime)[i];
+	p.lifeTime = stream(Stream_LifeTime)[i];
+	return p;
+}
+
+void PointSpriteStreamEmitter::setParticle(size_t i, const PointSprite& p)
+{
+	ET_ASSERT(i < _capacity);
+
+	float values[Stream_max];
+	particleValues(p, values);
+
+	for (size_t s = 0; s < Stream_max; ++s)
+		stream(s)[i] = values[s];
+}
+
+bool PointSpriteStreamEmitter::emit(const PointSprite& p)
+{
+	if (_activeParticles >= _capacity) return false;
+
+	setParticle(_activeParticles++, p);
+	return true;
+}
+
+size_t PointSpriteStreamEmitter::emit(size_t count, float t)
+{
+	size_t first = _activeParticles;
+	size_t emitted = etMin(count, _capacity - first);
+	if (emitted == 0) return 0;
+
+	/*
+	 * Same distribution as in defaultVariationFunction, but values are generated stream by stream
+	 * with the local generator (instead of rand()). Emission time is offset forward only.
+	 */
+	float base[Stream_max];
+	float variation[Stream_max];
+	particleValues(_base, base);
+	particleValues(_variation, variation);
+	base[Stream_EmitTime] = t + 0.5f * variation[Stream_EmitTime];
+	variation[Stream_EmitTime] *= 0.5f;
+
+	for (size_t s = 0; s < Stream_max; ++s)
+	{
+		float* values = stream(s) + first;
+		if (variation[s] == 0.0f)
+		{
+			std::fill(values, values + emitted, base[s]);
+		}
+		else
+		{
+			uint32_t state = _randomState;
+			for (size_t i = 0; i < emitted; ++i)
+			{
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				float r = static_cast<float>(static_cast<int32_t>(state)) / 2147483648.0f;
+				values[i] = base[s] + variation[s] * r;
+			}
+			_randomState = state;
+		}
+	}
+
+	float* alpha = stream(Stream_ColorA) + first;
+	const float* emitTime = stream(Stream_EmitTime) + first;
+	const float* lifeTime = stream(Stream_LifeTime) + first;
+	for (size_t i = 0; i < emitted; ++i)
+		alpha[i] = clamp(1.0f - (t - emitTime[i]) / lifeTime[i], 0.0f, 1.0f);
+
+	_activeParticles += emitted;
+	return emitted;
+}
+
+size_t PointSpriteStreamEmitter::emit(size_t count, float t, const PointSprite& base, const PointSprite& var)
+{
+	setBase(base);
+	setVariation(var);
+	return emit(count, t);
+}
+
+size_t PointSpriteStreamEmitter::emitMissingParticles(float t)
+{
+	return emit(_capacity - _activeParticles, t);
+}
+
+void PointSpriteStreamEmitter::particleValues(const PointSprite& p, float* values)
+{
+	values[Stream_PositionX] = p.position.x;
+	values[Stream_PositionY] = p.position.y;
+	values[Stream_PositionZ] = p.position.z;
+	values[Stream_VelocityX] = p.velocity.x;
+	values[Stream_VelocityY] = p.velocity.y;
+	values[Stream_VelocityZ] = p.velocity.z;
+	values[Stream_AccelerationX] = p.acceleration.x;
+	values[Stream_AccelerationY] = p.acceleration.y;
+	values[Stream_AccelerationZ] = p.acceleration.z;
+	values[Stream_ColorR] = p.color.x;
+	values[Stream_ColorG] = p.color.y;
+	values[Stream_ColorB] = p.color.z;
+	values[Stream_ColorA] = p.color.w;
+	values[Stream_Size] = p.size;
+	values[Stream_EmitTime] = p.emitTime;
+	values[Stream_LifeTime] = p.lifeTime;
+}
+
+void PointSpriteStreamEmitter::update(float t)
+	{ update(t, nullptr); }
+
+void PointSpriteStreamEmitter::update(float t, JobSystem& jobs)
+	{ update(t, &jobs); }
+
+void PointSpriteStreamEmitter::update(float t, JobSystem* jobs)
+{
+	if (_updateTime == 0.0f)
+		_updateTime = t;
+
+	float dt = t - _updateTime;
+	_updateTime = t;
+
+	/*
+	 * Each range is compacted in place, then ranges are moved together
+	 */
+	size_t rangesCount = (_activeParticles + particlesPerJob - 1) / particlesPerJob;
+	_aliveInRange.resize(rangesCount);
+
+	runParallel(jobs, rangesCount, 1, [this, t, dt](size_t begin, size_t end)
+	{
+		for (size_t r = begin; r < end; ++r)
+		{
+			size_t first = r * particlesPerJob;
+			_aliveInRange[r] = updateRange(first, etMin(first + particlesPerJob, _activeParticles), t, dt);
+		}
+	});
+
+	size_t aliveParticles = 0;
+	for (size_t r = 0; r < rangesCount; ++r)
+	{
+		size_t first = r * particlesPerJob;
+		size_t count = _aliveInRange[r];
+		if ((aliveParticles != first) && (count > 0))
+		{
+			for (size_t s = 0; s < Stream_max; ++s)
+				std::memmove(stream(s) + aliveParticles, stream(s) + first, count * sizeof(float));
+		}
+		aliveParticles += count;
+	}
+
+	size_t deadParticles = _activeParticles - aliveParticles;
+	_activeParticles = aliveParticles;
+
+	if (_autoRenewParticles)
+		emit(deadParticles, t);
+}
+
+size_t PointSpriteStreamEmitter::updateRange(size_t first, size_t last, float t, float dt)
+{
+	float* px = stream(Stream_PositionX);
+	float* py = stream(Stream_PositionY);
+	float* pz = stream(Stream_PositionZ);
+	float* vx = stream(Stream_VelocityX);
+	float* vy = stream(Stream_VelocityY);
+	float* vz = stream(Stream_VelocityZ);
+	const float* ax = stream(Stream_AccelerationX);
+	const float* ay = stream(Stream_AccelerationY);
+	const float* az = stream(Stream_AccelerationZ);
+	const float* emitTime = stream(Stream_EmitTime);
+	const float* lifeTime = stream(Stream_LifeTime);
+	float* alpha = stream(Stream_ColorA);
+	uint8_t* alive = _aliveFlags.data();
+
+	/*
+	 * Padding particles of the last group are updated too, their flags are ignored
+	 */
+	for (size_t i = first; i < last; i += 4)
+	{
+		simd::integrate4(px + i, vx + i, ax + i, dt);
+		simd::integrate4(py + i, vy + i, ay + i, dt);
+		simd::integrate4(pz + i, vz + i, az + i, dt);
+
+		uint32_t mask = simd::fade4(alpha + i, emitTime + i, lifeTime + i, t);
+		alive[i] = static_cast<uint8_t>(mask & 1);
+		alive[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+		alive[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+		alive[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+	}
+
+	size_t aliveCount = 0;
+	for (size_t i = first; i < last; ++i)
+		aliveCount += alive[i];
+
+	if (aliveCount == last - first)
+		return aliveCount;
+
+	/*
+	 * Dead particles before the boundary are replaced with the alive ones after it,
+	 * so only dead particles are moved (order is not preserved, as in Emitter).
+	 * Both lists are built without branching: index is always written,
+	 * but the position advances only for the matching particles.
+	 */
+	size_t boundary = first + aliveCount;
+	uint32_t* holes = _compactionIndices.data() + first;
+	uint32_t* movers = _compactionIndices.data() + boundary;
+
+	size_t holesCount = 0;
+	for (size_t i = first; i < boundary; ++i)
+	{
+		holes[holesCount] = static_cast<uint32_t>(i);
+		holesCount += 1 - alive[i];
+	}
+
+	size_t moversCount = 0;
+	for (size_t i = boundary; i < last; ++i)
+	{
+		movers[moversCount] = static_cast<uint32_t>(i);
+		moversCount += alive[i];
+	}
+	ET_ASSERT(holesCount == moversCount);
+
+	for (size_t s = 0; s < Stream_max; ++s)
+	{
+		float* values = stream(s);
+		for (size_t i = 0; i < holesCount; ++i)
+			values[holes[i]] = values[movers[i]];
+	}
+
+	return aliveCount;
+}
+
+void PointSpriteStreamEmitter::writeVertices(const VertexDeclaration& decl, void* data, size_t dataSize) const
+	{ writeVertices(decl, data, dataSize, nullptr); }
+
+void PointSpriteStreamEmitter::writeVertices(const VertexDeclaration& decl, void* data, size_t dataSize, JobSystem& jobs) const
+	{ writeVertices(decl, data, dataSize, &jobs); }
+
+void PointSpriteStreamEmitter::writeVertices(VertexArray::Description& desc, JobSystem& jobs) const
+	{ writeVertices(desc.declaration, desc.data.data(), desc.data.dataSize(), &jobs); }
+
+void PointSpriteStreamEmitter::writeVertices(const VertexDeclaration& decl, void* data, size_t dataSize, JobSystem* jobs) const
+{
+	ET_ASSERT(decl.interleaved());
+
+	size_t vertexSize = decl.dataSize();
+	size_t count = etMin(_activeParticles, dataSize / vertexSize);
+	char* vertices = reinterpret_cast<char*>(data);
+
+	const float* px = stream(Stream_PositionX);
+	const float* py = stream(Stream_PositionY);
+	const float* pz = stream(Stream_PositionZ);
+	const float* size = stream(Stream_Size);
+	const float* cr = stream(Stream_ColorR);
+	const float* cg = stream(Stream_ColorG);
+	const float* cb = stream(Stream_ColorB);
+	const float* ca = stream(Stream_ColorA);
+
+	uint32_t positionComponents = 0;
+	uint32_t colorComponents = 0;
+	size_t positionOffset = 0;
+	size_t colorOffset = 0;
+
+	if (decl.has(VertexAttributeUsage::Position))
+	{
+		const auto& e = decl.elementForUsage(VertexAttributeUsage::Position);
+		ET_ASSERT((e.type() == VertexAttributeType::Vec3) || (e.type() == VertexAttributeType::Vec4));
+		positionComponents = e.components();
+		positionOffset = e.offset();
+	}
+
+	if (decl.has(VertexAttributeUsage::Color))
+	{
+		const auto& e = decl.elementForUsage(VertexAttributeUsage::Color);
+		ET_ASSERT((e.type() == VertexAttributeType::Vec3) || (e.type() == VertexAttributeType::Vec4));
+		colorComponents = e.components();
+		colorOffset = e.offset();
+	}
+
+	runParallel(jobs, count, verticesPerJob, [&](size_t begin, size_t end)
+	{
+		if (positionComponents > 0)
+		{
+			char* target = vertices + begin * vertexSize + positionOffset;
+			for (size_t i = begin; i < end; ++i, target += vertexSize)
+			{
+				float* p = reinterpret_cast<float*>(target);
+				p[0] = px[i];
+				p[1] = py[i];
+				p[2] = pz[i];
+				if (positionComponents == 4)
+					p[3] = size[i];
+			}
+		}
+
+		if (colorComponents > 0)
+		{
+			char* target = vertices + begin * vertexSize + colorOffset;
+			for (size_t i = begin; i < end; ++i, target += vertexSize)
+			{
+				float* c = reinterpret_cast<float*>(target);
+				c[0] = cr[i];
+				c[1] = cg[i];
+				c[2] = cb[i];
+				if (colorComponents == 4)
+					c[3] = ca[i];
+			}
+		}
+	});
+}
@@ -6,6 +6,7 @@
  */
 
 #include <et/geometry/geometry.h>
+#include <et/tasks/jobsystem.h>
 #include <et/imaging/imageoperations.h>
 
 using namespace et;
@@ -26,11 +27,624 @@ mat3i ImageOperations::matrixFilterSharpen = mat3i(
 	 0, -1,  0);
 
 int indexForCoord(const vec2i& coord, const vec2i& size);
-bool grayscaleSortFunction(const vec4ub& v1, const vec4ub& v2);
 
 inline int roundf(float v, int minV, int maxV)
 	{ return clamp(static_cast<int>(v), minV, maxV); }
 
+namespace
+{
+	const size_t minimumRowsPerJob = 16;
+	const int pixelsPerBand = 16;
+
+	template <typename F>
+	void runParallel(JobSystem* jobs, size_t count, size_t minimumRange, F f)
+	{
+		if ((jobs == nullptr) || (count <= minimumRange))
+			f(0, count);
+		else
+			jobs->parallelFor(0, count, minimumRange, f);
+	}
+
+	inline int clampIndex(int i, int size)
+		{ return (i < 0) ? 0 : ((i >= size) ? size - 1 : i); }
+
+	/*
+	 * Batch of the pixel components, converted to floats
+	 */
+#	if (ET_SIMD_SSE)
+	typedef __m128 Batch;
+	enum : int { batchWidth = 4 };
+	inline Batch broadcast(float v) { return _mm_set1_ps(v); }
+	inline Batch load(const float* p) { return _mm_loadu_ps(p); }
+	inline void store(float* p, Batch a) { _mm_storeu_ps(p, a); }
+	inline Batch add(Batch a, Batch b) { return _mm_add_ps(a, b); }
+	inline Batch sub(Batch a, Batch b) { return _mm_sub_ps(a, b); }
+	inline Batch mul(Batch a, Batch b) { return _mm_mul_ps(a, b); }
+	inline Batch div(Batch a, Batch b) { return _mm_div_ps(a, b); }
+	inline Batch squareRoot(Batch a) { return _mm_sqrt_ps(a); }
+	inline Batch loadBytes(const unsigned char* p)
+	{
+		int32_t value = 0;
+		etCopyMemory(&value, p, sizeof(value));
+		__m128i zero = _mm_setzero_si128();
+		__m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero);
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+	}
+	inline void storeBytes(unsigned char* p, Batch a)
+	{
+		__m128i v = _mm_cvttps_epi32(a);
+		v = _mm_packs_epi32(v, v);
+		int32_t value = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+		etCopyMemory(p, &value, sizeof(value));
+	}
+#	elif (ET_SIMD_NEON)
+	typedef float32x4_t Batch;
+	enum : int { batchWidth = 4 };
+	inline Batch broadcast(float v) { return vdupq_n_f32(v); }
+	inline Batch load(const float* p) { return vld1q_f32(p); }
+	inline void store(float* p, Batch a) { vst1q_f32(p, a); }
+	inline Batch add(Batch a, Batch b) { return vaddq_f32(a, b); }
+	inline Batch sub(Batch a, Batch b) { return vsubq_f32(a, b); }
+	inline Batch mul(Batch a, Batch b) { return vmulq_f32(a, b); }
+#		if defined(__aarch64__)
+	inline Batch div(Batch a, Batch b) { return vdivq_f32(a, b); }
+	inline Batch squareRoot(Batch a) { return vsqrtq_f32(a); }
+#		else
+	inline Batch div(Batch a, Batch b)
+	{
+		float32x4_t inv = vrecpeq_f32(b);
+		inv = vmulq_f32(inv, vrecpsq_f32(b, inv));
+		inv = vmulq_f32(inv, vrecpsq_f32(b, inv));
+		return vmulq_f32(a, inv);
+	}
+	inline Batch squareRoot(Batch a)
+	{
+		float32x4_t inv = vrsqrteq_f32(a);
+		inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(a, inv), inv));
+		inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(a, inv), inv));
+		return vmulq_f32(a, inv);
+	}
+#		endif
+	inline Batch loadBytes(const unsigned char* p)
+	{
+		uint32_t value = 0;
+		etCopyMemory(&value, p, sizeof(value));
+		uint16x8_t v = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(value)));
+		return vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+	}
+	inline void storeBytes(unsigned char* p, Batch a)
+	{
+		uint16x4_t v = vqmovun_s32(vcvtq_s32_f32(a));
+		uint32_t value = vget_lane_u32(vreinterpret_u32_u8(vqmovn_u16(vcombine_u16(v, v))), 0);
+		etCopyMemory(p, &value, sizeof(value));
+	}
+#	else
+	typedef float Batch;
+	enum : int { batchWidth = 1 };
+	inline Batch broadcast(float v) { return v; }
+	inline Batch load(const float* p) { return *p; }
+	inline void store(float* p, Batch a) { *p = a; }
+	inline Batch add(Batch a, Batch b) { return a + b; }
+	inline Batch sub(Batch a, Batch b) { return a - b; }
+	inline Batch mul(Batch a, Batch b) { return a * b; }
+	inline Batch div(Batch a, Batch b) { return a / b; }
+	inline Batch squareRoot(Batch a) { return std::sqrt(a); }
+	inline Batch loadBytes(const unsigned char* p) { return static_cast<float>(*p); }
+	inline void storeBytes(unsigned char* p, Batch a) { *p = static_cast<unsigned char>(clamp(static_cast<int>(a), 0, 255)); }
+#	endif
+
+	/*
+	 * out(x) = (sum of in(x + k * step), k = first...last, + bias) / divisor
+	 */
+	struct BoxPass
+	{
+		int first = 0;
+		int last = 0;
+		int divisor = 1;
+		int bias = 0;
+
+		BoxPass(int f, int l, int d, int b) :
+			first(f), last(l), divisor(d), bias(b) { }
+	};
+	typedef std::vector<BoxPass> BoxPassList;
+
+	BoxPassList blurPasses(int radius, ImageBlurType type)
+	{
+		BoxPassList passes;
+		if (type == ImageBlurType_Linear)
+		{
+			/*
+			 * Triangle weights (radius + 1 - |k|) are the convolution of two boxes
+			 */
+			passes.emplace_back(0, radius, 1, 0);
+			passes.emplace_back(-radius, 0, sqr(radius + 1), 0);
+		}
+		else if (type == ImageBlurType_Gaussian)
+		{
+			/*
+			 * Widths of three boxes for sigma = radius / 2 (Kovesi, Fast almost-Gaussian filtering),
+			 * intermediate results are rounded
+			 */
+			const int boxesCount = 3;
+			float variance = 12.0f * sqr(0.5f * static_cast<float>(radius));
+			int lowerWidth = static_cast<int>(std::sqrt(variance / boxesCount + 1.0f));
+			if (lowerWidth % 2 == 0)
+				--lowerWidth;
+
+			float lowerBoxes = (variance - static_cast<float>(boxesCount * (sqr(lowerWidth) + 4 * lowerWidth + 3))) /
+				static_cast<float>(-4 * lowerWidth - 4);
+			int lowerBoxesCount = static_cast<int>(std::floor(lowerBoxes + 0.5f));
+
+			for (int i = 0; i < boxesCount; ++i)
+			{
+				int r = ((i < lowerBoxesCount) ? lowerWidth : lowerWidth + 2) / 2;
+				if (r > 0)
+					passes.emplace_back(-r, r, 2 * r + 1, r);
+			}
+		}
+		else
+		{
+			passes.emplace_back(-radius, radius, 2 * radius + 1, 0);
+		}
+		return passes;
+	}
+
+	/*
+	 * Runs box passes over the line of elements, each of lanes values. Line is extended
+	 * (by clamping coordinates) enough for all passes, so each pass is a sliding window sum:
+	 * constant time per element, independent from the radius.
+	 */
+	class LineBlur
+	{
+	public:
+		LineBlur(const BoxPassList& passes, int count, int lanes, int step) :
+			_passes(passes), _lanes(lanes), _step(step)
+		{
+			_ranges.resize(passes.size() + 1);
+			_ranges.back() = vec2i(0, count);
+			for (size_t i = passes.size(); i-- > 0;)
+			{
+				_ranges[i].x = _ranges[i + 1].x + passes[i].first * step;
+				_ranges[i].y = _ranges[i + 1].y + passes[i].last * step;
+			}
+			_origin = -_ranges.front().x;
+
+			size_t length = static_cast<size_t>(_ranges.front().y - _ranges.front().x) * lanes;
+			_input.resize(length);
+			_output.resize(length);
+			_sums.resize(lanes);
+		}
+
+		int firstElement() const
+			{ return _ranges.front().x; }
+
+		int lastElement() const
+			{ return _ranges.front().y; }
+
+		int* input(int element)
+			{ return _input.data() + (element + _origin) * _lanes; }
+
+		/*
+		 * Returns element 0 of the result, input is destroyed
+		 */
+		const int* run()
+		{
+			int* in = _input.data();
+			int* out = _output.data();
+			for (size_t i = 0; i < _passes.size(); ++i)
+			{
+				apply(_passes.at(i), in, out, _ranges.at(i + 1));
+				std::swap(in, out);
+			}
+			return in + _origin * _lanes;
+		}
+
+	private:
+		void apply(const BoxPass& pass, const int* in, int* out, const vec2i& range)
+		{
+			int* sums = _sums.data();
+			int lanes = _lanes;
+
+			/*
+			 * Half of the smallest fraction makes truncation exact, even for the exact multiples
+			 */
+			double inverse = 1.0 / static_cast<double>(pass.divisor);
+			double offset = static_cast<double>(pass.bias) * inverse + 0.5 * inverse;
+
+			for (int start = range.x; start < etMin(range.x + _step, range.y); ++start)
+			{
+				std::fill(_sums.begin(), _sums.end(), 0);
+				for (int k = pass.first; k <= pass.last; ++k)
+				{
+					const int* value = in + (start + k * _step + _origin) * lanes;
+					for (int l = 0; l < lanes; ++l)
+						sums[l] += value[l];
+				}
+
+				for (int x = start; x < range.y; x += _step)
+				{
+					int* target = out + (x + _origin) * lanes;
+					if (pass.divisor == 1)
+					{
+						for (int l = 0; l < lanes; ++l)
+							target[l] = sums[l];
+					}
+					else
+					{
+						for (int l = 0; l < lanes; ++l)
+							target[l] = static_cast<int>(static_cast<double>(sums[l]) * inverse + offset);
+					}
+
+					if (x + _step < range.y)
+					{
+						const int* added = in + (x + (pass.last + 1) * _step + _origin) * lanes;
+						const int* removed = in + (x + pass.first * _step + _origin) * lanes;
+						for (int l = 0; l < lanes; ++l)
+							sums[l] += added[l] - removed[l];
+					}
+				}
+			}
+		}
+
+	private:
+		const BoxPassList& _passes;
+		std::vector<vec2i> _ranges;
+		std::vector<int> _input;
+		std::vector<int> _output;
+		std::vector<int> _sums;
+		int _lanes = 0;
+		int _step = 1;
+		int _origin = 0;
+	};
+
+	/*
+	 * Lines are blurred in bands (of rows or columns), components of all pixels across the band
+	 * are lanes of one element, so rows are read and written sequentially in both directions
+	 */
+	void blurBand(unsigned char* pixels, const vec2i& size, int components, const BoxPassList& passes,
+		const vec2i& direction, int bandBegin, int bandEnd)
+	{
+		bool horizontal = (direction.y == 0);
+		int rowSize = size.x * components;
+		int elementsCount = horizontal ? size.x : size.y;
+		int elementStride = horizontal ? components : rowSize;
+		int groupStride = horizontal ? rowSize : components;
+		int groupsCount = bandEnd - bandBegin;
+		int lanes = groupsCount * components;
+		unsigned char* band = pixels + bandBegin * groupStride;
+
+		LineBlur line(passes, elementsCount, lanes, std::abs(horizontal ? direction.x : direction.y));
+		for (int e = line.firstElement(); e < line.lastElement(); ++e)
+		{
+			const unsigned char* element = band + clampIndex(e, elementsCount) * elementStride;
+			int* value = line.input(e);
+			for (int g = 0; g < groupsCount; ++g, value += components)
+			{
+				for (int c = 0; c < components; ++c)
+					value[c] = element[g * groupStride + c];
+			}
+		}
+
+		const int* result = line.run();
+		for (int e = 0; e < elementsCount; ++e)
+		{
+			unsigned char* element = band + e * elementStride;
+			for (int g = 0; g < groupsCount; ++g, result += components)
+			{
+				for (int c = 0; c < components; ++c)
+					element[g * groupStride + c] = static_cast<unsigned char>(result[c]);
+			}
+		}
+	}
+
+	/*
+	 * Arbitrary (diagonal) directions are filtered directly, with explicit weights
+	 */
+	void blurDirectional(const unsigned char* source, unsigned char* target, const vec2i& size, int components,
+		const vec2i& direction, const std::vector<int>& weights, int y0, int y1)
+	{
+		int radius = static_cast<int>(weights.size() / 2);
+		int totalWeight = 0;
+		for (int w : weights)
+			totalWeight += w;
+
+		for (int y = y0; y < y1; ++y)
+		{
+			for (int x = 0; x < size.x; ++x)
+			{
+				vec4i sum(0);
+				for (int r = -radius; r <= radius; ++r)
+				{
+					int index = components * indexForCoord(vec2i(x, y) + direction * r, size);
+					for (int c = 0; c < components; ++c)
+						sum[c] += source[index + c] * weights[r + radius];
+				}
+
+				int i0 = components * (y * size.x + x);
+				for (int c = 0; c < components; ++c)
+					target[i0 + c] = static_cast<unsigned char>(sum[c] / totalWeight);
+			}
+		}
+	}
+
+	std::vector<int> blurWeights(int radius, ImageBlurType type)
+	{
+		std::vector<int> weights(2 * radius + 1, 1);
+		float sigma = 0.5f * static_cast<float>(radius);
+		for (int r = -radius; r <= radius; ++r)
+		{
+			if (type == ImageBlurType_Linear)
+				weights[r + radius] = radius + 1 - std::abs(r);
+			else if (type == ImageBlurType_Gaussian)
+				weights[r + radius] = static_cast<int>(1024.0f * std::exp(-0.5f * sqr(static_cast<float>(r) / sigma)) + 0.5f);
+		}
+		return weights;
+	}
+
+	void blurImage(BinaryDataStorage& data, const vec2i& size, int components, const vec2i& direction,
+		int radius, ImageBlurType type, JobSystem* jobs)
+	{
+		if ((radius <= 0) || ((direction.x == 0) && (direction.y == 0)) || (size.square() <= 0)) return;
+
+		unsigned char* pixels = data.data();
+		if ((direction.x == 0) || (direction.y == 0))
+		{
+			BoxPassList passes = blurPasses(radius, type);
+			if (passes.empty()) return;
+
+			int bandsTotal = (direction.y == 0) ? size.y : size.x;
+			size_t bandsCount = static_cast<size_t>((bandsTotal + pixelsPerBand - 1) / pixelsPerBand);
+			runParallel(jobs, bandsCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t b = begin; b < end; ++b)
+				{
+					int bandBegin = static_cast<int>(b) * pixelsPerBand;
+					blurBand(pixels, size, components, passes, direction, bandBegin, etMin(bandBegin + pixelsPerBand, bandsTotal));
+				}
+			});
+		}
+		else
+		{
+			BinaryDataStorage source(data);
+			std::vector<int> weights = blurWeights(radius, type);
+			runParallel(jobs, size.y, minimumRowsPerJob, [&](size_t begin, size_t end)
+			{
+				blurDirectional(source.data(), pixels, size, components, direction, weights,
+					static_cast<int>(begin), static_cast<int>(end));
+			});
+		}
+	}
+
+	/*
+	 * Constant time median filter (Perreault, Hebert), each component is filtered separately.
+	 * Column histograms are moved down by one row per output row, kernel histogram is moved right
+	 * by one column per pixel. Fine (256 bins) kernel histogram is updated only for the coarse bin
+	 * which contains median.
+	 */
+	void medianRows(const unsigned char* source, unsigned char* target, const vec2i& size, int components,
+		int radius, int y0, int y1)
+	{
+		const int fineBins = 256;
+		const int coarseBins = 16;
+
+		int rowSize = size.x * components;
+		int window = 2 * radius + 1;
+		int middle = sqr(window) / 2;
+
+		std::vector<uint16_t> columnFine(size.x * fineBins);
+		std::vector<uint16_t> columnCoarse(size.x * coarseBins);
+		int kernelFine[fineBins] = { };
+		int kernelCoarse[coarseBins] = { };
+		int kernelFineColumn[coarseBins] = { };
+
+		for (int c = 0; c < components; ++c)
+		{
+			auto updateColumns = [&](int y, int delta)
+			{
+				const unsigned char* row = source + clampIndex(y, size.y) * rowSize + c;
+				for (int x = 0; x < size.x; ++x, row += components)
+				{
+					columnFine[x * fineBins + *row] += delta;
+					columnCoarse[x * coarseBins + (*row >> 4)] += delta;
+				}
+			};
+
+			std::fill(columnFine.begin(), columnFine.end(), 0);
+			std::fill(columnCoarse.begin(), columnCoarse.end(), 0);
+			for (int y = y0 - radius; y <= y0 + radius; ++y)
+				updateColumns(y, 1);
+
+			for (int y = y0; y < y1; ++y)
+			{
+				if (y > y0)
+				{
+					updateColumns(y - radius - 1, -1);
+					updateColumns(y + radius, 1);
+				}
+
+				std::fill(kernelCoarse, kernelCoarse + coarseBins, 0);
+				std::fill(kernelFineColumn, kernelFineColumn + coarseBins, -window - 1);
+				for (int k = -radius; k <= radius; ++k)
+				{
+					const uint16_t* column = columnCoarse.data() + clampIndex(k, size.x) * coarseBins;
+					for (int i = 0; i < coarseBins; ++i)
+						kernelCoarse[i] += column[i];
+				}
+
+				unsigned char* output = target + y * rowSize + c;
+				for (int x = 0; x < size.x; ++x, output += components)
+				{
+					if (x > 0)
+					{
+						const uint16_t* added = columnCoarse.data() + clampIndex(x + radius, size.x) * coarseBins;
+						const uint16_t* removed = columnCoarse.data() + clampIndex(x - radius - 1, size.x) * coarseBins;
+						for (int i = 0; i < coarseBins; ++i)
+							kernelCoarse[i] += added[i] - removed[i];
+					}
+
+					int count = 0;
+					int bin = 0;
+					while (count + kernelCoarse[bin] <= middle)
+						count += kernelCoarse[bin++];
+
+					int binOffset = bin * coarseBins;
+					int* fine = kernelFine + binOffset;
+					int lastColumn = kernelFineColumn[bin];
+					if (2 * (x - lastColumn) > window)
+					{
+						std::fill(fine, fine + coarseBins, 0);
+						for (int k = -radius; k <= radius; ++k)
+						{
+							const uint16_t* column = columnFine.data() + clampIndex(x + k, size.x) * fineBins + binOffset;
+							for (int i = 0; i < coarseBins; ++i)
+								fine[i] += column[i];
+						}
+					}
+					else
+					{
+						for (int j = lastColumn + 1; j <= x; ++j)
+						{
+							const uint16_t* added = columnFine.data() + clampIndex(j + radius, size.x) * fineBins + binOffset;
+							const uint16_t* removed = columnFine.data() + clampIndex(j - radius - 1, size.x) * fineBins + binOffset;
+							for (int i = 0; i < coarseBins; ++i)
+								fine[i] += added[i] - removed[i];
+						}
+					}
+					kernelFineColumn[bin] = x;
+
+					int value = 0;
+					while (count + fine[value] <= middle)
+						count += fine[value++];
+
+					*output = static_cast<unsigned char>(binOffset + value);
+				}
+			}
+		}
+	}
+
+	void matrixFilterRows(const unsigned char* source, unsigned char* target, const vec2i& size, int components,
+		const mat3i& m, int y0, int y1)
+	{
+		int rowSize = size.x * components;
+
+		int divisor = 0;
+		Batch weights[3][3];
+		for (int v = 0; v < 3; ++v)
+		{
+			for (int u = 0; u < 3; ++u)
+			{
+				weights[v][u] = broadcast(static_cast<float>(m[v][u]));
+				divisor += m[v][u];
+			}
+		}
+
+		if (divisor == 0)
+			divisor = 1;
+
+		Batch batchDivisor = broadcast(static_cast<float>(divisor));
+		for (int y = y0; y < y1; ++y)
+		{
+			const unsigned char* rows[3] = { source + clampIndex(y - 1, size.y) * rowSize,
+				source + y * rowSize, source + clampIndex(y + 1, size.y) * rowSize };
+			unsigned char* output = target + y * rowSize;
+
+			auto filterComponent = [&](int i)
+			{
+				int x = i / components;
+				int c = i % components;
+				int sum = 0;
+				for (int v = 0; v < 3; ++v)
+				{
+					for (int u = 0; u < 3; ++u)
+						sum += m[v][u] * rows[v][clampIndex(x + u - 1, size.x) * components + c];
+				}
+				output[i] = static_cast<unsigned char>(clamp(sum / divisor, 0, 255));
+			};
+
+			/*
+			 * Components of the inner pixels are filtered as flat array,
+			 * horizontal neighbours are one pixel (components values) away
+			 */
+			int i = 0;
+			for (; i < etMin(components, rowSize); ++i)
+				filterComponent(i);
+
+			for (; i + batchWidth <= rowSize - components; i += batchWidth)
+			{
+				Batch sum = broadcast(0.0f);
+				for (int v = 0; v < 3; ++v)
+				{
+					const unsigned char* row = rows[v] + i - components;
+					sum = add(sum, mul(weights[v][0], loadBytes(row)));
+					sum = add(sum, mul(weights[v][1], loadBytes(row + components)));
+					sum = add(sum, mul(weights[v][2], loadBytes(row + 2 * components)));
+				}
+				storeBytes(output + i, div(sum, batchDivisor));
+			}
+
+			for (; i < rowSize; ++i)
+				filterComponent(i);
+		}
+	}
+
+	void normalMapRows(const unsigned char* source, unsigned char* target, const vec2i& size, int components,
+		const vec2& scale, int y0, int y1)
+	{
+		int rowSize = size.x * components;
+		Batch scaleX = broadcast(scale.x / 255.0f);
+		Batch scaleY = broadcast(scale.y / 255.0f);
+		Batch zero = broadcast(0.0f);
+		Batch one = broadcast(1.0f);
+		Batch half = broadcast(0.5f);
+		Batch maxValue = broadcast(255.0f);
+
+		float heightsX[batchWidth] = { };
+		float heightsY[batchWidth] = { };
+		float normal[3][batchWidth] = { };
+
+		for (int y = y0; y < y1; ++y)
+		{
+			bool halfY = y < size.y / 2;
+			const unsigned char* row = source + y * rowSize;
+			const unsigned char* nextRow = source + clampIndex(y + (halfY ? 1 : -1), size.y) * rowSize;
+			unsigned char* output = target + y * rowSize;
+
+			for (int x0 = 0; x0 < size.x; x0 += batchWidth)
+			{
+				int count = etMin(static_cast<int>(batchWidth), size.x - x0);
+				for (int j = 0; j < count; ++j)
+				{
+					int x = x0 + j;
+					bool halfX = x < size.x / 2;
+					int h00 = row[x * components];
+					int h01 = row[clampIndex(x + (halfX ? 1 : -1), size.x) * components];
+					int h10 = nextRow[x * components];
+					heightsX[j] = static_cast<float>(halfX ? h01 - h00 : h00 - h01);
+					heightsY[j] = static_cast<float>(halfY ? h10 - h00 : h00 - h10);
+				}
+
+				/*
+				 * cross((1, 0, dx), (0, 1, dy)) = (-dx, -dy, 1)
+				 */
+				Batch nx = sub(zero, mul(load(heightsX), scaleX));
+				Batch ny = sub(zero, mul(load(heightsY), scaleY));
+				Batch length = squareRoot(add(add(mul(nx, nx), mul(ny, ny)), one));
+				store(normal[0], mul(maxValue, add(half, mul(half, div(nx, length)))));
+				store(normal[1], mul(maxValue, add(half, mul(half, div(ny, length)))));
+				store(normal[2], mul(maxValue, add(half, mul(half, div(one, length)))));
+
+				for (int j = 0; j < count; ++j)
+				{
+					unsigned char* pixel = output + (x0 + j) * components;
+					pixel[0] = static_cast<unsigned char>(normal[0][j]);
+					pixel[1] = static_cast<unsigned char>(normal[1][j]);
+					pixel[2] = static_cast<unsigned char>(normal[2][j]);
+				}
+			}
+		}
+	}
+}
+
 void ImageOperations::transfer(const BinaryDataStorage& src, const vec2i& srcSize, int srcComponents,
 	BinaryDataStorage& dst, const vec2i& dstSize, int dstComponents, const vec2i& position)
 {
@@ -153,160 +767,59 @@ void ImageOperations::applyPixelFilter(BinaryDataStorage& data, const vec2i& siz
 }
 
 void ImageOperations::blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius, ImageBlurType type)
-{
-	type = ImageBlurType_Average;
-
-	BinaryDataStorage source(data);
-	for (int y = 0; y < size.y; ++y)
-	{
-		for (int x = 0; x < size.x; ++x)
-		{
-			int i0 = components * indexForCoord(vec2i(x, y), size);
+	{ blurImage(data, size, components, direction, radius, type, nullptr); }
 
-			vec4i sum;
-			int scale = (type == ImageBlurType_Average) ? 1 : (radius + 1);
-			int totalScale = scale;
-			for (int c = 0; c < components; ++c)
-				sum[c] = source[i0 + c] * scale;
-
-			for (int r = 1; r <= radius; ++r)
-			{
-				vec2i vNext = vec2i(x, y) + direction * r;
-				vec2i vPrev = vec2i(x, y) - direction * r;
-				int iNext = components * indexForCoord(vNext, size);
-				int iPrev = components * indexForCoord(vPrev, size);
-				scale = (type == ImageBlurType_Average) ? 1 : (radius + 1 - r);
-				totalScale += 2 * scale;
-				for (int c = 0; c < components; ++c)
-				{
-					sum[c] += source[iNext + c] * scale;
-					sum[c] += source[iPrev + c] * scale;
-				}
-
-			}
-
-			sum /= totalScale;
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = static_cast<unsigned char>(sum[c]);
-		}
-	}
-}
+void ImageOperations::blur(BinaryDataStorage& data, const vec2i& size, int components, vec2i direction, int radius,
+	ImageBlurType type, JobSystem& jobs)
+	{ blurImage(data, size, components, direction, radius, type, &jobs); }
 
 void ImageOperations::median(BinaryDataStorage& data, const vec2i& size, int components, int radius)
 {
 	BinaryDataStorage source(data);
+	medianRows(source.data(), data.data(), size, components, radius, 0, size.y);
+}
 
-	std::vector<vec4ub> matrix;
-	matrix.reserve(static_cast<std::vector<vec4ub>::size_type>((1 + 2 * radius) * (1 + 2 * radius)));
-
-	for (int y = 0; y < size.y; ++y)
+void ImageOperations::median(BinaryDataStorage& data, const vec2i& size, int components, int radius, JobSystem& jobs)
+{
+	BinaryDataStorage source(data);
+	runParallel(&jobs, size.y, etMax(minimumRowsPerJob, static_cast<size_t>(2 * radius + 1)), [&](size_t begin, size_t end)
 	{
-		for (int x = 0; x < size.x; ++x)
-		{
-			int i0 = components * indexForCoord(vec2i(x, y), size);
-
-			matrix.clear();
-			for (int v = -radius; v <= radius; ++v)
-			{
-				for (int u = - radius; u <= radius; ++u)
-				{
-					int index = components * indexForCoord(vec2i(x + u, y + v), size);
-					vec4ub color(0);
-					for (int c = 0; c < components; ++c)
-						color[c] = source[index+c];
-					matrix.push_back(color);
-				}
-			}
-
-			std::sort(matrix.begin(), matrix.end(), grayscaleSortFunction);
-
-			vec4ub& middle = matrix.at(matrix.size() / 2);
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = middle[c];
-		}
-	}
+		medianRows(source.data(), data.data(), size, components, radius, static_cast<int>(begin), static_cast<int>(end));
+	});
 }
 
 void ImageOperations::applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m)
 {
 	BinaryDataStorage source(data);
-	matrix3<unsigned char> colorMatrix[4];
+	matrixFilterRows(source.data(), data.data(), size, components, m, 0, size.y);
+}
 
-	for (int y = 0; y < size.y; ++y)
+void ImageOperations::applyMatrixFilter(BinaryDataStorage& data, const vec2i& size, int components, const mat3i& m, JobSystem& jobs)
+{
+	BinaryDataStorage source(data);
+	runParallel(&jobs, size.y, minimumRowsPerJob, [&](size_t begin, size_t end)
 	{
-		for (int x = 0; x < size.x; ++x)
-		{
-			for (int dy = -1; dy <= 1; ++dy)
-			{
-				for (int dx = -1; dx <= 1; ++dx)
-				{
-					int index = components * indexForCoord(vec2i(x + dx, y + dy), size);
-					for (int c = 0; c < components; ++c)
-						colorMatrix[c][dy+1][dx+1] = source[index+c];
-				}
-			}
-
-			vec4i result(0);
-			int cSum = 0;
-			for (int v = 0; v < 3; ++v)
-			{
-				for (int u = 0; u < 3; ++u)
-				{
-					int value = m[v][u];
-					result.x += colorMatrix[0][v][u] * value;
-					result.y += colorMatrix[1][v][u] * value;
-					result.z += colorMatrix[2][v][u] * value;
-					result.w += colorMatrix[3][v][u] * value;
-					cSum += value;
-				}
-			}
-
-			if (cSum)
-				result /= cSum;
-
-			int i0 = components * indexForCoord(vec2i(x, y), size);
-			for (int c = 0; c < components; ++c)
-				data[i0 + c] = static_cast<unsigned char>(clamp(result[c], 0, 255));
-		}
-	}
+		matrixFilterRows(source.data(), data.data(), size, components, m, static_cast<int>(begin), static_cast<int>(end));
+	});
 }
 
 void ImageOperations::normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale)
 {
 	ET_ASSERT(components > 2);
 
-	vec2 fScale = scale / 255.0f;
 	BinaryDataStorage source(data);
-	for (int y = 0; y < size.y; ++y)
-	{
-		bool halfY = y < size.y / 2;
-		for (int x = 0; x < size.x; ++x)
-		{
-			bool halfX = x < size.x / 2;
-			vec2i nextX(x + (halfX ? 1 : -1), y);
-			vec2i nextY(x, y + (halfY ? 1 : -1));
-
-			int c00 = components * indexForCoord(vec2i(x, y), size);
-			int c01 = components * indexForCoord(nextX, size);
-			int c10 = components * indexForCoord(nextY, size);
-
-			short h00 = source[c00];
-			short h01 = source[c01];
-			short h10 = source[c10];
-
-			float dx = static_cast<float>(halfX ? h01 - h00 : h00 - h01) * fScale.x;
-			float dy = static_cast<float>(halfY ? h10 - h00 : h00 - h10) * fScale.y;
-
-			vec3 du(1.0f, 0.0f, dx);
-			vec3 dv(0.0f, 1.0f, dy);
+	normalMapRows(source.data(), data.data(), size, components, scale, 0, size.y);
+}
 
-			vec3 produce = normalize(cross(du, dv));
+void ImageOperations::normalMapFilter(BinaryDataStorage& data, const vec2i& size, int components, const vec2& scale, JobSystem& jobs)
+{
+	ET_ASSERT(components > 2);
 
-			data[c00+0] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.x));
-			data[c00+1] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.y));
-			data[c00+2] = static_cast<unsigned char>(255.0f * (0.5f + 0.5f * produce.z));
-		}
-	}
+	BinaryDataStorage source(data);
+	runParallel(&jobs, size.y, minimumRowsPerJob, [&](size_t begin, size_t end)
+	{
+		normalMapRows(source.data(), data.data(), size, components, scale, static_cast<int>(begin), static_cast<int>(end));
+	});
 }
 
 /*
@@ -318,10 +831,3 @@ int indexForCoord(const vec2i& coord, const vec2i& size)
 	int yVal = coord.y < 0 ? 0 : (coord.y >= size.y ? size.y - 1 : coord.y);
 	return yVal * size.x + xVal;
 }
-
-bool grayscaleSortFunction(const vec4ub& v1, const vec4ub& v2)
-{
-	int g1 = 76 * v1.x + 150 * v1.y + 29 * v1.z;
-	int g2 = 76 * v2.x + 150 * v2.y + 29 * v2.z;
-	return g1 < g2;
-}
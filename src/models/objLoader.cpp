@@ -5,10 +5,13 @@
  *
  */
 
+#include <unordered_map>
 #include <et/app/application.h>
 #include <et/core/conversion.h>
+#include <et/core/profiler.h>
 #include <et/core/filesystem.h>
 #include <et/primitives/primitives.h>
+#include <et/primitives/meshoptimizer.h>
 #include <et/models/objloader.h>
 
 using namespace et;
@@ -30,42 +33,393 @@ namespace et
 	};
 }
 
-inline std::istream& operator >> (std::istream& stream, vec2& value)
+namespace
 {
-	std::string ln;
-	std::getline(stream, ln);
-	trim(ln);
-	
-	auto values = split(ln, " ");
-	
-	size_t comp = 0;
-	for (const auto& val : values)
+	const size_t minimumChunkSize = 1024 * 1024;
+
+	enum OBJAttribute : uint32_t
 	{
-		if (comp < 2)
-			value[comp++] = strToFloat(val);
+		OBJAttribute_Position,
+		OBJAttribute_TexCoord,
+		OBJAttribute_Normal,
+		OBJAttribute_max
+	};
+
+	enum OBJCommand : uint32_t
+	{
+		OBJCommand_Group,
+		OBJCommand_UseMaterial,
+		OBJCommand_Smoothing,
+		OBJCommand_MaterialLibrary,
+	};
+
+	/*
+	 * Commands changing group state, applied in order after all chunks are parsed.
+	 * cornerIndex is the amount of corner indices emitted by the chunk before the command.
+	 */
+	struct OBJChunkCommand
+	{
+		OBJCommand command;
+		size_t cornerIndex;
+		std::string argument;
+	};
+
+	/*
+	 * Negative (relative) indices are stored as index within the chunk
+	 * and are fixed up by number of attributes in all preceding chunks.
+	 */
+	struct OBJChunkFixup
+	{
+		size_t cornerIndex;
+		OBJAttribute attribute;
+	};
+
+	struct OBJChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		std::vector<vec3> positions;
+		std::vector<vec3> normals;
+		std::vector<vec2> texCoords;
+		std::vector<uint32_t> corners;
+		std::vector<OBJChunkCommand> commands;
+		std::vector<OBJChunkFixup> fixups;
+		size_t unknownLines = 0;
+	};
+
+	/*
+	 * Identical corners within the group share vertex, when meshes are optimized
+	 */
+	struct OBJCorner
+	{
+		uint32_t attributes[OBJAttribute_max];
+
+		OBJCorner(const uint32_t* corner)
+			{ std::copy(corner, corner + OBJAttribute_max, attributes); }
+
+		bool operator == (const OBJCorner& c) const
+			{ return std::equal(attributes, attributes + OBJAttribute_max, c.attributes); }
+	};
+
+	struct OBJCornerHash
+	{
+		size_t operator () (const OBJCorner& c) const
+		{
+			uint64_t result = c.attributes[OBJAttribute_Position];
+			result = result * 0x9e3779b97f4a7c15ull + c.attributes[OBJAttribute_TexCoord];
+			result = result * 0x9e3779b97f4a7c15ull + c.attributes[OBJAttribute_Normal];
+			return static_cast<size_t>(result ^ (result >> 32));
+		}
+	};
+
+	inline bool isSpace(char c)
+		{ return (c == ' ') || (c == '\t'); }
+
+	inline bool isLineEnd(char c)
+		{ return (c == '\n') || (c == '\r'); }
+
+	inline bool isDigit(char c)
+		{ return (c >= '0') && (c <= '9'); }
+
+	inline const char* skipSpaces(const char* p, const char* end)
+	{
+		while ((p < end) && isSpace(*p)) ++p;
+		return p;
 	}
-	
-	return stream;
-}
 
-inline std::istream& operator >> (std::istream& stream, vec3& value)
-{
-	std::string ln;
-	std::getline(stream, ln);
-	trim(ln);
-	
-	auto values = split(ln, " ");
-	
-	size_t comp = 0;
-	for (const auto& val : values)
+	inline const char* skipLine(const char* p, const char* end)
 	{
-		if ((comp < 3) && !val.empty())
-			value[comp++] = strToFloat(val);
+		while ((p < end) && (*p != '\n')) ++p;
+		return (p < end) ? p + 1 : end;
+	}
+
+	inline const char* skipToken(const char* p, const char* end)
+	{
+		while ((p < end) && !isSpace(*p) && !isLineEnd(*p)) ++p;
+		return p;
+	}
+
+	bool keywordEqualTo(const char* begin, const char* end, const char* keyword)
+	{
+		while ((begin < end) && (*keyword != 0))
+		{
+			if (tolower(*begin++) != *keyword++)
+				return false;
+		}
+		return (begin == end) && (*keyword == 0);
+	}
+
+	std::string readToken(const char*& p, const char* end)
+	{
+		p = skipSpaces(p, end);
+		const char* tokenBegin = p;
+		p = skipToken(p, end);
+		return std::string(tokenBegin, p);
+	}
+
+	std::string readRestOfLine(const char*& p, const char* end)
+	{
+		p = skipSpaces(p, end);
+		const char* lineBegin = p;
+		while ((p < end) && !isLineEnd(*p)) ++p;
+
+		const char* lineEnd = p;
+		while ((lineEnd > lineBegin) && isSpace(*(lineEnd - 1))) --lineEnd;
+
+		return std::string(lineBegin, lineEnd);
+	}
+
+	/*
+	 * Decimal numbers with optional sign, fraction and exponent, no locale involved
+	 */
+	const char* parseFloat(const char* p, const char* end, float& value)
+	{
+		static const double powersOfTen[] = { 1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7,
+			1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18,
+			1.0e19, 1.0e20, 1.0e21, 1.0e22 };
+
+		p = skipSpaces(p, end);
+
+		bool negative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+			negative = (*p++ == '-');
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		int significantDigits = 0;
+
+		while ((p < end) && isDigit(*p))
+		{
+			if (significantDigits < 19)
+			{
+				mantissa = 10 * mantissa + static_cast<uint64_t>(*p - '0');
+				significantDigits += (mantissa > 0) ? 1 : 0;
+			}
+			else
+			{
+				++exponent;
+			}
+			++p;
+		}
+
+		if ((p < end) && (*p == '.'))
+		{
+			++p;
+			while ((p < end) && isDigit(*p))
+			{
+				if (significantDigits < 19)
+				{
+					mantissa = 10 * mantissa + static_cast<uint64_t>(*p - '0');
+					significantDigits += (mantissa > 0) ? 1 : 0;
+					--exponent;
+				}
+				++p;
+			}
+		}
+
+		if ((p < end) && ((*p == 'e') || (*p == 'E')))
+		{
+			++p;
+			bool negativeExponent = false;
+			if ((p < end) && ((*p == '-') || (*p == '+')))
+				negativeExponent = (*p++ == '-');
+
+			int explicitExponent = 0;
+			while ((p < end) && isDigit(*p))
+			{
+				explicitExponent = std::min(10 * explicitExponent + (*p - '0'), 1000);
+				++p;
+			}
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+		}
+
+		double result = static_cast<double>(mantissa);
+		if (exponent < 0)
+			result = (exponent >= -22) ? result / powersOfTen[-exponent] : result * std::pow(10.0, exponent);
+		else if (exponent > 0)
+			result = (exponent <= 22) ? result * powersOfTen[exponent] : result * std::pow(10.0, exponent);
+
+		value = static_cast<float>(negative ? -result : result);
+		return skipToken(p, end);
+	}
+
+	const char* parseInt(const char* p, const char* end, int64_t& value)
+	{
+		bool negative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+			negative = (*p++ == '-');
+
+		value = 0;
+		while ((p < end) && isDigit(*p))
+			value = 10 * value + (*p++ - '0');
+
+		if (negative)
+			value = -value;
+
+		return p;
+	}
+
+	template <typename T>
+	const char* parseVector(const char* p, const char* end, T& value)
+	{
+		for (size_t i = 0; i < sizeof(T) / sizeof(float); ++i)
+		{
+			p = skipSpaces(p, end);
+			if ((p >= end) || isLineEnd(*p)) break;
+			p = parseFloat(p, end, value[i]);
+		}
+		return p;
+	}
+
+	/*
+	 * Parses face corner in form of v, v/vt, v//vn or v/vt/vn.
+	 * Missing indices are set to zero, as for the first element of the array.
+	 * Returns mask of attributes with relative indices.
+	 */
+	const char* parseFaceCorner(const char* p, const char* end, const OBJChunk& chunk,
+		uint32_t* corner, uint32_t& relativeMask)
+	{
+		const size_t localCount[OBJAttribute_max] =
+			{ chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size() };
+
+		relativeMask = 0;
+		for (uint32_t a = 0; a < OBJAttribute_max; ++a)
+		{
+			int64_t index = 0;
+			p = parseInt(p, end, index);
+
+			if (index < 0)
+			{
+				corner[a] = static_cast<uint32_t>(static_cast<int64_t>(localCount[a]) + index);
+				relativeMask |= 1 << a;
+			}
+			else
+			{
+				corner[a] = (index > 0) ? static_cast<uint32_t>(index - 1) : 0;
+			}
+
+			if ((p < end) && (*p == '/'))
+				++p;
+			else
+				break;
+		}
+
+		return skipToken(p, end);
+	}
+
+	void parseChunk(OBJChunk& chunk, bool swapYZ)
+	{
+		const char* end = chunk.end;
+		const char* p = chunk.begin;
+
+		std::vector<uint32_t> polygon;
+		std::vector<uint32_t> polygonRelativeMasks;
+
+		auto emitCorner = [&chunk, &polygon, &polygonRelativeMasks](size_t k)
+		{
+			for (uint32_t a = 0; a < OBJAttribute_max; ++a)
+			{
+				if (polygonRelativeMasks[k] & (1 << a))
+					chunk.fixups.push_back({ chunk.corners.size(), static_cast<OBJAttribute>(a) });
+
+				chunk.corners.push_back(polygon[OBJAttribute_max * k + a]);
+			}
+		};
+
+		while (p < end)
+		{
+			p = skipSpaces(p, end);
+			if (p >= end) break;
+
+			const char* keyBegin = p;
+			const char* keyEnd = skipToken(p, end);
+			p = keyEnd;
+
+			if ((keyBegin == keyEnd) || (*keyBegin == '#'))
+			{
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "v"))
+			{
+				vec3 value;
+				p = parseVector(p, end, value);
+
+				if (swapYZ)
+					std::swap(value.y, value.z);
+
+				chunk.positions.push_back(value);
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "vt"))
+			{
+				vec2 value;
+				p = parseVector(p, end, value);
+				chunk.texCoords.push_back(value);
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "vn"))
+			{
+				vec3 value;
+				p = parseVector(p, end, value);
+
+				if (swapYZ)
+					std::swap(value.y, value.z);
+
+				chunk.normals.push_back(value);
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "f"))
+			{
+				polygon.clear();
+				polygonRelativeMasks.clear();
+				for (;;)
+				{
+					p = skipSpaces(p, end);
+					if ((p >= end) || isLineEnd(*p)) break;
+
+					uint32_t corner[OBJAttribute_max] = { };
+					uint32_t relativeMask = 0;
+					p = parseFaceCorner(p, end, chunk, corner, relativeMask);
+
+					polygon.insert(polygon.end(), corner, corner + OBJAttribute_max);
+					polygonRelativeMasks.push_back(relativeMask);
+				}
+
+				ET_ASSERT(polygonRelativeMasks.size() > 2);
+
+				for (size_t i = 1; i + 1 < polygonRelativeMasks.size(); ++i)
+				{
+					emitCorner(0);
+					emitCorner(i);
+					emitCorner(i + 1);
+				}
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "g"))
+			{
+				chunk.commands.push_back({ OBJCommand_Group, chunk.corners.size(), readRestOfLine(p, end) });
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "usemtl"))
+			{
+				chunk.commands.push_back({ OBJCommand_UseMaterial, chunk.corners.size(), readToken(p, end) });
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "s"))
+			{
+				chunk.commands.push_back({ OBJCommand_Smoothing, chunk.corners.size(), readRestOfLine(p, end) });
+			}
+			else if (keywordEqualTo(keyBegin, keyEnd, "mtllib"))
+			{
+				chunk.commands.push_back({ OBJCommand_MaterialLibrary, chunk.corners.size(), readToken(p, end) });
+			}
+			else
+			{
+				++chunk.unknownLines;
+			}
+
+			p = skipLine(p, end);
+		}
 	}
-	
-	return stream;
 }
 
+/*
+ * Material files are small, parsed with streams
+ */
 inline std::istream& operator >> (std::istream& stream, vec4& value)
 {
 	std::string ln;
@@ -94,6 +448,8 @@ OBJLoaderThread::OBJLoaderThread(OBJLoader* owner, ObjectsCache& cache) :
 
 ThreadResult OBJLoaderThread::main()
 {
+	ET_PROFILE_THREAD("OBJ loading");
+	
 	_owner->loadData(true, _cache);
 
 	_owner->processLoadedData();
@@ -111,11 +467,11 @@ ThreadResult OBJLoaderThread::main()
 
 OBJLoader::OBJLoader(RenderContext* rc, const std::string& inFile) : _rc(rc),
 	inputFileName(application().resolveFileName(inFile).c_str()),
-	inputFile(inputFileName.c_str()), lastGroup(0), _loadOptions(0)
+	inputFile(MappedFile::Pointer::create(inputFileName)), lastGroup(0), _loadOptions(0)
 {
 	inputFilePath = getFilePath(inputFileName);
 	
-	if (inputFile.fail())
+	if (!inputFile->valid())
 		log::info("Unable to open file %s", inputFileName.c_str());
 }
 
@@ -132,181 +488,130 @@ OBJLoader::~OBJLoader()
 	
 	_groups.clear();
 	
-	if (inputFile.is_open())
-		inputFile.close();
-	
 	if (materialFile.is_open())
 		materialFile.close();
 }
 
 void OBJLoader::loadData(bool async, ObjectsCache& cache)
 {
-	std::string line;
-	int lineNumber = 0;
-	char key = 0;
-	while (inputFile.is_open() && !inputFile.eof())
+	ET_PROFILE_SCOPE("OBJLoader::loadData");
+	
+	if (!inputFile->valid())
+		return;
+	
+	const char* data = inputFile->data();
+	const char* dataEnd = data + inputFile->size();
+	
+	/*
+	 * File is split into chunks at line boundaries, chunks are parsed in parallel
+	 * and merged in order, so the result is the same as for sequential parsing
+	 */
+	size_t chunksCount = std::min(inputFile->size() / minimumChunkSize, 4 * (jobSystem().workersCount() + 1));
+	chunksCount = std::max(chunksCount, static_cast<size_t>(1));
+	size_t chunkSize = inputFile->size() / chunksCount;
+	
+	std::vector<OBJChunk> chunks(chunksCount);
+	const char* chunkBegin = data;
+	for (size_t i = 0; i < chunksCount; ++i)
+	{
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = (i + 1 < chunksCount) ? skipLine(std::max(chunkBegin, data + (i + 1) * chunkSize), dataEnd) : dataEnd;
+		chunkBegin = chunks[i].end;
+	}
+	
+	bool swapYZ = (_loadOptions & Option_SwapYwithZ) == Option_SwapYwithZ;
+	jobSystem().parallelFor(0, chunksCount, 1, [&chunks, swapYZ](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			parseChunk(chunks[i], swapYZ);
+	});
+	
+	size_t totalPositions = 0;
+	size_t totalTexCoords = 0;
+	size_t totalNormals = 0;
+	for (const auto& chunk : chunks)
+	{
+		totalPositions += chunk.positions.size();
+		totalTexCoords += chunk.texCoords.size();
+		totalNormals += chunk.normals.size();
+	}
+	_vertices.reserve(totalPositions);
+	_texCoords.reserve(totalTexCoords);
+	_normals.reserve(totalNormals);
+	
+	auto createDefaultGroup = [this]()
 	{
-		++lineNumber;
-		inputFile >> key;
+		lastGroup = sharedObjectFactory().createObject<OBJGroup>("group-" + intToStr(_lastGroupId++));
+		_groups.push_back(lastGroup);
+	};
+	
+	auto appendCorners = [this, &createDefaultGroup](const OBJChunk& chunk, size_t begin, size_t end)
+	{
+		if (begin == end) return;
 		
-		if (inputFile.eof()) 
-			break;
+		if (lastGroup == nullptr)
+			createDefaultGroup();
 		
-		key = static_cast<char>(tolower(key));
+		lastGroup->corners.insert(lastGroup->corners.end(), chunk.corners.begin() + begin, chunk.corners.begin() + end);
+	};
+	
+	size_t unknownLines = 0;
+	for (auto& chunk : chunks)
+	{
+		const uint32_t base[OBJAttribute_max] = { static_cast<uint32_t>(_vertices.size()),
+			static_cast<uint32_t>(_texCoords.size()), static_cast<uint32_t>(_normals.size()) };
 		
-		if (key == '#')
-		{
-			getLine(inputFile, line);
-		}
-		else if (key == 'm') // mtllib
+		for (const auto& fixup : chunk.fixups)
+			chunk.corners[fixup.cornerIndex] += base[fixup.attribute];
+		
+		_vertices.insert(_vertices.end(), chunk.positions.begin(), chunk.positions.end());
+		_texCoords.insert(_texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+		_normals.insert(_normals.end(), chunk.normals.begin(), chunk.normals.end());
+		
+		size_t cornerIndex = 0;
+		for (const auto& cmd : chunk.commands)
 		{
-			std::string mtllib;
-			inputFile >> mtllib;
-			lowercase(mtllib);
+			appendCorners(chunk, cornerIndex, cmd.cornerIndex);
+			cornerIndex = cmd.cornerIndex;
 			
-			if (mtllib.compare("tllib") == 0)
+			if (cmd.command == OBJCommand_Group)
 			{
-				std::string matName;
-				inputFile >> matName;
-				loadMaterials(matName, async, cache);
-			}
-			else
-			{
-				std::cout << "Unresolved symbol: " << key << mtllib << std::endl;
+				lastGroup = sharedObjectFactory().createObject<OBJGroup>(cmd.argument);
+				_groups.push_back(lastGroup);
 			}
-		}
-		else if (key == 'g') // group
-		{
-			getLine(inputFile, line);
-			trim(line);
-			
-			lastGroup = sharedObjectFactory().createObject<OBJGroup>(line);
-			_groups.push_back(lastGroup);
-		}
-		else if (key == 'u') // group's material
-		{
-			std::string usemtl;
-			inputFile >> usemtl;
-			lowercase(usemtl);
-			
-			if (usemtl.compare("semtl") == 0) 
+			else if (cmd.command == OBJCommand_UseMaterial)
 			{
-				std::string materialId;
-				inputFile >> materialId;
-				
-				if ((lastGroup != nullptr) && (lastGroup->material.empty() || lastGroup->material == materialId))
+				if ((lastGroup != nullptr) && (lastGroup->material.empty() || lastGroup->material == cmd.argument))
 				{
-					lastGroup->material = materialId;
+					lastGroup->material = cmd.argument;
 				}
 				else
 				{
-					auto groupName = "group-" + intToStr(_lastGroupId++) + "-" + materialId;
-					lastGroup = sharedObjectFactory().createObject<OBJGroup>(groupName, materialId);
+					auto groupName = "group-" + intToStr(_lastGroupId++) + "-" + cmd.argument;
+					lastGroup = sharedObjectFactory().createObject<OBJGroup>(groupName, cmd.argument);
 					_groups.push_back(lastGroup);
 				}
 			}
-			else
-			{
-				std::cout << "Unresolved symbol " << key << usemtl << ". Current group: " << lastGroup->name << std::endl;
-			}
-		}
-		else if (key == 's') // smoothing group
-		{
-			if (lastGroup == nullptr)
+			else if (cmd.command == OBJCommand_Smoothing)
 			{
-				lastGroup = sharedObjectFactory().createObject<OBJGroup>("group-" + intToStr(_lastGroupId++));
-				_groups.push_back(lastGroup);
-			}
-			getLine(inputFile, line);
-			_lastSmoothGroup = (line.compare("off") == 0) ? 0 : strToInt(line);
-		}
-		else if (key == 'f') // faces
-		{
-			OBJFace face;
-			std::getline(inputFile, line);
-			trim(line);
-
-			auto faces = split(line, " ");
-			ET_ASSERT((faces.size() > 2) && (faces.size() < 6));
-
-			for (auto inFace : faces)
-			{
-				OBJVertex vertex;
-				auto indexes = split(inFace, "/");
-								
-				vertex.numVertices = indexes.size();
-
-				size_t i = 0;
-				for (auto index : indexes)
-				{
-					auto iValue = strToInt(index);
-					
-					if (iValue < 0)
-					{
-						size_t szValue = static_cast<size_t>(-iValue);
-						ET_ASSERT(szValue <= _vertices.size());
-						vertex[i++] = _vertices.size() - szValue;
-					}
-					else
-					{
-						vertex[i++] = iValue - 1;
-					}
-				}
+				if (lastGroup == nullptr)
+					createDefaultGroup();
 				
-				face.vertices.push_back(vertex);
-			}
-			
-			if (lastGroup == nullptr)
-			{
-				lastGroup = sharedObjectFactory().createObject<OBJGroup>("group-" + intToStr(_lastGroupId++));
-				_groups.push_back(lastGroup);
-			}
-			
-			lastGroup->faces.push_back(face);
-		}
-		else if (key == 'v')
-		{
-			char subKey = static_cast<char>(inputFile.peek());
-			
-			if (subKey == 't')
-			{
-				vec2 vertex;
-				inputFile >> subKey >> vertex;
-				_texCoords.push_back(vertex);
-			}
-			else if (subKey == 'n')
-			{
-				vec3 vertex;
-				inputFile >> subKey >> vertex;
-
-				if ((_loadOptions & Option_SwapYwithZ) == Option_SwapYwithZ)
-					std::swap(vertex.y, vertex.z);
-
-				_normals.push_back(vertex);
-			}
-			else if (isWhitespaceChar(subKey))
-			{
-				vec3 vertex;
-				inputFile >> vertex;
-
-				if ((_loadOptions & Option_SwapYwithZ) == Option_SwapYwithZ)
-					std::swap(vertex.y, vertex.z);
-
-				_vertices.push_back(vertex);
+				_lastSmoothGroup = (cmd.argument.compare("off") == 0) ? 0 : strToInt(cmd.argument);
 			}
-			else
+			else if (cmd.command == OBJCommand_MaterialLibrary)
 			{
-				getLine(inputFile, line);
-				std::cout << "Unknown line " << lineNumber << " in file: " << line << std::endl;
+				loadMaterials(cmd.argument, async, cache);
 			}
 		}
-		else
-		{
-			getLine(inputFile, line);
-			std::cout << "Unknown line " << lineNumber << " in file: " << key << line << std::endl;
-		}
+		appendCorners(chunk, cornerIndex, chunk.corners.size());
 		
+		unknownLines += chunk.unknownLines;
+		chunk = OBJChunk();
 	}
+	
+	if (unknownLines > 0)
+		log::info("%u unknown lines in file %s", static_cast<uint32_t>(unknownLines), inputFileName.c_str());
 }
 
 s3d::ElementContainer::Pointer OBJLoader::load(ObjectsCache& cache, size_t options)
@@ -663,18 +968,24 @@ void OBJLoader::loadMaterials(const std::string& fileName, bool async, ObjectsCa
 
 void OBJLoader::processLoadedData()
 {
+	ET_PROFILE_SCOPE("OBJLoader::processLoadedData");
+	
 	size_t totalTriangles = 0;
 
 	for (const auto& group : _groups)
-	{
-		for (const auto& face : group->faces)
-			totalTriangles += face.vertices.size() - 2;
-	}
+		totalTriangles += group->corners.size() / (3 * OBJAttribute_max);
 	
 	size_t totalVertices = 3 * totalTriangles;
 	
 	bool hasNormals = _normals.size() > 0;
 	bool hasTexCoords = _texCoords.size() > 0;
+	bool optimizeMeshes = (_loadOptions & Option_OptimizeMeshes) == Option_OptimizeMeshes;
+	bool generateLods = (_loadOptions & Option_GenerateLods) == Option_GenerateLods;
+	
+	/*
+	 * Levels of detail are generated by collapsing edges, so vertices should be shared
+	 */
+	bool indexVertices = optimizeMeshes || generateLods;
 		
 	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
 	
@@ -695,27 +1006,30 @@ void OBJLoader::processLoadedData()
 	RawDataAcessor<vec2> tex = _vertexData->chunk(VertexAttributeUsage::TexCoord0).accessData<vec2>(0);
 	
 	size_t index = 0;
+	size_t vertexIndex = 0;
 	
-	auto PUSH_VERTEX = [this, &pos, &norm, &tex, &index, hasTexCoords, hasNormals](const OBJVertex& vertex, const vec3& offset)
+	auto PUSH_VERTEX = [this, &pos, &norm, &tex, &vertexIndex, hasTexCoords, hasNormals](const uint32_t* corner, const vec3& offset)
 	{
+		size_t index = vertexIndex;
+		
 		{
-			ET_ASSERT(vertex[0] < _vertices.size());
-			pos[index] = _vertices[vertex[0]] - offset;
+			ET_ASSERT(corner[OBJAttribute_Position] < _vertices.size());
+			pos[index] = _vertices[corner[OBJAttribute_Position]] - offset;
 		}
 		
 		if (hasTexCoords)
 		{
-			ET_ASSERT(vertex[1] < _texCoords.size());
-			tex[index] = _texCoords[vertex[1]];
+			ET_ASSERT(corner[OBJAttribute_TexCoord] < _texCoords.size());
+			tex[index] = _texCoords[corner[OBJAttribute_TexCoord]];
 		}
 		
 		if (hasNormals)
 		{
-			ET_ASSERT(vertex[2] < _normals.size());
-			norm[index] = _normals[vertex[2]];
+			ET_ASSERT(corner[OBJAttribute_Normal] < _normals.size());
+			norm[index] = _normals[corner[OBJAttribute_Normal]];
 		}
 		
-		++index;
+		++vertexIndex;
 	};
 	
 	for (auto group : _groups)
@@ -724,36 +1038,38 @@ void OBJLoader::processLoadedData()
 		
 		vec3 center;
 		
+		const uint32_t* corners = group->corners.data();
+		size_t numCorners = group->corners.size() / OBJAttribute_max;
+		
 		if (_loadOptions & Option_CalculateTransforms)
 		{
-			size_t totalVertices = 0;
-			
-			for (auto face : group->faces)
-			{
-				size_t numTriangles = face.vertices.size() - 2;
-				for (size_t i = 1; i <= numTriangles; ++i)
-				{
-					center += _vertices[face.vertices[0][0]];
-					center += _vertices[face.vertices[i][0]];
-					center += _vertices[face.vertices[i+1][0]];
-					totalVertices += 3;
-				}
-			}
+			for (size_t i = 0; i < numCorners; ++i)
+				center += _vertices[corners[OBJAttribute_max * i + OBJAttribute_Position]];
 			
-			if (totalVertices > 0.0f)
-				center /= static_cast<float>(totalVertices);
+			if (numCorners > 0)
+				center /= static_cast<float>(numCorners);
 		}
 		
-		for (auto face : group->faces)
+		if (indexVertices)
 		{
-			size_t numTriangles = face.vertices.size() - 2;
-			for (size_t i = 1; i <= numTriangles; ++i)
+			std::unordered_map<OBJCorner, uint32_t, OBJCornerHash> groupVertices;
+			groupVertices.reserve(numCorners);
+			
+			for (size_t i = 0; i < numCorners; ++i, ++index)
 			{
-				PUSH_VERTEX(face.vertices[0], center);
-				PUSH_VERTEX(face.vertices[i], center);
-				PUSH_VERTEX(face.vertices[i+1], center);
+				const uint32_t* corner = corners + OBJAttribute_max * i;
+				auto inserted = groupVertices.emplace(corner, static_cast<uint32_t>(vertexIndex));
+				if (inserted.second)
+					PUSH_VERTEX(corner, center);
+				
+				_indices->setIndex(inserted.first->second, index);
 			}
 		}
+		else
+		{
+			for (size_t i = 0; i < numCorners; ++i, ++index)
+				PUSH_VERTEX(corners + OBJAttribute_max * i, center);
+		}
 		
 		Material::Pointer m;
 		
@@ -769,8 +1085,67 @@ void OBJLoader::processLoadedData()
 		_meshes.emplace_back(group->name, startIndex, index - startIndex, m, center);
 	}
 	
+	if (indexVertices)
+		_vertexData->resize(vertexIndex);
+	
 	if (!hasNormals)
-		primitives::calculateNormals(_vertexData, _indices, 0, _indices->primitivesCount());
+		primitives::calculateNormals(_vertexData, _indices, 0, _indices->primitivesCount(), jobSystem());
+	
+	if (optimizeMeshes)
+		optimizeLoadedMeshes();
+	
+	if (generateLods)
+		generateLevelsOfDetail();
+}
+
+void OBJLoader::optimizeLoadedMeshes()
+{
+	ET_PROFILE_SCOPE("OBJLoader::optimizeLoadedMeshes");
+	
+	primitives::VertexCacheStatistics before = primitives::analyzeVertexCache(_indices, 0, _indices->actualSize());
+	
+	for (const auto& mesh : _meshes)
+	{
+		primitives::optimizeVertexCache(_indices, mesh.start, mesh.count);
+		primitives::optimizeOverdraw(_vertexData, _indices, mesh.start, mesh.count);
+	}
+	primitives::optimizeVertexFetch(_vertexData, _indices);
+	
+	primitives::VertexCacheStatistics after = primitives::analyzeVertexCache(_indices, 0, _indices->actualSize());
+	
+	log::info("[OBJLoader] %s: %llu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", inputFileName.c_str(),
+		static_cast<unsigned long long>(_vertexData->size()), before.acmr, after.acmr, before.atvr, after.atvr);
+}
+
+void OBJLoader::generateLevelsOfDetail()
+{
+	ET_PROFILE_SCOPE("OBJLoader::generateLevelsOfDetail");
+	
+	const std::vector<float> ratios = { 0.5f, 0.25f, 0.125f };
+	
+	/*
+	 * Groups are indexed separately, so material boundaries are open borders
+	 */
+	primitives::SimplificationOptions options;
+	options.lockBorders = true;
+	
+	primitives::IndexRangeList ranges;
+	for (const auto& mesh : _meshes)
+		ranges.emplace_back(mesh.start, static_cast<uint32_t>(mesh.count));
+	
+	_levelsOfDetail = primitives::buildLevelsOfDetail(_vertexData, _indices, ranges, ratios, 0.001f, options);
+	
+	for (const auto& lod : _levelsOfDetail)
+	{
+		if (_loadOptions & Option_OptimizeMeshes)
+		{
+			for (const auto& range : lod.ranges)
+				primitives::optimizeVertexCache(_indices, range.start, range.count);
+		}
+		
+		log::info("[OBJLoader] %s: level of detail with %llu triangles, error %.5f, screen coverage %.3f",
+			inputFileName.c_str(), static_cast<unsigned long long>(lod.trianglesCount), lod.error, lod.screenCoverage);
+	}
 }
 
 s3d::ElementContainer::Pointer OBJLoader::generateVertexBuffers()
@@ -790,9 +1165,10 @@ s3d::ElementContainer::Pointer OBJLoader::generateVertexBuffers()
 	vao->setBuffers(_rc->vertexBufferFactory().createVertexBuffer("model-vb", _vertexData, BufferDrawType::Static),
 		_rc->vertexBufferFactory().createIndexBuffer("model-ib", _indices, BufferDrawType::Static));
 
-	for (const auto& i : _meshes)
+	for (size_t m = 0, me = _meshes.size(); m < me; ++m)
 	{
-		s3d::Element::Pointer object;
+		const auto& i = _meshes[m];
+		Mesh::Pointer object;
 		
 		if (_loadOptions & Option_SupportMeshes)
 		{
@@ -805,6 +1181,16 @@ s3d::ElementContainer::Pointer OBJLoader::generateVertexBuffers()
 			object = Mesh::Pointer::create(i.name, vao, i.material, i.start, i.count, result.ptr());
 		}
 		
+		for (size_t l = 0, le = _levelsOfDetail.size(); l < le; ++l)
+		{
+			const auto& range = _levelsOfDetail[l].ranges[m];
+			if (range.count == 0)
+				continue;
+			
+			auto lod = Mesh::Pointer::create(i.name + "-lod" + intToStr(l + 1), vao, i.material, range.start, range.count);
+			object->attachLod(l + 1, lod, _levelsOfDetail[l].screenCoverage);
+		}
+		
 		object->setTranslation(i.center);
 	}
 
@@ -0,0 +1,22 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/tools.h>
+#include <et/rendering/renderingcaps.h>
+
+using namespace et;
+
+void RenderingCapabilities::checkCaps()
+{
+	_maxTextureSize = 16384;
+	_maxCubemapTextureSize = 16384;
+	_maxSamples = 1;
+	_maxAnisotropyLevel = 1.0f;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(TextureFormat::max); ++i)
+		_textureFormatSupport[static_cast<TextureFormat>(i)] = 1;
+}
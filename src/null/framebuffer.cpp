@@ -0,0 +1,292 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rendering/framebuffer.h>
+#include <et/rendering/rendercontext.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+Framebuffer::Framebuffer(RenderContext* rc, const FramebufferDescription& desc,
+	const std::string& aName) : APIObject(aName), _rc(rc), _description(desc)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	uint32_t framebuffer = NullRenderDevice::instance().generateHandle();
+	setAPIHandle(framebuffer);
+	
+	_rc->renderState().bindFramebuffer(framebuffer);
+	
+	bool hasColor = (_description.numColorRenderTargets > 0) &&
+		(_description.colorInternalformat != TextureFormat::Invalid) &&
+		(_description.colorIsRenderbuffer || (_description.colorFormat != TextureFormat::Invalid));
+	
+	bool hasDepth = (_description.depthInternalformat != TextureFormat::Invalid) &&
+		(_description.depthIsRenderbuffer || (_description.depthFormat != TextureFormat::Invalid));
+	
+	if (hasColor)
+	{
+		if (_description.colorIsRenderbuffer)
+		{
+			createOrUpdateColorRenderbuffer();
+		}
+		else
+		{
+			for (size_t i = 0; i < _description.numColorRenderTargets; ++i)
+			{
+				Texture::Pointer target;
+				if (_description.isCubemap)
+				{
+					target = _rc->textureFactory().genCubeTexture(_description.colorInternalformat, _description.size.x,
+						_description.colorFormat, _description.colorType, name() + "_color_" + intToStr(i));
+				}
+				else
+				{
+					size_t dataSize = _description.size.square() *
+						bitsPerPixelForTextureFormat(_description.colorInternalformat, _description.colorType) / 8;
+					
+					target = _rc->textureFactory().genTexture(TextureTarget::Texture_2D, _description.colorInternalformat,
+						_description.size, _description.colorFormat, _description.colorType,
+						BinaryDataStorage(dataSize, 0), name() + "_color_" + intToStr(i));
+				}
+				addRenderTarget(target);
+			}
+		}
+	}
+	
+	if (hasDepth)
+	{
+		if (_description.depthIsRenderbuffer)
+		{
+			createOrUpdateDepthRenderbuffer();
+		}
+		else
+		{
+			Texture::Pointer depthTarget;
+			if (_description.isCubemap)
+			{
+				depthTarget = _rc->textureFactory().genCubeTexture(_description.depthInternalformat, _description.size.x,
+					_description.depthFormat, _description.depthType, name() + "_depth");
+			}
+			else
+			{
+				size_t dataSize = _description.size.square() *
+					bitsPerPixelForTextureFormat(_description.depthInternalformat, _description.depthType) / 8;
+				
+				depthTarget = _rc->textureFactory().genTexture(TextureTarget::Texture_2D, _description.depthInternalformat,
+					_description.size, _description.depthFormat, _description.depthType,
+					BinaryDataStorage(dataSize, 0), name() + "_depth");
+			}
+			setDepthTarget(depthTarget);
+		}
+	}
+#endif
+}
+
+Framebuffer::Framebuffer(RenderContext* rc, uint32_t fboId, const std::string& aName) :
+	APIObject(aName), _rc(rc)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	setAPIHandle(fboId);
+	_description.size = rc->parameters().contextSize;
+#endif
+}
+
+Framebuffer::~Framebuffer()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	_rc->renderState().frameBufferDeleted(static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+bool Framebuffer::checkStatus()
+{
+	return true;
+}
+
+void Framebuffer::addRenderTarget(const Texture::Pointer& rt)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (rt.invalid() || (rt->size() != _description.size)) return;
+	
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+	_renderTargets.push_back(rt);
+#endif
+}
+
+void Framebuffer::setDepthTarget(const Texture::Pointer& rt)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (rt.invalid() || (rt->size() != _description.size)) return;
+	
+	_depthBuffer = rt;
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Framebuffer::setDepthTarget(const Texture::Pointer& texture, uint32_t)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (texture.invalid() || (texture->size() != _description.size)) return;
+	
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Framebuffer::addSameRendertarget()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_renderTargets.empty()) return;
+	
+	Texture::Pointer basic = _renderTargets.front();
+	
+	std::string texName = name() + "_color_" + intToStr(_renderTargets.size() + 1);
+	
+	Texture::Pointer target;
+	if (_description.isCubemap)
+	{
+		target = _rc->textureFactory().genCubeTexture(basic->internalFormat(), basic->width(),
+			basic->format(), basic->dataType(), texName);
+	}
+	else
+	{
+		BinaryDataStorage emptyData(basic->size().square() *
+			bitsPerPixelForTextureFormat(basic->internalFormat(), basic->dataType()) / 8, 0);
+		
+		target = _rc->textureFactory().genTexture(basic->target(), basic->internalFormat(),
+			basic->size(), basic->format(), basic->dataType(), emptyData, texName);
+	}
+	
+	addRenderTarget(target);
+#endif
+}
+
+void Framebuffer::setCurrentRenderTarget(const Texture::Pointer& texture)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(texture.valid());
+	setCurrentRenderTarget(texture, texture->target());
+#endif
+}
+
+void Framebuffer::setCurrentRenderTarget(const Texture::Pointer& texture, TextureTarget)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(texture.valid());
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Framebuffer::setCurrentRenderTarget(size_t index)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(index < _renderTargets.size());
+	ET_ASSERT(_renderTargets[index].valid());
+	
+	setCurrentRenderTarget(_renderTargets.at(index));
+#endif
+}
+
+void Framebuffer::setCurrentCubemapFace(uint32_t faceIndex)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(_description.isCubemap && (faceIndex < 6));
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Framebuffer::createOrUpdateColorRenderbuffer()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_colorRenderbuffer == 0)
+		_colorRenderbuffer = NullRenderDevice::instance().generateHandle();
+	
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+	_rc->renderState().bindRenderbuffer(_colorRenderbuffer);
+	
+	setColorRenderbuffer(_colorRenderbuffer);
+#endif
+}
+
+void Framebuffer::createOrUpdateDepthRenderbuffer()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_depthRenderbuffer == 0)
+		_depthRenderbuffer = NullRenderDevice::instance().generateHandle();
+	
+	_rc->renderState().bindFramebuffer(static_cast<uint32_t>(apiHandle()));
+	_rc->renderState().bindRenderbuffer(_depthRenderbuffer);
+	
+	setDepthRenderbuffer(_depthRenderbuffer);
+#endif
+}
+
+void Framebuffer::resize(const vec2i& sz)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_description.size == sz) return;
+	
+	_description.size = sz;
+	
+	if (_description.colorIsRenderbuffer && (_colorRenderbuffer != 0))
+		createOrUpdateColorRenderbuffer();
+	
+	for (auto rt : _renderTargets)
+	{
+		TextureDescription::Pointer desc = rt->description();
+		desc->size = sz;
+		desc->data.resize(desc->layersCount * desc->dataSizeForAllMipLevels());
+		rt->updateData(_rc, desc);
+	}
+	
+	if (_description.depthIsRenderbuffer && (_depthRenderbuffer != 0))
+	{
+		createOrUpdateDepthRenderbuffer();
+	}
+	else if (_depthBuffer.valid())
+	{
+		auto desc = _depthBuffer->description();
+		desc->size = sz;
+		desc->data.resize(desc->layersCount * desc->dataSizeForAllMipLevels());
+		_depthBuffer->updateData(_rc, desc);
+	}
+#endif
+}
+
+void Framebuffer::forceSize(const vec2i& sz)
+{
+	_description.size = sz;
+}
+
+void Framebuffer::resolveMultisampledTo(Framebuffer::Pointer framebuffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	_rc->renderState().bindReadFramebuffer(static_cast<uint32_t>(apiHandle()));
+	_rc->renderState().bindDrawFramebuffer(static_cast<uint32_t>(framebuffer->apiHandle()));
+#endif
+}
+
+void Framebuffer::invalidate(bool, bool)
+{
+}
+
+void Framebuffer::setColorRenderbuffer(uint32_t r)
+{
+	_colorRenderbuffer = r;
+}
+
+void Framebuffer::setDepthRenderbuffer(uint32_t r)
+{
+	_depthRenderbuffer = r;
+}
+
+void Framebuffer::setDrawBuffersCount(int32_t value)
+{
+	_drawBuffers = value;
+	
+	if (_rc->renderState().actualState().boundFramebuffer == apiHandle())
+		_rc->renderState().setDrawBuffersCount(value);
+}
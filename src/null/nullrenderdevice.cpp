@@ -0,0 +1,119 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/primitives/primitives.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+inline size_t primitiveCountForDraw(PrimitiveType pt, size_t count)
+{
+	size_t minimalCount = (pt == PrimitiveType::TriangleStrips) ? 3 : ((pt == PrimitiveType::LineStrip) ? 2 : 1);
+	return (count < minimalCount) ? 0 : primitives::primitiveCountForIndexCount(count, pt);
+}
+
+uint32_t NullRenderDevice::generateHandle()
+{
+	return static_cast<uint32_t>(_handleCounter.retain());
+}
+
+void NullRenderDevice::beginFrame()
+{
+	/*
+	 * keep work recorded between frames (resource uploads, etc.) in totals
+	 */
+	accumulateStatistics();
+	_commands.clear();
+}
+
+void NullRenderDevice::endFrame()
+{
+	_lastFrame = _currentFrame;
+	accumulateStatistics();
+
+	++_framesRendered;
+}
+
+void NullRenderDevice::accumulateStatistics()
+{
+	_total.commands += _currentFrame.commands;
+	_total.drawCalls += _currentFrame.drawCalls;
+	_total.primitives += _currentFrame.primitives;
+	_total.stateChanges += _currentFrame.stateChanges;
+	_total.uploadedBytes += _currentFrame.uploadedBytes;
+
+	_currentFrame = NullRenderStatistics();
+}
+
+void NullRenderDevice::resetStatistics()
+{
+	_currentFrame = NullRenderStatistics();
+	_lastFrame = NullRenderStatistics();
+	_total = NullRenderStatistics();
+	_framesRendered = 0;
+}
+
+void NullRenderDevice::addCommand(const NullCommand& cmd)
+{
+	++_currentFrame.commands;
+
+	if (_recordingEnabled)
+		_commands.push_back(cmd);
+}
+
+void NullRenderDevice::record(NullCommandType type, uint32_t object)
+{
+	if ((type != NullCommandType::Clear) && (type != NullCommandType::ReadPixels))
+		++_currentFrame.stateChanges;
+
+	addCommand(NullCommand(type, object));
+}
+
+void NullRenderDevice::recordDraw(PrimitiveType pt, uint32_t indexBuffer, size_t first, size_t count, size_t instances)
+{
+	NullCommand cmd((instances > 1) ? NullCommandType::DrawInstanced : NullCommandType::Draw, indexBuffer);
+	cmd.primitiveType = pt;
+	cmd.first = first;
+	cmd.count = count;
+	cmd.instances = instances;
+
+	++_currentFrame.drawCalls;
+	_currentFrame.primitives += instances * primitiveCountForDraw(pt, count);
+
+	addCommand(cmd);
+}
+
+void NullRenderDevice::recordUpload(NullCommandType type, uint32_t object, size_t dataSize)
+{
+	NullCommand cmd(type, object);
+	cmd.count = dataSize;
+
+	_currentFrame.uploadedBytes += dataSize;
+
+	addCommand(cmd);
+}
+
+void* NullRenderDevice::mapBuffer(uint32_t buffer, size_t dataSize)
+{
+	BinaryDataStorage& storage = _mappedBuffers[buffer];
+
+	if (storage.size() < dataSize)
+		storage.resize(dataSize);
+
+	return storage.data();
+}
+
+void NullRenderDevice::unmapBuffer(uint32_t buffer)
+{
+	auto i = _mappedBuffers.find(buffer);
+
+	if (i != _mappedBuffers.end())
+	{
+		recordUpload(NullCommandType::BufferData, buffer, i->second.size());
+		_mappedBuffers.erase(i);
+	}
+}
@@ -0,0 +1,426 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/application.h>
+#include <et/camera/camera.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/program.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+/*
+ * Uniform types are reported with the same values OpenGL uses
+ */
+enum : uint32_t
+{
+	UniformType_Int = 0x1404,
+	UniformType_Float = 0x1406,
+	UniformType_Vec2 = 0x8B50,
+	UniformType_Vec3 = 0x8B51,
+	UniformType_Vec4 = 0x8B52,
+	UniformType_Mat3 = 0x8B5B,
+	UniformType_Mat4 = 0x8B5C,
+	UniformType_Sampler2D = 0x8B5E,
+	UniformType_SamplerCube = 0x8B60,
+	UniformType_Sampler2DShadow = 0x8B62,
+};
+
+uint32_t uniformTypeForName(const std::string&);
+void parseUniformDeclarations(const std::string&, StringList&, std::vector<uint32_t>&);
+
+inline void setCachedUniform(UniformCache& cache, int location, const void* value, size_t size, bool forced, uint32_t program)
+{
+	if (cache.update(location, value, size, forced))
+		NullRenderDevice::instance().record(NullCommandType::Uniform, program);
+}
+
+Program::Program(RenderContext* rc) : _rc(rc),
+	_mModelViewLocation(-1), _mModelViewProjectionLocation(-1), _vCameraLocation(-1),
+	_vPrimaryLightLocation(-1), _mLightProjectionMatrixLocation(-1), _mTransformLocation(-1),
+	_mInstanceTransformLocation(-1)
+{
+#if defined(ET_CONSOLE_APPLICATION)
+	ET_FAIL("Attempt to create Program in console application");
+#endif
+}
+
+Program::Program(RenderContext* rc, const std::string& vertexShader, const std::string& geometryShader,
+	const std::string& fragmentShader, const std::string& objName, const std::string& origin,
+	const StringList& defines) : APIObject(objName, origin), _rc(rc), _mModelViewLocation(-1),
+	_mModelViewProjectionLocation(-1), _vCameraLocation(-1), _vPrimaryLightLocation(-1),
+	_mLightProjectionMatrixLocation(-1), _mTransformLocation(-1), _mInstanceTransformLocation(-1), _defines(defines)
+{
+#if defined(ET_CONSOLE_APPLICATION)
+	ET_FAIL("Attempt to create Program in console application");
+#else
+	buildProgram(vertexShader, geometryShader, fragmentShader);
+#endif
+}
+
+Program::~Program()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	uint32_t program = static_cast<uint32_t>(apiHandle());
+	if (program != 0)
+	{
+		_rc->renderState().programDeleted(program);
+	}
+#endif
+}
+
+Program::UniformMap::const_iterator Program::findUniform(const std::string& name) const
+{
+	ET_ASSERT(apiHandleValid());
+	return _uniforms.find(name);
+}
+
+int Program::getUniformLocation(const std::string& uniform) const
+{
+	auto i = findUniform(uniform);
+	return (i == _uniforms.end()) ? -1 : i->second.location;
+}
+
+uint32_t Program::getUniformType(const std::string& uniform) const
+{
+	auto i = findUniform(uniform);
+	return (i == _uniforms.end()) ? 0 : i->second.type;
+}
+
+Program::Uniform Program::getUniform(const std::string& uniform) const
+{
+	auto i = findUniform(uniform);
+	return (i == _uniforms.end()) ? Program::Uniform() : i->second;
+}
+
+void Program::setModelViewMatrix(const mat4& m, bool forced)
+{
+	setUniform(_mModelViewLocation, UniformType_Mat4, m, forced);
+}
+
+void Program::setMVPMatrix(const mat4& m, bool forced)
+{
+	setUniform(_mModelViewProjectionLocation, UniformType_Mat4, m, forced);
+}
+
+void Program::setCameraPosition(const vec3& p, bool forced)
+{
+	setUniform(_vCameraLocation, UniformType_Vec3, p, forced);
+}
+
+void Program::setPrimaryLightPosition(const vec3& p, bool forced)
+{
+	setUniform(_vPrimaryLightLocation, UniformType_Vec3, p, forced);
+}
+
+void Program::setLightProjectionMatrix(const mat4& m, bool forced)
+{
+	setUniform(_mLightProjectionMatrixLocation, UniformType_Mat4, m, forced);
+}
+
+void Program::setTransformMatrix(const mat4 &m, bool forced)
+{
+	setUniform(_mTransformLocation, UniformType_Mat4, m, forced);
+}
+
+void Program::setInstanceTransforms(const mat4* m, size_t count)
+{
+	setUniform(_mInstanceTransformLocation, UniformType_Mat4, m, count);
+}
+
+void Program::setCameraProperties(const Camera& cam)
+{
+	setModelViewMatrix(cam.modelViewMatrix());
+	setMVPMatrix(cam.modelViewProjectionMatrix());
+	setCameraPosition(cam.position());
+}
+
+void Program::buildProgram(const std::string& vertex_source, const std::string& geom_source,
+	const std::string& frag_source)
+{
+	_uniformCache.clear();
+	_uniforms.clear();
+
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (apiHandleInvalid())
+		setAPIHandle(NullRenderDevice::instance().generateHandle());
+
+	/*
+	 * There is no compiler, so uniforms are taken from declarations in the sources
+	 * and receive sequential locations
+	 */
+	StringList names;
+	std::vector<uint32_t> types;
+	parseUniformDeclarations(vertex_source, names, types);
+	parseUniformDeclarations(geom_source, names, types);
+	parseUniformDeclarations(frag_source, names, types);
+
+	for (size_t i = 0, e = names.size(); i < e; ++i)
+	{
+		if (_uniforms.count(names.at(i)) > 0) continue;
+
+		Program::Uniform P;
+		P.type = types.at(i);
+		P.location = static_cast<int>(_uniforms.size());
+		_uniforms[names.at(i)] = P;
+		_uniformCache.addUniform(names.at(i), P);
+
+		if (names.at(i) == "mModelView")
+			_mModelViewLocation = P.location;
+
+		if (names.at(i) == "mModelViewProjection")
+			_mModelViewProjectionLocation = P.location;
+
+		if (names.at(i) == "vCamera")
+			_vCameraLocation = P.location;
+
+		if (names.at(i) == "vPrimaryLight")
+			_vPrimaryLightLocation = P.location;
+
+		if (names.at(i) == "mLightProjectionMatrix")
+			_mLightProjectionMatrixLocation = P.location;
+
+		if (names.at(i) == "mTransform")
+			_mTransformLocation = P.location;
+
+		if (names.at(i) == "mInstanceTransform")
+			_mInstanceTransformLocation = P.location;
+	}
+
+	_rc->renderState().bindProgram(static_cast<uint32_t>(apiHandle()), true);
+#endif
+}
+
+int Program::link()
+{
+	return 1;
+}
+
+void Program::validate() const
+{
+}
+
+/*
+ * Uniform setters
+ */
+
+void Program::setUniform(int nLoc, uint32_t, int32_t value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	int32_t intValue = static_cast<int32_t>(value);
+	setCachedUniform(_uniformCache, nLoc, &intValue, sizeof(intValue), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, uint32_t value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	int32_t intValue = static_cast<int32_t>(value);
+	setCachedUniform(_uniformCache, nLoc, &intValue, sizeof(intValue), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, long long value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	int32_t intValue = static_cast<int32_t>(value);
+	setCachedUniform(_uniformCache, nLoc, &intValue, sizeof(intValue), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, unsigned long long value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	int32_t intValue = static_cast<int32_t>(value);
+	setCachedUniform(_uniformCache, nLoc, &intValue, sizeof(intValue), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const unsigned long value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	int32_t intValue = static_cast<int32_t>(value);
+	setCachedUniform(_uniformCache, nLoc, &intValue, sizeof(intValue), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const float value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec2& value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec3& value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec4& value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniformDirectly(int nLoc, uint32_t, const vec4& value)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), true, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const mat3& value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const mat4& value, bool forced)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), forced, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniformDirectly(int nLoc, uint32_t, const mat4& value)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (nLoc == -1) return;
+	setCachedUniform(_uniformCache, nLoc, &value, sizeof(value), true, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec2* value, size_t amount)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((nLoc == -1) || (amount == 0)) return;
+	setCachedUniform(_uniformCache, nLoc, value, amount * sizeof(vec2), false, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec3* value, size_t amount)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((nLoc == -1) || (amount == 0)) return;
+	setCachedUniform(_uniformCache, nLoc, value, amount * sizeof(vec3), false, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const vec4* value, size_t amount)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((nLoc == -1) || (amount == 0)) return;
+	setCachedUniform(_uniformCache, nLoc, value, amount * sizeof(vec4), false, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+void Program::setUniform(int nLoc, uint32_t, const mat4* value, size_t amount)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((nLoc == -1) || (amount == 0)) return;
+	setCachedUniform(_uniformCache, nLoc, value, amount * sizeof(mat4), false, static_cast<uint32_t>(apiHandle()));
+#endif
+}
+
+uint32_t uniformTypeForName(const std::string& name)
+{
+	static const std::map<std::string, uint32_t> types =
+	{
+		{ "int", UniformType_Int },
+		{ "bool", UniformType_Int },
+		{ "float", UniformType_Float },
+		{ "vec2", UniformType_Vec2 },
+		{ "vec3", UniformType_Vec3 },
+		{ "vec4", UniformType_Vec4 },
+		{ "mat3", UniformType_Mat3 },
+		{ "mat4", UniformType_Mat4 },
+		{ "sampler2D", UniformType_Sampler2D },
+		{ "sampler2DRect", UniformType_Sampler2D },
+		{ "samplerCube", UniformType_SamplerCube },
+		{ "sampler2DShadow", UniformType_Sampler2DShadow },
+	};
+
+	auto i = types.find(name);
+	return (i == types.end()) ? 0 : i->second;
+}
+
+void parseUniformDeclarations(const std::string& source, StringList& names, std::vector<uint32_t>& types)
+{
+	static const std::string tokenDelimiters = " \t\r\n;,";
+
+	std::vector<std::string> tokens;
+	std::string token;
+	for (char c : source)
+	{
+		bool isDelimiter = tokenDelimiters.find(c) != std::string::npos;
+
+		if (isDelimiter && !token.empty())
+		{
+			tokens.push_back(token);
+			token.clear();
+		}
+
+		if (c == ';')
+			tokens.push_back(";");
+		else if (!isDelimiter)
+			token.push_back(c);
+	}
+
+	for (size_t i = 0, e = tokens.size(); i < e; ++i)
+	{
+		if (tokens.at(i) != "uniform") continue;
+
+		size_t typeIndex = i + 1;
+		while ((typeIndex < e) && ((tokens.at(typeIndex) == "lowp") ||
+			(tokens.at(typeIndex) == "mediump") || (tokens.at(typeIndex) == "highp")))
+		{
+			++typeIndex;
+		}
+
+		if (typeIndex >= e) break;
+
+		uint32_t type = uniformTypeForName(tokens.at(typeIndex));
+		if (type == 0) continue;
+
+		for (size_t n = typeIndex + 1; (n < e) && (tokens.at(n) != ";"); ++n)
+		{
+			size_t initializer = tokens.at(n).find('=');
+			std::string name = tokens.at(n).substr(0, etMin(tokens.at(n).find('['), initializer));
+
+			if (!name.empty())
+			{
+				names.push_back(name);
+				types.push_back(type);
+			}
+
+			if (initializer != std::string::npos) break;
+		}
+	}
+}
@@ -0,0 +1,633 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/vertexbuffer/vertexdeclaration.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/renderstate.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+/*
+ * Values are the same as in OpenGL, so code passing them explicitly keeps working
+ */
+static const uint32_t arrayBufferTarget = 0x8892;
+static const uint32_t elementArrayBufferTarget = 0x8893;
+
+RenderState::State::State()
+{
+	enabledVertexAttributes.fill(0);
+	drawBuffers.fill(0);
+}
+
+PreservedRenderStateScope::PreservedRenderStateScope(RenderContext* rc, bool shouldApplyBefore) :
+	_rc(rc), _state(RenderState::currentState())
+{
+	if (shouldApplyBefore)
+		_rc->renderState().applyState(_state);
+}
+
+PreservedRenderStateScope::~PreservedRenderStateScope()
+{
+	_rc->renderState().applyState(_state);
+}
+
+void RenderState::setRenderContext(RenderContext* rc)
+{
+	_rc = rc;
+
+#if !defined(ET_CONSOLE_APPLICATION)
+	_currentState = RenderState::currentState();
+	NullRenderDevice::instance().setActiveRenderState(this);
+#endif
+}
+
+void RenderState::setMainViewportSize(const vec2i& sz, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (!force && (sz.x == _currentState.mainViewportSize.x) && (sz.y == _currentState.mainViewportSize.y)) return;
+
+	_currentState.mainViewportSize = sz;
+	_currentState.mainViewportSizeFloat = vec2(static_cast<float>(sz.x), static_cast<float>(sz.y));
+
+	bool shouldSetViewport = (_currentState.boundFramebuffer == 0) ||
+		(_defaultFramebuffer.valid() && (_currentState.boundFramebuffer == _defaultFramebuffer->apiHandle()));
+
+	if (shouldSetViewport)
+	{
+		_currentState.viewportSize = sz;
+		_currentState.viewportSizeFloat = _currentState.mainViewportSizeFloat;
+		NullRenderDevice::instance().record(NullCommandType::Viewport);
+	}
+#endif
+}
+
+void RenderState::setViewportSize(const vec2i& sz, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (!force && (sz.x == _currentState.viewportSize.x) && (sz.y == _currentState.viewportSize.y)) return;
+
+	_currentState.viewportSize = sz;
+	_currentState.viewportSizeFloat = vec2(static_cast<float>(sz.x), static_cast<float>(sz.y));
+	NullRenderDevice::instance().record(NullCommandType::Viewport);
+#endif
+}
+
+void RenderState::setActiveTextureUnit(uint32_t unit, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((unit != _currentState.activeTextureUnit) || force)
+	{
+		_currentState.activeTextureUnit = unit;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::bindTexture(uint32_t unit, uint32_t texture, TextureTarget target, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	setActiveTextureUnit(unit, force);
+
+	if (force || (_currentState.boundTextures[target][unit] != texture))
+	{
+		_currentState.boundTextures[target][unit] = texture;
+		NullRenderDevice::instance().record(NullCommandType::BindTexture, texture);
+	}
+#endif
+}
+
+void RenderState::bindProgram(uint32_t program, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (program != _currentState.boundProgram))
+	{
+		_currentState.boundProgram = program;
+		NullRenderDevice::instance().record(NullCommandType::BindProgram, program);
+	}
+#endif
+}
+
+void RenderState::bindProgram(const Program::Pointer& prog, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(prog.valid());
+	bindProgram(static_cast<uint32_t>(prog->apiHandle()), force);
+#endif
+}
+
+void RenderState::bindBuffer(uint32_t target, uint32_t buffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if ((target == arrayBufferTarget) && (force || (_currentState.boundArrayBuffer != buffer)))
+	{
+		_currentState.boundArrayBuffer = buffer;
+		NullRenderDevice::instance().record(NullCommandType::BindBuffer, buffer);
+	}
+	else if ((target == elementArrayBufferTarget) && (force || (_currentState.boundElementArrayBuffer != buffer)))
+	{
+		_currentState.boundElementArrayBuffer = buffer;
+		NullRenderDevice::instance().record(NullCommandType::BindBuffer, buffer);
+	}
+	else if ((target != arrayBufferTarget) && (target != elementArrayBufferTarget))
+	{
+		log::warning("Trying to bind buffer %u to unknown target %u", buffer, target);
+	}
+#endif
+}
+
+void RenderState::setVertexAttributes(const VertexDeclaration& decl, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	for (uint32_t i = 0; i < VertexAttributeUsage_max; ++i)
+		setVertexAttribEnabled(i, decl.has(static_cast<VertexAttributeUsage>(i)), force);
+
+	setVertexAttributesBaseIndex(decl, 0);
+#endif
+}
+
+void RenderState::setVertexAttributesBaseIndex(const VertexDeclaration& decl, size_t index, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	for (size_t i = 0; i < decl.numElements(); ++i)
+	{
+		const VertexElement& e = decl.element(i);
+		size_t dataOffset = index * (decl.interleaved() ? decl.dataSize() : vertexAttributeTypeSize(e.type()));
+		setVertexAttribPointer(e, dataOffset, force);
+	}
+#endif
+}
+
+void RenderState::bindBuffer(const VertexBuffer& buffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (buffer.valid())
+	{
+		bindBuffer(arrayBufferTarget, static_cast<uint32_t>(buffer->apiHandle()), force);
+		setVertexAttributes(buffer->declaration(), force);
+	}
+	else
+	{
+		bindBuffer(arrayBufferTarget, 0, force);
+	}
+#endif
+}
+
+void RenderState::bindBuffer(const IndexBuffer& buf, bool force)
+{
+	bindBuffer(elementArrayBufferTarget, buf.valid() ? static_cast<uint32_t>(buf->apiHandle()) : 0, force);
+}
+
+void RenderState::bindBuffers(const VertexBuffer& vb, const IndexBuffer& ib, bool force)
+{
+	bindBuffer(vb, force);
+	bindBuffer(ib, force);
+}
+
+void RenderState::bindVertexArray(uint32_t buffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.boundVertexArrayObject != buffer))
+	{
+		_currentState.boundVertexArrayObject = buffer;
+		NullRenderDevice::instance().record(NullCommandType::BindVertexArray, buffer);
+	}
+#endif
+}
+
+void RenderState::bindVertexArray(const VertexArrayObject& vao, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	bindVertexArray(vao.valid() ? static_cast<uint32_t>(vao->apiHandle()) : 0, force);
+#endif
+}
+
+void RenderState::resetBufferBindings()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	bindVertexArray(0);
+	bindBuffer(elementArrayBufferTarget, 0);
+	bindBuffer(arrayBufferTarget, 0);
+#endif
+}
+
+void RenderState::bindTexture(uint32_t unit, const Texture::Pointer& texture, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (texture.valid())
+		bindTexture(unit, static_cast<uint32_t>(texture->apiHandle()), texture->target(), force);
+	else
+		bindTexture(unit, 0, TextureTarget::Texture_2D, force);
+#endif
+}
+
+void RenderState::bindFramebuffer(uint32_t framebuffer, bool force)
+{
+	bindFramebuffer(framebuffer, 0, force);
+}
+
+void RenderState::bindFramebuffer(uint32_t framebuffer, uint32_t, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.boundFramebuffer != framebuffer) ||
+		(_currentState.boundDrawFramebuffer != framebuffer) ||
+		(_currentState.boundReadFramebuffer != framebuffer))
+	{
+		_currentState.boundDrawFramebuffer = framebuffer;
+		_currentState.boundReadFramebuffer = framebuffer;
+		_currentState.boundFramebuffer = framebuffer;
+		NullRenderDevice::instance().record(NullCommandType::BindFramebuffer, framebuffer);
+	}
+#endif
+}
+
+void RenderState::bindReadFramebuffer(uint32_t framebuffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	bool alreadyBound = (_currentState.boundReadFramebuffer == framebuffer) ||
+		(_currentState.boundFramebuffer == framebuffer);
+
+	if (force || !alreadyBound)
+	{
+		_currentState.boundReadFramebuffer = framebuffer;
+		NullRenderDevice::instance().record(NullCommandType::BindFramebuffer, framebuffer);
+	}
+#endif
+}
+
+void RenderState::bindDrawFramebuffer(uint32_t framebuffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	bool alreadyBound = (_currentState.boundDrawFramebuffer == framebuffer) ||
+		(_currentState.boundFramebuffer == framebuffer);
+
+	if (force || !alreadyBound)
+	{
+		_currentState.boundDrawFramebuffer = framebuffer;
+		NullRenderDevice::instance().record(NullCommandType::BindFramebuffer, framebuffer);
+	}
+#endif
+}
+
+void RenderState::bindFramebuffer(const Framebuffer::Pointer& fbo, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (fbo.valid())
+	{
+		bindFramebuffer(static_cast<uint32_t>(fbo->apiHandle()), 0, force);
+
+		setViewportSize(fbo->size(), force);
+
+		if (fbo->hasRenderTargets())
+			setDrawBuffersCount(fbo->drawBuffersCount());
+	}
+	else
+	{
+		bindFramebuffer(0, 0, force);
+		setViewportSize(_currentState.mainViewportSize, force);
+	}
+#endif
+}
+
+void RenderState::bindRenderbuffer(uint32_t renderbuffer, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.boundRenderbuffer != renderbuffer))
+	{
+		_currentState.boundRenderbuffer = renderbuffer;
+		NullRenderDevice::instance().record(NullCommandType::State, renderbuffer);
+	}
+#endif
+}
+
+void RenderState::setDefaultFramebuffer(const Framebuffer::Pointer& framebuffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	_defaultFramebuffer = framebuffer;
+
+	if (_defaultFramebuffer.valid())
+		setMainViewportSize(_defaultFramebuffer->size());
+#endif
+}
+
+void RenderState::bindDefaultFramebuffer(bool force)
+{
+	bindFramebuffer(_defaultFramebuffer, force);
+}
+
+void RenderState::setDrawBuffersCount(int32_t count)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	for (int32_t i = 0; i < static_cast<int32_t>(MaxDrawBuffers); ++i)
+		_currentState.drawBuffers[i] = (i < count) ? 1 : 0;
+
+	NullRenderDevice::instance().record(NullCommandType::State);
+#endif
+}
+
+void RenderState::setDepthMask(bool enable, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.depthMask != enable))
+	{
+		_currentState.depthMask = enable;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setDepthTest(bool enable, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (enable != _currentState.depthTestEnabled))
+	{
+		_currentState.depthTestEnabled = enable;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setDepthFunc(DepthFunc func, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (func != _currentState.lastDepthFunc))
+	{
+		_currentState.lastDepthFunc = func;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setSeparateBlend(bool enable, BlendState color, BlendState alpha, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.blendEnabled != enable))
+	{
+		_currentState.blendEnabled = enable;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+
+	bool shouldSet = force;
+
+	if ((color != BlendState::Current) && (color != _currentState.lastColorBlend))
+	{
+		shouldSet = true;
+		_currentState.lastColorBlend = color;
+	}
+
+	if ((alpha != BlendState::Current) && (alpha != _currentState.lastAlphaBlend))
+	{
+		shouldSet = true;
+		_currentState.lastAlphaBlend = alpha;
+	}
+
+	if (shouldSet)
+		NullRenderDevice::instance().record(NullCommandType::State);
+#endif
+}
+
+void RenderState::setBlend(bool enable, BlendState blend, bool force)
+{
+	setSeparateBlend(enable, blend, blend, force);
+}
+
+void RenderState::vertexArrayDeleted(uint32_t buffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_currentState.boundVertexArrayObject == buffer)
+	{
+		bindBuffer(arrayBufferTarget, 0, true);
+		bindBuffer(elementArrayBufferTarget, 0, true);
+		bindVertexArray(0);
+	}
+#endif
+}
+
+void RenderState::vertexBufferDeleted(uint32_t buffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_currentState.boundArrayBuffer == buffer)
+		bindBuffer(arrayBufferTarget, 0);
+#endif
+}
+
+void RenderState::indexBufferDeleted(uint32_t buffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_currentState.boundElementArrayBuffer == buffer)
+		bindBuffer(elementArrayBufferTarget, 0);
+#endif
+}
+
+void RenderState::programDeleted(uint32_t program)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_currentState.boundProgram == program)
+		bindProgram(0, true);
+#endif
+}
+
+void RenderState::textureDeleted(uint32_t texture)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	for (auto& target : _currentState.boundTextures)
+	{
+		for (auto& unit : target.second)
+		{
+			if (unit.second == texture)
+				unit.second = 0;
+		}
+	}
+#endif
+}
+
+void RenderState::frameBufferDeleted(uint32_t buffer)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (_defaultFramebuffer.valid() && (_defaultFramebuffer->apiHandle() == buffer))
+		_defaultFramebuffer = Framebuffer::Pointer();
+
+	if (_currentState.boundFramebuffer == buffer)
+		bindDefaultFramebuffer();
+#endif
+}
+
+void RenderState::setVertexAttribEnabled(uint32_t attrib, bool enabled, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	bool wasEnabled = _currentState.enabledVertexAttributes[attrib] > 0;
+
+	if (force || (enabled != wasEnabled))
+		NullRenderDevice::instance().record(NullCommandType::State, attrib);
+
+	_currentState.enabledVertexAttributes[attrib] = enabled;
+#endif
+}
+
+void RenderState::setVertexAttribPointer(const VertexElement& e, size_t, bool)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	NullRenderDevice::instance().record(NullCommandType::State, static_cast<uint32_t>(e.usage()));
+#endif
+}
+
+void RenderState::setCulling(bool enabled, CullState cull, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.cullEnabled != enabled))
+	{
+		_currentState.cullEnabled = enabled;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+
+	if ((cull != CullState::Current) && (force || (_currentState.lastCull != cull)))
+	{
+		_currentState.lastCull = cull;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setPolygonOffsetFill(bool enabled, float factor, float units, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.polygonOffsetFillEnabled != enabled))
+	{
+		_currentState.polygonOffsetFillEnabled = enabled;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+
+	_currentState.polygonOffsetFactor = factor;
+	_currentState.polygonOffsetUnits = units;
+#endif
+}
+
+void RenderState::setWireframeRendering(bool wire, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.wireframe != wire))
+	{
+		_currentState.wireframe = wire;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setClearColor(const vec4& color, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || ((_currentState.clearColor - color).dotSelf() > std::numeric_limits<float>::epsilon()))
+	{
+		_currentState.clearColor = color;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setColorMask(ColorMask mask, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	setColorMask(static_cast<size_t>(mask), force);
+#endif
+}
+
+void RenderState::setColorMask(size_t mask, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.colorMask != mask))
+	{
+		_currentState.colorMask = mask;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setClearDepth(float depth, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.clearDepth != depth))
+	{
+		_currentState.clearDepth = depth;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setClip(bool enable, const recti& clip, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (enable != _currentState.clipEnabled))
+	{
+		_currentState.clipEnabled = enable;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+
+	if (force || (clip != _currentState.clipRect))
+	{
+		_currentState.clipRect = clip;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::setSampleAlphaToCoverage(bool enable, bool force)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	if (force || (_currentState.alphaToCoverage != enable))
+	{
+		_currentState.alphaToCoverage = enable;
+		NullRenderDevice::instance().record(NullCommandType::State);
+	}
+#endif
+}
+
+void RenderState::reset()
+{
+	applyState(RenderState::State());
+}
+
+void RenderState::applyState(const RenderState::State& s)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	setClearColor(s.clearColor, true);
+	setColorMask(s.colorMask, true);
+	setSeparateBlend(s.blendEnabled, s.lastColorBlend, s.lastAlphaBlend, true);
+	setDepthFunc(s.lastDepthFunc, true);
+	setDepthMask(s.depthMask, true);
+	setDepthTest(s.depthTestEnabled, true);
+	setPolygonOffsetFill(s.polygonOffsetFillEnabled, s.polygonOffsetFactor, s.polygonOffsetUnits, true);
+	setWireframeRendering(s.wireframe, true);
+	setCulling(s.cullEnabled, s.lastCull, true);
+	setClip(s.clipEnabled, s.clipRect, true);
+	setViewportSize(s.viewportSize, true);
+	bindFramebuffer(s.boundFramebuffer, true);
+	bindProgram(s.boundProgram, true);
+	bindVertexArray(s.boundVertexArrayObject, true);
+	bindBuffer(elementArrayBufferTarget, s.boundElementArrayBuffer, true);
+	bindBuffer(arrayBufferTarget, s.boundArrayBuffer, true);
+
+	for (auto& target : s.boundTextures)
+	{
+		for (auto& unit : target.second)
+			bindTexture(unit.first, unit.second, target.first, true);
+	}
+
+	for (uint32_t i = 0, e = static_cast<uint32_t>(VertexAttributeUsage::max); i < e; ++i)
+		setVertexAttribEnabled(i, (s.enabledVertexAttributes[i] != 0), true);
+
+	setActiveTextureUnit(s.activeTextureUnit, true);
+#endif
+}
+
+RenderState::State RenderState::currentState()
+{
+#if defined(ET_CONSOLE_APPLICATION)
+	return RenderState::State();
+#else
+	return NullRenderDevice::instance().deviceState();
+#endif
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/threading/threading.h>
+#include <et/rendering/rendercontext.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+VertexBufferData::VertexBufferData(RenderContext* rc, const VertexArray::Description& desc,
+	BufferDrawType vertexDrawType, const std::string& aName) : APIObject(aName), _rc(rc),
+	_decl(desc.declaration), _drawType(vertexDrawType)
+{
+#if defined(ET_CONSOLE_APPLICATION)
+	ET_FAIL("Attempt to create VertexBuffer in console application.")
+#else
+	setAPIHandle(NullRenderDevice::instance().generateHandle());
+	setData(desc.data.data(), desc.data.dataSize());
+#endif
+}
+
+VertexBufferData::VertexBufferData(RenderContext* rc, const VertexDeclaration& decl, const void* vertexData,
+	size_t vertexDataSize, BufferDrawType vertexDrawType, const std::string& aName) : APIObject(aName), _rc(rc),
+	_decl(decl), _drawType(vertexDrawType)
+{
+#if defined(ET_CONSOLE_APPLICATION)
+	ET_FAIL("Attempt to create VertexBuffer in console application.")
+#else
+	setAPIHandle(NullRenderDevice::instance().generateHandle());
+	setData(vertexData, vertexDataSize);
+#endif
+}
+
+VertexBufferData::~VertexBufferData()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	uint32_t buffer = static_cast<uint32_t>(apiHandle());
+	if (buffer != 0)
+	{
+		_rc->renderState().vertexBufferDeleted(buffer);
+	}
+#endif
+}
+
+void VertexBufferData::setData(const void*, size_t dataSize)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	_rc->renderState().bindBuffer(0x8892, static_cast<uint32_t>(apiHandle()));
+
+	_dataSize = dataSize;
+	NullRenderDevice::instance().recordUpload(NullCommandType::BufferData, static_cast<uint32_t>(apiHandle()), dataSize);
+#endif
+}
+
+void* VertexBufferData::map(size_t offset, size_t dataSize, MapBufferMode mode)
+{
+	ET_ASSERT(!_mapped)
+	ET_ASSERT(dataSize > 0)
+
+	void* result = nullptr;
+
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT(offset + dataSize <= _dataSize);
+	(void)mode;
+
+	/*
+	 * with the render thread buffers should be updated from the frame (see RenderFrame::updateVertexBuffer)
+	 */
+	ET_ASSERT(Threading::currentThread() == Threading::renderingThread());
+
+	_rc->renderState().bindBuffer(0x8892, static_cast<uint32_t>(apiHandle()));
+
+	result = reinterpret_cast<uint8_t*>(NullRenderDevice::instance().mapBuffer(static_cast<uint32_t>(apiHandle()),
+		_dataSize)) + offset;
+
+	_mapped = true;
+#endif
+
+	return result;
+}
+
+void VertexBufferData::unmap()
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	NullRenderDevice::instance().unmapBuffer(static_cast<uint32_t>(apiHandle()));
+	_mapped = false;
+#endif
+}
+
+void VertexBufferData::serialize(std::ostream&)
+{
+	ET_FAIL("Unsupported");
+}
+
+void VertexBufferData::deserialize(std::istream&)
+{
+	ET_FAIL("Unsupported");
+}
@@ -17,7 +17,8 @@ static const std::string etNoShader = "none";
 
 Program::Program(RenderContext* rc) : _rc(rc),
 	_mModelViewLocation(-1), _mModelViewProjectionLocation(-1), _vCameraLocation(-1),
-	_vPrimaryLightLocation(-1), _mLightProjectionMatrixLocation(-1), _mTransformLocation(-1)
+	_vPrimaryLightLocation(-1), _mLightProjectionMatrixLocation(-1), _mTransformLocation(-1),
+	_mInstanceTransformLocation(-1)
 {
 #if defined(ET_CONSOLE_APPLICATION)
 	ET_FAIL("Attempt to create Program in console application");
@@ -28,7 +29,7 @@ Program::Program(RenderContext* rc, const std::string& vertexShader, const std::
 	const std::string& fragmentShader, const std::string& objName, const std::string& origin,
 	const StringList& defines) : APIObject(objName, origin), _rc(rc), _mModelViewLocation(-1),
 	_mModelViewProjectionLocation(-1), _vCameraLocation(-1), _vPrimaryLightLocation(-1),
-	_mLightProjectionMatrixLocation(-1), _mTransformLocation(-1), _defines(defines)
+	_mLightProjectionMatrixLocation(-1), _mTransformLocation(-1), _mInstanceTransformLocation(-1), _defines(defines)
 {
 #if defined(ET_CONSOLE_APPLICATION)
 	ET_FAIL("Attempt to create Program in console application");
@@ -113,6 +114,11 @@ void Program::setTransformMatrix(const mat4 &m, bool forced)
 	setUniform(_mTransformLocation, GL_FLOAT_MAT4, m, forced);
 }
 
+void Program::setInstanceTransforms(const mat4* m, size_t count)
+{
+	setUniform(_mInstanceTransformLocation, GL_FLOAT_MAT4, m, count);
+}
+
 void Program::setCameraProperties(const Camera& cam)
 {
 	ET_ASSERT(apiHandleValid());
@@ -125,12 +131,7 @@ void Program::setCameraProperties(const Camera& cam)
 void Program::buildProgram(const std::string& vertex_source, const std::string& geom_source,
 	const std::string& frag_source)
 {
-	_floatCache.clear();
-	_vec2Cache.clear();
-	_vec3Cache.clear();
-	_vec4Cache.clear();
-	_mat3Cache.clear();
-	_mat4Cache.clear();
+	_uniformCache.clear();
 	_uniforms.clear();
 	
 #if !defined(ET_CONSOLE_APPLICATION)
@@ -308,6 +309,7 @@ void Program::buildProgram(const std::string& vertex_source, const std::string&
 		{
 			int activeUniforms = 0;
 			_uniforms.clear();
+			_uniformCache.clear();
 			glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms);
 			glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
 			for (uint32_t i = 0, e = static_cast<uint32_t>(activeUniforms); i < e; i++)
@@ -319,6 +321,7 @@ void Program::buildProgram(const std::string& vertex_source, const std::string&
 				glGetActiveUniform(program, i, maxNameLength, &uLenght, &uSize, &P.type, name.binary());
 				P.location = glGetUniformLocation(program, name.binary());
 				_uniforms[name.binary()] = P;
+				_uniformCache.addUniform(name.binary(), P);
 
 				if (strcmp(name.binary(), "mModelView") == 0)
 					_mModelViewLocation = P.location;
@@ -337,6 +340,9 @@ void Program::buildProgram(const std::string& vertex_source, const std::string&
 
 				if (strcmp(name.binary(), "mTransform") == 0)
 					_mTransformLocation = P.location;
+
+				if ((strcmp(name.binary(), "mInstanceTransform") == 0) || (strcmp(name.binary(), "mInstanceTransform[0]") == 0))
+					_mInstanceTransformLocation = P.location;
 			}
 		}
 	}
@@ -419,7 +425,7 @@ void Program::validate() const
  * Uniform setters
  */
 
-void Program::setUniform(int nLoc, uint32_t type, int32_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, int32_t value, bool forced)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 	if (nLoc == -1) return;
@@ -428,12 +434,16 @@ void Program::setUniform(int nLoc, uint32_t type, int32_t value, bool)
 	ET_ASSERT((type == GL_INT) || (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE));
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform1i(nLoc, value);
-	checkOpenGLError("glUniform1i");
+	GLint intValue = value;
+	if (_uniformCache.update(nLoc, &intValue, sizeof(intValue), forced))
+	{
+		glUniform1i(nLoc, intValue);
+		checkOpenGLError("glUniform1i");
+	}
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, uint32_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, uint32_t value, bool forced)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 	if (nLoc == -1) return;
@@ -442,12 +452,16 @@ void Program::setUniform(int nLoc, uint32_t type, uint32_t value, bool)
 	ET_ASSERT((type == GL_INT) || (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE));
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform1i(nLoc, static_cast<GLint>(value));
-	checkOpenGLError("glUniform1i");
+	GLint intValue = static_cast<GLint>(value);
+	if (_uniformCache.update(nLoc, &intValue, sizeof(intValue), forced))
+	{
+		glUniform1i(nLoc, intValue);
+		checkOpenGLError("glUniform1i");
+	}
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, int64_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, long long value, bool forced)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 	if (nLoc == -1) return;
@@ -456,12 +470,16 @@ void Program::setUniform(int nLoc, uint32_t type, int64_t value, bool)
 	ET_ASSERT((type == GL_INT) || (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE));
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform1i(nLoc, static_cast<GLint>(value));
-	checkOpenGLError("glUniform1i");
+	GLint intValue = static_cast<GLint>(value);
+	if (_uniformCache.update(nLoc, &intValue, sizeof(intValue), forced))
+	{
+		glUniform1i(nLoc, intValue);
+		checkOpenGLError("glUniform1i");
+	}
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, uint64_t value, bool)
+void Program::setUniform(int nLoc, uint32_t type, unsigned long long value, bool forced)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 	if (nLoc == -1) return;
@@ -470,12 +488,16 @@ void Program::setUniform(int nLoc, uint32_t type, uint64_t value, bool)
 	ET_ASSERT((type == GL_INT) || (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE));
 	ET_ASSERT(apiHandleValid());
 
-	glUniform1i(nLoc, static_cast<GLint>(value));
-	checkOpenGLError("glUniform1i");
+	GLint intValue = static_cast<GLint>(value);
+	if (_uniformCache.update(nLoc, &intValue, sizeof(intValue), forced))
+	{
+		glUniform1i(nLoc, intValue);
+		checkOpenGLError("glUniform1i");
+	}
 #endif
 }
 
-void Program::setUniform(int nLoc, uint32_t type, const unsigned long value, bool)
+void Program::setUniform(int nLoc, uint32_t type, const unsigned long value, bool forced)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
 	if (nLoc == -1) return;
@@ -484,8 +506,12 @@ void Program::setUniform(int nLoc, uint32_t type, const unsigned long value, boo
 	ET_ASSERT((type == GL_INT) || (type == GL_SAMPLER_2D) || (type == GL_SAMPLER_CUBE));
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform1i(nLoc, static_cast<GLint>(value));
-	checkOpenGLError("glUniform1i");
+	GLint intValue = static_cast<GLint>(value);
+	if (_uniformCache.update(nLoc, &intValue, sizeof(intValue), forced))
+	{
+		glUniform1i(nLoc, intValue);
+		checkOpenGLError("glUniform1i");
+	}
 #endif
 }
 
@@ -498,9 +524,8 @@ void Program::setUniform(int nLoc, uint32_t type, const float value, bool forced
 	ET_ASSERT(type == GL_FLOAT);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_floatCache.count(nLoc) == 0) || (_floatCache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_floatCache[nLoc] = value;
 		glUniform1f(nLoc, value);
 		checkOpenGLError("glUniform1f");
 	}
@@ -516,9 +541,8 @@ void Program::setUniform(int nLoc, uint32_t type, const vec2& value, bool forced
 	ET_ASSERT(type == GL_FLOAT_VEC2);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_vec2Cache.count(nLoc) == 0) || (_vec2Cache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_vec2Cache[nLoc] = value;
 		glUniform2fv(nLoc, 1, value.data());
 		checkOpenGLError("glUniform2fv");
 	}
@@ -535,9 +559,8 @@ void Program::setUniform(int nLoc, uint32_t type, const vec3& value, bool forced
 	ET_ASSERT(type == GL_FLOAT_VEC3);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_vec3Cache.count(nLoc) == 0) || (_vec3Cache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_vec3Cache[nLoc] = value;
 		glUniform3fv(nLoc, 1, value.data());
 		checkOpenGLError("glUniform3fv");
 	}
@@ -554,9 +577,8 @@ void Program::setUniform(int nLoc, uint32_t type, const vec4& value, bool forced
 	ET_ASSERT(type == GL_FLOAT_VEC4);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_vec4Cache.count(nLoc) == 0) || (_vec4Cache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_vec4Cache[nLoc] = value;
 		glUniform4fv(nLoc, 1, value.data());
 		checkOpenGLError("glUniform4fv");
 	}
@@ -573,6 +595,7 @@ void Program::setUniformDirectly(int nLoc, uint32_t type, const vec4& value)
 	ET_ASSERT(type == GL_FLOAT_VEC4);
 	ET_ASSERT(apiHandleValid());
 	
+	_uniformCache.update(nLoc, &value, sizeof(value), true);
 	glUniform4fv(nLoc, 1, value.data());
 	checkOpenGLError("glUniform4fv");
 #endif
@@ -587,9 +610,8 @@ void Program::setUniform(int nLoc, uint32_t type, const mat3& value, bool forced
 	ET_ASSERT(type == GL_FLOAT_MAT3);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_mat3Cache.count(nLoc) == 0) || (_mat3Cache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_mat3Cache[nLoc] = value;
 		glUniformMatrix3fv(nLoc, 1, 0, value.data());
 		checkOpenGLError("glUniformMatrix3fv");
 	}
@@ -606,9 +628,8 @@ void Program::setUniform(int nLoc, uint32_t type, const mat4& value, bool forced
 	ET_ASSERT(type == GL_FLOAT_MAT4);
 	ET_ASSERT(apiHandleValid());
 	
-	if (forced || ((_mat4Cache.count(nLoc) == 0) || (_mat4Cache[nLoc] != value)))
+	if (_uniformCache.update(nLoc, &value, sizeof(value), forced))
 	{
-		_mat4Cache[nLoc] = value;
 		glUniformMatrix4fv(nLoc, 1, 0, value.data());
 		checkOpenGLError("glUniformMatrix4fv");
 	}
@@ -625,6 +646,7 @@ void Program::setUniformDirectly(int nLoc, uint32_t type, const mat4& value)
 	ET_ASSERT(type == GL_FLOAT_MAT4);
 	ET_ASSERT(apiHandleValid());
 	
+	_uniformCache.update(nLoc, &value, sizeof(value), true);
 	glUniformMatrix4fv(nLoc, 1, 0, value.data());
 	checkOpenGLError("glUniformMatrix4fv");
 #endif
@@ -639,8 +661,11 @@ void Program::setUniform(int nLoc, uint32_t type, const vec2* value, size_t amou
 	ET_ASSERT(type == GL_FLOAT_VEC2);
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform2fv(nLoc, static_cast<GLsizei>(amount), value->data());
-	checkOpenGLError("glUniform2fv");
+	if (_uniformCache.update(nLoc, value, amount * sizeof(vec2), false))
+	{
+		glUniform2fv(nLoc, static_cast<GLsizei>(amount), value->data());
+		checkOpenGLError("glUniform2fv");
+	}
 #endif
 }
 
@@ -653,8 +678,11 @@ void Program::setUniform(int nLoc, uint32_t type, const vec3* value, size_t amou
 	ET_ASSERT(type == GL_FLOAT_VEC3);
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform3fv(nLoc, static_cast<GLsizei>(amount), value->data());
-	checkOpenGLError("glUniform3fv");
+	if (_uniformCache.update(nLoc, value, amount * sizeof(vec3), false))
+	{
+		glUniform3fv(nLoc, static_cast<GLsizei>(amount), value->data());
+		checkOpenGLError("glUniform3fv");
+	}
 #endif
 }
 
@@ -667,8 +695,11 @@ void Program::setUniform(int nLoc, uint32_t type, const vec4* value, size_t amou
 	ET_ASSERT(type == GL_FLOAT_VEC4);
 	ET_ASSERT(apiHandleValid());
 	
-	glUniform4fv(nLoc, static_cast<GLsizei>(amount), value->data());
-	checkOpenGLError("glUniform4fv");
+	if (_uniformCache.update(nLoc, value, amount * sizeof(vec4), false))
+	{
+		glUniform4fv(nLoc, static_cast<GLsizei>(amount), value->data());
+		checkOpenGLError("glUniform4fv");
+	}
 #endif
 }
 
@@ -681,7 +712,10 @@ void Program::setUniform(int nLoc, uint32_t type, const mat4* value, size_t amou
 	ET_ASSERT(type == GL_FLOAT_MAT4);
 	ET_ASSERT(apiHandleValid());
 	
-	glUniformMatrix4fv(nLoc, static_cast<GLsizei>(amount), 0, value->data());
-	checkOpenGLError("glUniformMatrix4fv");
+	if (_uniformCache.update(nLoc, value, amount * sizeof(mat4), false))
+	{
+		glUniformMatrix4fv(nLoc, static_cast<GLsizei>(amount), 0, value->data());
+		checkOpenGLError("glUniformMatrix4fv");
+	}
 #endif
 }
@@ -334,6 +334,79 @@ void Texture::updatePartialDataDirectly(RenderContext* rc, const vec2i& offset,
 #endif
 }
 
+void Texture::updateMipLevel(RenderContext* rc, size_t level, const char* data, size_t dataSize)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT((_desc->target == TextureTarget::Texture_2D) && (level < _desc->mipMapCount));
+	
+	if (apiHandleInvalid())
+	{
+		generateTexture(rc);
+		rc->renderState().bindTexture(defaultBindingUnit, static_cast<uint32_t>(apiHandle()), _desc->target, true);
+		
+		setFiltration(rc, _filtration.x, _filtration.y);
+		setWrap(rc, _wrap.x, _wrap.y, _wrap.z);
+		
+		if (_desc->mipMapCount > 1)
+			setMaxLod(rc, _desc->mipMapCount - 1);
+	}
+	else
+	{
+		rc->renderState().bindTexture(defaultBindingUnit, static_cast<uint32_t>(apiHandle()), _desc->target);
+	}
+	
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	checkOpenGLError("glPixelStorei");
+	
+	auto targetValue = textureTargetValue(_desc->target);
+	auto internalFormatValue = textureFormatValue(_desc->internalformat);
+	vec2i mipSize = _desc->sizeForMipLevel(level);
+	
+	if (_desc->compressed)
+	{
+		etCompressedTexImage2D(targetValue, static_cast<int>(level), internalFormatValue,
+			mipSize.x, mipSize.y, 0, static_cast<GLsizei>(dataSize), data);
+	}
+	else
+	{
+		etTexImage2D(targetValue, static_cast<int>(level), internalFormatValue, mipSize.x, mipSize.y,
+			0, textureFormatValue(_desc->format), dataTypeValue(_desc->type), data);
+	}
+	
+	checkOpenGLError("Texture::updateMipLevel(%lu) - %s", static_cast<unsigned long>(level), name().c_str());
+#endif
+}
+
+void Texture::releaseMipLevel(RenderContext* rc, size_t level)
+{
+#if !defined(ET_CONSOLE_APPLICATION)
+	ET_ASSERT((_desc->target == TextureTarget::Texture_2D) && (level < _desc->mipMapCount));
+	
+	if (apiHandleInvalid()) return;
+	
+	rc->renderState().bindTexture(defaultBindingUnit, static_cast<uint32_t>(apiHandle()), _desc->target);
+	
+	/*
+	 * OpenGL does not allow to free storage of the single level,
+	 * redefining it with zero size releases memory in all known drivers
+	 */
+	auto targetValue = textureTargetValue(_desc->target);
+	auto internalFormatValue = textureFormatValue(_desc->internalformat);
+	
+	if (_desc->compressed)
+	{
+		etCompressedTexImage2D(targetValue, static_cast<int>(level), internalFormatValue, 0, 0, 0, 0, nullptr);
+	}
+	else
+	{
+		etTexImage2D(targetValue, static_cast<int>(level), internalFormatValue, 0, 0, 0,
+			textureFormatValue(_desc->format), dataTypeValue(_desc->type), nullptr);
+	}
+	
+	checkOpenGLError("Texture::releaseMipLevel(%lu) - %s", static_cast<unsigned long>(level), name().c_str());
+#endif
+}
+
 void Texture::generateMipMaps(RenderContext* rc)
 {
 #if !defined(ET_CONSOLE_APPLICATION)
@@ -352,6 +425,15 @@ void Texture::setMaxLod(RenderContext* rc, size_t value)
 #endif
 }
 
+void Texture::setBaseLod(RenderContext* rc, size_t value)
+{
+#if defined(GL_TEXTURE_BASE_LEVEL) && !defined(ET_CONSOLE_APPLICATION)
+	rc->renderState().bindTexture(defaultBindingUnit, static_cast<uint32_t>(apiHandle()), _desc->target);
+	glTexParameteri(textureTargetValue(_desc->target), GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(value));
+	checkOpenGLError("Texture::setBaseLod(%lu) - %s", static_cast<unsigned long>(value), name().c_str());
+#endif
+}
+
 void Texture::setAnisotropyLevel(RenderContext* rc, float value)
 {
 #if defined(GL_TEXTURE_MAX_ANISOTROPY_EXT) && !defined(ET_CONSOLE_APPLICATION)
@@ -64,6 +64,16 @@ bool RenderContext::valid()
 	return _private != nullptr;
 }
 
+bool RenderContext::makeCurrent()
+{
+	return eglMakeCurrent(_private->display, _private->surface, _private->surface, _private->context) != EGL_FALSE;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return eglMakeCurrent(_private->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_FALSE;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return 0;
@@ -67,6 +67,19 @@ void RenderContext::init()
 	_fpsTimer.start(mainTimerPool(), 1.0f, NotifyTimer::RepeatForever);
 }
 
+/*
+ * Context is owned by cocos2d
+ */
+bool RenderContext::makeCurrent()
+{
+	return false;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return false;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return 0;
@@ -72,6 +72,19 @@ void RenderContext::init()
 	_fpsTimer.start(mainTimerPool(), 1.0f, NotifyTimer::RepeatForever);
 }
 
+/*
+ * Context is bound by the OpenGL view controller on the main thread
+ */
+bool RenderContext::makeCurrent()
+{
+	return false;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return false;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return reinterpret_cast<size_t>(sharedOpenGLViewController);
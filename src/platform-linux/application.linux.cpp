@@ -0,0 +1,122 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rendering/rendercontext.h>
+#include <et/app/application.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <signal.h>
+
+using namespace et;
+
+/*
+ * Application runs without window: frames are produced by the run loop below
+ * until quit() is called or the process receives SIGINT / SIGTERM.
+ */
+static volatile sig_atomic_t terminationRequested = 0;
+
+void handleTerminationSignal(int)
+{
+	terminationRequested = 1;
+}
+
+void Application::platformInit()
+{
+	_env.updateDocumentsFolder(_identifier);
+	
+#if !defined(ET_CONSOLE_APPLICATION)
+	signal(SIGINT, handleTerminationSignal);
+	signal(SIGTERM, handleTerminationSignal);
+#endif
+}
+
+void Application::platformFinalize()
+{
+	sharedObjectFactory().deleteObject(_renderContext);
+	_renderContext = nullptr;
+}
+
+void Application::platformSuspend()
+{
+}
+
+void Application::platformResume()
+{
+}
+
+void Application::platformActivate()
+{
+}
+
+void Application::platformDeactivate()
+{
+}
+
+int Application::platformRun(int, char*[])
+{
+	RenderContextParameters params;
+	delegate()->setRenderContextParameters(params);
+	
+	_lastQueuedTimeMSec = queryContiniousTimeInMilliSeconds();
+	_runLoop.updateTime(_lastQueuedTimeMSec);
+	
+	_renderContext = sharedObjectFactory().createObject<RenderContext>(params, this);
+	if (_renderContext->valid())
+	{
+		_renderingContextHandle = _renderContext->renderingContextHandle();
+		enterRunLoop();
+		
+#	if !defined(ET_CONSOLE_APPLICATION)
+		_delegate->applicationWillResizeContext(_renderContext->sizei());
+		
+		while (_running)
+		{
+			if (terminationRequested)
+				quit(0);
+			else if (shouldPerformRendering())
+				performUpdateAndRender();
+		}
+		
+		terminated();
+#	endif
+	}
+	
+	sharedObjectFactory().deleteObject(_delegate);
+	sharedObjectFactory().deleteObject(_renderContext);
+	
+	_delegate = nullptr;
+	_renderContext = nullptr;
+	
+	return _exitCode;
+}
+
+void Application::quit(int exitCode)
+{
+	_running = false;
+	_exitCode = exitCode;
+}
+
+void Application::alert(const std::string& title, const std::string& message, AlertType type)
+{
+	if (type == AlertType_Error)
+		log::error("%s: %s", title.c_str(), message.c_str());
+	else if (type == AlertType_Warning)
+		log::warning("%s: %s", title.c_str(), message.c_str());
+	else
+		log::info("%s: %s", title.c_str(), message.c_str());
+}
+
+void Application::setTitle(const std::string&)
+{
+}
+
+void Application::requestUserAttention()
+{
+}
+
+#endif // ET_PLATFORM_LINUX
@@ -0,0 +1,55 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/locale/locale.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <time.h>
+
+using namespace et;
+
+std::string formatCurrentTime(const char* format)
+{
+	time_t t = ::time(nullptr);
+	
+	tm localTime = { };
+	localtime_r(&t, &localTime);
+	
+	char buffer[64] = { };
+	strftime(buffer, sizeof(buffer), format, &localTime);
+	
+	return std::string(buffer);
+}
+
+std::string locale::time()
+{
+	return formatCurrentTime("%H:%M:%S");
+}
+
+std::string locale::date()
+{
+	return formatCurrentTime("%Y-%m-%d");
+}
+
+std::string locale::currentLocale()
+{
+	const char* lang = getenv("LANG");
+	if ((lang == nullptr) || (strlen(lang) < 2) || (strcmp(lang, "C") == 0) || (strcmp(lang, "POSIX") == 0))
+		return "en-US";
+	
+	std::string result(lang);
+	
+	size_t encodingPos = result.find('.');
+	if (encodingPos != std::string::npos)
+		result.erase(encodingPos);
+	
+	std::replace(result.begin(), result.end(), '_', '-');
+	return result;
+}
+
+#endif // ET_PLATFORM_LINUX
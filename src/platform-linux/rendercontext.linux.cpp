@@ -0,0 +1,113 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rendering/rendercontext.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <et/app/application.h>
+#include <et/rendering/renderingcaps.h>
+#include <et/null/nullrenderdevice.h>
+
+using namespace et;
+
+/*
+ * Headless render context, all rendering goes to the NullRenderDevice
+ */
+class et::RenderContextPrivate
+{
+public:
+	RenderContextPrivate(RenderContext* rc) :
+		renderContext(rc) { }
+
+public:
+	RenderContext* renderContext = nullptr;
+};
+
+RenderContext::RenderContext(const RenderContextParameters& params, Application* app) : _params(params),
+	_app(app), _programFactory(0), _textureFactory(0), _framebufferFactory(0), _vertexBufferFactory(0), _renderer(0)
+{
+	ET_PIMPL_INIT(RenderContext, this)
+	
+	RenderingCapabilities::instance().checkCaps();
+	NullRenderDevice::instance().setActiveRenderState(&_renderState);
+	
+	_renderState.setRenderContext(this);
+	_programFactory = ProgramFactory::Pointer::create(this);
+	_textureFactory = TextureFactory::Pointer::create(this);
+	_framebufferFactory = FramebufferFactory::Pointer::create(this);
+	_vertexBufferFactory = VertexBufferFactory::Pointer::create(this);
+	_renderer = Renderer::Pointer::create(this);
+	
+	_renderState.setDefaultFramebuffer(_framebufferFactory->createFramebufferWrapper(0, "default-fbo"));
+	
+	updateScreenScale(_params.contextSize);
+}
+
+RenderContext::~RenderContext()
+{
+	_renderer.reset(nullptr);
+	_vertexBufferFactory.reset(nullptr);
+	_framebufferFactory.reset(nullptr);
+	_textureFactory.reset(nullptr);
+	_programFactory.reset(nullptr);
+	
+	NullRenderDevice::instance().setActiveRenderState(nullptr);
+	
+	ET_PIMPL_FINALIZE(RenderContext)
+}
+
+void RenderContext::init()
+{
+	_renderState.setMainViewportSize(_params.contextSize);
+	
+	_fpsTimer.expired.connect(this, &RenderContext::onFPSTimerExpired);
+	_fpsTimer.start(mainTimerPool().ptr(), 1.0f, -1);
+}
+
+bool RenderContext::valid()
+{
+	return _private != nullptr;
+}
+
+/*
+ * Null render device is not bound to the thread
+ */
+bool RenderContext::makeCurrent()
+{
+	return true;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return true;
+}
+
+size_t RenderContext::renderingContextHandle()
+{
+	return 0;
+}
+
+void RenderContext::beginRender()
+{
+	NullRenderDevice::instance().beginFrame();
+	_renderState.bindDefaultFramebuffer();
+}
+
+void RenderContext::endRender()
+{
+	_renderState.bindDefaultFramebuffer();
+	
+	NullRenderDevice& device = NullRenderDevice::instance();
+	device.endFrame();
+	
+	++_info.averageFramePerSecond;
+	_info.averageDIPPerSecond += device.lastFrameStatistics().drawCalls;
+	_info.averagePolygonsPerSecond += device.lastFrameStatistics().primitives;
+}
+
+#endif // ET_PLATFORM_LINUX
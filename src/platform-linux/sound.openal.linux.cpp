@@ -0,0 +1,31 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/sound/sound.h>
+
+#if (ET_PLATFORM_LINUX)
+
+using namespace et;
+using namespace audio;
+
+void Manager::nativePreInit()
+{
+}
+
+void Manager::nativeInit()
+{
+}
+
+void Manager::nativeRelease()
+{
+}
+
+void Manager::nativePostRelease()
+{
+}
+
+#endif // ET_PLATFORM_LINUX
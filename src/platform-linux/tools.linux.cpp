@@ -0,0 +1,320 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/tools.h>
+
+#if (ET_PLATFORM_LINUX)
+
+#include <dirent.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <et/platform/platformtools.h>
+#include <et/core/hardware.h>
+#include <et/core/containers.h>
+
+static const std::string currentFolder(".");
+static const std::string previousFolder("..");
+
+static uint64_t startTime = 0;
+static bool startTimeInitialized = false;
+
+const char et::pathDelimiter = '/';
+const char et::invalidPathDelimiter = '\\';
+
+uint64_t queryMonotonicTimeInMicroSeconds()
+{
+	timespec ts = { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+}
+
+float et::queryContiniousTimeInSeconds()
+{
+	return static_cast<float>(queryContiniousTimeInMilliSeconds()) / 1000.0f;
+}
+
+uint64_t et::queryContiniousTimeInMilliSeconds()
+{
+	if (!startTimeInitialized)
+	{
+		startTime = queryMonotonicTimeInMicroSeconds();
+		startTimeInitialized = true;
+	};
+	
+	return (queryMonotonicTimeInMicroSeconds() - startTime) / 1000;
+}
+
+uint64_t et::queryCurrentTimeInMicroSeconds()
+{
+	return queryMonotonicTimeInMicroSeconds();
+}
+
+std::string et::applicationPath()
+{
+	char buffer[PATH_MAX] = { };
+	ssize_t length = readlink("/proc/self/exe", buffer, PATH_MAX - 1);
+	
+	if (length <= 0)
+		return applicationPackagePath();
+	
+	return getFilePath(std::string(buffer, static_cast<size_t>(length)));
+}
+
+std::string et::applicationPackagePath()
+{
+	char buffer[PATH_MAX] = { };
+	
+	if (getcwd(buffer, PATH_MAX) == nullptr)
+		return emptyString;
+	
+	return addTrailingSlash(std::string(buffer));
+}
+
+std::string et::applicationDataFolder()
+{
+	return applicationPackagePath();
+}
+
+std::string et::documentsBaseFolder()
+{
+	const char* home = getenv("HOME");
+	return (home == nullptr) ? applicationPackagePath() : addTrailingSlash(std::string(home));
+}
+
+std::string et::libraryBaseFolder()
+{
+	const char* dataHome = getenv("XDG_DATA_HOME");
+	if (dataHome != nullptr)
+		return addTrailingSlash(std::string(dataHome));
+	
+	return documentsBaseFolder() + ".local/share/";
+}
+
+std::string et::temporaryBaseFolder()
+{
+	const char* tmp = getenv("TMPDIR");
+	return (tmp == nullptr) ? std::string("/tmp/") : addTrailingSlash(std::string(tmp));
+}
+
+bool et::fileExists(const std::string& name)
+{
+	struct stat status = { };
+	return (stat(name.c_str(), &status) == 0) && S_ISREG(status.st_mode);
+}
+
+bool et::folderExists(const std::string& name)
+{
+	struct stat status = { };
+	return (stat(name.c_str(), &status) == 0) && S_ISDIR(status.st_mode);
+}
+
+bool et::createDirectory(const std::string& path, bool recursive)
+{
+	if (path.empty())
+		return false;
+	
+	if (::mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0)
+		return true;
+	
+	if (errno == EEXIST)
+		return folderExists(path);
+	
+	if (recursive && (errno == ENOENT))
+	{
+		std::string parent = path;
+		while (!parent.empty() && (parent.back() == pathDelimiter))
+			parent.pop_back();
+		
+		size_t delimiterPos = parent.find_last_of(pathDelimiter);
+		if ((delimiterPos == std::string::npos) || (delimiterPos == 0))
+			return false;
+		
+		if (createDirectory(parent.substr(0, delimiterPos), true))
+			return (::mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0) || (errno == EEXIST);
+	}
+	
+	return false;
+}
+
+bool et::removeFile(const std::string& path)
+{
+	return ::remove(path.c_str()) == 0;
+}
+
+bool et::removeDirectory(const std::string& path)
+{
+	return ::rmdir(path.c_str()) == 0;
+}
+
+bool et::copyFile(const std::string& from, const std::string& to)
+{
+	std::ifstream source(from, std::ios::binary);
+	if (source.fail()) return false;
+	
+	std::ofstream destination(to, std::ios::binary | std::ios::trunc);
+	if (destination.fail()) return false;
+	
+	destination << source.rdbuf();
+	return !destination.fail();
+}
+
+void et::getFolderContent(const std::string& path, StringList& list)
+{
+	DIR* dir = opendir(path.c_str());
+	if (dir == nullptr)
+	{
+		log::error("Unable to get contents of the %s", path.c_str());
+		return;
+	}
+	
+	std::string normalizedFolder = addTrailingSlash(path);
+	
+	dirent* ent = nullptr;
+	while ((ent = readdir(dir)) != nullptr)
+	{
+		std::string name(ent->d_name);
+		if ((name != currentFolder) && (name != previousFolder))
+			list.push_back(normalizedFolder + name);
+	}
+	
+	closedir(dir);
+}
+
+void et::findFiles(const std::string& folder, const std::string& mask, bool recursive, StringList& list)
+{
+	std::string normalizedFolder = addTrailingSlash(folder);
+	
+	DIR* dir = opendir(normalizedFolder.c_str());
+	if (dir == nullptr) return;
+	
+	StringList folderList;
+	
+	dirent* ent = nullptr;
+	while ((ent = readdir(dir)) != nullptr)
+	{
+		std::string name(ent->d_name);
+		if ((name == currentFolder) || (name == previousFolder)) continue;
+		
+		std::string fullPath = normalizedFolder + name;
+		
+		if (recursive && folderExists(fullPath))
+			folderList.push_back(fullPath);
+		
+		if (fnmatch(mask.c_str(), name.c_str(), 0) == 0)
+			list.push_back(fullPath);
+	}
+	
+	closedir(dir);
+	
+	for (const std::string& i : folderList)
+		findFiles(i, mask, recursive, list);
+}
+
+void et::findSubfolders(const std::string& folder, bool recursive, StringList& list)
+{
+	std::string normalizedFolder = addTrailingSlash(folder);
+	
+	DIR* dir = opendir(normalizedFolder.c_str());
+	if (dir == nullptr) return;
+	
+	StringList folderList;
+	
+	dirent* ent = nullptr;
+	while ((ent = readdir(dir)) != nullptr)
+	{
+		std::string name(ent->d_name);
+		if ((name == currentFolder) || (name == previousFolder)) continue;
+		
+		std::string fullPath = normalizedFolder + name;
+		if (folderExists(fullPath))
+			folderList.push_back(fullPath + "/");
+	}
+	
+	closedir(dir);
+	
+	if (recursive)
+	{
+		for (const std::string& i : folderList)
+			findSubfolders(i, true, list);
+	}
+	
+	list.insert(list.end(), folderList.begin(), folderList.end());
+}
+
+void et::openUrl(const std::string& url)
+{
+	log::info("Unable to open url in headless environment: %s", url.c_str());
+}
+
+std::string et::unicodeToUtf8(const std::wstring& w)
+{
+	size_t length = wcstombs(nullptr, w.c_str(), 0);
+	if (length == static_cast<size_t>(-1))
+		return emptyString;
+	
+	DataStorage<char> result(length + 1, 0);
+	wcstombs(result.data(), w.c_str(), result.size());
+	
+	return std::string(result.data());
+}
+
+std::wstring et::utf8ToUnicode(const std::string& mbcs)
+{
+	size_t length = mbstowcs(nullptr, mbcs.c_str(), 0);
+	if (length == static_cast<size_t>(-1))
+		return std::wstring();
+	
+	DataStorage<wchar_t> result(length + 1, 0);
+	mbstowcs(result.data(), mbcs.c_str(), result.size());
+	
+	return std::wstring(result.data());
+}
+
+std::string et::applicationIdentifierForCurrentProject()
+	{ return "com.et.app"; }
+
+uint64_t et::getFileDate(const std::string& path)
+{
+	struct stat s = { };
+	stat(path.c_str(), &s);
+	return static_cast<uint64_t>(s.st_mtime);
+}
+
+/*
+ * Headless environment does not have any screens
+ */
+et::vec2i et::nativeScreenSize()
+{
+	return vec2i(0);
+}
+
+et::vec2i et::availableScreenSize()
+{
+	return vec2i(0);
+}
+
+et::Screen et::currentScreen()
+{
+	return Screen();
+}
+
+std::vector<et::Screen> et::availableScreens()
+{
+	return std::vector<et::Screen>();
+}
+
+std::string et::selectFile(const StringList&, SelectFileMode, const std::string&)
+{
+	return emptyString;
+}
+
+#endif // ET_PLATFORM_LINUX
@@ -137,6 +137,19 @@ void RenderContext::init()
 	_private->run();
 }
 
+/*
+ * Frames are driven by display link thread, which locks and flushes context around each of them
+ */
+bool RenderContext::makeCurrent()
+{
+	return false;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return false;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return 0;
@@ -0,0 +1,67 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/et.h>
+#include <et/core/mappedfile.h>
+
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace et
+{
+	class MappedFilePrivate
+	{
+	public:
+		void* address = MAP_FAILED;
+		size_t length = 0;
+	};
+}
+
+using namespace et;
+
+MappedFile::MappedFile(const std::string& fileName)
+{
+	ET_PIMPL_INIT(MappedFile)
+	
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1) return;
+	
+	struct stat fileInfo = { };
+	if ((fstat(fd, &fileInfo) == 0) && (fileInfo.st_size > 0))
+	{
+		_private->length = static_cast<size_t>(fileInfo.st_size);
+		_private->address = mmap(nullptr, _private->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	}
+	
+	/*
+	 * Mapping stays valid after descriptor is closed
+	 */
+	close(fd);
+	
+	if (_private->address == MAP_FAILED)
+	{
+		log::warning("Unable to map file %s", fileName.c_str());
+		return;
+	}
+	
+	_data = static_cast<char*>(_private->address);
+	_size = _private->length;
+}
+
+MappedFile::~MappedFile()
+{
+	if (_private->address != MAP_FAILED)
+		munmap(_private->address, _private->length);
+	
+	ET_PIMPL_FINALIZE(MappedFile)
+}
+
+#endif
@@ -7,7 +7,7 @@
 
 #include <et/threading/mutex.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
 #include <errno.h>
 #include <pthread.h>
@@ -19,6 +19,13 @@ namespace et
 	public:
 		pthread_mutex_t mutex;
 	};
+	
+	class ConditionPrivate
+	{
+	public:
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+	};
 }
 
 using namespace et;
@@ -57,4 +64,43 @@ void Mutex::unlock()
 		log::error("Mutex already unlocked or was locked from another thread.");
 }
 
+/*
+ * Condition
+ */
+Condition::Condition()
+{
+	ET_PIMPL_INIT(Condition)
+	
+	pthread_mutex_init(&_private->mutex, nullptr);
+	pthread_cond_init(&_private->condition, nullptr);
+}
+
+Condition::~Condition()
+{
+	pthread_cond_destroy(&_private->condition);
+	pthread_mutex_destroy(&_private->mutex);
+	
+	ET_PIMPL_FINALIZE(Condition)
+}
+
+void Condition::lock()
+{
+	pthread_mutex_lock(&_private->mutex);
+}
+
+void Condition::unlock()
+{
+	pthread_mutex_unlock(&_private->mutex);
+}
+
+void Condition::wait()
+{
+	pthread_cond_wait(&_private->condition, &_private->mutex);
+}
+
+void Condition::notifyAll()
+{
+	pthread_cond_broadcast(&_private->condition);
+}
+
 #endif // !ET_PLATFORM_WIN
@@ -7,8 +7,10 @@
 
 #include <et/threading/thread.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
+#include <errno.h>
+#include <time.h>
 #include <pthread.h>
 #include <unistd.h>
 
@@ -30,6 +32,7 @@ namespace et
 		AtomicBool running;
 		AtomicBool suspended;
 		ThreadId threadId = 0;
+		bool resumeRequested = false;
 	};
 }
 
@@ -91,24 +94,73 @@ void Thread::run()
 
 void Thread::suspend()
 {
-	if (_private->suspended) return;
+	pthread_mutex_lock(&_private->suspendMutex);
 	
-	_private->suspended = true;
+	if (_private->resumeRequested)
+	{
+		_private->resumeRequested = false;
+	}
+	else
+	{
+		_private->suspended = true;
+		while (_private->suspended)
+			pthread_cond_wait(&_private->suspend, &_private->suspendMutex);
+	}
 	
+	pthread_mutex_unlock(&_private->suspendMutex);
+}
+
+bool Thread::suspend(uint64_t timeoutMSec)
+{
+	timespec deadline = { };
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	
+	uint64_t nsec = static_cast<uint64_t>(deadline.tv_nsec) + (timeoutMSec % 1000) * 1000000;
+	deadline.tv_sec += static_cast<time_t>(timeoutMSec / 1000 + nsec / 1000000000);
+	deadline.tv_nsec = static_cast<long>(nsec % 1000000000);
+	
+	bool resumed = true;
 	pthread_mutex_lock(&_private->suspendMutex);
-	pthread_cond_wait(&_private->suspend, &_private->suspendMutex);
+	
+	if (_private->resumeRequested)
+	{
+		_private->resumeRequested = false;
+	}
+	else
+	{
+		_private->suspended = true;
+		while (_private->suspended)
+		{
+			if (pthread_cond_timedwait(&_private->suspend, &_private->suspendMutex, &deadline) == ETIMEDOUT)
+				break;
+		}
+		
+		resumed = !_private->suspended;
+		_private->suspended = false;
+	}
+	
 	pthread_mutex_unlock(&_private->suspendMutex);
+	return resumed;
 }
 
 void Thread::resume()
 {
+	pthread_mutex_lock(&_private->suspendMutex);
+	
+	/*
+	 * resume requested before thread actually suspended should not be lost
+	 */
 	if (_private->suspended)
 	{
 		_private->suspended = false;
-		pthread_mutex_lock(&_private->suspendMutex);
 		pthread_cond_signal(&_private->suspend);
-		pthread_mutex_unlock(&_private->suspendMutex);
 	}
+	else
+	{
+		_private->resumeRequested = true;
+	}
+	
+	pthread_mutex_unlock(&_private->suspendMutex);
 }
 
 void Thread::stop()
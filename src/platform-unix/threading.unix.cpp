@@ -7,9 +7,10 @@
 
 #include <et/threading/threading.h>
 
-#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID)
+#if (ET_PLATFORM_IOS | ET_PLATFORM_MAC | ET_PLATFORM_ANDROID | ET_PLATFORM_LINUX)
 
 #include <pthread.h>
+#include <unistd.h>
 
 using namespace et;
 
@@ -39,7 +40,8 @@ void Threading::setRenderingThread(ThreadId t)
 
 size_t Threading::coresCount()
 {
-	return 0;
+	long result = sysconf(_SC_NPROCESSORS_ONLN);
+	return (result > 0) ? static_cast<size_t>(result) : 1;
 }
 
 float Threading::cpuUsage()
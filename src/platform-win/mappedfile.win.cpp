@@ -0,0 +1,68 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/et.h>
+#include <et/core/mappedfile.h>
+
+#if (ET_PLATFORM_WIN)
+
+namespace et
+{
+	class MappedFilePrivate
+	{
+	public:
+		HANDLE mapping = nullptr;
+		void* address = nullptr;
+	};
+}
+
+using namespace et;
+
+MappedFile::MappedFile(const std::string& fileName)
+{
+	ET_PIMPL_INIT(MappedFile)
+	
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	
+	if (file == INVALID_HANDLE_VALUE) return;
+	
+	LARGE_INTEGER fileSize = { };
+	if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+	{
+		_private->mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (_private->mapping != nullptr)
+			_private->address = MapViewOfFile(_private->mapping, FILE_MAP_COPY, 0, 0, 0);
+	}
+	
+	/*
+	 * Mapping keeps reference to the file
+	 */
+	CloseHandle(file);
+	
+	if (_private->address == nullptr)
+	{
+		log::warning("Unable to map file %s", fileName.c_str());
+		return;
+	}
+	
+	_data = static_cast<char*>(_private->address);
+	_size = static_cast<size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	if (_private->address != nullptr)
+		UnmapViewOfFile(_private->address);
+	
+	if (_private->mapping != nullptr)
+		CloseHandle(_private->mapping);
+	
+	ET_PIMPL_FINALIZE(MappedFile)
+}
+
+#endif
@@ -29,6 +29,23 @@ namespace et
 	private:
 		HANDLE _mutex;
 	};
+	
+	class ConditionPrivate
+	{
+	public:
+		ConditionPrivate()
+		{
+			InitializeCriticalSection(&section);
+			InitializeConditionVariable(&condition);
+		}
+		
+		~ConditionPrivate()
+			{ DeleteCriticalSection(&section); }
+		
+	public:
+		CRITICAL_SECTION section;
+		CONDITION_VARIABLE condition;
+	};
 }
 
 using namespace et;
@@ -53,4 +70,37 @@ void Mutex::unlock()
 	_private->unlock();
 }
 
+/*
+ * Condition
+ */
+Condition::Condition()
+{
+	ET_PIMPL_INIT(Condition)
+}
+
+Condition::~Condition()
+{
+	ET_PIMPL_FINALIZE(Condition)
+}
+
+void Condition::lock()
+{
+	EnterCriticalSection(&_private->section);
+}
+
+void Condition::unlock()
+{
+	LeaveCriticalSection(&_private->section);
+}
+
+void Condition::wait()
+{
+	SleepConditionVariableCS(&_private->condition, &_private->section, INFINITE);
+}
+
+void Condition::notifyAll()
+{
+	WakeAllConditionVariable(&_private->condition);
+}
+
 #endif // ET_PLATFORM_WIN
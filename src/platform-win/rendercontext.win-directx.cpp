@@ -116,6 +116,16 @@ bool RenderContext::valid()
 	return _private != nullptr;
 }
 
+bool RenderContext::makeCurrent()
+{
+	return false;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return false;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return reinterpret_cast<size_t>(_private->primaryContext.hWnd);
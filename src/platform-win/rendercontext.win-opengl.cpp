@@ -117,6 +117,16 @@ bool RenderContext::valid()
 	return _private != nullptr;
 }
 
+bool RenderContext::makeCurrent()
+{
+	return wglMakeCurrent(_private->primaryContext.hDC, _private->primaryContext.hGLRC) != 0;
+}
+
+bool RenderContext::releaseCurrent()
+{
+	return wglMakeCurrent(_private->primaryContext.hDC, nullptr) != 0;
+}
+
 size_t RenderContext::renderingContextHandle()
 {
 	return reinterpret_cast<size_t>(_private->primaryContext.hWnd);
@@ -90,17 +90,25 @@ ThreadResult Thread::main()
 
 void Thread::suspend()
 {
-	if (_private->suspended.atomicCounterValue() != 0) return;
-
-	_private->suspended.retain();
+	_private->suspended.setValue(1);
 	WaitForSingleObject(_private->activityEvent, INFINITE);
+	_private->suspended.setValue(0);
 }
 
-void Thread::resume()
+bool Thread::suspend(uint64_t timeoutMSec)
 {
-	if (_private->suspended.atomicCounterValue() == 0) return;
+	_private->suspended.setValue(1);
+	DWORD result = WaitForSingleObject(_private->activityEvent, static_cast<DWORD>(timeoutMSec));
+	_private->suspended.setValue(0);
+	return (result == WAIT_OBJECT_0);
+}
 
-	_private->suspended.release();
+void Thread::resume()
+{
+	/*
+	 * activity event is auto-reset, so resume requested
+	 * before thread actually suspended will not be lost
+	 */
 	SetEvent(_private->activityEvent);
 }
 
@@ -0,0 +1,460 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/geometry/geometry.h>
+#include <et/primitives/meshoptimizer.h>
+
+using namespace et;
+
+namespace
+{
+	const uint32_t invalidIndex = static_cast<uint32_t>(-1);
+
+	const size_t forsythCacheSize = 32;
+	const size_t forsythValenceTableSize = 32;
+	const float forsythCacheDecayPower = 1.5f;
+	const float forsythLastTriangleScore = 0.75f;
+	const float forsythValenceBoostScale = 2.0f;
+	const float forsythValenceBoostPower = 0.5f;
+
+	/*
+	 * Indices of the range, renumbered to [0, vertices.size())
+	 */
+	struct LocalIndices
+	{
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> vertices;
+	};
+
+	LocalIndices loadIndices(const IndexArray& indexArray, size_t firstIndex, size_t indexCount)
+	{
+		LocalIndices result;
+		result.indices.resize(indexCount);
+		for (size_t i = 0; i < indexCount; ++i)
+			result.indices[i] = indexArray.getIndex(firstIndex + i);
+
+		result.vertices = result.indices;
+		std::sort(result.vertices.begin(), result.vertices.end());
+		result.vertices.erase(std::unique(result.vertices.begin(), result.vertices.end()), result.vertices.end());
+
+		for (auto& index : result.indices)
+		{
+			auto i = std::lower_bound(result.vertices.begin(), result.vertices.end(), index);
+			index = static_cast<uint32_t>(i - result.vertices.begin());
+		}
+
+		return result;
+	}
+
+	void storeIndices(IndexArray& indexArray, size_t firstIndex, const LocalIndices& local)
+	{
+		for (size_t i = 0, e = local.indices.size(); i < e; ++i)
+			indexArray.setIndex(local.vertices[local.indices[i]], firstIndex + i);
+	}
+
+	/*
+	 * Vertex is in cache if it was transformed within last cacheSize misses,
+	 * so flushing is just a shift of the timestamp
+	 */
+	class FIFOVertexCache
+	{
+	public:
+		FIFOVertexCache(size_t vertexCount, size_t cacheSize) :
+			_cacheTime(vertexCount, 0), _cacheSize(static_cast<uint32_t>(cacheSize)),
+			_timestamp(static_cast<uint32_t>(cacheSize) + 1) { }
+
+		uint32_t processTriangle(const uint32_t* triangle)
+		{
+			uint32_t misses = 0;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32_t& vertexTime = _cacheTime[triangle[k]];
+				if (_timestamp - vertexTime > _cacheSize)
+				{
+					vertexTime = _timestamp++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+
+		void flush()
+			{ _timestamp += _cacheSize + 1; }
+
+	private:
+		std::vector<uint32_t> _cacheTime;
+		uint32_t _cacheSize = 0;
+		uint32_t _timestamp = 0;
+	};
+
+	bool validateTriangles(const IndexArray::Pointer& indexArray, const char* function)
+	{
+		if (indexArray->primitiveType() == PrimitiveType::Triangles)
+			return true;
+
+		log::error("primitives::%s - only triangles are supported.", function);
+		return false;
+	}
+}
+
+primitives::VertexCacheStatistics primitives::analyzeVertexCache(const IndexArray::Pointer& indexArray,
+	size_t firstIndex, size_t indexCount, size_t cacheSize)
+{
+	VertexCacheStatistics result;
+
+	indexCount -= indexCount % 3;
+	if ((indexCount == 0) || !validateTriangles(indexArray, "analyzeVertexCache"))
+		return result;
+
+	LocalIndices local = loadIndices(indexArray.reference(), firstIndex, indexCount);
+
+	FIFOVertexCache cache(local.vertices.size(), cacheSize);
+	for (size_t i = 0; i < indexCount; i += 3)
+		result.verticesTransformed += cache.processTriangle(local.indices.data() + i);
+
+	result.trianglesCount = indexCount / 3;
+	result.verticesCount = local.vertices.size();
+	result.acmr = static_cast<float>(result.verticesTransformed) / static_cast<float>(result.trianglesCount);
+	result.atvr = static_cast<float>(result.verticesTransformed) / static_cast<float>(result.verticesCount);
+	return result;
+}
+
+void primitives::optimizeVertexCache(IndexArray::Pointer indexArray, size_t firstIndex, size_t indexCount)
+{
+	indexCount -= indexCount % 3;
+	if ((indexCount <= 3) || !validateTriangles(indexArray, "optimizeVertexCache"))
+		return;
+
+	LocalIndices local = loadIndices(indexArray.reference(), firstIndex, indexCount);
+	const uint32_t* indices = local.indices.data();
+	size_t vertexCount = local.vertices.size();
+	size_t triangleCount = indexCount / 3;
+
+	float cacheScores[forsythCacheSize] = { };
+	for (size_t i = 0; i < forsythCacheSize; ++i)
+	{
+		cacheScores[i] = (i < 3) ? forsythLastTriangleScore : std::pow(1.0f - static_cast<float>(i - 3) /
+			static_cast<float>(forsythCacheSize - 3), forsythCacheDecayPower);
+	}
+
+	float valenceScores[forsythValenceTableSize] = { };
+	for (size_t i = 1; i < forsythValenceTableSize; ++i)
+		valenceScores[i] = forsythValenceBoostScale * std::pow(static_cast<float>(i), -forsythValenceBoostPower);
+
+	auto vertexScore = [&cacheScores, &valenceScores](int cachePosition, uint32_t valence) -> float
+	{
+		if (valence == 0)
+			return -1.0f;
+
+		float result = (cachePosition >= 0) ? cacheScores[cachePosition] : 0.0f;
+
+		return result + ((valence < forsythValenceTableSize) ? valenceScores[valence] :
+			forsythValenceBoostScale * std::pow(static_cast<float>(valence), -forsythValenceBoostPower));
+	};
+
+	/*
+	 * Triangles, which are not emitted yet, for each vertex
+	 */
+	std::vector<uint32_t> valence(vertexCount, 0);
+	for (uint32_t index : local.indices)
+		++valence[index];
+
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indexCount; ++i)
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+		vertexScores[v] = vertexScore(-1, valence[v]);
+
+	uint32_t bestTriangle = invalidIndex;
+	float bestScore = 0.0f;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		const uint32_t* triangle = indices + 3 * t;
+		float score = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(forsythCacheSize + 3);
+	newCache.reserve(forsythCacheSize + 3);
+
+	size_t inputCursor = 0;
+	for (size_t emittedTriangles = 0; emittedTriangles < triangleCount; ++emittedTriangles)
+	{
+		/*
+		 * No triangles adjacent to the cached vertices, take next one in the original order
+		 */
+		if (bestTriangle == invalidIndex)
+		{
+			while (emitted[inputCursor])
+				++inputCursor;
+
+			bestTriangle = static_cast<uint32_t>(inputCursor);
+		}
+
+		const uint32_t* triangle = indices + 3 * bestTriangle;
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = 1;
+
+		newCache.clear();
+		for (size_t k = 0; k < 3; ++k)
+		{
+			uint32_t v = triangle[k];
+			uint32_t* begin = adjacency.data() + adjacencyOffset[v];
+			uint32_t* end = begin + valence[v];
+			uint32_t* i = std::find(begin, end, bestTriangle);
+			ET_ASSERT(i != end);
+			*i = *(end - 1);
+			--valence[v];
+
+			if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+				newCache.push_back(v);
+		}
+
+		for (uint32_t v : cache)
+		{
+			if ((v != triangle[0]) && (v != triangle[1]) && (v != triangle[2]))
+				newCache.push_back(v);
+		}
+		cache.swap(newCache);
+
+		for (size_t i = 0, e = cache.size(); i < e; ++i)
+		{
+			uint32_t v = cache[i];
+			cachePosition[v] = (i < forsythCacheSize) ? static_cast<int>(i) : -1;
+			vertexScores[v] = vertexScore(cachePosition[v], valence[v]);
+		}
+
+		if (cache.size() > forsythCacheSize)
+			cache.resize(forsythCacheSize);
+
+		bestTriangle = invalidIndex;
+		bestScore = 0.0f;
+		for (uint32_t v : cache)
+		{
+			const uint32_t* adjacent = adjacency.data() + adjacencyOffset[v];
+			for (uint32_t a = 0; a < valence[v]; ++a)
+			{
+				const uint32_t* candidate = indices + 3 * adjacent[a];
+				float score = vertexScores[candidate[0]] + vertexScores[candidate[1]] + vertexScores[candidate[2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = adjacent[a];
+				}
+			}
+		}
+	}
+
+	local.indices.swap(output);
+	storeIndices(indexArray.reference(), firstIndex, local);
+}
+
+void primitives::optimizeOverdraw(const VertexArray::Pointer& vertexArray, IndexArray::Pointer indexArray,
+	size_t firstIndex, size_t indexCount, float threshold)
+{
+	indexCount -= indexCount % 3;
+	if ((indexCount <= 3) || !validateTriangles(indexArray, "optimizeOverdraw"))
+		return;
+
+	VertexDataChunk posChunk = vertexArray->chunk(VertexAttributeUsage::Position);
+	if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3))
+	{
+		log::error("primitives::optimizeOverdraw - data is invalid.");
+		return;
+	}
+
+	LocalIndices local = loadIndices(indexArray.reference(), firstIndex, indexCount);
+	const uint32_t* indices = local.indices.data();
+	size_t triangleCount = indexCount / 3;
+
+	FIFOVertexCache cache(local.vertices.size(), defaultVertexCacheSize);
+
+	/*
+	 * Hard boundaries are triangles, which does not reuse any of cached vertices
+	 */
+	std::vector<size_t> hardBoundaries;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		if ((cache.processTriangle(indices + 3 * t) == 3) || (t == 0))
+			hardBoundaries.push_back(t);
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	/*
+	 * Soft boundaries split hard clusters, while ACMR of the cluster
+	 * is not worse than threshold times ACMR of the hard cluster
+	 */
+	std::vector<size_t> clusterStarts;
+	for (size_t c = 0; c + 1 < hardBoundaries.size(); ++c)
+	{
+		size_t begin = hardBoundaries[c];
+		size_t end = hardBoundaries[c + 1];
+
+		uint32_t misses = 0;
+		cache.flush();
+		for (size_t t = begin; t < end; ++t)
+			misses += cache.processTriangle(indices + 3 * t);
+
+		float clusterThreshold = threshold * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+		clusterStarts.push_back(begin);
+
+		misses = 0;
+		size_t clusterStart = begin;
+		cache.flush();
+		for (size_t t = begin; t + 1 < end; ++t)
+		{
+			misses += cache.processTriangle(indices + 3 * t);
+			if (static_cast<float>(misses) <= clusterThreshold * static_cast<float>(t - clusterStart + 1))
+			{
+				clusterStart = t + 1;
+				clusterStarts.push_back(clusterStart);
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+
+	/*
+	 * Clusters facing outwards from the mesh center are drawn first
+	 */
+	auto pos = posChunk.accessData<vec3>(0);
+
+	struct Cluster
+	{
+		size_t begin = 0;
+		size_t end = 0;
+		vec3 centroid;
+		vec3 normal;
+		float area = 0.0f;
+		float sortKey = 0.0f;
+	};
+
+	std::vector<Cluster> clusters(clusterStarts.size() - 1);
+
+	float meshArea = 0.0f;
+	vec3 meshCentroid;
+	for (size_t c = 0, e = clusters.size(); c < e; ++c)
+	{
+		Cluster& cluster = clusters[c];
+		cluster.begin = clusterStarts[c];
+		cluster.end = clusterStarts[c + 1];
+
+		for (size_t t = cluster.begin; t < cluster.end; ++t)
+		{
+			const uint32_t* triangle = indices + 3 * t;
+			const vec3& p0 = pos[static_cast<size_t>(local.vertices[triangle[0]])];
+			const vec3& p1 = pos[static_cast<size_t>(local.vertices[triangle[1]])];
+			const vec3& p2 = pos[static_cast<size_t>(local.vertices[triangle[2]])];
+
+			vec3 n = cross(p1 - p0, p2 - p0);
+			float area = n.length();
+
+			cluster.centroid += area * (p0 + p1 + p2) / 3.0f;
+			cluster.normal += n;
+			cluster.area += area;
+		}
+
+		meshCentroid += cluster.centroid;
+		meshArea += cluster.area;
+
+		if (cluster.area > 0.0f)
+			cluster.centroid /= cluster.area;
+	}
+
+	if (meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	for (auto& cluster : clusters)
+	{
+		float normalLength = cluster.normal.length();
+		if (normalLength > 0.0f)
+			cluster.sortKey = dot(cluster.centroid - meshCentroid, cluster.normal / normalLength);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& l, const Cluster& r)
+		{ return l.sortKey > r.sortKey; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+	for (const auto& cluster : clusters)
+		output.insert(output.end(), indices + 3 * cluster.begin, indices + 3 * cluster.end);
+
+	local.indices.swap(output);
+	storeIndices(indexArray.reference(), firstIndex, local);
+}
+
+void primitives::optimizeVertexFetch(VertexArray::Pointer vertexArray, IndexArray::Pointer indexArray)
+{
+	size_t vertexCount = vertexArray->size();
+
+	std::vector<uint32_t> remap(vertexCount, invalidIndex);
+	uint32_t nextVertex = 0;
+
+	for (size_t i = 0, e = indexArray->actualSize(); i < e; ++i)
+	{
+		uint32_t index = indexArray->getIndex(i);
+		ET_ASSERT(index < vertexCount);
+
+		if (remap[index] == invalidIndex)
+			remap[index] = nextVertex++;
+
+		indexArray->setIndex(remap[index], i);
+	}
+
+	for (auto& index : remap)
+	{
+		if (index == invalidIndex)
+			index = nextVertex++;
+	}
+
+	auto remapChunk = [&remap](VertexDataChunk chunk)
+	{
+		if (chunk.invalid()) return;
+
+		size_t typeSize = chunk->typeSize();
+		if (chunk->dataSize() < remap.size() * typeSize)
+		{
+			log::error("primitives::optimizeVertexFetch - data chunk is smaller than vertex array.");
+			return;
+		}
+
+		BinaryDataStorage source(remap.size() * typeSize);
+		etCopyMemory(source.binary(), chunk->data(), source.dataSize());
+
+		char* destination = chunk->data();
+		for (size_t v = 0, e = remap.size(); v < e; ++v)
+			etCopyMemory(destination + remap[v] * typeSize, source.binary() + v * typeSize, typeSize);
+	};
+
+	VertexDeclaration decl = vertexArray->decl();
+	for (const auto& element : decl.elements())
+		remapChunk(vertexArray->chunk(element.usage()));
+
+	remapChunk(vertexArray->smoothing());
+}
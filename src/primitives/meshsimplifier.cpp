@@ -0,0 +1,679 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/geometry/geometry.h>
+#include <et/primitives/meshsimplifier.h>
+
+using namespace et;
+
+namespace
+{
+	const float borderQuadricWeight = 10.0f;
+	const float passErrorScale = 1.5f;
+	const float maxNormalDeviation = 0.25f;
+	const double minimalQuadricWeight = 1.0e-12;
+
+	/*
+	 * Symmetric 4x4 matrix of the plane distances, weighted by triangle areas
+	 */
+	struct Quadric
+	{
+		double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+		double a01 = 0.0, a02 = 0.0, a12 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void addPlane(const vec3& n, float d, float w)
+		{
+			a00 += w * n.x * n.x;
+			a11 += w * n.y * n.y;
+			a22 += w * n.z * n.z;
+			a01 += w * n.x * n.y;
+			a02 += w * n.x * n.z;
+			a12 += w * n.y * n.z;
+			b0 += w * n.x * d;
+			b1 += w * n.y * d;
+			b2 += w * n.z * d;
+			c += w * d * d;
+		}
+
+		Quadric& operator += (const Quadric& q)
+		{
+			a00 += q.a00; a11 += q.a11; a22 += q.a22;
+			a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			weight += q.weight;
+			return *this;
+		}
+
+		double evaluate(const vec3& p) const
+		{
+			double x = p.x;
+			double y = p.y;
+			double z = p.z;
+			double result = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return etMax(0.0, result);
+		}
+	};
+
+	enum VertexKind : uint8_t
+	{
+		VertexKind_Manifold,
+		VertexKind_Border,
+		VertexKind_Locked,
+	};
+
+	struct Collapse
+	{
+		uint32_t source = 0;
+		uint32_t target = 0;
+		float error = 0.0f;
+
+		Collapse(uint32_t s, uint32_t t, float e) :
+			source(s), target(t), error(e) { }
+	};
+
+	float attributeWeight(VertexAttributeUsage usage, const primitives::SimplificationOptions& options)
+	{
+		switch (usage)
+		{
+			case VertexAttributeUsage::Normal:
+				return options.normalWeight;
+
+			case VertexAttributeUsage::Color:
+				return options.colorWeight;
+
+			case VertexAttributeUsage::TexCoord0:
+			case VertexAttributeUsage::TexCoord1:
+			case VertexAttributeUsage::TexCoord2:
+			case VertexAttributeUsage::TexCoord3:
+				return options.texCoordWeight;
+
+			default:
+				return 0.0f;
+		}
+	}
+
+	class MeshSimplifier
+	{
+	public:
+		MeshSimplifier(const VertexArray::Pointer&, const IndexArray::Pointer&, const primitives::IndexRangeList&,
+			const primitives::SimplificationOptions&);
+
+		float simplify(size_t targetTriangles);
+		void store(IndexArray::Pointer, primitives::SimplificationResult&);
+
+	private:
+		void loadAttributes(const VertexArray::Pointer&, const primitives::SimplificationOptions&);
+		void classifyVertices(bool lockBorders);
+		void computeQuadrics();
+		void buildAdjacency();
+
+		bool hasEdge(uint32_t a, uint32_t b) const;
+		bool isBorderEdge(uint32_t a, uint32_t b) const
+			{ return !(hasEdge(a, b) && hasEdge(b, a)); }
+
+		float collapseError(uint32_t source, uint32_t target) const;
+		bool canCollapse(uint32_t source, uint32_t target) const;
+		bool flipsTriangles(uint32_t source, uint32_t target, const std::vector<uint32_t>& remap) const;
+
+	private:
+		std::vector<vec3> _positions;
+		std::vector<float> _attributes;
+		size_t _attributesStride = 0;
+
+		std::vector<uint32_t> _indices;
+		std::vector<uint32_t> _triangleRanges;
+		size_t _rangesCount = 0;
+
+		std::vector<Quadric> _quadrics;
+		std::vector<uint8_t> _kinds;
+
+		std::vector<uint32_t> _adjacencyOffsets;
+		std::vector<uint32_t> _adjacency;
+
+		float _maxErrorSquared = 0.0f;
+	};
+
+	MeshSimplifier::MeshSimplifier(const VertexArray::Pointer& vertexArray, const IndexArray::Pointer& indexArray,
+		const primitives::IndexRangeList& ranges, const primitives::SimplificationOptions& options) :
+		_rangesCount(ranges.size()), _maxErrorSquared(sqr(options.maxError))
+	{
+		ET_ASSERT(indexArray->primitiveType() == PrimitiveType::Triangles);
+
+		size_t vertexCount = vertexArray->size();
+
+		for (uint32_t r = 0, re = static_cast<uint32_t>(ranges.size()); r < re; ++r)
+		{
+			ET_ASSERT(ranges[r].start + ranges[r].count <= indexArray->actualSize());
+
+			for (size_t i = ranges[r].start, e = ranges[r].start + ranges[r].count / 3 * 3; i < e; i += 3)
+			{
+				uint32_t i0 = indexArray->getIndex(i);
+				uint32_t i1 = indexArray->getIndex(i + 1);
+				uint32_t i2 = indexArray->getIndex(i + 2);
+				if ((i0 == i1) || (i1 == i2) || (i0 == i2))
+					continue;
+
+				ET_ASSERT((i0 < vertexCount) && (i1 < vertexCount) && (i2 < vertexCount));
+				_indices.push_back(i0);
+				_indices.push_back(i1);
+				_indices.push_back(i2);
+				_triangleRanges.push_back(r);
+			}
+		}
+
+		/*
+		 * Positions are normalized to the unit diagonal of the bounds, so errors are relative
+		 */
+		VertexDataChunk posChunk = vertexArray->chunk(VertexAttributeUsage::Position);
+		ET_ASSERT(posChunk.valid() && (posChunk->type() == VertexAttributeType::Vec3));
+
+		auto pos = posChunk.accessData<vec3>(0);
+		_positions.resize(vertexCount);
+
+		vec3 minVertex(std::numeric_limits<float>::max());
+		vec3 maxVertex(-std::numeric_limits<float>::max());
+		for (uint32_t index : _indices)
+		{
+			minVertex = minv(minVertex, pos[static_cast<size_t>(index)]);
+			maxVertex = maxv(maxVertex, pos[static_cast<size_t>(index)]);
+		}
+
+		float diagonal = _indices.empty() ? 0.0f : (maxVertex - minVertex).length();
+		float scale = (diagonal > std::numeric_limits<float>::epsilon()) ? 1.0f / diagonal : 1.0f;
+		for (size_t i = 0; i < vertexCount; ++i)
+			_positions[i] = (pos[i] - minVertex) * scale;
+
+		loadAttributes(vertexArray, options);
+		buildAdjacency();
+		classifyVertices(options.lockBorders);
+		computeQuadrics();
+	}
+
+	void MeshSimplifier::loadAttributes(const VertexArray::Pointer& vertexArray,
+		const primitives::SimplificationOptions& options)
+	{
+		struct Attribute
+		{
+			VertexDataChunk chunk;
+			size_t components = 0;
+			float scale = 0.0f;
+		};
+		std::vector<Attribute> attributes;
+
+		size_t vertexCount = _positions.size();
+		VertexDeclaration decl = vertexArray->decl();
+		for (const auto& element : decl.elements())
+		{
+			float weight = attributeWeight(element.usage(), options);
+			VertexDataChunk chunk = vertexArray->chunk(element.usage());
+
+			if ((weight <= 0.0f) || chunk.invalid() || (chunk->type() == VertexAttributeType::Int) ||
+				(chunk->dataSize() < vertexCount * chunk->typeSize()))
+			{
+				continue;
+			}
+
+			Attribute attribute;
+			attribute.chunk = chunk;
+			attribute.components = chunk->typeSize() / sizeof(float);
+			attribute.scale = std::sqrt(weight);
+			attributes.push_back(attribute);
+			_attributesStride += attribute.components;
+		}
+
+		/*
+		 * Attributes are stored premultiplied by square root of the weights,
+		 * so weighted error is just a squared distance
+		 */
+		_attributes.resize(vertexCount * _attributesStride);
+		float* output = _attributes.data();
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			for (const auto& attribute : attributes)
+			{
+				const float* input = reinterpret_cast<const float*>(attribute.chunk->data() + i * attribute.chunk->typeSize());
+				for (size_t c = 0; c < attribute.components; ++c)
+					*output++ = input[c] * attribute.scale;
+			}
+		}
+	}
+
+	void MeshSimplifier::classifyVertices(bool lockBorders)
+	{
+		size_t vertexCount = _positions.size();
+		_kinds.assign(vertexCount, VertexKind_Manifold);
+
+		/*
+		 * Vertices with the same position and different attributes (seams),
+		 * and vertices shared between ranges, are locked
+		 */
+		std::vector<uint32_t> usedVertices(_indices);
+		std::sort(usedVertices.begin(), usedVertices.end());
+		usedVertices.erase(std::unique(usedVertices.begin(), usedVertices.end()), usedVertices.end());
+
+		std::sort(usedVertices.begin(), usedVertices.end(), [this](uint32_t a, uint32_t b)
+		{
+			const vec3& pa = _positions[a];
+			const vec3& pb = _positions[b];
+			return (pa.x < pb.x) || ((pa.x == pb.x) && ((pa.y < pb.y) || ((pa.y == pb.y) && (pa.z < pb.z))));
+		});
+
+		for (size_t i = 1, e = usedVertices.size(); i < e; ++i)
+		{
+			if (_positions[usedVertices[i]] == _positions[usedVertices[i - 1]])
+			{
+				_kinds[usedVertices[i]] = VertexKind_Locked;
+				_kinds[usedVertices[i - 1]] = VertexKind_Locked;
+			}
+		}
+
+		const uint32_t noRange = static_cast<uint32_t>(-1);
+		std::vector<uint32_t> vertexRanges(vertexCount, noRange);
+		for (size_t i = 0, e = _indices.size(); i < e; ++i)
+		{
+			uint32_t& vertexRange = vertexRanges[_indices[i]];
+			uint32_t triangleRange = _triangleRanges[i / 3];
+
+			if (vertexRange == noRange)
+				vertexRange = triangleRange;
+			else if (vertexRange != triangleRange)
+				_kinds[_indices[i]] = VertexKind_Locked;
+		}
+
+		/*
+		 * Edge without opposite one is the border edge, vertices on the border are allowed to collapse
+		 * only along the border, vertices with more than two border edges (or all border vertices,
+		 * if borders are locked) are not collapsed
+		 */
+		std::vector<uint32_t> borderEdgesCount(vertexCount, 0);
+		for (size_t i = 0, e = _indices.size(); i < e; i += 3)
+		{
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32_t a = _indices[i + k];
+				uint32_t b = _indices[i + (k + 1) % 3];
+				if (!hasEdge(b, a))
+				{
+					++borderEdgesCount[a];
+					++borderEdgesCount[b];
+				}
+			}
+		}
+
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			if ((_kinds[i] == VertexKind_Locked) || (borderEdgesCount[i] == 0))
+				continue;
+
+			_kinds[i] = ((borderEdgesCount[i] == 2) && !lockBorders) ? VertexKind_Border : VertexKind_Locked;
+		}
+	}
+
+	void MeshSimplifier::computeQuadrics()
+	{
+		_quadrics.resize(_positions.size());
+
+		for (size_t i = 0, e = _indices.size(); i < e; i += 3)
+		{
+			uint32_t i0 = _indices[i];
+			uint32_t i1 = _indices[i + 1];
+			uint32_t i2 = _indices[i + 2];
+
+			vec3 n = cross(_positions[i1] - _positions[i0], _positions[i2] - _positions[i0]);
+			float area = 0.5f * n.length();
+			if (area <= 0.0f)
+				continue;
+
+			n /= 2.0f * area;
+			float d = -dot(n, _positions[i0]);
+
+			Quadric q;
+			q.addPlane(n, d, area);
+			q.weight = area;
+
+			_quadrics[i0] += q;
+			_quadrics[i1] += q;
+			_quadrics[i2] += q;
+
+			/*
+			 * Border edges are kept in place by the planes, perpendicular to the triangle
+			 */
+			for (size_t k = 0; k < 3; ++k)
+			{
+				uint32_t a = _indices[i + k];
+				uint32_t b = _indices[i + (k + 1) % 3];
+				if (hasEdge(b, a))
+					continue;
+
+				vec3 edge = _positions[b] - _positions[a];
+				float edgeLength = edge.length();
+				if (edgeLength <= 0.0f)
+					continue;
+
+				vec3 borderNormal = cross(edge, n) / edgeLength;
+				Quadric border;
+				border.addPlane(borderNormal, -dot(borderNormal, _positions[a]), borderQuadricWeight * sqr(edgeLength));
+
+				_quadrics[a] += border;
+				_quadrics[b] += border;
+			}
+		}
+	}
+
+	void MeshSimplifier::buildAdjacency()
+	{
+		_adjacencyOffsets.assign(_positions.size() + 1, 0);
+		for (uint32_t index : _indices)
+			++_adjacencyOffsets[index + 1];
+
+		for (size_t i = 1, e = _adjacencyOffsets.size(); i < e; ++i)
+			_adjacencyOffsets[i] += _adjacencyOffsets[i - 1];
+
+		std::vector<uint32_t> fill(_adjacencyOffsets.begin(), _adjacencyOffsets.end() - 1);
+		_adjacency.resize(_indices.size());
+		for (size_t i = 0, e = _indices.size(); i < e; ++i)
+			_adjacency[fill[_indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	bool MeshSimplifier::hasEdge(uint32_t a, uint32_t b) const
+	{
+		for (uint32_t k = _adjacencyOffsets[a], ke = _adjacencyOffsets[a + 1]; k < ke; ++k)
+		{
+			const uint32_t* triangle = _indices.data() + 3 * _adjacency[k];
+			if (((triangle[0] == a) && (triangle[1] == b)) || ((triangle[1] == a) && (triangle[2] == b)) ||
+				((triangle[2] == a) && (triangle[0] == b)))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool MeshSimplifier::canCollapse(uint32_t source, uint32_t target) const
+	{
+		switch (_kinds[source])
+		{
+			case VertexKind_Manifold:
+				return true;
+
+			case VertexKind_Border:
+				return (_kinds[target] != VertexKind_Manifold) && isBorderEdge(source, target);
+
+			default:
+				return false;
+		}
+	}
+
+	float MeshSimplifier::collapseError(uint32_t source, uint32_t target) const
+	{
+		const Quadric& q = _quadrics[source];
+		double weight = etMax(q.weight, minimalQuadricWeight);
+
+		double attributesError = 0.0;
+		const float* a = _attributes.data() + source * _attributesStride;
+		const float* b = _attributes.data() + target * _attributesStride;
+		for (size_t i = 0; i < _attributesStride; ++i)
+			attributesError += sqr(a[i] - b[i]);
+
+		return static_cast<float>(q.evaluate(_positions[target]) / weight + attributesError);
+	}
+
+	bool MeshSimplifier::flipsTriangles(uint32_t source, uint32_t target, const std::vector<uint32_t>& remap) const
+	{
+		for (uint32_t k = _adjacencyOffsets[source], ke = _adjacencyOffsets[source + 1]; k < ke; ++k)
+		{
+			const uint32_t* triangle = _indices.data() + 3 * _adjacency[k];
+
+			uint32_t t[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+			if ((t[0] == t[1]) || (t[1] == t[2]) || (t[0] == t[2]))
+				continue;
+
+			if ((t[0] == target) || (t[1] == target) || (t[2] == target))
+				continue;
+
+			vec3 p[3] = { _positions[t[0]], _positions[t[1]], _positions[t[2]] };
+			vec3 normalBefore = cross(p[1] - p[0], p[2] - p[0]);
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				if (t[i] == source)
+					p[i] = _positions[target];
+			}
+			vec3 normalAfter = cross(p[1] - p[0], p[2] - p[0]);
+
+			if (dot(normalBefore, normalAfter) <= maxNormalDeviation * normalBefore.length() * normalAfter.length())
+				return true;
+		}
+		return false;
+	}
+
+	float MeshSimplifier::simplify(size_t targetTriangles)
+	{
+		float result = 0.0f;
+		size_t vertexCount = _positions.size();
+
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> lockedInPass(vertexCount);
+
+		const uint32_t noTarget = static_cast<uint32_t>(-1);
+		std::vector<uint32_t> bestTargets(vertexCount);
+		std::vector<float> bestErrors(vertexCount);
+
+		auto collapseComparator = [](const Collapse& l, const Collapse& r)
+			{ return l.error < r.error; };
+
+		while (_indices.size() / 3 > targetTriangles)
+		{
+			/*
+			 * Only the cheapest collapse of each vertex is considered within the pass
+			 */
+			std::fill(bestTargets.begin(), bestTargets.end(), noTarget);
+			std::fill(bestErrors.begin(), bestErrors.end(), std::numeric_limits<float>::max());
+			for (size_t i = 0, e = _indices.size(); i < e; ++i)
+			{
+				uint32_t a = _indices[i];
+				uint32_t b = _indices[(i % 3 == 2) ? i - 2 : i + 1];
+
+				if (canCollapse(a, b))
+				{
+					float error = collapseError(a, b);
+					if (error < bestErrors[a])
+					{
+						bestErrors[a] = error;
+						bestTargets[a] = b;
+					}
+				}
+
+				if (canCollapse(b, a))
+				{
+					float error = collapseError(b, a);
+					if (error < bestErrors[b])
+					{
+						bestErrors[b] = error;
+						bestTargets[b] = a;
+					}
+				}
+			}
+
+			collapses.clear();
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				if ((bestTargets[i] != noTarget) && (bestErrors[i] <= _maxErrorSquared))
+					collapses.emplace_back(i, bestTargets[i], bestErrors[i]);
+			}
+
+			if (collapses.empty())
+				break;
+
+			/*
+			 * Each collapse removes about two triangles, collapses much worse than the ones
+			 * which would be enough to reach the target are postponed to the next pass
+			 */
+			size_t trianglesToRemove = _indices.size() / 3 - targetTriangles;
+			size_t limitIndex = etMin(collapses.size() - 1, trianglesToRemove / 2);
+			std::nth_element(collapses.begin(), collapses.begin() + limitIndex, collapses.end(), collapseComparator);
+			float passErrorLimit = etMin(_maxErrorSquared, collapses[limitIndex].error * passErrorScale);
+
+			auto passEnd = std::partition(collapses.begin(), collapses.end(),
+				[passErrorLimit](const Collapse& c) { return c.error <= passErrorLimit; });
+			collapses.erase(passEnd, collapses.end());
+			std::sort(collapses.begin(), collapses.end(), collapseComparator);
+
+			for (uint32_t i = 0; i < vertexCount; ++i)
+				remap[i] = i;
+			std::fill(lockedInPass.begin(), lockedInPass.end(), false);
+
+			size_t trianglesRemoved = 0;
+			for (const auto& collapse : collapses)
+			{
+				if ((collapse.error > passErrorLimit) || (trianglesRemoved >= trianglesToRemove))
+					break;
+
+				if (lockedInPass[collapse.source] || lockedInPass[collapse.target])
+					continue;
+
+				if (flipsTriangles(collapse.source, collapse.target, remap))
+					continue;
+
+				for (uint32_t k = _adjacencyOffsets[collapse.source], ke = _adjacencyOffsets[collapse.source + 1]; k < ke; ++k)
+				{
+					const uint32_t* triangle = _indices.data() + 3 * _adjacency[k];
+					if ((remap[triangle[0]] == collapse.target) || (remap[triangle[1]] == collapse.target) ||
+						(remap[triangle[2]] == collapse.target))
+					{
+						++trianglesRemoved;
+					}
+				}
+
+				remap[collapse.source] = collapse.target;
+				lockedInPass[collapse.source] = true;
+				lockedInPass[collapse.target] = true;
+
+				_quadrics[collapse.target] += _quadrics[collapse.source];
+				result = etMax(result, collapse.error);
+			}
+
+			if (trianglesRemoved == 0)
+				break;
+
+			size_t writePosition = 0;
+			for (size_t i = 0, e = _indices.size(); i < e; i += 3)
+			{
+				uint32_t i0 = remap[_indices[i]];
+				uint32_t i1 = remap[_indices[i + 1]];
+				uint32_t i2 = remap[_indices[i + 2]];
+				if ((i0 == i1) || (i1 == i2) || (i0 == i2))
+					continue;
+
+				_triangleRanges[writePosition / 3] = _triangleRanges[i / 3];
+				_indices[writePosition++] = i0;
+				_indices[writePosition++] = i1;
+				_indices[writePosition++] = i2;
+			}
+			_indices.resize(writePosition);
+			_triangleRanges.resize(writePosition / 3);
+
+			buildAdjacency();
+		}
+
+		return std::sqrt(result);
+	}
+
+	void MeshSimplifier::store(IndexArray::Pointer indexArray, primitives::SimplificationResult& result)
+	{
+		size_t firstIndex = indexArray->actualSize();
+		if (indexArray->capacity() < firstIndex + _indices.size())
+			indexArray->resize(firstIndex + _indices.size());
+
+		std::vector<uint32_t> rangeCounts(_rangesCount, 0);
+		for (uint32_t r : _triangleRanges)
+			rangeCounts[r] += 3;
+
+		result.ranges.resize(_rangesCount);
+		std::vector<uint32_t> rangeWritePositions(_rangesCount, 0);
+		for (size_t r = 0, position = firstIndex; r < _rangesCount; ++r)
+		{
+			result.ranges[r] = primitives::IndexRange(static_cast<uint32_t>(position), rangeCounts[r]);
+			rangeWritePositions[r] = static_cast<uint32_t>(position);
+			position += rangeCounts[r];
+		}
+
+		for (size_t i = 0, e = _indices.size(); i < e; i += 3)
+		{
+			uint32_t& position = rangeWritePositions[_triangleRanges[i / 3]];
+			indexArray->setIndex(_indices[i], position++);
+			indexArray->setIndex(_indices[i + 1], position++);
+			indexArray->setIndex(_indices[i + 2], position++);
+		}
+
+		indexArray->setActualSize(firstIndex + _indices.size());
+		result.trianglesCount = _indices.size() / 3;
+	}
+}
+
+primitives::SimplificationResult primitives::simplify(const VertexArray::Pointer& vertexArray,
+	IndexArray::Pointer indexArray, const IndexRangeList& ranges, float targetRatio, const SimplificationOptions& options)
+{
+	MeshSimplifier simplifier(vertexArray, indexArray, ranges, options);
+
+	size_t trianglesCount = 0;
+	for (const auto& range : ranges)
+		trianglesCount += range.count / 3;
+
+	SimplificationResult result;
+	result.error = simplifier.simplify(static_cast<size_t>(clamp(targetRatio, 0.0f, 1.0f) * static_cast<float>(trianglesCount)));
+	simplifier.store(indexArray, result);
+	return result;
+}
+
+primitives::LevelOfDetailList primitives::buildLevelsOfDetail(const VertexArray::Pointer& vertexArray,
+	IndexArray::Pointer indexArray, const IndexRangeList& ranges, const std::vector<float>& ratios,
+	float screenError, const SimplificationOptions& options)
+{
+	LevelOfDetailList result;
+	result.reserve(ratios.size());
+
+	size_t sourceTriangles = 0;
+	for (const auto& range : ranges)
+		sourceTriangles += range.count / 3;
+
+	const IndexRangeList* sourceRanges = &ranges;
+	size_t sourceLevelTriangles = sourceTriangles;
+	float sourceLevelError = 0.0f;
+
+	for (float ratio : ratios)
+	{
+		if (sourceLevelTriangles == 0)
+			break;
+
+		float targetTriangles = ratio * static_cast<float>(sourceTriangles);
+		SimplificationResult level = simplify(vertexArray, indexArray, *sourceRanges,
+			targetTriangles / static_cast<float>(sourceLevelTriangles), options);
+
+		/*
+		 * Each level accumulates errors of the previous levels
+		 */
+		result.emplace_back();
+		LevelOfDetail& lod = result.back();
+		lod.ranges.swap(level.ranges);
+		lod.trianglesCount = level.trianglesCount;
+		lod.error = sourceLevelError + level.error;
+		lod.screenCoverage = (lod.error > 0.0f) ? screenError / lod.error : std::numeric_limits<float>::max();
+
+		sourceRanges = &lod.ranges;
+		sourceLevelTriangles = lod.trianglesCount;
+		sourceLevelError = lod.error;
+	}
+
+	return result;
+}
@@ -7,10 +7,83 @@
 
 #include <et/core/containers.h>
 #include <et/geometry/geometry.h>
+#include <et/tasks/jobsystem.h>
 #include <et/primitives/primitives.h>
 
 using namespace et;
 
+namespace
+{
+	const size_t minimumVerticesPerJob = 16384;
+	const uint32_t invalidVertex = static_cast<uint32_t>(-1);
+	
+	/*
+	 * Cell coordinates are packed into 64-bit key, 21 bits per axis
+	 */
+	const uint32_t cellGridBits = 21;
+	const float cellGridRange = static_cast<float>(1 << (cellGridBits - 1));
+	
+	inline uint64_t mixHash(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+	
+	inline uint64_t packCell(const vec3i& c)
+	{
+		const uint64_t mask = (1ull << cellGridBits) - 1;
+		return (static_cast<uint64_t>(c.x) & mask) | ((static_cast<uint64_t>(c.y) & mask) << cellGridBits) |
+			((static_cast<uint64_t>(c.z) & mask) << (2 * cellGridBits));
+	}
+	
+	/*
+	 * Open addressing hash table from the grid cell to the list of vertices inside of it
+	 */
+	class CellGrid
+	{
+	public:
+		CellGrid(size_t maxCells)
+		{
+			size_t tableSize = 16;
+			while (tableSize < 2 * maxCells)
+				tableSize *= 2;
+			
+			_cells.resize(tableSize, 0);
+			_heads.resize(tableSize, invalidVertex);
+			_mask = tableSize - 1;
+		}
+		
+		uint32_t find(uint64_t cell) const
+		{
+			for (size_t i = mixHash(cell) & _mask; _heads[i] != invalidVertex; i = (i + 1) & _mask)
+			{
+				if (_cells[i] == cell)
+					return _heads[i];
+			}
+			return invalidVertex;
+		}
+		
+		uint32_t& head(uint64_t cell)
+		{
+			size_t i = mixHash(cell) & _mask;
+			while ((_heads[i] != invalidVertex) && (_cells[i] != cell))
+				i = (i + 1) & _mask;
+			
+			_cells[i] = cell;
+			return _heads[i];
+		}
+		
+	private:
+		std::vector<uint64_t> _cells;
+		std::vector<uint32_t> _heads;
+		size_t _mask = 0;
+	};
+}
+
 inline int getIndex(int u, int v, int u_sz, int v_sz)
 	{ return clamp<int>(u, 0, u_sz - 1) + clamp<int>(v, 0, v_sz - 1) * u_sz; }
 
@@ -464,159 +537,370 @@ uint32_t primitives::buildTriangleStripIndexes(IndexArray::Pointer buffer, const
 	return buildTriangleStripIndexes(buffer.reference(), dim, vertexOffset, indexOffset);
 }
 
-void primitives::calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer, size_t first, size_t last)
+namespace
 {
-	ET_ASSERT(first < last);
-
-	VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
-	VertexDataChunk nrmChunk = data->chunk(VertexAttributeUsage::Normal);
-
-	if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) || !nrmChunk.valid() ||
-		(nrmChunk->type() != VertexAttributeType::Vec3))
-	{
-		log::error("primitives::calculateNormals - data is invalid.");
-		return;
-	}
-	
-	RawDataAcessor<vec3> nrm = nrmChunk.accessData<vec3>(0);
-	RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(0);
+	const size_t minimumTrianglesPerJob = 8192;
 	
-	const auto& e = buffer->primitive(last);
-	
-	for (auto i = buffer->primitive(first); i != e; ++i)
-	{
-		const auto& p = (*i);
-		nrm[p[0]] = vec3(0.0f);
-		nrm[p[1]] = vec3(0.0f);
-		nrm[p[2]] = vec3(0.0f);
-	}
-
-	for (auto i = buffer->primitive(first); i != e; ++i)
+	template <typename F>
+	void runParallel(JobSystem* jobs, size_t count, size_t minimumRange, F f)
 	{
-		const auto& p = (*i);
-		triangle t(pos[p[0]], pos[p[1]], pos[p[2]]);
-		vec3 n = t.normalizedNormal() * t.square();
-		nrm[p[0]] += n;
-		nrm[p[1]] += n;
-		nrm[p[2]] += n;
+		if ((jobs == nullptr) || (count <= minimumRange))
+			f(0, count);
+		else
+			jobs->parallelFor(0, count, minimumRange, f);
 	}
 	
-	for (auto i = buffer->primitive(first); i != e; ++i)
+	/*
+	 * Triangles of the primitives range as plain list of indices
+	 */
+	std::vector<uint32_t> loadTriangles(const IndexArray::Pointer& buffer, size_t first, size_t last, size_t vertexCount)
 	{
-		const auto& p = (*i);
-		nrm[p[0]].normalize();
-		nrm[p[1]].normalize();
-		nrm[p[2]].normalize();
+		std::vector<uint32_t> indices;
+		indices.reserve(3 * (last - first));
+		for (auto i = buffer->primitive(first), e = buffer->primitive(last); i != e; ++i)
+		{
+			const auto& p = (*i);
+			ET_ASSERT((p[0] < vertexCount) && (p[1] < vertexCount) && (p[2] < vertexCount));
+			indices.push_back(static_cast<uint32_t>(p[0]));
+			indices.push_back(static_cast<uint32_t>(p[1]));
+			indices.push_back(static_cast<uint32_t>(p[2]));
+		}
+		(void)vertexCount;
+		return indices;
 	}
-}
-
-void primitives::calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
-	uint32_t first, uint32_t last)
-{
-	ET_ASSERT(first < last);
 	
-	VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
-	VertexDataChunk nrmChunk = data->chunk(VertexAttributeUsage::Normal);
-	VertexDataChunk uvChunk = data->chunk(VertexAttributeUsage::TexCoord0);
-	VertexDataChunk tanChunk = data->chunk(VertexAttributeUsage::Tangent);
-	
-	if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) ||
-		nrmChunk.invalid() || (nrmChunk->type() != VertexAttributeType::Vec3) ||
-		tanChunk.invalid() || (tanChunk->type() != VertexAttributeType::Vec3) ||
-		uvChunk.invalid() || (uvChunk->type() != VertexAttributeType::Vec2))
+	/*
+	 * Sums values of the triangles sharing each of the used vertices and passes sum to the function.
+	 * Sequentially values are scattered to vertices, in parallel they are gathered by each vertex
+	 * using triangles adjacency, so there are no concurrent writes.
+	 */
+	template <typename T, typename F>
+	void accumulateTriangleValues(const std::vector<uint32_t>& indices, const std::vector<T>& values,
+		size_t vertexCount, JobSystem* jobs, F f)
 	{
-		log::error("primitives::calculateTangents - data is invalid.");
-		return;
+		if (jobs == nullptr)
+		{
+			std::vector<T> sums(vertexCount, T(0.0f));
+			std::vector<bool> used(vertexCount, false);
+			for (size_t i = 0, e = indices.size(); i < e; ++i)
+			{
+				sums[indices[i]] += values[i / 3];
+				used[indices[i]] = true;
+			}
+			
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				if (used[v])
+					f(v, sums[v]);
+			}
+			return;
+		}
+		
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (uint32_t index : indices)
+			++offsets[index + 1];
+		
+		std::vector<uint32_t> usedVertices;
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			if (offsets[v + 1] > 0)
+				usedVertices.push_back(static_cast<uint32_t>(v));
+			offsets[v + 1] += offsets[v];
+		}
+		
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		std::vector<uint32_t> adjacency(indices.size());
+		for (size_t i = 0, e = indices.size(); i < e; ++i)
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		
+		jobs->parallelFor(0, usedVertices.size(), minimumVerticesPerJob, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				uint32_t v = usedVertices[i];
+				
+				T sum(0.0f);
+				for (uint32_t k = offsets[v], ke = offsets[v + 1]; k < ke; ++k)
+					sum += values[adjacency[k]];
+				
+				f(v, sum);
+			}
+		});
 	}
-
-	DataStorage<vec3> tan1(data->size(), 0);
-	DataStorage<vec3> tan2(data->size(), 0);
-
-	RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(0);
-	RawDataAcessor<vec3> nrm = nrmChunk.accessData<vec3>(0);
-	RawDataAcessor<vec3> tan = tanChunk.accessData<vec3>(0);
-	RawDataAcessor<vec2> uv = uvChunk.accessData<vec2>(0);
-
-	for (IndexArray::PrimitiveIterator i = buffer->primitive(first), e = buffer->primitive(last); i != e; ++i)
+	
+	struct TangentSpace
 	{
-		IndexArray::Primitive& p = (*i);
+		vec3 tangent;
+		vec3 binormal;
 		
-		vec3& v1 = pos[p[0]];
-		vec3& v2 = pos[p[1]];
-		vec3& v3 = pos[p[2]];
-		vec2& w1 = uv[p[0]];
-		vec2& w2 = uv[p[1]];
-		vec2& w3 = uv[p[2]];
-
-		float x1 = v2.x - v1.x; 
-		float x2 = v3.x - v1.x; 
-		float y1 = v2.y - v1.y; 
-		float y2 = v3.y - v1.y; 
-		float z1 = v2.z - v1.z; 
-		float z2 = v3.z - v1.z; 
-		float s1 = w2.x - w1.x; 
-		float s2 = w3.x - w1.x; 
-		float t1 = w2.y - w1.y; 
-		float t2 = w3.y - w1.y; 
-		float r = 1.0f / (s1 * t2 - s2 * t1); 
-
-		vec3 sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
-		vec3 tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r); 
-
-		tan1[p[0]] += sdir; 
-		tan1[p[1]] += sdir; 
-		tan1[p[2]] += sdir;
-		tan2[p[0]] += tdir; 
-		tan2[p[1]] += tdir; 
-		tan2[p[2]] += tdir; 
-	} 
-
-	for (IndexArray::PrimitiveIterator i = buffer->primitive(first), e = buffer->primitive(last); i != e; ++i)
+		TangentSpace(float value) :
+			tangent(value), binormal(value) { }
+		
+		TangentSpace& operator += (const TangentSpace& t)
+		{
+			tangent += t.tangent;
+			binormal += t.binormal;
+			return *this;
+		}
+	};
+	
+	void calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+		size_t first, size_t last, JobSystem* jobs)
 	{
-		const IndexArray::Primitive& p = (*i);
-		for (size_t k = 0; k < 3; ++k)
+		ET_ASSERT(first < last);
+		
+		VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
+		VertexDataChunk nrmChunk = data->chunk(VertexAttributeUsage::Normal);
+		
+		if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) || !nrmChunk.valid() ||
+			(nrmChunk->type() != VertexAttributeType::Vec3))
 		{
-			vec3& n = nrm[p[k]];
-			vec3& t = tan1[p[k]]; 
-			float value = dot(cross(n, t), tan2[p[k]]);
-			tan[p[k]] = normalize(t - n * dot(n, t)) * signOrZero(value);
+			log::error("primitives::calculateNormals - data is invalid.");
+			return;
 		}
+		
+		RawDataAcessor<vec3> nrm = nrmChunk.accessData<vec3>(0);
+		RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(0);
+		
+		std::vector<uint32_t> indices = loadTriangles(buffer, first, last, data->size());
+		
+		/*
+		 * Cross product of the edges is normal, weighted by triangle area.
+		 * Triangles are processed by four, edges are stored as x[4], y[4], z[4].
+		 */
+		std::vector<vec3> faceNormals(indices.size() / 3);
+		auto computeFaceNormals = [&indices, &faceNormals, &pos](size_t begin, size_t end)
+		{
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				float e1[12];
+				float e2[12];
+				float n[12];
+				for (size_t k = 0; k < 4; ++k)
+				{
+					const uint32_t* t = indices.data() + 3 * (i + k);
+					const vec3& p0 = pos[static_cast<size_t>(t[0])];
+					vec3 edge1 = pos[static_cast<size_t>(t[1])] - p0;
+					vec3 edge2 = pos[static_cast<size_t>(t[2])] - p0;
+					e1[k] = edge1.x;
+					e1[4 + k] = edge1.y;
+					e1[8 + k] = edge1.z;
+					e2[k] = edge2.x;
+					e2[4 + k] = edge2.y;
+					e2[8 + k] = edge2.z;
+				}
+				
+				simd::crossProducts4(e1, e2, n);
+				
+				for (size_t k = 0; k < 4; ++k)
+					faceNormals[i + k] = vec3(n[k], n[4 + k], n[8 + k]);
+			}
+			
+			for (; i < end; ++i)
+			{
+				const uint32_t* t = indices.data() + 3 * i;
+				const vec3& p0 = pos[static_cast<size_t>(t[0])];
+				faceNormals[i] = cross(pos[static_cast<size_t>(t[1])] - p0, pos[static_cast<size_t>(t[2])] - p0);
+			}
+		};
+		runParallel(jobs, faceNormals.size(), minimumTrianglesPerJob, computeFaceNormals);
+		
+		accumulateTriangleValues(indices, faceNormals, data->size(), jobs, [&nrm](size_t v, const vec3& n)
+			{ nrm[v] = normalize(n); });
 	}
-}
-
-void primitives::smoothTangents(VertexArray::Pointer data, const IndexArray::Pointer&,
-	uint32_t first, uint32_t last)
-{
-	ET_ASSERT(first < last);
-	
-	VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
-	VertexDataChunk tanChunk = data->chunk(VertexAttributeUsage::Tangent);
 	
-	if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) || !tanChunk.valid() ||
-		(tanChunk->type() != VertexAttributeType::Vec3))
+	void calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+		uint32_t first, uint32_t last, JobSystem* jobs)
 	{
-		log::error("primitives::smoothTangents - data is invalid.");
-		return;
+		ET_ASSERT(first < last);
+		
+		VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
+		VertexDataChunk nrmChunk = data->chunk(VertexAttributeUsage::Normal);
+		VertexDataChunk uvChunk = data->chunk(VertexAttributeUsage::TexCoord0);
+		VertexDataChunk tanChunk = data->chunk(VertexAttributeUsage::Tangent);
+		
+		if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) ||
+			nrmChunk.invalid() || (nrmChunk->type() != VertexAttributeType::Vec3) ||
+			tanChunk.invalid() || (tanChunk->type() != VertexAttributeType::Vec3) ||
+			uvChunk.invalid() || (uvChunk->type() != VertexAttributeType::Vec2))
+		{
+			log::error("primitives::calculateTangents - data is invalid.");
+			return;
+		}
+		
+		RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(0);
+		RawDataAcessor<vec3> nrm = nrmChunk.accessData<vec3>(0);
+		RawDataAcessor<vec3> tan = tanChunk.accessData<vec3>(0);
+		RawDataAcessor<vec2> uv = uvChunk.accessData<vec2>(0);
+		
+		std::vector<uint32_t> indices = loadTriangles(buffer, first, last, data->size());
+		
+		std::vector<TangentSpace> faceTangents(indices.size() / 3, TangentSpace(0.0f));
+		auto computeFaceTangents = [&indices, &faceTangents, &pos, &uv](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				const uint32_t* t = indices.data() + 3 * i;
+				
+				const vec3& v1 = pos[static_cast<size_t>(t[0])];
+				const vec3& v2 = pos[static_cast<size_t>(t[1])];
+				const vec3& v3 = pos[static_cast<size_t>(t[2])];
+				const vec2& w1 = uv[static_cast<size_t>(t[0])];
+				const vec2& w2 = uv[static_cast<size_t>(t[1])];
+				const vec2& w3 = uv[static_cast<size_t>(t[2])];
+				
+				vec3 e1 = v2 - v1;
+				vec3 e2 = v3 - v1;
+				float s1 = w2.x - w1.x;
+				float s2 = w3.x - w1.x;
+				float t1 = w2.y - w1.y;
+				float t2 = w3.y - w1.y;
+				
+				/*
+				 * Triangles with degenerate texture coordinates do not contribute
+				 */
+				float det = s1 * t2 - s2 * t1;
+				float r = (det != 0.0f) ? 1.0f / det : 0.0f;
+				
+				faceTangents[i].tangent = (e1 * t2 - e2 * t1) * r;
+				faceTangents[i].binormal = (e2 * s1 - e1 * s2) * r;
+			}
+		};
+		runParallel(jobs, faceTangents.size(), minimumTrianglesPerJob, computeFaceTangents);
+		
+		accumulateTriangleValues(indices, faceTangents, data->size(), jobs, [&nrm, &tan](size_t v, const TangentSpace& ts)
+		{
+			const vec3& n = nrm[v];
+			const vec3& t = ts.tangent;
+			tan[v] = normalize(t - n * dot(n, t)) * signOrZero(dot(cross(n, t), ts.binormal));
+		});
 	}
-
-	size_t len = last - first;
-	DataStorage<vec3> tanSmooth(data->size());
-	RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(first);
-	RawDataAcessor<vec3> tan = tanChunk.accessData<vec3>(first);
-	for (size_t p = 0; p < len; ++p)
+	
+	/*
+	 * Vertices closer than distance are looked up in the grid with cell of (at least) twice the distance,
+	 * so only own cell and the nearest adjacent cell along each axis are checked
+	 */
+	void smoothVectors(VertexArray::Pointer data, VertexAttributeUsage usage, uint32_t first, uint32_t last,
+		float distance, JobSystem* jobs, const char* functionName)
 	{
-		tanSmooth[p] = tan[p];
-		for (size_t i = p + 1; i < len; ++i)
+		ET_ASSERT(first < last);
+		
+		VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
+		VertexDataChunk valuesChunk = data->chunk(usage);
+		
+		if (posChunk.invalid() || (posChunk->type() != VertexAttributeType::Vec3) || !valuesChunk.valid() ||
+			(valuesChunk->type() != VertexAttributeType::Vec3))
+		{
+			log::error("primitives::%s - data is invalid.", functionName);
+			return;
+		}
+		
+		size_t count = last - first;
+		RawDataAcessor<vec3> pos = posChunk.accessData<vec3>(first);
+		RawDataAcessor<vec3> values = valuesChunk.accessData<vec3>(first);
+		
+		/*
+		 * Smoothing groups are bit masks, vertices with equal groups are always smoothed together
+		 */
+		const int* groups = nullptr;
+		const VertexDataChunk& smoothing = data->smoothing();
+		if (smoothing.valid() && (smoothing->dataSize() >= last * sizeof(int)))
+			groups = reinterpret_cast<const int*>(smoothing->data()) + first;
+		
+		vec3 extent(0.0f);
+		for (size_t i = 0; i < count; ++i)
+			extent = maxv(extent, absv(pos[i]));
+		
+		float maxCoordinate = etMax(extent.x, etMax(extent.y, extent.z));
+		float cellSize = etMax(2.0f * distance, maxCoordinate / cellGridRange);
+		float scale = (cellSize > 0.0f) ? 1.0f / cellSize : 1.0f;
+		
+		std::vector<vec3i> cells(count);
+		std::vector<vec3i> sides(count);
+		auto computeCells = [&cells, &sides, &pos, scale](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				vec3 p = pos[i] * scale;
+				vec3 c(std::floor(p.x), std::floor(p.y), std::floor(p.z));
+				vec3 f = p - c;
+				
+				cells[i] = vec3i(static_cast<int>(c.x), static_cast<int>(c.y), static_cast<int>(c.z));
+				sides[i] = vec3i(f.x < 0.5f ? -1 : 1, f.y < 0.5f ? -1 : 1, f.z < 0.5f ? -1 : 1);
+			}
+		};
+		runParallel(jobs, count, minimumVerticesPerJob, computeCells);
+		
+		CellGrid grid(count);
+		std::vector<uint32_t> nextInCell(count);
+		for (size_t i = 0; i < count; ++i)
 		{
-			if ((pos[p] - pos[i]).dotSelf() <= 1.0e-3f)
-				tanSmooth[p] += tan[i];
+			uint32_t& head = grid.head(packCell(cells[i]));
+			nextInCell[i] = head;
+			head = static_cast<uint32_t>(i);
 		}
+		
+		float distanceSquared = sqr(distance);
+		std::vector<vec3> smoothed(count);
+		auto smoothValues = [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				vec3 sum(0.0f);
+				for (int n = 0; n < 8; ++n)
+				{
+					vec3i cell = cells[i] + vec3i((n & 1) ? sides[i].x : 0, (n & 2) ? sides[i].y : 0, (n & 4) ? sides[i].z : 0);
+					for (uint32_t u = grid.find(packCell(cell)); u != invalidVertex; u = nextInCell[u])
+					{
+						size_t j = u;
+						if ((pos[j] - pos[i]).dotSelf() > distanceSquared)
+							continue;
+						
+						if ((groups == nullptr) || (groups[i] == groups[j]) || ((groups[i] & groups[j]) != 0))
+							sum += values[j];
+					}
+				}
+				smoothed[i] = normalize(sum);
+			}
+		};
+		runParallel(jobs, count, minimumVerticesPerJob, smoothValues);
+		
+		for (size_t i = 0; i < count; ++i)
+			values[i] = smoothed[i];
 	}
-
-	for (size_t i = 0; i < len; ++i)
-		tan[i] = normalize(tanSmooth[i]);
 }
 
+void primitives::calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer, size_t first, size_t last)
+	{ ::calculateNormals(data, buffer, first, last, nullptr); }
+
+void primitives::calculateNormals(VertexArray::Pointer data, const IndexArray::Pointer& buffer, size_t first, size_t last,
+	JobSystem& jobs)
+	{ ::calculateNormals(data, buffer, first, last, &jobs); }
+
+void primitives::calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+	uint32_t first, uint32_t last)
+	{ ::calculateTangents(data, buffer, first, last, nullptr); }
+
+void primitives::calculateTangents(VertexArray::Pointer data, const IndexArray::Pointer& buffer,
+	uint32_t first, uint32_t last, JobSystem& jobs)
+	{ ::calculateTangents(data, buffer, first, last, &jobs); }
+
+void primitives::smoothNormals(VertexArray::Pointer data, uint32_t first, uint32_t last, float distance)
+	{ smoothVectors(data, VertexAttributeUsage::Normal, first, last, distance, nullptr, "smoothNormals"); }
+
+void primitives::smoothNormals(VertexArray::Pointer data, uint32_t first, uint32_t last, float distance,
+	JobSystem& jobs)
+	{ smoothVectors(data, VertexAttributeUsage::Normal, first, last, distance, &jobs, "smoothNormals"); }
+
+void primitives::smoothTangents(VertexArray::Pointer data, const IndexArray::Pointer&,
+	uint32_t first, uint32_t last, float distance)
+	{ smoothVectors(data, VertexAttributeUsage::Tangent, first, last, distance, nullptr, "smoothTangents"); }
+
+void primitives::smoothTangents(VertexArray::Pointer data, const IndexArray::Pointer&,
+	uint32_t first, uint32_t last, float distance, JobSystem& jobs)
+	{ smoothVectors(data, VertexAttributeUsage::Tangent, first, last, distance, &jobs, "smoothTangents"); }
+
 #define ET_ADD_TRIANGLE(c1, c2, c3) \
 	{ \
 		pos[ k ] = corners[c1]; \
@@ -993,92 +1277,290 @@ void primitives::tesselateTriangles(VertexArray::Pointer data, const vec3& aspec
 	tesselateTriangles(data, linearIndices, aspect);
 }
 
-uint64_t primitives::vector3Hash(const vec3& v)
-{
-	char raw[256] = { };
-	
-	int64_t ix = static_cast<int64_t>(174763.0f * v.x);
-	int64_t iy = static_cast<int64_t>(478441.0f * v.y);
-	int64_t iz = static_cast<int64_t>(720743.0f * v.z);
-	int symbols = sprintf(raw, "%lld%lld%lld%lld", ix, iy, iz, ix+iy+iz);
-	
-	uint64_t* ptr = reinterpret_cast<uint64_t*>(raw);
-	uint64_t* end = ptr + symbols / sizeof(uint64_t) + 1;
-	uint64_t result = *ptr++;
-	
-	while (ptr != end)
-		result ^= *ptr++;
-	
-	return result;
-}
-
-VertexArray::Pointer primitives::buildLinearIndexArray(VertexArray::Pointer vertexArray, IndexArray::Pointer indexArray)
+namespace
 {
 	/*
-	 * Count unique vertices
+	 * Attributes without float components are compared bitwise
 	 */
-	size_t dataSize = vertexArray->size();
-	std::map<uint64_t, size_t> countMap;
-	std::vector<uint64_t> hashes;
-	hashes.reserve(vertexArray->size());
-	
-	auto oldPos = vertexArray->chunk(VertexAttributeUsage::Position).accessData<vec3>(0);
-	auto oldNrm = vertexArray->chunk(VertexAttributeUsage::Normal).accessData<vec3>(0);
-	auto oldClr = vertexArray->chunk(VertexAttributeUsage::Color).accessData<vec4>(0);
+	struct WeldingAttribute
+	{
+		const char* data = nullptr;
+		size_t typeSize = 0;
+		size_t components = 0;
+		float tolerance = 0.0f;
+	};
 	
-	for (size_t i = 0; i < dataSize; ++i)
+	bool verticesEqual(const std::vector<WeldingAttribute>& attributes, size_t a, size_t b)
 	{
-		uint64_t hash = vector3Hash(oldPos[i]);
-		countMap[hash] = 0;
-		hashes.push_back(hash);
+		for (const auto& attribute : attributes)
+		{
+			const char* pa = attribute.data + a * attribute.typeSize;
+			const char* pb = attribute.data + b * attribute.typeSize;
+			
+			if (attribute.components == 0)
+			{
+				if (memcmp(pa, pb, attribute.typeSize) != 0)
+					return false;
+			}
+			else
+			{
+				const float* fa = reinterpret_cast<const float*>(pa);
+				const float* fb = reinterpret_cast<const float*>(pb);
+				for (size_t i = 0; i < attribute.components; ++i)
+				{
+					if (std::abs(fa[i] - fb[i]) > attribute.tolerance)
+						return false;
+				}
+			}
+		}
+		return true;
 	}
 	
-	indexArray->resizeToFit(dataSize);
-	
-	VertexArray::Pointer result = VertexArray::Pointer::create(vertexArray->decl(), countMap.size());
-	
-	auto newPos = result->chunk(VertexAttributeUsage::Position).accessData<vec3>(0);
-	auto newNrm = result->chunk(VertexAttributeUsage::Normal).accessData<vec3>(0);
-	auto newClr = result->chunk(VertexAttributeUsage::Color).accessData<vec4>(0);
-	
-	bool hasNormals = newNrm.valid();
-	bool hasColor = newClr.valid();
-	
-	std::map<uint64_t, size_t> indexMap;
-	for (size_t i = 0; i < dataSize; ++i)
+	VertexArray::Pointer weldVertices(VertexArray::Pointer data, IndexArray::Pointer indexArray,
+		const primitives::VertexWeldingOptions& options, JobSystem* jobs)
 	{
-		uint64_t hash = hashes[i];
-		if (indexMap.count(hash) == 0)
+		VertexDeclaration decl = data->decl();
+		size_t vertexCount = data->size();
+		
+		std::vector<WeldingAttribute> attributes;
+		auto addAttribute = [&attributes, &options, vertexCount](VertexDataChunk chunk)
 		{
-			newPos[indexMap.size()] = oldPos[i];
+			if (chunk.invalid() || (options[chunk->usage()] < 0.0f) ||
+				(chunk->dataSize() < vertexCount * chunk->typeSize()))
+			{
+				return;
+			}
 			
-			if (hasNormals)
-				newNrm[indexMap.size()] = oldNrm[i];
+			WeldingAttribute attribute;
+			attribute.data = chunk->data();
+			attribute.typeSize = chunk->typeSize();
+			attribute.tolerance = options[chunk->usage()];
+			
+			if ((chunk->type() != VertexAttributeType::Int) && (attribute.tolerance > 0.0f))
+				attribute.components = attribute.typeSize / sizeof(float);
+			
+			attributes.push_back(attribute);
+		};
+		
+		for (const auto& element : decl.elements())
+			addAttribute(data->chunk(element.usage()));
+		addAttribute(data->smoothing());
+		
+		/*
+		 * Vertices are looked up in the uniform grid by position. Cell is not smaller than tolerance,
+		 * so vertices to be merged are always in the same or in the adjacent cells.
+		 */
+		std::vector<vec3i> cells(vertexCount);
+		std::vector<uint8_t> borders(vertexCount, 0);
+		
+		VertexDataChunk posChunk = data->chunk(VertexAttributeUsage::Position);
+		float positionTolerance = options[VertexAttributeUsage::Position];
+		
+		if (posChunk.valid() && (posChunk->type() == VertexAttributeType::Vec3) && (positionTolerance >= 0.0f))
+		{
+			auto pos = posChunk.accessData<vec3>(0);
 			
-			if (hasColor)
-				newClr[indexMap.size()] = oldClr[i];
+			vec3 extent(0.0f);
+			for (size_t i = 0; i < vertexCount; ++i)
+				extent = maxv(extent, absv(pos[i]));
 			
-			indexArray->setIndex(static_cast<uint32_t>(indexMap.size()), i);
-			indexMap[hash] = indexMap.size();
+			float maxCoordinate = etMax(extent.x, etMax(extent.y, extent.z));
+			
+			float cellSize = etMax(positionTolerance, maxCoordinate / cellGridRange);
+			float scale = (cellSize > 0.0f) ? 1.0f / cellSize : 1.0f;
+			
+			/*
+			 * Adjacent cells are checked only for vertices closer than tolerance to the cell border
+			 */
+			float border = positionTolerance * scale;
+			
+			auto computeCells = [&cells, &borders, &pos, scale, border](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					vec3 p = pos[i] * scale;
+					vec3 c(std::floor(p.x), std::floor(p.y), std::floor(p.z));
+					vec3 f = p - c;
+					
+					cells[i] = vec3i(static_cast<int>(c.x), static_cast<int>(c.y), static_cast<int>(c.z));
+					
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						if (f[axis] <= border)
+							borders[i] |= static_cast<uint8_t>(1 << (2 * axis));
+						
+						if (f[axis] >= 1.0f - border)
+							borders[i] |= static_cast<uint8_t>(2 << (2 * axis));
+					}
+				}
+			};
+			
+			if (jobs == nullptr)
+				computeCells(0, vertexCount);
+			else
+				jobs->parallelFor(0, vertexCount, minimumVerticesPerJob, computeCells);
 		}
-		else
+		
+		/*
+		 * Offsets of the cells to check for each combination of border flags, own cell goes first
+		 */
+		std::vector<vec3i> neighbourCells[64];
+		for (uint32_t flags = 0; flags < 64; ++flags)
+		{
+			for (int z = -1; z <= 1; ++z)
+			{
+				for (int y = -1; y <= 1; ++y)
+				{
+					for (int x = -1; x <= 1; ++x)
+					{
+						vec3i offset(x, y, z);
+						bool include = true;
+						for (size_t axis = 0; axis < 3; ++axis)
+						{
+							if (offset[axis] != 0)
+								include &= (flags & ((offset[axis] < 0 ? 1u : 2u) << (2 * axis))) != 0;
+						}
+						
+						if (include)
+							neighbourCells[flags].push_back(offset);
+					}
+				}
+			}
+			std::stable_partition(neighbourCells[flags].begin(), neighbourCells[flags].end(),
+				[](const vec3i& offset) { return offset.dotSelf() == 0; });
+		}
+		
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint32_t> uniqueVertices;
+		std::vector<uint32_t> nextInCell;
+		CellGrid grid(vertexCount);
+		
+		for (size_t v = 0; v < vertexCount; ++v)
 		{
-			if (hasNormals)
-				newNrm[indexMap[hash]] += oldNrm[i];
+			const auto& neighbours = neighbourCells[borders[v]];
 			
-			if (hasColor)
-				newClr[indexMap[hash]] = 0.5f * (newClr[indexMap[hash]] + oldClr[i]);
+			uint32_t found = invalidVertex;
+			for (size_t n = 0, ne = neighbours.size(); (n < ne) && (found == invalidVertex); ++n)
+			{
+				uint32_t u = grid.find(packCell(cells[v] + neighbours[n]));
+				while ((u != invalidVertex) && !verticesEqual(attributes, uniqueVertices[u], v))
+					u = nextInCell[u];
+				found = u;
+			}
+			
+			if (found == invalidVertex)
+			{
+				found = static_cast<uint32_t>(uniqueVertices.size());
+				uniqueVertices.push_back(static_cast<uint32_t>(v));
+				
+				uint32_t& head = grid.head(packCell(cells[v]));
+				nextInCell.push_back(head);
+				head = found;
+			}
 			
-			indexArray->setIndex(static_cast<uint32_t>(indexMap[hash]), i);
+			remap[v] = found;
+		}
+		
+		VertexArray::Pointer result = VertexArray::Pointer::create(decl, uniqueVertices.size());
+		
+		auto copyChunk = [&uniqueVertices](VertexDataChunk source, VertexDataChunk destination)
+		{
+			if (source.invalid() || destination.invalid()) return;
+			
+			size_t typeSize = source->typeSize();
+			const char* sourceData = source->data();
+			char* destinationData = destination->data();
+			for (size_t i = 0, e = uniqueVertices.size(); i < e; ++i)
+				etCopyMemory(destinationData + i * typeSize, sourceData + uniqueVertices[i] * typeSize, typeSize);
+		};
+		
+		for (const auto& element : decl.elements())
+			copyChunk(data->chunk(element.usage()), result->chunk(element.usage()));
+		copyChunk(data->smoothing(), result->smoothing());
+		
+		if (indexArray->actualSize() == 0)
+		{
+			indexArray->resizeToFit(vertexCount);
+			for (size_t i = 0; i < vertexCount; ++i)
+				indexArray->setIndex(remap[i], i);
+		}
+		else
+		{
+			for (size_t i = 0, e = indexArray->actualSize(); i < e; ++i)
+				indexArray->setIndex(remap[indexArray->getIndex(i)], i);
 		}
+		
+		return result;
 	}
+}
+
+uint64_t primitives::vector3Hash(const vec3& v)
+{
+	uint64_t ix = static_cast<uint64_t>(static_cast<int64_t>(174763.0f * v.x));
+	uint64_t iy = static_cast<uint64_t>(static_cast<int64_t>(478441.0f * v.y));
+	uint64_t iz = static_cast<uint64_t>(static_cast<int64_t>(720743.0f * v.z));
+	return mixHash(ix ^ mixHash(iy ^ mixHash(iz)));
+}
+
+VertexArray::Pointer primitives::weldVertices(VertexArray::Pointer data, IndexArray::Pointer indexArray,
+	const VertexWeldingOptions& options)
+{
+	return ::weldVertices(data, indexArray, options, nullptr);
+}
+
+VertexArray::Pointer primitives::weldVertices(VertexArray::Pointer data, IndexArray::Pointer indexArray,
+	const VertexWeldingOptions& options, JobSystem& jobs)
+{
+	return ::weldVertices(data, indexArray, options, &jobs);
+}
+
+VertexArray::Pointer primitives::buildLinearIndexArray(VertexArray::Pointer vertexArray, IndexArray::Pointer indexArray)
+{
+	VertexWeldingOptions options(-1.0f);
+	options[VertexAttributeUsage::Position] = 1.0e-5f;
 	
-	if (hasNormals)
+	indexArray->setActualSize(0);
+	VertexArray::Pointer result = weldVertices(vertexArray, indexArray, options);
+	
+	size_t dataSize = vertexArray->size();
+	
+	VertexDataChunk oldNrmChunk = vertexArray->chunk(VertexAttributeUsage::Normal);
+	if (oldNrmChunk.valid() && (oldNrmChunk->type() == VertexAttributeType::Vec3))
 	{
+		auto oldNrm = oldNrmChunk.accessData<vec3>(0);
+		auto newNrm = result->chunk(VertexAttributeUsage::Normal).accessData<vec3>(0);
+		
+		for (size_t i = 0; i < newNrm.size(); ++i)
+			newNrm[i] = vec3(0.0f);
+		
+		for (size_t i = 0; i < dataSize; ++i)
+			newNrm[static_cast<size_t>(indexArray->getIndex(i))] += oldNrm[i];
+		
 		for (size_t i = 0; i < newNrm.size(); ++i)
 			newNrm[i].normalize();
 	}
 	
+	VertexDataChunk oldClrChunk = vertexArray->chunk(VertexAttributeUsage::Color);
+	if (oldClrChunk.valid() && (oldClrChunk->type() == VertexAttributeType::Vec4))
+	{
+		auto oldClr = oldClrChunk.accessData<vec4>(0);
+		auto newClr = result->chunk(VertexAttributeUsage::Color).accessData<vec4>(0);
+		
+		std::vector<uint32_t> counts(newClr.size(), 0);
+		for (size_t i = 0; i < newClr.size(); ++i)
+			newClr[i] = vec4(0.0f);
+		
+		for (size_t i = 0; i < dataSize; ++i)
+		{
+			size_t index = indexArray->getIndex(i);
+			newClr[index] += oldClr[i];
+			++counts[index];
+		}
+		
+		for (size_t i = 0; i < newClr.size(); ++i)
+			newClr[i] /= static_cast<float>(etMax(1u, counts[i]));
+	}
+	
 	return result;
 }
 
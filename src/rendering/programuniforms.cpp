@@ -0,0 +1,189 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rendering/program.h>
+
+using namespace et;
+
+namespace
+{
+	/*
+	 * Locations above are not cached, values are always sent
+	 */
+	const int maxCachedLocation = 4096;
+
+	template <typename T>
+	bool compareNames(const T& u, UniformName name)
+		{ return u.hashedName < name; }
+}
+
+/*
+ * UniformCache
+ */
+void UniformCache::clear()
+{
+	_uniforms.clear();
+	_values.clear();
+	_storage.clear();
+}
+
+void UniformCache::addUniform(const std::string& name, const ProgramUniform& uniform)
+{
+	size_t arrayIndex = name.find('[');
+	if (arrayIndex != std::string::npos)
+	{
+		addHashedUniform(name, uniform);
+		addHashedUniform(name.substr(0, arrayIndex), uniform);
+	}
+	else
+	{
+		addHashedUniform(name, uniform);
+	}
+}
+
+void UniformCache::addHashedUniform(const std::string& name, const ProgramUniform& uniform)
+{
+	UniformName hashedName(name);
+	
+	auto i = std::lower_bound(_uniforms.begin(), _uniforms.end(), hashedName, compareNames<HashedUniform>);
+	if ((i != _uniforms.end()) && (i->hashedName == hashedName))
+	{
+		/*
+		 * Uniforms are looked up only by hash, so colliding one could not be set at all.
+		 * Renaming one of the uniforms in the shader is the only way out
+		 */
+		if (i->name != name)
+			ET_FAIL_FMT("Uniforms %s and %s have the same name hash", i->name.c_str(), name.c_str());
+		
+		return;
+	}
+
+	HashedUniform entry;
+	entry.hashedName = hashedName;
+	entry.name = name;
+	entry.uniform = uniform;
+	_uniforms.insert(i, entry);
+}
+
+const ProgramUniform* UniformCache::findUniform(UniformName name) const
+{
+	auto i = std::lower_bound(_uniforms.begin(), _uniforms.end(), name, compareNames<HashedUniform>);
+	return ((i != _uniforms.end()) && (i->hashedName == name)) ? &i->uniform : nullptr;
+}
+
+bool UniformCache::update(int location, const void* data, size_t size, bool force)
+{
+	if ((location < 0) || (location > maxCachedLocation))
+		return true;
+
+	if (static_cast<size_t>(location) >= _values.size())
+		_values.resize(location + 1);
+
+	/*
+	 * Storage for the value is allocated on the first update,
+	 * arrays set with more elements than before receive new storage
+	 */
+	Value& value = _values[location];
+	if (value.size < size)
+	{
+		value.offset = static_cast<uint32_t>(_storage.size());
+		value.size = static_cast<uint32_t>(size);
+		value.valid = false;
+		_storage.resize(_storage.size() + size);
+	}
+
+	uint8_t* stored = _storage.data() + value.offset;
+	if (!force && value.valid && (memcmp(stored, data, size) == 0))
+		return false;
+
+	etCopyMemory(stored, data, size);
+	value.valid = true;
+	return true;
+}
+
+void UniformCache::invalidate()
+{
+	for (auto& value : _values)
+		value.valid = false;
+}
+
+/*
+ * UniformBlock
+ */
+void UniformBlock::setValue(UniformName name, ValueType type, const void* data, size_t size)
+{
+	for (const auto& e : _entries)
+	{
+		if (e.name == name)
+		{
+			ET_ASSERT(e.type == type);
+			etCopyMemory(_data.data() + e.offset, data, size);
+			return;
+		}
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.type = type;
+	entry.offset = static_cast<uint32_t>(_data.size());
+	_entries.push_back(entry);
+
+	_data.resize(_data.size() + size);
+	etCopyMemory(_data.data() + entry.offset, data, size);
+}
+
+void UniformBlock::clear()
+{
+	_entries.clear();
+	_data.clear();
+}
+
+/*
+ * Program
+ */
+void Program::setUniforms(const UniformBlock& block)
+{
+	for (const auto& e : block.entries())
+	{
+		const ProgramUniform* u = _uniformCache.findUniform(e.name);
+		if (u == nullptr) continue;
+
+		switch (e.type)
+		{
+			case UniformBlock::ValueType::Int:
+				setUniform(u->location, u->type, block.value<int32_t>(e), false);
+				break;
+
+			case UniformBlock::ValueType::Float:
+				setUniform(u->location, u->type, block.value<float>(e));
+				break;
+
+			case UniformBlock::ValueType::Vec2:
+				setUniform(u->location, u->type, block.value<vec2>(e));
+				break;
+
+			case UniformBlock::ValueType::Vec3:
+				setUniform(u->location, u->type, block.value<vec3>(e));
+				break;
+
+			case UniformBlock::ValueType::Vec4:
+				setUniform(u->location, u->type, block.value<vec4>(e));
+				break;
+
+			case UniformBlock::ValueType::Mat3:
+				setUniform(u->location, u->type, block.value<mat3>(e));
+				break;
+
+			case UniformBlock::ValueType::Mat4:
+				setUniform(u->location, u->type, block.value<mat4>(e));
+				break;
+
+			default:
+				ET_FAIL("Invalid uniform value type");
+		}
+	}
+}
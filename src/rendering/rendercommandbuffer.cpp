@@ -0,0 +1,451 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/tasks/jobsystem.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/rendercommandbuffer.h>
+
+using namespace et;
+
+namespace
+{
+	const uint32_t passBits = 8;
+	const uint32_t programBits = 12;
+	const uint32_t materialBits = 16;
+	const uint32_t vertexArrayBits = 12;
+	const uint32_t depthBits = 16;
+
+	const uint32_t radixBits = 8;
+	const uint32_t radixSize = 1 << radixBits;
+	const uint32_t radixPasses = 64 / radixBits;
+
+	inline uint64_t keyField(uint32_t value, uint32_t bits)
+	{
+		return static_cast<uint64_t>(value & ((1u << bits) - 1));
+	}
+
+	/*
+	 * Bits of the non-negative floats are ordered the same way as their values,
+	 * sign bit is always zero, so the next 16 bits are taken
+	 */
+	inline uint32_t quantizeDepth(float depth)
+	{
+		union { float f; uint32_t i; } value;
+		value.f = (depth > 0.0f) ? depth : 0.0f;
+		return value.i >> (31 - depthBits);
+	}
+}
+
+RenderCommandBuffer::RenderCommandBuffer() :
+	_materials(MaterialTable::Pointer::create())
+{
+	for (auto& order : _depthOrder)
+		order = DepthOrder::FrontToBack;
+}
+
+RenderCommandBuffer::~RenderCommandBuffer()
+{
+	for (auto buffer : _workerBuffers)
+		sharedObjectFactory().deleteObject(buffer);
+}
+
+RenderCommandBuffer::Identifier RenderCommandBuffer::addMaterial(const Material& material)
+{
+	CriticalSectionScope lock(_materials->lock);
+	ET_ASSERT(_materials->materials.size() < MaxMaterials);
+
+	_materials->materials.push_back(material);
+	return static_cast<Identifier>(_materials->materials.size() - 1);
+}
+
+void RenderCommandBuffer::removeMaterials()
+{
+	ET_ASSERT(_packets.empty());
+
+	CriticalSectionScope lock(_materials->lock);
+	_materials->materials.clear();
+}
+
+void RenderCommandBuffer::shareMaterials(const RenderCommandBuffer& buffer)
+{
+	ET_ASSERT(_packets.empty());
+	_materials = buffer._materials;
+}
+
+void RenderCommandBuffer::setDepthOrder(uint32_t pass, DepthOrder order)
+{
+	ET_ASSERT(pass < MaxPasses);
+
+	_depthOrder[pass] = order;
+
+	if (!_packets.empty())
+		_sorted = false;
+}
+
+void RenderCommandBuffer::draw(uint32_t pass, const Program::Pointer& program, Identifier material,
+	const VertexArrayObject& vao, uint32_t first, uint32_t count, const mat4& transform, float depth)
+{
+	Packet packet;
+	packet.transform = transform;
+	packet.material = material;
+	packet.first = first;
+	packet.count = count;
+	packet.pass = pass;
+	packet.depth = depth;
+	addPacket(packet, program, vao);
+}
+
+void RenderCommandBuffer::drawInstanced(uint32_t pass, const Program::Pointer& program, Identifier material,
+	const VertexArrayObject& vao, uint32_t first, uint32_t count, const mat4* transforms, uint32_t instances, float depth)
+{
+	ET_ASSERT((transforms != nullptr) && (instances > 0));
+
+	Packet packet;
+	packet.material = material;
+	packet.first = first;
+	packet.count = count;
+	packet.pass = pass;
+	packet.depth = depth;
+	packet.firstInstance = static_cast<uint32_t>(_instanceTransforms.size());
+	packet.instances = instances;
+
+	_instanceTransforms.insert(_instanceTransforms.end(), transforms, transforms + instances);
+	addPacket(packet, program, vao);
+}
+
+void RenderCommandBuffer::addPacket(Packet& packet, const Program::Pointer& program, const VertexArrayObject& vao)
+{
+	ET_ASSERT(packet.pass < MaxPasses);
+	ET_ASSERT(program.valid() && vao.valid());
+
+	auto programIt = _programIdentifiers.find(program.ptr());
+	if (programIt == _programIdentifiers.end())
+	{
+		packet.program = static_cast<Identifier>(_programs.size());
+		_programIdentifiers.insert(std::make_pair(program.ptr(), packet.program));
+		_programs.push_back(program);
+	}
+	else
+	{
+		packet.program = programIt->second;
+	}
+
+	auto vaoIt = _vertexArrayIdentifiers.find(vao.ptr());
+	if (vaoIt == _vertexArrayIdentifiers.end())
+	{
+		packet.vertexArray = static_cast<Identifier>(_vertexArrays.size());
+		_vertexArrayIdentifiers.insert(std::make_pair(vao.ptr(), packet.vertexArray));
+		_vertexArrays.push_back(vao);
+	}
+	else
+	{
+		packet.vertexArray = vaoIt->second;
+	}
+
+	/*
+	 * Identifiers above the limits are wrapped, which only makes sorting less efficient,
+	 * submission compares actual identifiers
+	 */
+	_packets.push_back(packet);
+	_sorted = false;
+}
+
+void RenderCommandBuffer::append(const RenderCommandBuffer& buffer)
+{
+	ET_ASSERT(buffer._materials == _materials);
+
+	if (buffer._packets.empty()) return;
+
+	std::vector<Identifier> programs(buffer._programs.size());
+	for (size_t i = 0, e = programs.size(); i < e; ++i)
+	{
+		const Program::Pointer& program = buffer._programs[i];
+		auto it = _programIdentifiers.find(program.ptr());
+		if (it == _programIdentifiers.end())
+		{
+			programs[i] = static_cast<Identifier>(_programs.size());
+			_programIdentifiers.insert(std::make_pair(program.ptr(), programs[i]));
+			_programs.push_back(program);
+		}
+		else
+		{
+			programs[i] = it->second;
+		}
+	}
+
+	std::vector<Identifier> vertexArrays(buffer._vertexArrays.size());
+	for (size_t i = 0, e = vertexArrays.size(); i < e; ++i)
+	{
+		const VertexArrayObject& vao = buffer._vertexArrays[i];
+		auto it = _vertexArrayIdentifiers.find(vao.ptr());
+		if (it == _vertexArrayIdentifiers.end())
+		{
+			vertexArrays[i] = static_cast<Identifier>(_vertexArrays.size());
+			_vertexArrayIdentifiers.insert(std::make_pair(vao.ptr(), vertexArrays[i]));
+			_vertexArrays.push_back(vao);
+		}
+		else
+		{
+			vertexArrays[i] = it->second;
+		}
+	}
+
+	uint32_t instancesOffset = static_cast<uint32_t>(_instanceTransforms.size());
+	_instanceTransforms.insert(_instanceTransforms.end(), buffer._instanceTransforms.begin(),
+		buffer._instanceTransforms.end());
+
+	_packets.reserve(_packets.size() + buffer._packets.size());
+	for (Packet packet : buffer._packets)
+	{
+		packet.program = programs[packet.program];
+		packet.vertexArray = vertexArrays[packet.vertexArray];
+		packet.firstInstance += instancesOffset;
+		_packets.push_back(packet);
+	}
+	_sorted = false;
+}
+
+void RenderCommandBuffer::record(size_t count, size_t minimumRange, JobSystem& jobs, RecordFunction recordFunction)
+{
+	struct RecordedRange
+	{
+		size_t begin = 0;
+		RenderCommandBuffer* buffer = nullptr;
+	};
+
+	CriticalSection rangesLock;
+	std::vector<RecordedRange> ranges;
+
+	jobs.parallelFor(0, count, minimumRange, [&](size_t begin, size_t end)
+	{
+		RecordedRange range;
+		range.begin = begin;
+		{
+			CriticalSectionScope lock(rangesLock);
+			if (_workerBuffers.empty())
+			{
+				range.buffer = sharedObjectFactory().createObject<RenderCommandBuffer>();
+			}
+			else
+			{
+				range.buffer = _workerBuffers.back();
+				_workerBuffers.pop_back();
+			}
+		}
+		range.buffer->shareMaterials(*this);
+
+		recordFunction(*range.buffer, begin, end);
+
+		CriticalSectionScope lock(rangesLock);
+		ranges.push_back(range);
+	});
+
+	std::sort(ranges.begin(), ranges.end(), [](const RecordedRange& l, const RecordedRange& r)
+		{ return l.begin < r.begin; });
+
+	for (const auto& range : ranges)
+	{
+		append(*range.buffer);
+		range.buffer->clear();
+		_workerBuffers.push_back(range.buffer);
+	}
+}
+
+uint64_t RenderCommandBuffer::sortKey(const Packet& p) const
+{
+	uint64_t pass = keyField(p.pass, passBits);
+	uint64_t program = keyField(p.program, programBits);
+	uint64_t material = keyField(p.material, materialBits);
+	uint64_t vertexArray = keyField(p.vertexArray, vertexArrayBits);
+	uint64_t depth = quantizeDepth(p.depth);
+
+	const uint32_t stateBits = programBits + materialBits + vertexArrayBits;
+	uint64_t state = (program << (materialBits + vertexArrayBits)) | (material << vertexArrayBits) | vertexArray;
+
+	if (_depthOrder[p.pass] == DepthOrder::BackToFront)
+	{
+		depth = keyField(~static_cast<uint32_t>(depth), depthBits);
+		return (pass << (64 - passBits)) | (depth << stateBits) | state;
+	}
+
+	return (pass << (64 - passBits)) | (state << depthBits) | depth;
+}
+
+void RenderCommandBuffer::sort()
+{
+	if (_sorted) return;
+
+	size_t count = _packets.size();
+	_sortEntries.resize(count);
+	_sortScratch.resize(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		_sortEntries[i].key = sortKey(_packets[i]);
+		_sortEntries[i].index = static_cast<uint32_t>(i);
+	}
+
+	Statistics unsorted = countStateChanges(_sortEntries);
+
+	/*
+	 * LSD radix sort, histograms of all digits are built in one pass,
+	 * digits which are the same for all of the keys are skipped
+	 */
+	std::vector<uint32_t> histograms(radixPasses * radixSize, 0);
+	for (const auto& entry : _sortEntries)
+	{
+		for (uint32_t d = 0; d < radixPasses; ++d)
+			++histograms[d * radixSize + ((entry.key >> (d * radixBits)) & (radixSize - 1))];
+	}
+
+	for (uint32_t d = 0; d < radixPasses; ++d)
+	{
+		uint32_t* histogram = histograms.data() + d * radixSize;
+		uint32_t shift = d * radixBits;
+
+		if ((count == 0) || (histogram[(_sortEntries.front().key >> shift) & (radixSize - 1)] == count))
+			continue;
+
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < radixSize; ++i)
+		{
+			uint32_t digitCount = histogram[i];
+			histogram[i] = offset;
+			offset += digitCount;
+		}
+
+		for (const auto& entry : _sortEntries)
+			_sortScratch[histogram[(entry.key >> shift) & (radixSize - 1)]++] = entry;
+
+		_sortEntries.swap(_sortScratch);
+	}
+
+	_statistics = countStateChanges(_sortEntries);
+	_statistics.unsortedStateChanges = unsorted.stateChanges();
+	_sorted = true;
+}
+
+RenderCommandBuffer::Statistics RenderCommandBuffer::countStateChanges(const std::vector<SortEntry>& entries) const
+{
+	Statistics result;
+	result.packets = entries.size();
+
+	Identifier program = InvalidIdentifier;
+	Identifier material = InvalidIdentifier;
+	Identifier vertexArray = InvalidIdentifier;
+	for (const auto& entry : entries)
+	{
+		const Packet& p = _packets[entry.index];
+
+		bool programChanged = (p.program != program);
+		if (programChanged)
+		{
+			++result.programChanges;
+			program = p.program;
+		}
+
+		/*
+		 * material uniforms belong to the program, so they are set again when program changes
+		 */
+		if (programChanged || (p.material != material))
+		{
+			++result.materialChanges;
+			material = p.material;
+		}
+
+		if (p.vertexArray != vertexArray)
+		{
+			++result.vertexArrayChanges;
+			vertexArray = p.vertexArray;
+		}
+	}
+	return result;
+}
+
+void RenderCommandBuffer::submit(RenderContext* rc)
+{
+	sort();
+
+	auto& rs = rc->renderState();
+	auto rn = rc->renderer();
+
+	Identifier program = InvalidIdentifier;
+	Identifier material = InvalidIdentifier;
+	Identifier vertexArray = InvalidIdentifier;
+	for (const auto& entry : _sortEntries)
+	{
+		const Packet& p = _packets[entry.index];
+		Program::Pointer& prog = _programs[p.program];
+
+		bool programChanged = (p.program != program);
+		if (programChanged)
+		{
+			rs.bindProgram(prog);
+			program = p.program;
+		}
+
+		if (programChanged || (p.material != material))
+		{
+			CriticalSectionScope lock(_materials->lock);
+			ET_ASSERT(p.material < _materials->materials.size());
+
+			const Material& mat = _materials->materials[p.material];
+			for (const auto& binding : mat.textures)
+				rs.bindTexture(binding.unit, binding.texture);
+
+			if (!mat.uniforms.empty())
+				prog->setUniforms(mat.uniforms);
+
+			if (mat.apply)
+				mat.apply(prog);
+
+			material = p.material;
+		}
+
+		const VertexArrayObject& vao = _vertexArrays[p.vertexArray];
+		if (p.vertexArray != vertexArray)
+		{
+			rs.bindVertexArray(vao);
+			vertexArray = p.vertexArray;
+		}
+
+		if (p.instances > 0)
+		{
+			prog->setInstanceTransforms(_instanceTransforms.data() + p.firstInstance, p.instances);
+			rn->drawElementsInstanced(vao->indexBuffer(), p.first, p.count, p.instances);
+		}
+		else
+		{
+			prog->setTransformMatrix(p.transform);
+			rn->drawElements(vao->indexBuffer(), p.first, p.count);
+		}
+	}
+}
+
+void RenderCommandBuffer::clear()
+{
+	_packets.clear();
+	_instanceTransforms.clear();
+	_sortEntries.clear();
+	_programs.clear();
+	_vertexArrays.clear();
+	_programIdentifiers.clear();
+	_vertexArrayIdentifiers.clear();
+	_statistics = Statistics();
+	_sorted = true;
+}
+
+std::vector<uint32_t> RenderCommandBuffer::submissionOrder()
+{
+	sort();
+
+	std::vector<uint32_t> result;
+	result.reserve(_sortEntries.size());
+	for (const auto& entry : _sortEntries)
+		result.push_back(entry.index);
+	return result;
+}
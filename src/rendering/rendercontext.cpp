@@ -31,10 +31,14 @@ void RenderContext::resized(const vec2i& sz)
 {
 	updateScreenScale(sz);
 	
+	_app->acquireRenderContext();
+	
 	_renderState.setMainViewportSize(sz);
 	
 	if (_app->running())
 		_app->contextResized(sz);
+	
+	_app->releaseRenderContext();
 }
 
 void RenderContext::updateScreenScale(const vec2i& screenSize)
@@ -0,0 +1,202 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/profiler.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/renderframe.h>
+
+using namespace et;
+
+/*
+ * RenderFence
+ */
+void RenderFence::signal(uint64_t v)
+{
+	_condition.lock();
+	ET_ASSERT(v >= _value);
+	_value = v;
+	_condition.notifyAll();
+	_condition.unlock();
+}
+
+uint64_t RenderFence::value() const
+{
+	_condition.lock();
+	uint64_t result = _value;
+	_condition.unlock();
+	return result;
+}
+
+void RenderFence::wait(uint64_t v) const
+{
+	_condition.lock();
+	while (_value < v)
+		_condition.wait();
+	_condition.unlock();
+}
+
+/*
+ * RenderFrame
+ */
+RenderFrame::RenderFrame()
+{
+}
+
+RenderFrame::~RenderFrame()
+{
+	for (auto buffer : _buffers)
+		sharedObjectFactory().deleteObject(buffer);
+}
+
+void RenderFrame::reset(uint64_t index, RenderCommandBuffer* materials)
+{
+	for (size_t i = 0; i < _usedBuffers; ++i)
+		_buffers[i]->clear();
+
+	_entries.clear();
+	_uploads.clear();
+	_materials = materials;
+	_usedBuffers = 0;
+	_index = index;
+}
+
+void RenderFrame::execute(Command command)
+{
+	Entry entry;
+	entry.command = command;
+	_entries.push_back(entry);
+}
+
+RenderCommandBuffer& RenderFrame::commandBuffer()
+{
+	if (_usedBuffers == _buffers.size())
+		_buffers.push_back(sharedObjectFactory().createObject<RenderCommandBuffer>());
+
+	RenderCommandBuffer* buffer = _buffers[_usedBuffers++];
+	buffer->shareMaterials(*_materials);
+
+	Entry entry;
+	entry.buffer = buffer;
+	_entries.push_back(entry);
+
+	return *buffer;
+}
+
+void RenderFrame::updateVertexBuffer(const VertexBuffer& buffer, size_t offset, BinaryDataStorage&& data)
+{
+	ET_ASSERT(buffer.valid() && (data.size() > 0));
+
+	size_t uploadIndex = _uploads.size();
+	_uploads.push_back(std::move(data));
+
+	VertexBuffer target = buffer;
+	execute([this, target, offset, uploadIndex](RenderContext*) mutable
+	{
+		const BinaryDataStorage& upload = _uploads[uploadIndex];
+		void* mapped = target->map(offset, upload.size(), MapBufferMode::WriteOnly);
+		etCopyMemory(mapped, upload.data(), upload.size());
+		target->unmap();
+	});
+}
+
+void RenderFrame::updateTexture(const Texture::Pointer& texture, TextureDescription::Pointer desc)
+{
+	ET_ASSERT(texture.valid() && desc.valid());
+
+	Texture::Pointer target = texture;
+	execute([target, desc](RenderContext* rc) mutable
+		{ target->updateData(rc, desc); });
+}
+
+void RenderFrame::execute(RenderContext* rc)
+{
+	ET_PROFILE_SCOPE("RenderFrame::execute");
+
+	for (auto& entry : _entries)
+	{
+		if (entry.buffer == nullptr)
+			entry.command(rc);
+		else
+			entry.buffer->submit(rc);
+	}
+}
+
+/*
+ * RenderFramePipeline
+ */
+RenderFramePipeline::RenderFramePipeline()
+{
+}
+
+RenderCommandBuffer::Identifier RenderFramePipeline::addMaterial(const RenderCommandBuffer::Material& material)
+{
+	return _materials.addMaterial(material);
+}
+
+void RenderFramePipeline::removeMaterials()
+{
+	ET_ASSERT(!_recording);
+	
+	/*
+	 * Recorded frames refer to the materials, so they should be submitted first
+	 */
+	{
+		ET_PROFILE_SCOPE("RenderFramePipeline::wait");
+		_fence.wait(_recordedFrames);
+	}
+	
+	_materials.removeMaterials();
+}
+
+RenderFrame& RenderFramePipeline::beginFrame()
+{
+	ET_ASSERT(!_recording);
+
+	uint64_t index = _recordedFrames + 1;
+	if (index > FramesCount)
+	{
+		ET_PROFILE_SCOPE("RenderFramePipeline::wait");
+		_fence.wait(index - FramesCount);
+	}
+
+	RenderFrame& frame = _frames[index % FramesCount];
+	frame.reset(index, &_materials);
+
+	_recording = true;
+	return frame;
+}
+
+void RenderFramePipeline::endFrame()
+{
+	ET_ASSERT(_recording);
+
+	CriticalSectionScope lock(_lock);
+	++_recordedFrames;
+	_recording = false;
+}
+
+bool RenderFramePipeline::submit(RenderContext* rc)
+{
+	uint64_t index = 0;
+	{
+		CriticalSectionScope lock(_lock);
+		if (_submittedFrames == _recordedFrames)
+			return false;
+
+		index = _submittedFrames + 1;
+	}
+
+	_frames[index % FramesCount].execute(rc);
+
+	{
+		CriticalSectionScope lock(_lock);
+		_submittedFrames = index;
+	}
+
+	_fence.signal(index);
+	return true;
+}
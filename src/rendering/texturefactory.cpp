@@ -46,6 +46,24 @@ namespace et
 		IntrusivePtr<Loader> loader;
 		StringList supportedExtensions;
 	};
+	
+	/*
+	 * Reloaded data is decoded on the calling thread and uploaded on the thread owning render context
+	 */
+	class TextureUpdateTask : public Task
+	{
+	public:
+		TextureUpdateTask(RenderContext* rc, const Texture::Pointer& texture, const TextureDescription::Pointer& data) :
+			_rc(rc), _texture(texture), _data(data) { }
+		
+		void execute()
+			{ _texture->updateData(_rc, _data); }
+		
+	private:
+		RenderContext* _rc = nullptr;
+		Texture::Pointer _texture;
+		TextureDescription::Pointer _data;
+	};
 }
 
 using namespace et;
@@ -55,13 +73,12 @@ TextureFactory::TextureFactory(RenderContext* rc) :
 {
 	ET_PIMPL_INIT(TextureFactory, this)
 	
-	_loadingThread = sharedObjectFactory().createObject<TextureLoadingThread>(this);
+	_loadingPool = sharedObjectFactory().createObject<TextureLoadingPool>(this);
 }
 
 TextureFactory::~TextureFactory()
 {
-	_loadingThread->stop();
-	_loadingThread->waitForTermination();
+	_loadingPool->stop();
 
 	ET_PIMPL_FINALIZE(TextureFactory)
 }
@@ -77,7 +94,7 @@ ObjectLoader::Pointer TextureFactory::objectLoader()
 }
 
 Texture::Pointer TextureFactory::loadTexture(const std::string& fileName, ObjectsCache& cache,
-	bool async, TextureLoaderDelegate* delegate)
+	bool async, TextureLoaderDelegate* delegate, TextureLoadingPriority priority)
 {
 	if (fileName.length() == 0)
 		return Texture::Pointer();
@@ -126,7 +143,7 @@ Texture::Pointer TextureFactory::loadTexture(const std::string& fileName, Object
 			cache.manage(texture, _private->loader);
 			
 			if (async)
-				_loadingThread->addRequest(desc->origin(), texture, delegate);
+				_loadingPool->addRequest(desc->origin(), texture, delegate, priority);
 			else if (calledFromAnotherThread)
 				ET_FAIL("ERROR: Unable to load texture synchronously from non-rendering thread.");
 		}
@@ -134,11 +151,37 @@ Texture::Pointer TextureFactory::loadTexture(const std::string& fileName, Object
 	}
 	else
 	{
+		/*
+		 * Texture was created, but its loading was cancelled, so it should be requested again
+		 */
+		if (_cancelledTextures.erase(texture->origin()) > 0)
+		{
+			if (async)
+				_loadingPool->addRequest(texture->origin(), texture, delegate, priority);
+			else
+				reloadObject(texture, cache);
+			
+			return texture;
+		}
+		
 		auto newProperty = cache.getFileProperty(file);
 		if (cachedFileProperty != newProperty)
 			reloadObject(texture, cache);
 	
-		if (async)
+		if (async && _loadingPool->attachToPendingRequest(texture->origin(), delegate, priority))
+		{
+			/*
+			 * Texture is still loading, delegate will be notified when it is done
+			 */
+			textureDidStartLoading.invokeInMainRunLoop(texture);
+			if (delegate != nullptr)
+			{
+				Invocation1 i;
+				i.setTarget(delegate, &TextureLoaderDelegate::textureDidStartLoading, texture);
+				i.invokeInMainRunLoop();
+			}
+		}
+		else if (async)
 		{
 			textureDidStartLoading.invokeInMainRunLoop(texture);
 			if (delegate != nullptr)
@@ -252,12 +295,31 @@ void TextureFactory::textureLoadingThreadDidLoadTextureData(TextureLoadingReques
 	request->texture->updateData(renderContext(), request->textureDescription);
 	textureDidLoad.invoke(request->texture);
 
-	if (request->delegate)
-		request->delegate->textureDidLoad(request->texture);
+	_loadingPool->completeRequest(request, [request](TextureLoaderDelegate* delegate)
+		{ delegate->textureDidLoad(request->texture); });
 
 	sharedObjectFactory().deleteObject(request);
 }
 
+void TextureFactory::textureLoadingThreadDidCancelRequest(TextureLoadingRequest* request)
+{
+	CriticalSectionScope lock(_csTextureLoading);
+	
+	_cancelledTextures.insert(request->texture->origin());
+	sharedObjectFactory().deleteObject(request);
+}
+
+void TextureFactory::setTextureLoadingPriority(Texture::Pointer texture, TextureLoadingPriority priority)
+{
+	if (texture.valid())
+		_loadingPool->setPriority(texture->origin(), priority);
+}
+
+TextureLoadingStatistics TextureFactory::textureLoadingStatistics()
+{
+	return _loadingPool->statistics();
+}
+
 Texture::Pointer TextureFactory::loadTexturesToCubemap(const std::string& posx, const std::string& negx,
 	const std::string& posy, const std::string& negy, const std::string& posz, const std::string& negz,
 	ObjectsCache& cache)
@@ -345,7 +407,15 @@ Texture::Pointer TextureFactory::createTextureWrapper(uint32_t texture, const ve
 void TextureFactory::reloadObject(LoadableObject::Pointer object, ObjectsCache&)
 {
 	TextureDescription::Pointer newData = et::loadTexture(object->origin());
+	if (newData.invalid()) return;
 	
-	if (newData.valid())
+	if (application().renderingOnSeparateThread())
+	{
+		application().renderRunLoop().addTask(sharedObjectFactory().createObject<TextureUpdateTask>(renderContext(),
+			Texture::Pointer(object), newData), 0.0f);
+	}
+	else
+	{
 		Texture::Pointer(object)->updateData(renderContext(), newData);
+	}
 }
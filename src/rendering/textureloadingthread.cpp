@@ -5,91 +5,169 @@
 *
 */
 
-#include <et/app/invocation.h>
+#include <et/core/profiler.h>
+#include <et/core/tools.h>
+#include <et/app/application.h>
+#include <et/threading/threading.h>
 #include <et/imaging/textureloader.h>
 #include <et/imaging/textureloaderthread.h>
 
+namespace et
+{
+	class TextureLoadingWorker : public Thread
+	{
+	public:
+		TextureLoadingWorker(TextureLoadingPool* owner, size_t index) :
+			Thread(false), _owner(owner), _index(index) { }
+
+		ThreadResult main()
+		{
+			ET_PROFILE_THREAD("Texture loading " + intToStr(_index));
+			
+			while (running())
+			{
+				TextureLoadingRequest* req = _owner->dequeRequest();
+				
+				if (req)
+					_owner->processRequest(req);
+				else
+					suspend();
+			}
+			
+			return 0;
+		}
+
+	private:
+		TextureLoadingPool* _owner = nullptr;
+		size_t _index = 0;
+	};
+}
+
 using namespace et;
 
 TextureLoaderDelegate::~TextureLoaderDelegate()
 {
 	for (auto i : _requests)
-		i->discardDelegate();
+		i->discardDelegate(this);
 }
 
+/*
+ * TextureLoadingRequest
+ */
 TextureLoadingRequest::TextureLoadingRequest(const std::string& name, const Texture::Pointer& tex, TextureLoaderDelegate* d) :
-	fileName(name), textureDescription(sharedObjectFactory().createObject<TextureDescription>()), texture(tex), delegate(d)
+	fileName(name), textureDescription(sharedObjectFactory().createObject<TextureDescription>()), texture(tex)
 {
-	if (delegate)
-		delegate->addTextureLoadingRequest(this);
+	addDelegate(d);
 }
 
 TextureLoadingRequest::~TextureLoadingRequest()
 {
-	if (delegate)
-		delegate->removeTextureLoadingRequest(this);
+	for (auto d : delegates)
+		d->removeTextureLoadingRequest(this);
 }
 
-void TextureLoadingRequest::discardDelegate()
+void TextureLoadingRequest::addDelegate(TextureLoaderDelegate* d)
 {
-	delegate = nullptr;
+	if ((d == nullptr) || (std::find(delegates.begin(), delegates.end(), d) != delegates.end()))
+		return;
+	
+	delegates.push_back(d);
+	d->addTextureLoadingRequest(this);
 }
 
-TextureLoadingThread::TextureLoadingThread(TextureLoadingThreadDelegate* delegate) :
-	Thread(false), _delegate(delegate) { }
+void TextureLoadingRequest::discardDelegate(TextureLoaderDelegate* d)
+{
+	if (owner == nullptr)
+		delegates.erase(std::remove(delegates.begin(), delegates.end(), d), delegates.end());
+	else
+		owner->discardDelegate(this, d);
+}
 
-TextureLoadingThread::~TextureLoadingThread()
+/*
+ * TextureLoadingPool
+ */
+TextureLoadingPool::TextureLoadingPool(TextureLoadingThreadDelegate* delegate, size_t workersCount) :
+	_delegate(delegate), _workersCount(workersCount)
+{
+	if (_workersCount == 0)
+		_workersCount = etMax(size_t(2), Threading::coresCount()) - 1;
+}
+
+TextureLoadingPool::~TextureLoadingPool()
 {
 	stop();
 
 	CriticalSectionScope lock(_requestsCriticalSection);
-	while (_requests.size())
+	for (auto& queue : _requests)
 	{
-		sharedObjectFactory().deleteObject(_requests.front());
-		_requests.pop();
+		for (auto req : queue)
+			sharedObjectFactory().deleteObject(req);
+		queue.clear();
 	}
+	_pendingRequests.clear();
 }
 
-TextureLoadingRequest* TextureLoadingThread::dequeRequest()
+void TextureLoadingPool::stop()
+{
+	for (auto w : _workers)
+	{
+		w->stop();
+		w->waitForTermination();
+		sharedObjectFactory().deleteObject(w);
+	}
+	_workers.clear();
+}
+
+TextureLoadingRequest* TextureLoadingPool::dequeRequest()
 {
 	CriticalSectionScope lock(_requestsCriticalSection);
-	TextureLoadingRequest* result = nullptr;
 
-	if (_requests.size()) 
+	for (auto& queue : _requests)
 	{
-		result = _requests.front();
-		_requests.pop();
+		if (!queue.empty())
+		{
+			TextureLoadingRequest* result = queue.front();
+			result->queued = false;
+			queue.pop_front();
+			return result;
+		}
 	}
 
-	return result;
+	return nullptr;
 }
 
-ThreadResult TextureLoadingThread::main()
+void TextureLoadingPool::processRequest(TextureLoadingRequest* req)
 {
-	while (running())
+	req->decodeStartTime = queryContiniousTimeInMilliSeconds();
 	{
-		TextureLoadingRequest* req = dequeRequest();
-
-		if (req)
-		{
-			req->textureDescription = loadTexture(req->fileName);
+		ET_PROFILE_SCOPE("TextureLoadingPool::loadTexture");
+		req->textureDescription = loadTexture(req->fileName);
+	}
+	req->decodeEndTime = queryContiniousTimeInMilliSeconds();
 
-			Invocation1 invocation;
-			invocation.setTarget(_delegate, &TextureLoadingThreadDelegate::textureLoadingThreadDidLoadTextureData, req);
-			invocation.invokeInMainRunLoop();
-		}
-		else
-		{
-			suspend();
-		}
+	{
+		CriticalSectionScope lock(_requestsCriticalSection);
+		
+		uint64_t waitTime = req->decodeStartTime - req->queuedTime;
+		uint64_t decodeTime = req->decodeEndTime - req->decodeStartTime;
+		
+		_statistics.requestsCompleted++;
+		_statistics.totalWaitTime += waitTime;
+		_statistics.totalDecodeTime += decodeTime;
+		_statistics.maxWaitTime = etMax(_statistics.maxWaitTime, waitTime);
+		_statistics.maxDecodeTime = etMax(_statistics.maxDecodeTime, decodeTime);
 	}
 
-	return 0;
+	Invocation1 invocation;
+	invocation.setTarget(_delegate, &TextureLoadingThreadDelegate::textureLoadingThreadDidLoadTextureData, req);
+	invocation.invokeInRunLoop(application().renderRunLoop());
 }
 
-void TextureLoadingThread::addRequest(const std::string& fileName, Texture::Pointer texture,
-	TextureLoaderDelegate* delegate)
+void TextureLoadingPool::addRequest(const std::string& fileName, Texture::Pointer texture,
+	TextureLoaderDelegate* delegate, TextureLoadingPriority priority)
 {
+	ET_ASSERT(priority < TextureLoadingPriority::max);
+	
 	if (delegate)
 	{
 		Invocation1 i;
@@ -97,11 +175,149 @@ void TextureLoadingThread::addRequest(const std::string& fileName, Texture::Poin
 		i.invokeInMainRunLoop();
 	}
 	
+	/*
+	 * Lookup and insertion are done under the same lock,
+	 * otherwise two threads could queue separate requests for the same file
+	 */
 	CriticalSectionScope lock(_requestsCriticalSection);
-	_requests.push(sharedObjectFactory().createObject<TextureLoadingRequest>(fileName, texture, delegate));
+	
+	if (attachToPendingRequest(fileName, delegate, priority))
+		return;
+	
+	auto req = sharedObjectFactory().createObject<TextureLoadingRequest>(fileName, texture, delegate);
+	req->owner = this;
+	req->priority = priority;
+	req->queuedTime = queryContiniousTimeInMilliSeconds();
+	req->queued = true;
+	
+	_requests[static_cast<uint32_t>(priority)].push_back(req);
+	_pendingRequests[fileName] = req;
 
-	if (running())
-		resume();
+	if (_workers.empty())
+	{
+		for (size_t i = 0; i < _workersCount; ++i)
+			_workers.push_back(sharedObjectFactory().createObject<TextureLoadingWorker>(this, i));
+		
+		for (auto w : _workers)
+			w->run();
+	}
 	else
-		run();
+	{
+		wakeWorker();
+	}
+}
+
+bool TextureLoadingPool::attachToPendingRequest(const std::string& fileName, TextureLoaderDelegate* delegate,
+	TextureLoadingPriority priority)
+{
+	CriticalSectionScope lock(_requestsCriticalSection);
+	
+	auto i = _pendingRequests.find(fileName);
+	if (i == _pendingRequests.end())
+		return false;
+	
+	i->second->addDelegate(delegate);
+	promoteRequest(i->second, priority);
+	_statistics.requestsCoalesced++;
+	return true;
+}
+
+void TextureLoadingPool::setPriority(const std::string& fileName, TextureLoadingPriority priority)
+{
+	CriticalSectionScope lock(_requestsCriticalSection);
+
+	auto i = _pendingRequests.find(fileName);
+	if (i != _pendingRequests.end())
+		promoteRequest(i->second, priority);
+}
+
+void TextureLoadingPool::promoteRequest(TextureLoadingRequest* req, TextureLoadingPriority priority)
+{
+	if (priority >= req->priority) return;
+	
+	if (req->queued)
+	{
+		auto& oldQueue = _requests[static_cast<uint32_t>(req->priority)];
+		oldQueue.erase(std::find(oldQueue.begin(), oldQueue.end(), req));
+		_requests[static_cast<uint32_t>(priority)].push_back(req);
+	}
+	
+	req->priority = priority;
+}
+
+void TextureLoadingPool::completeRequest(TextureLoadingRequest* req,
+	const std::function<void(TextureLoaderDelegate*)>& notify)
+{
+	CriticalSectionScope lock(_requestsCriticalSection);
+	
+	auto i = _pendingRequests.find(req->fileName);
+	if ((i != _pendingRequests.end()) && (i->second == req))
+		_pendingRequests.erase(i);
+	
+	/*
+	 * Owner is kept until delegates are notified, so delegate destroyed
+	 * in the meantime is discarded through the pool and waits for this lock.
+	 * Delegates could also be discarded from notify itself on this thread.
+	 */
+	auto delegates = req->delegates;
+	for (auto delegate : delegates)
+	{
+		if (std::find(req->delegates.begin(), req->delegates.end(), delegate) != req->delegates.end())
+			notify(delegate);
+	}
+	
+	req->owner = nullptr;
+}
+
+void TextureLoadingPool::discardDelegate(TextureLoadingRequest* req, TextureLoaderDelegate* d)
+{
+	{
+		CriticalSectionScope lock(_requestsCriticalSection);
+		
+		auto& delegates = req->delegates;
+		delegates.erase(std::remove(delegates.begin(), delegates.end(), d), delegates.end());
+		
+		/*
+		 * Decoding is skipped only when nobody is waiting for the texture anymore
+		 */
+		if (!delegates.empty() || !req->queued)
+			return;
+		
+		auto& queue = _requests[static_cast<uint32_t>(req->priority)];
+		queue.erase(std::find(queue.begin(), queue.end(), req));
+		_pendingRequests.erase(req->fileName);
+		
+		req->queued = false;
+		req->cancelled = true;
+		req->owner = nullptr;
+		_statistics.requestsCancelled++;
+	}
+
+	Invocation1 invocation;
+	invocation.setTarget(_delegate, &TextureLoadingThreadDelegate::textureLoadingThreadDidCancelRequest, req);
+	invocation.invokeInMainRunLoop();
+}
+
+TextureLoadingStatistics TextureLoadingPool::statistics()
+{
+	CriticalSectionScope lock(_requestsCriticalSection);
+	return _statistics;
+}
+
+void TextureLoadingPool::wakeWorker()
+{
+	for (auto w : _workers)
+	{
+		if (w->suspended())
+		{
+			w->resume();
+			return;
+		}
+	}
+
+	/*
+	 * All workers are busy or just about to suspend,
+	 * the one resumed will not fall asleep and will pick the request
+	 */
+	_workers.at(_nextWorkerToWake++ % _workers.size())->resume();
 }
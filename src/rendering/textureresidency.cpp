@@ -0,0 +1,461 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/tools.h>
+#include <et/app/application.h>
+#include <et/imaging/ddsloader.h>
+#include <et/imaging/pvrloader.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/textureresidency.h>
+
+using namespace et;
+
+namespace
+{
+	/*
+	 * Textures, which were not reported for this amount of frames,
+	 * does not receive finer levels anymore
+	 */
+	const uint64_t activeFramesWindow = 4;
+
+	bool canStreamTexture(const TextureDescription& desc)
+	{
+		if ((desc.target != TextureTarget::Texture_2D) || (desc.layersCount != 1) ||
+			(desc.mipMapCount < 2) || !desc.valid())
+		{
+			return false;
+		}
+
+#	if (!ET_PLATFORM_IOS)
+		/*
+		 * PVRTC textures are decompressed to the single RGBA level on load
+		 */
+		if ((desc.internalformat >= TextureFormat::PVR_2bpp_RGB) &&
+			(desc.internalformat <= TextureFormat::PVR_4bpp_sRGBA))
+		{
+			return false;
+		}
+#	endif
+
+		return true;
+	}
+}
+
+/*
+ * TextureResidencyPolicy
+ */
+TextureResidencyPolicy::TextureResidencyPolicy(size_t budget) :
+	_budget(budget)
+{
+}
+
+TextureResidencyPolicy::Handle TextureResidencyPolicy::add(const vec2i& size, const std::vector<size_t>& levelSizes)
+{
+	ET_ASSERT(!levelSizes.empty());
+
+	Handle handle = InvalidHandle;
+	if (_freeHandles.empty())
+	{
+		handle = static_cast<Handle>(_entries.size());
+		_entries.emplace_back();
+	}
+	else
+	{
+		handle = _freeHandles.back();
+		_freeHandles.pop_back();
+	}
+
+	Entry& entry = _entries.at(handle);
+	entry = Entry();
+	entry.levelSizes = levelSizes;
+	entry.levelsCount = static_cast<uint32_t>(levelSizes.size());
+	entry.residentLevel = entry.levelsCount;
+	entry.desiredLevel = entry.levelsCount - 1;
+	entry.maxDimension = static_cast<float>(etMax(size.x, size.y));
+	entry.active = true;
+	return handle;
+}
+
+void TextureResidencyPolicy::remove(Handle handle)
+{
+	Entry& entry = _entries.at(handle);
+	ET_ASSERT(entry.active);
+
+	for (uint32_t level = entry.residentLevel; level < entry.levelsCount; ++level)
+		_residentSize -= entry.levelSizes.at(level);
+
+	if (entry.pending)
+	{
+		_residentSize -= entry.levelSizes.at(entry.pendingLevel);
+		--_pendingLoads;
+	}
+
+	entry = Entry();
+	_freeHandles.push_back(handle);
+}
+
+void TextureResidencyPolicy::reportScreenSize(Handle handle, float pixels, uint64_t frame)
+{
+	Entry& entry = _entries.at(handle);
+	ET_ASSERT(entry.active);
+
+	float ratio = entry.maxDimension / etMax(1.0f, pixels);
+	uint32_t level = (ratio > 1.0f) ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0;
+	level = etMin(level, entry.levelsCount - 1);
+
+	if (frame > entry.lastUsedFrame)
+	{
+		entry.desiredLevel = level;
+		entry.lastUsedFrame = frame;
+	}
+	else
+	{
+		entry.desiredLevel = etMin(entry.desiredLevel, level);
+	}
+}
+
+bool TextureResidencyPolicy::evictLevel(uint64_t olderThanFrame, ActionList& actions)
+{
+	Entry* victim = nullptr;
+	Handle victimHandle = InvalidHandle;
+	bool victimOverResident = false;
+
+	for (Handle handle = 0, e = static_cast<Handle>(_entries.size()); handle < e; ++handle)
+	{
+		Entry& entry = _entries[handle];
+		if (!entry.active || entry.pending || (entry.residentLevel + 1 >= entry.levelsCount))
+			continue;
+
+		/*
+		 * Levels finer than required are evicted first, then least recently used ones
+		 */
+		bool overResident = entry.residentLevel < entry.desiredLevel;
+		if (!overResident && (entry.lastUsedFrame >= olderThanFrame))
+			continue;
+
+		bool better = (victim == nullptr) || (overResident && !victimOverResident);
+		if (!better && (overResident == victimOverResident))
+		{
+			better = (entry.lastUsedFrame < victim->lastUsedFrame) ||
+				((entry.lastUsedFrame == victim->lastUsedFrame) && (entry.residentLevel < victim->residentLevel));
+		}
+
+		if (better)
+		{
+			victim = &entry;
+			victimHandle = handle;
+			victimOverResident = overResident;
+		}
+	}
+
+	if (victim == nullptr)
+		return false;
+
+	actions.emplace_back(ActionType::Evict, victimHandle, victim->residentLevel);
+	_residentSize -= victim->levelSizes.at(victim->residentLevel);
+	++victim->residentLevel;
+	return true;
+}
+
+TextureResidencyPolicy::ActionList TextureResidencyPolicy::update(uint64_t frame)
+{
+	ActionList result;
+
+	auto startLoad = [this, &result](Handle handle, uint32_t level)
+	{
+		Entry& entry = _entries[handle];
+		entry.pending = true;
+		entry.pendingLevel = level;
+		_residentSize += entry.levelSizes.at(level);
+		++_pendingLoads;
+		result.emplace_back(ActionType::Load, handle, level);
+	};
+
+	/*
+	 * Budget could be decreased since last update
+	 */
+	while ((_residentSize > _budget) && evictLevel(frame, result)) { }
+
+	/*
+	 * Coarsest levels are loaded unconditionally, so each texture has something to display
+	 */
+	std::vector<Handle> candidates;
+	for (Handle handle = 0, e = static_cast<Handle>(_entries.size()); handle < e; ++handle)
+	{
+		const Entry& entry = _entries[handle];
+		if (!entry.active || entry.pending || entry.failed)
+			continue;
+
+		if (entry.residentLevel == entry.levelsCount)
+		{
+			if (_pendingLoads < _maxPendingLoads)
+				startLoad(handle, entry.levelsCount - 1);
+		}
+		else if ((entry.residentLevel > entry.desiredLevel) && (entry.lastUsedFrame + activeFramesWindow > frame))
+		{
+			candidates.push_back(handle);
+		}
+	}
+
+	/*
+	 * Recently used textures with the largest lack of details go first,
+	 * finer levels are streamed one by one
+	 */
+	std::sort(candidates.begin(), candidates.end(), [this](Handle l, Handle r)
+	{
+		const Entry& le = _entries[l];
+		const Entry& re = _entries[r];
+
+		if (le.lastUsedFrame != re.lastUsedFrame)
+			return le.lastUsedFrame > re.lastUsedFrame;
+
+		uint32_t lDelta = le.residentLevel - le.desiredLevel;
+		uint32_t rDelta = re.residentLevel - re.desiredLevel;
+		if (lDelta != rDelta)
+			return lDelta > rDelta;
+
+		return le.levelSizes[le.residentLevel - 1] < re.levelSizes[re.residentLevel - 1];
+	});
+
+	for (Handle handle : candidates)
+	{
+		if (_pendingLoads >= _maxPendingLoads)
+			break;
+
+		const Entry& entry = _entries[handle];
+		uint32_t level = entry.residentLevel - 1;
+		size_t levelSize = entry.levelSizes.at(level);
+
+		while ((_residentSize + levelSize > _budget) && evictLevel(entry.lastUsedFrame, result)) { }
+
+		if (_residentSize + levelSize <= _budget)
+			startLoad(handle, level);
+	}
+
+	return result;
+}
+
+void TextureResidencyPolicy::levelDidLoad(Handle handle, uint32_t level)
+{
+	Entry& entry = _entries.at(handle);
+	if (!entry.active || !entry.pending || (entry.pendingLevel != level)) return;
+
+	entry.pending = false;
+	entry.residentLevel = level;
+	--_pendingLoads;
+}
+
+void TextureResidencyPolicy::levelDidFailToLoad(Handle handle, uint32_t level)
+{
+	Entry& entry = _entries.at(handle);
+	if (!entry.active || !entry.pending || (entry.pendingLevel != level)) return;
+
+	entry.pending = false;
+	entry.failed = true;
+	_residentSize -= entry.levelSizes.at(level);
+	--_pendingLoads;
+}
+
+uint32_t TextureResidencyPolicy::levelsCount(Handle handle) const
+{
+	return _entries.at(handle).levelsCount;
+}
+
+uint32_t TextureResidencyPolicy::residentLevel(Handle handle) const
+{
+	return _entries.at(handle).residentLevel;
+}
+
+uint32_t TextureResidencyPolicy::desiredLevel(Handle handle) const
+{
+	return _entries.at(handle).desiredLevel;
+}
+
+bool TextureResidencyPolicy::hasPendingLoad(Handle handle) const
+{
+	return _entries.at(handle).pending;
+}
+
+/*
+ * TextureResidencyManager
+ */
+TextureResidencyManager::TextureResidencyManager(RenderContext* rc, size_t budget) :
+	_rc(rc), _policy(budget)
+{
+}
+
+TextureResidencyManager::~TextureResidencyManager()
+{
+	while (_pendingReads.atomicCounterValue() > 0)
+		Thread::sleepMSec(1);
+}
+
+Texture::Pointer TextureResidencyManager::loadTexture(const std::string& fileName, ObjectsCache& cache)
+{
+	auto file = application().resolveFileName(fileName);
+
+	auto existing = _handles.find(file);
+	if (existing != _handles.end())
+		return _textures.at(existing->second).texture;
+
+	TextureDescription::Pointer desc = TextureDescription::Pointer::create();
+	desc->setOrigin(file);
+
+	bool streamable = false;
+	uint64_t dataOffset = 0;
+
+	auto ext = lowercase(getFileExt(file));
+	if ((ext == "dds") || (ext == "pvr"))
+	{
+		InputStream input(file, StreamMode_Binary);
+		if (input.valid())
+		{
+			if (ext == "dds")
+			{
+				dds::loadInfoFromStream(input.stream(), desc.reference());
+
+				/*
+				 * Same as dds::loadFromStream does
+				 */
+				while ((desc->mipMapCount > 1) && ((desc->sizeForMipLevel(desc->mipMapCount - 1).x <= 4) ||
+					(desc->sizeForMipLevel(desc->mipMapCount - 1).y <= 4)))
+				{
+					--desc->mipMapCount;
+				}
+			}
+			else
+			{
+				pvr::loadInfoFromStream(input.stream(), desc.reference());
+			}
+
+			dataOffset = static_cast<uint64_t>(input.stream().tellg());
+			streamable = !input.stream().fail() && canStreamTexture(desc.reference());
+		}
+	}
+
+	if (!streamable)
+		return _rc->textureFactory().loadTexture(fileName, cache);
+
+	std::vector<size_t> levelSizes(desc->mipMapCount);
+	for (size_t level = 0; level < levelSizes.size(); ++level)
+		levelSizes[level] = desc->dataSizeForMipLevel(level);
+
+	auto handle = _policy.add(desc->size, levelSizes);
+
+	StreamedTexture& entry = _textures[handle];
+	entry.texture = Texture::Pointer::create(_rc, desc, file, true);
+	entry.fileName = file;
+	entry.dataOffset = dataOffset;
+	_handles[file] = handle;
+
+	return entry.texture;
+}
+
+void TextureResidencyManager::releaseTexture(const Texture::Pointer& texture)
+{
+	auto i = _handles.find(texture->origin());
+	if (i == _handles.end()) return;
+
+	_policy.remove(i->second);
+	_textures.erase(i->second);
+	_handles.erase(i);
+}
+
+void TextureResidencyManager::reportScreenSize(const Texture::Pointer& texture, float pixels)
+{
+	auto i = _handles.find(texture->origin());
+	if (i != _handles.end())
+		_policy.reportScreenSize(i->second, pixels, _frame);
+}
+
+void TextureResidencyManager::update()
+{
+	processLoadedLevels();
+
+	auto actions = _policy.update(_frame);
+	for (const auto& action : actions)
+	{
+		if (action.type == TextureResidencyPolicy::ActionType::Evict)
+		{
+			auto& texture = _textures.at(action.handle).texture;
+			texture->setBaseLod(_rc, action.level + 1);
+			texture->releaseMipLevel(_rc, action.level);
+		}
+		else
+		{
+			requestLevel(action.handle, action.level);
+		}
+	}
+
+	++_frame;
+}
+
+void TextureResidencyManager::processLoadedLevels()
+{
+	std::vector<LoadedLevel> loadedLevels;
+	{
+		CriticalSectionScope lock(_csLoadedLevels);
+		loadedLevels.swap(_loadedLevels);
+	}
+
+	for (const auto& loaded : loadedLevels)
+	{
+		auto i = _textures.find(loaded.handle);
+		if ((i == _textures.end()) || (i->second.pendingRequest != loaded.request))
+			continue;
+
+		if (loaded.succeeded)
+		{
+			auto& texture = i->second.texture;
+			texture->updateMipLevel(_rc, loaded.level, loaded.data.constBinaryData(), loaded.data.dataSize());
+			texture->setBaseLod(_rc, loaded.level);
+			_policy.levelDidLoad(loaded.handle, loaded.level);
+		}
+		else
+		{
+			log::warning("Unable to stream level %u of texture %s", loaded.level, i->second.fileName.c_str());
+			_policy.levelDidFailToLoad(loaded.handle, loaded.level);
+		}
+	}
+}
+
+void TextureResidencyManager::requestLevel(TextureResidencyPolicy::Handle handle, uint32_t level)
+{
+	StreamedTexture& entry = _textures.at(handle);
+	entry.pendingRequest = ++_requestCounter;
+
+	TextureDescription::Pointer desc = entry.texture->description();
+	uint64_t offset = entry.dataOffset + desc->dataOffsetForMipLevel(level, 0);
+	size_t dataSize = desc->dataSizeForMipLevel(level);
+	uint64_t request = entry.pendingRequest;
+	std::string fileName = entry.fileName;
+
+	_pendingReads.retain();
+	Invocation([this, fileName, offset, dataSize, request, handle, level]()
+	{
+		LoadedLevel result;
+		result.request = request;
+		result.handle = handle;
+		result.level = level;
+
+		InputStream input(fileName, StreamMode_Binary);
+		if (input.valid())
+		{
+			result.data.resize(dataSize);
+			input.stream().seekg(static_cast<std::streamoff>(offset));
+			input.stream().read(result.data.binary(), static_cast<std::streamsize>(dataSize));
+			result.succeeded = !input.stream().fail();
+		}
+
+		{
+			CriticalSectionScope lock(_csLoadedLevels);
+			_loadedLevels.push_back(std::move(result));
+		}
+
+		_pendingReads.release();
+	}).invokeInBackground();
+}
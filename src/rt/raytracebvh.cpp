@@ -0,0 +1,493 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <cstring>
+#include <et/rt/raytracebvh.h>
+
+#if (ET_SIMD_AVX)
+#	include <immintrin.h>
+#elif (ET_SIMD_SSE)
+#	include <emmintrin.h>
+#endif
+
+using namespace et;
+using namespace et::rt;
+
+namespace
+{
+	enum : uint32_t
+	{
+		TraverseStackSize = 64
+	};
+
+	const float intersectionEpsilon = 0.00001f;
+
+	/*
+	 * Minimal wrappers over SIMD registers, masks are stored in the same type
+	 * with all bits set for "true" lanes. Generic implementation is used where
+	 * corresponding instruction set is not available.
+	 */
+	template <size_t N>
+	struct floatN
+	{
+		float v[N];
+
+		static floatN load(const float* p)
+			{ floatN r; for (size_t i = 0; i < N; ++i) r.v[i] = p[i]; return r; }
+
+		static floatN set(float f)
+			{ floatN r; for (size_t i = 0; i < N; ++i) r.v[i] = f; return r; }
+
+		void store(float* p) const
+			{ for (size_t i = 0; i < N; ++i) p[i] = v[i]; }
+
+		uint32_t mask() const
+		{
+			uint32_t result = 0;
+			for (size_t i = 0; i < N; ++i)
+				result |= (bits(v[i]) >> 31) << i;
+			return result;
+		}
+
+		static uint32_t bits(float f)
+			{ uint32_t u = 0; std::memcpy(&u, &f, sizeof(u)); return u; }
+
+		static float fromBits(uint32_t u)
+			{ float f = 0.0f; std::memcpy(&f, &u, sizeof(f)); return f; }
+
+		static float boolean(bool b)
+			{ return fromBits(b ? 0xffffffff : 0); }
+	};
+
+#define ET_FLOATN_BINARY_OP(OP, EXPR) \
+	template <size_t N> inline floatN<N> OP(const floatN<N>& a, const floatN<N>& b) \
+		{ floatN<N> r; for (size_t i = 0; i < N; ++i) r.v[i] = EXPR; return r; }
+
+	ET_FLOATN_BINARY_OP(operator +, a.v[i] + b.v[i])
+	ET_FLOATN_BINARY_OP(operator -, a.v[i] - b.v[i])
+	ET_FLOATN_BINARY_OP(operator *, a.v[i] * b.v[i])
+	ET_FLOATN_BINARY_OP(operator /, a.v[i] / b.v[i])
+	ET_FLOATN_BINARY_OP(vmin, (a.v[i] < b.v[i]) ? a.v[i] : b.v[i])
+	ET_FLOATN_BINARY_OP(vmax, (a.v[i] > b.v[i]) ? a.v[i] : b.v[i])
+	ET_FLOATN_BINARY_OP(operator <, floatN<N>::boolean(a.v[i] < b.v[i]))
+	ET_FLOATN_BINARY_OP(operator <=, floatN<N>::boolean(a.v[i] <= b.v[i]))
+	ET_FLOATN_BINARY_OP(operator >, floatN<N>::boolean(a.v[i] > b.v[i]))
+	ET_FLOATN_BINARY_OP(operator &, floatN<N>::fromBits(floatN<N>::bits(a.v[i]) & floatN<N>::bits(b.v[i])))
+	ET_FLOATN_BINARY_OP(operator |, floatN<N>::fromBits(floatN<N>::bits(a.v[i]) | floatN<N>::bits(b.v[i])))
+
+#undef ET_FLOATN_BINARY_OP
+
+	template <size_t N>
+	inline floatN<N> vabs(const floatN<N>& a)
+		{ floatN<N> r; for (size_t i = 0; i < N; ++i) r.v[i] = std::abs(a.v[i]); return r; }
+
+	template <size_t N>
+	inline floatN<N> select(const floatN<N>& m, const floatN<N>& a, const floatN<N>& b)
+	{
+		floatN<N> r;
+		for (size_t i = 0; i < N; ++i)
+			r.v[i] = (floatN<N>::bits(m.v[i]) != 0) ? a.v[i] : b.v[i];
+		return r;
+	}
+
+#if (ET_SIMD_SSE)
+	struct float4
+	{
+		__m128 v;
+
+		float4() { }
+		float4(__m128 a) : v(a) { }
+
+		static float4 load(const float* p)
+			{ return _mm_loadu_ps(p); }
+
+		static float4 set(float f)
+			{ return _mm_set1_ps(f); }
+
+		void store(float* p) const
+			{ _mm_storeu_ps(p, v); }
+
+		uint32_t mask() const
+			{ return static_cast<uint32_t>(_mm_movemask_ps(v)); }
+	};
+
+	inline float4 operator + (const float4& a, const float4& b) { return _mm_add_ps(a.v, b.v); }
+	inline float4 operator - (const float4& a, const float4& b) { return _mm_sub_ps(a.v, b.v); }
+	inline float4 operator * (const float4& a, const float4& b) { return _mm_mul_ps(a.v, b.v); }
+	inline float4 operator / (const float4& a, const float4& b) { return _mm_div_ps(a.v, b.v); }
+	inline float4 operator < (const float4& a, const float4& b) { return _mm_cmplt_ps(a.v, b.v); }
+	inline float4 operator <= (const float4& a, const float4& b) { return _mm_cmple_ps(a.v, b.v); }
+	inline float4 operator > (const float4& a, const float4& b) { return _mm_cmpgt_ps(a.v, b.v); }
+	inline float4 operator & (const float4& a, const float4& b) { return _mm_and_ps(a.v, b.v); }
+	inline float4 operator | (const float4& a, const float4& b) { return _mm_or_ps(a.v, b.v); }
+	inline float4 vmin(const float4& a, const float4& b) { return _mm_min_ps(a.v, b.v); }
+	inline float4 vmax(const float4& a, const float4& b) { return _mm_max_ps(a.v, b.v); }
+
+	inline float4 vabs(const float4& a)
+		{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+	inline float4 select(const float4& m, const float4& a, const float4& b)
+		{ return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)); }
+#else
+	typedef floatN<4> float4;
+#endif
+
+#if (ET_SIMD_AVX)
+	struct float8
+	{
+		__m256 v;
+
+		float8() { }
+		float8(__m256 a) : v(a) { }
+
+		static float8 load(const float* p)
+			{ return _mm256_loadu_ps(p); }
+
+		static float8 set(float f)
+			{ return _mm256_set1_ps(f); }
+
+		void store(float* p) const
+			{ _mm256_storeu_ps(p, v); }
+
+		uint32_t mask() const
+			{ return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+	};
+
+	inline float8 operator + (const float8& a, const float8& b) { return _mm256_add_ps(a.v, b.v); }
+	inline float8 operator - (const float8& a, const float8& b) { return _mm256_sub_ps(a.v, b.v); }
+	inline float8 operator * (const float8& a, const float8& b) { return _mm256_mul_ps(a.v, b.v); }
+	inline float8 operator / (const float8& a, const float8& b) { return _mm256_div_ps(a.v, b.v); }
+	inline float8 operator < (const float8& a, const float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+	inline float8 operator <= (const float8& a, const float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+	inline float8 operator > (const float8& a, const float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+	inline float8 operator & (const float8& a, const float8& b) { return _mm256_and_ps(a.v, b.v); }
+	inline float8 operator | (const float8& a, const float8& b) { return _mm256_or_ps(a.v, b.v); }
+	inline float8 vmin(const float8& a, const float8& b) { return _mm256_min_ps(a.v, b.v); }
+	inline float8 vmax(const float8& a, const float8& b) { return _mm256_max_ps(a.v, b.v); }
+
+	inline float8 vabs(const float8& a)
+		{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+
+	inline float8 select(const float8& m, const float8& a, const float8& b)
+		{ return _mm256_blendv_ps(b.v, a.v, m.v); }
+#else
+	typedef floatN<8> float8;
+#endif
+
+	template <size_t N> struct PacketRegister { };
+	template <> struct PacketRegister<4> { typedef float4 Type; };
+	template <> struct PacketRegister<8> { typedef float8 Type; };
+
+	inline float safeInverse(float value)
+	{
+		return (std::abs(value) > std::numeric_limits<float>::epsilon()) ? 1.0f / value :
+			std::copysign(std::numeric_limits<float>::max(), value);
+	}
+
+	inline bool rayBox(const vec3& origin, const vec3& inverseDirection, const TriangleBVH::Node& node,
+		float maxDistance, float& entry)
+	{
+		vec3 t0 = (node.minVertex - origin) * inverseDirection;
+		vec3 t1 = (node.maxVertex - origin) * inverseDirection;
+		vec3 tMin = minv(t0, t1);
+		vec3 tMax = maxv(t0, t1);
+		entry = etMax(0.0f, etMax(tMin.x, etMax(tMin.y, tMin.z)));
+		return entry <= etMin(maxDistance, etMin(tMax.x, etMin(tMax.y, tMax.z)));
+	}
+}
+
+void BVH::clear()
+{
+	_nodes.clear();
+	_triangles.clear();
+}
+
+void BVH::build(const SceneTriangleList& sceneTriangles)
+{
+	clear();
+
+	size_t triangleCount = sceneTriangles.lastElementIndex();
+	if (triangleCount == 0)
+		return;
+
+	std::vector<triangle> triangles;
+	triangles.reserve(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+		triangles.push_back(sceneTriangles[i].tri);
+
+	TriangleBVH hierarchy;
+	hierarchy.build(triangles.data(), triangles.size());
+
+	_nodes = hierarchy.nodes();
+
+	/*
+	 * node offsets reference index table, so triangles stored in the same order
+	 * are referenced directly and leaf contents are contiguous in memory
+	 */
+	const auto& indices = hierarchy.indices();
+	_triangles.resize(indices.size());
+	for (size_t i = 0, e = indices.size(); i < e; ++i)
+	{
+		const triangle& t = triangles.at(indices.at(i));
+		_triangles[i].v0 = t.v1();
+		_triangles[i].e1 = t.edge2to1();
+		_triangles[i].e2 = t.edge3to1();
+		_triangles[i].index = indices.at(i);
+	}
+}
+
+template <bool anyHit>
+bool BVH::traverseRay(const ray3d& ray, Hit& hit) const
+{
+	if (empty()) return false;
+
+	vec3 inverseDirection(safeInverse(ray.direction.x), safeInverse(ray.direction.y), safeInverse(ray.direction.z));
+	float nearest = hit.distance;
+	uint32_t nearestIndex = InvalidTriangleIndex;
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	float entry = 0.0f;
+	if (!rayBox(ray.origin, inverseDirection, _nodes.front(), nearest, entry))
+		return false;
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const auto& node = _nodes[nodeIndex];
+
+		if (node.leaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				const PackedTriangle& t = _triangles[i];
+
+				vec3 h = cross(ray.direction, t.e2);
+				float a = dot(t.e1, h);
+				if (std::abs(a) < intersectionEpsilon) continue;
+
+				float f = 1.0f / a;
+				vec3 s = ray.origin - t.v0;
+				float u = f * dot(s, h);
+				if ((u < 0.0f) || (u > 1.0f)) continue;
+
+				vec3 q = cross(s, t.e1);
+				float v = f * dot(ray.direction, q);
+				if ((v < 0.0f) || (u + v > 1.0f)) continue;
+
+				float distance = f * dot(t.e2, q);
+				if ((distance > intersectionEpsilon) && (distance < nearest))
+				{
+					nearest = distance;
+					nearestIndex = t.index;
+
+					/* any hit closer than initial distance is enough */
+					if (anyHit) break;
+				}
+			}
+
+			if (anyHit && (nearestIndex != InvalidTriangleIndex))
+				break;
+
+			continue;
+		}
+
+		uint32_t left = nodeIndex + 1;
+		uint32_t right = node.offset;
+		float leftEntry = 0.0f;
+		float rightEntry = 0.0f;
+		bool hitLeft = rayBox(ray.origin, inverseDirection, _nodes[left], nearest, leftEntry);
+		bool hitRight = rayBox(ray.origin, inverseDirection, _nodes[right], nearest, rightEntry);
+
+		ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+		if (hitLeft && hitRight)
+		{
+			bool leftFirst = leftEntry <= rightEntry;
+			stack[stackSize++] = leftFirst ? right : left;
+			stack[stackSize++] = leftFirst ? left : right;
+		}
+		else if (hitLeft)
+		{
+			stack[stackSize++] = left;
+		}
+		else if (hitRight)
+		{
+			stack[stackSize++] = right;
+		}
+	}
+
+	if (nearestIndex == InvalidTriangleIndex)
+		return false;
+
+	hit.distance = nearest;
+	hit.triangleIndex = nearestIndex;
+	return true;
+}
+
+bool BVH::intersect(const ray3d& ray, Hit& hit) const
+{
+	return traverseRay<false>(ray, hit);
+}
+
+bool BVH::occluded(const ray3d& ray, float maxDistance) const
+{
+	Hit hit;
+	hit.distance = maxDistance;
+	return traverseRay<true>(ray, hit);
+}
+
+template <size_t N, bool anyHit>
+uint32_t BVH::traversePacket(RayPacket<N>& packet) const
+{
+	typedef typename PacketRegister<N>::Type F;
+
+	const uint32_t allLanes = (1u << N) - 1;
+
+	F ox = F::load(packet.originX);
+	F oy = F::load(packet.originY);
+	F oz = F::load(packet.originZ);
+	F dx = F::load(packet.directionX);
+	F dy = F::load(packet.directionY);
+	F dz = F::load(packet.directionZ);
+	F tMax = F::load(packet.distance);
+
+	float inverse[N];
+	for (size_t i = 0; i < N; ++i) inverse[i] = safeInverse(packet.directionX[i]);
+	F idx = F::load(inverse);
+	for (size_t i = 0; i < N; ++i) inverse[i] = safeInverse(packet.directionY[i]);
+	F idy = F::load(inverse);
+	for (size_t i = 0; i < N; ++i) inverse[i] = safeInverse(packet.directionZ[i]);
+	F idz = F::load(inverse);
+
+	const F zero = F::set(0.0f);
+	const F one = F::set(1.0f);
+	const F epsilon = F::set(intersectionEpsilon);
+
+	uint32_t activeLanes = (zero < tMax).mask();
+	uint32_t hitLanes = 0;
+
+	/* averaged direction is used to order children */
+	vec3 packetDirection;
+	for (size_t i = 0; i < N; ++i)
+		packetDirection += vec3(packet.directionX[i], packet.directionY[i], packet.directionZ[i]);
+
+	uint32_t stack[TraverseStackSize];
+	uint32_t stackSize = 0;
+
+	if ((activeLanes != 0) && !empty())
+		stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const auto& node = _nodes[nodeIndex];
+
+		F tx0 = (F::set(node.minVertex.x) - ox) * idx;
+		F tx1 = (F::set(node.maxVertex.x) - ox) * idx;
+		F ty0 = (F::set(node.minVertex.y) - oy) * idy;
+		F ty1 = (F::set(node.maxVertex.y) - oy) * idy;
+		F tz0 = (F::set(node.minVertex.z) - oz) * idz;
+		F tz1 = (F::set(node.maxVertex.z) - oz) * idz;
+		F entry = vmax(vmax(zero, vmin(tx0, tx1)), vmax(vmin(ty0, ty1), vmin(tz0, tz1)));
+		F exit = vmin(vmin(tMax, vmax(tx0, tx1)), vmin(vmax(ty0, ty1), vmax(tz0, tz1)));
+
+		if (((entry <= exit).mask() & activeLanes) == 0)
+			continue;
+
+		if (!node.leaf())
+		{
+			ET_ASSERT(stackSize + 2 <= TraverseStackSize);
+			uint32_t left = nodeIndex + 1;
+			uint32_t right = node.offset;
+			vec3 leftCenter = _nodes[left].minVertex + _nodes[left].maxVertex;
+			vec3 rightCenter = _nodes[right].minVertex + _nodes[right].maxVertex;
+			bool leftFirst = dot(rightCenter - leftCenter, packetDirection) >= 0.0f;
+			stack[stackSize++] = leftFirst ? right : left;
+			stack[stackSize++] = leftFirst ? left : right;
+			continue;
+		}
+
+		for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+		{
+			const PackedTriangle& t = _triangles[i];
+
+			F e1x = F::set(t.e1.x);
+			F e1y = F::set(t.e1.y);
+			F e1z = F::set(t.e1.z);
+			F e2x = F::set(t.e2.x);
+			F e2y = F::set(t.e2.y);
+			F e2z = F::set(t.e2.z);
+
+			F hx = dy * e2z - dz * e2y;
+			F hy = dz * e2x - dx * e2z;
+			F hz = dx * e2y - dy * e2x;
+			F a = e1x * hx + e1y * hy + e1z * hz;
+			F valid = epsilon < vabs(a);
+			if ((valid.mask() & activeLanes) == 0) continue;
+
+			F f = one / a;
+			F sx = ox - F::set(t.v0.x);
+			F sy = oy - F::set(t.v0.y);
+			F sz = oz - F::set(t.v0.z);
+			F u = f * (sx * hx + sy * hy + sz * hz);
+			valid = valid & (zero <= u) & (u <= one);
+
+			F qx = sy * e1z - sz * e1y;
+			F qy = sz * e1x - sx * e1z;
+			F qz = sx * e1y - sy * e1x;
+			F v = f * (dx * qx + dy * qy + dz * qz);
+			valid = valid & (zero <= v) & ((u + v) <= one);
+
+			F distance = f * (e2x * qx + e2y * qy + e2z * qz);
+			valid = valid & (epsilon < distance) & (distance < tMax);
+
+			uint32_t validLanes = valid.mask() & activeLanes;
+			if (validLanes == 0) continue;
+
+			hitLanes |= validLanes;
+			if (anyHit)
+			{
+				activeLanes &= ~validLanes;
+				if (activeLanes == 0)
+					return hitLanes;
+				continue;
+			}
+
+			tMax = select(valid, distance, tMax);
+			for (uint32_t lane = 0; lane < N; ++lane)
+			{
+				if (validLanes & (1u << lane))
+					packet.triangleIndex[lane] = t.index;
+			}
+		}
+	}
+
+	if (!anyHit)
+		tMax.store(packet.distance);
+
+	return hitLanes & allLanes;
+}
+
+void BVH::intersect(RayPacket4& packet) const
+	{ traversePacket<4, false>(packet); }
+
+void BVH::intersect(RayPacket8& packet) const
+	{ traversePacket<8, false>(packet); }
+
+uint32_t BVH::occluded(const RayPacket4& packet) const
+{
+	RayPacket4 local(packet);
+	return traversePacket<4, true>(local);
+}
+
+uint32_t BVH::occluded(const RayPacket8& packet) const
+{
+	RayPacket8 local(packet);
+	return traversePacket<8, true>(local);
+}
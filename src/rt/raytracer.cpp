@@ -0,0 +1,523 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <deque>
+#include <et/core/tools.h>
+#include <et/rt/raytracer.h>
+
+using namespace et;
+using namespace et::rt;
+
+namespace
+{
+	typedef std::deque<float, SharedBlockAllocatorSTDProxy<float>> IndexOfRefractionDeque;
+
+	vec3 randomDiffuseVector(const vec3& normal);
+	vec3 randomReflectedVector(const vec3& incidence, const vec3& normal, float roughness, vec3& idealReflection);
+	vec3 randomRefractedVector(const vec3& incidence, const vec3& normal, float eta, float k, float roughness, vec3& idealRefraction);
+	vec3 refract(const vec3& incidence, const vec3& normal, float eta, float k);
+
+	float calculateRefractiveCoefficient(const vec3& incidence, const vec3& normal, float eta);
+	float computeFresnelTerm(const vec3& incidence, const vec3& normal, float indexOfRefraction);
+
+	vec4 gatherBouncesRecursive(const RaytraceScene& scene, const ray3d& ray, size_t depth, size_t maxDepth,
+		IndexOfRefractionDeque& mediumIORs, const vec4& terminatingColor);
+
+	vec4 gatherBounces(const RaytraceScene& scene, const ray3d& ray, SceneIntersection i, size_t depth,
+		size_t maxDepth, IndexOfRefractionDeque& mediumIORs, const vec4& terminatingColor);
+
+	vec4 computeReflection(const RaytraceScene& scene, const SceneMaterial& mat, const vec3& rayDirection,
+		const vec3& startPoint, const vec3& startNormal, size_t depth, size_t maxDepth,
+		IndexOfRefractionDeque& mediumIORs, const vec4& terminatingColor);
+
+	vec4 sampleEnvironmentColor(const RaytraceScene& scene, const ray3d& r);
+
+	inline float randomFloatFrom1to1()
+	{
+		static float values[512] = { };
+		static bool shouldInitialize = true;
+		if (shouldInitialize)
+		{
+			for (int i = 0; i < 512; ++i)
+				values[i] = randomFloat(-1.0f, 1.0f);
+			shouldInitialize = false;
+		}
+		return values[rand() % 512];
+	}
+
+	vec4 sampleTexture(const TextureDescription::Pointer& tex, vec2i texCoord)
+	{
+		{
+			while (texCoord.x >= tex->size.x) texCoord.x -= tex->size.x;
+			while (texCoord.y >= tex->size.y) texCoord.y -= tex->size.y;
+			while (texCoord.x < 0) texCoord.x += tex->size.x;
+			while (texCoord.y < 0) texCoord.y += tex->size.y;
+		}
+
+		const vec4* rawData = reinterpret_cast<const vec4*>(tex->data.binary());
+		return rawData[texCoord.x + texCoord.y * tex->size.x];
+	}
+
+	vec4 sampleEnvironmentColor(const RaytraceScene& scene, const ray3d& r)
+	{
+		if (scene.environmentMap.invalid())
+			return scene.ambientColor;
+
+		ET_ASSERT(scene.environmentMap->bitsPerPixel == 128)
+
+		float phi = 0.5f + std::atan2(r.direction.z, r.direction.x) / DOUBLE_PI;
+		float theta = 0.5f + std::asin(r.direction.y) / PI;
+
+		vec2 tc(phi * scene.environmentMap->size.x, theta * scene.environmentMap->size.y);
+		vec2i baseTexCoord(static_cast<int>(tc.x), static_cast<int>(tc.y));
+
+		vec4 c00 = sampleTexture(scene.environmentMap, baseTexCoord); ++baseTexCoord.x;
+		vec4 c10 = sampleTexture(scene.environmentMap, baseTexCoord); ++baseTexCoord.y;
+		vec4 c11 = sampleTexture(scene.environmentMap, baseTexCoord); --baseTexCoord.x;
+		vec4 c01 = sampleTexture(scene.environmentMap, baseTexCoord);
+
+		vec2 dudv(tc.x - std::floor(tc.x), tc.y - std::floor(tc.y));
+
+		return scene.ambientColor * mix(mix(c00, c10, dudv.x), mix(c01, c11, dudv.x), dudv.y);
+	}
+
+	vec4 computeReflection(const RaytraceScene& scene, const SceneMaterial& mat, const vec3& rayDirection,
+		const vec3& startPoint, const vec3& startNormal, size_t depth, size_t maxDepth, IndexOfRefractionDeque& mediumIORs,
+		const vec4& terminatingColor)
+	{
+		vec3 ideal;
+		vec3 reflectedRay = randomReflectedVector(rayDirection, startNormal, mat.roughness, ideal);
+		auto deepBounce = gatherBouncesRecursive(scene, ray3d(startPoint, reflectedRay), depth, maxDepth, mediumIORs, terminatingColor);
+		return mat.emissiveColor + mat.reflectiveColor * (deepBounce * dot(reflectedRay, ideal));
+	}
+
+	vec4 gatherBouncesRecursive(const RaytraceScene& scene, const ray3d& ray, size_t depth, size_t maxDepth,
+		IndexOfRefractionDeque& mediumIORs, const vec4& terminatingColor)
+	{
+		if (depth >= maxDepth)
+			return terminatingColor;
+
+		return gatherBounces(scene, ray, scene.findNearestIntersection(ray), depth,
+			maxDepth, mediumIORs, terminatingColor);
+	}
+
+	vec4 gatherBounces(const RaytraceScene& scene, const ray3d& ray, SceneIntersection i, size_t depth,
+		size_t maxDepth, IndexOfRefractionDeque& mediumIORs, const vec4& terminatingColor)
+	{
+		if (!i.objectHit)
+			return sampleEnvironmentColor(scene, ray);
+
+		const SceneMaterial& mat = scene.materialAtIndex(i.materialIndex);
+
+		if (mat.refractiveIndex > 0.0f)
+		{
+			bool enteringMaterial = dot(ray.direction, i.hitNormal) < 0.0f;
+			bool hasNonDefaultIOR = (mediumIORs.size() > 1);
+
+			float currentIOR = 1.0f;
+			float targetIOR = 1.0f;
+
+			if (enteringMaterial)
+			{
+				currentIOR = mediumIORs.back();
+				targetIOR = mat.refractiveIndex;
+			}
+			else
+			{
+				currentIOR = mat.refractiveIndex;
+				targetIOR = hasNonDefaultIOR ? *(mediumIORs.crbegin() + 1) : mediumIORs.back();
+				i.hitNormal *= -1.0f;
+			}
+
+			float eta = currentIOR / targetIOR;
+			float k = calculateRefractiveCoefficient(ray.direction, i.hitNormal, eta);
+
+			if (k < 0.0f) // reflect to the current medium
+			{
+				return computeReflection(scene, mat, ray.direction, i.hitPoint, i.hitNormal, depth + 1, maxDepth,
+					mediumIORs, terminatingColor);
+			}
+			else
+			{
+				float fresnel = computeFresnelTerm(ray.direction, i.hitNormal, eta);
+
+				if (randomFloat() < fresnel) // reflect to the current medium
+				{
+					return computeReflection(scene, mat, ray.direction, i.hitPoint, i.hitNormal, depth + 1, maxDepth,
+						mediumIORs, terminatingColor);
+				}
+				else // perform refraction
+				{
+					if (enteringMaterial)
+						mediumIORs.push_back(targetIOR);
+					else if (hasNonDefaultIOR)
+						mediumIORs.pop_back();
+
+					vec3 ideal;
+					vec3 refractedRay = randomRefractedVector(ray.direction, i.hitNormal, eta, k, mat.roughness, ideal);
+
+					auto deepBounce = gatherBouncesRecursive(scene, ray3d(i.hitPoint, refractedRay), depth + 1, maxDepth,
+						mediumIORs, terminatingColor);
+
+					return mat.emissiveColor + mat.diffuseColor * (deepBounce * dot(refractedRay, ideal));
+				}
+			}
+		}
+		else if (randomFloat() > mat.roughness)
+		{
+			return computeReflection(scene, mat, ray.direction, i.hitPoint, i.hitNormal, depth + 1, maxDepth,
+				mediumIORs, terminatingColor);
+		}
+		else
+		{
+			vec3 direction = randomDiffuseVector(i.hitNormal);
+
+			auto deepBounce = gatherBouncesRecursive(scene, ray3d(i.hitPoint, direction), depth + 1, maxDepth,
+				mediumIORs, terminatingColor);
+
+			return mat.emissiveColor + mat.diffuseColor * (deepBounce * dot(direction, i.hitNormal));
+		}
+	}
+
+	/*
+	 * Primary rays of neighbour pixels are coherent, so they are traced in packets,
+	 * secondary bounces are traced one by one
+	 */
+	template <typename G, typename P>
+	void tracePrimaryRays(const RaytraceScene& scene, const vec2i& origin, const vec2i& size,
+		size_t samples, G generateRay, P process)
+	{
+		PreferredRayPacket packet;
+		SceneIntersection intersections[PreferredRayPacket::Size];
+		vec2i pixels[PreferredRayPacket::Size];
+		size_t lanes = 0;
+
+		auto flush = [&]()
+		{
+			for (size_t i = lanes; i < PreferredRayPacket::Size; ++i)
+				packet.disable(i);
+
+			scene.findNearestIntersections(packet, intersections);
+
+			for (size_t i = 0; i < lanes; ++i)
+				process(pixels[i], packet.ray(i), intersections[i]);
+
+			lanes = 0;
+		};
+
+		vec2i pixel;
+		for (size_t sample = 0; sample < samples; ++sample)
+		{
+			for (pixel.y = origin.y; pixel.y < origin.y + size.y; ++pixel.y)
+			{
+				for (pixel.x = origin.x; pixel.x < origin.x + size.x; ++pixel.x)
+				{
+					pixels[lanes] = pixel;
+					packet.set(lanes, generateRay(pixel));
+					if (++lanes == PreferredRayPacket::Size)
+						flush();
+				}
+			}
+		}
+
+		if (lanes > 0)
+			flush();
+	}
+
+	vec3 randomDiffuseVector(const vec3& normal)
+	{
+		return randomVectorOnHemisphere(normal, HALF_PI);
+	}
+
+	vec3 randomReflectedVector(const vec3& incidence, const vec3& normal, float roughness, vec3& idealReflection)
+	{
+		idealReflection = reflect(incidence, normal);
+		return randomVectorOnHemisphere(idealReflection, HALF_PI * roughness);
+	}
+
+	vec3 refract(const vec3& incidence, const vec3& normal, float eta, float k)
+	{
+		return eta * incidence - (eta * dot(normal, incidence) + std::sqrt(k)) * normal;
+	}
+
+	vec3 randomRefractedVector(const vec3& incidence, const vec3& normal, float eta, float k, float roughness, vec3& idealRefraction)
+	{
+		ET_ASSERT(k > 0.0f)
+		idealRefraction = refract(incidence, normal, eta, k);
+		return randomVectorOnHemisphere(idealRefraction, HALF_PI * roughness);
+	}
+
+	float calculateRefractiveCoefficient(const vec3& incidence, const vec3& normal, float eta)
+	{
+		return 1.0f - sqr(eta) * (1.0f - sqr(dot(normal, incidence)));
+	}
+
+	float computeFresnelTerm(const vec3& incidence, const vec3& normal, float indexOfRefraction)
+	{
+		float eta = indexOfRefraction * dot(incidence, normal);
+		float eta2 = eta * eta;
+		float beta = 1.0f - indexOfRefraction * indexOfRefraction;
+		float result = 1.0f + 2.0f * (eta2 + eta * sqrt(beta + eta2)) / beta;
+		return clamp(result * result, 0.0f, 1.0f);
+	}
+}
+
+void rt::raytrace(const RaytraceScene& scene, const vec2i& imageSize, const vec2i& origin,
+	const vec2i& size, OutputFunction outputFunction)
+{
+	vec2 dudv = vec2(2.0f) / vector2ToFloat(imageSize);
+	vec2 subPixel = 0.5f * dudv;
+
+	ray3d centerRay = scene.camera.castRay(vec2(0.0f));
+	vec3 ce1 = cross(centerRay.direction, centerRay.direction.x > 0.1f ? unitY : unitX).normalized();
+	vec3 ce2 = cross(ce1, centerRay.direction).normalized();
+
+	auto it = scene.findNearestIntersection(centerRay);
+
+	float deltaAngleForAppertureBlades = DOUBLE_PI / static_cast<float>(scene.apertureBlades);
+	float initialAngleForAppertureBlades = 0.5f * deltaAngleForAppertureBlades;
+	float focalDistance = length(it.hitPoint - centerRay.origin);
+	plane focalPlane(scene.camera.direction(), (scene.camera.position() - scene.camera.direction() * focalDistance).length());
+
+	auto generateRay = [&](const vec2i& pixel) -> ray3d
+	{
+		vec2 fpixel = (vector2ToFloat(pixel) + vec2(0.5f)) * dudv - vec2(1.0f);
+		ray3d r = scene.camera.castRay(fpixel + subPixel * vec2(randomFloatFrom1to1(), randomFloatFrom1to1()));
+
+		if (scene.apertureSize > 0.0f)
+		{
+			vec3 focal;
+			intersect::rayPlane(r, focalPlane, &focal);
+
+			float ra1 = initialAngleForAppertureBlades + static_cast<float>(rand() % scene.apertureBlades) * deltaAngleForAppertureBlades;
+			float ra2 = ra1 + deltaAngleForAppertureBlades;
+			float rd = scene.apertureSize * std::sqrt(randomFloat());
+
+			vec3 o1 = rd * (ce1 * std::sin(ra1) + ce2 * std::cos(ra1));
+			vec3 o2 = rd * (ce1 * std::sin(ra2) + ce2 * std::cos(ra2));
+			vec3 cameraJitter = r.origin + mix(o1, o2, randomFloat());
+
+			r = ray3d(cameraJitter, (focal - cameraJitter).normalized());
+		}
+
+		return r;
+	};
+
+	vec2i pixel;
+	for (pixel.y = origin.y; pixel.y < origin.y + size.y; ++pixel.y)
+	{
+		pixel.x = origin.x;
+		outputFunction(pixel, vec4(1.0f, 0.0f, 0.0f, 1.0f));
+		pixel.x = origin.x + size.x - 1;
+		outputFunction(pixel, vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	}
+
+	for (pixel.x = origin.x; pixel.x < origin.x + size.x; ++pixel.x)
+	{
+		pixel.y = origin.y;
+		outputFunction(pixel, vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		pixel.y = origin.y + size.y - 1;
+		outputFunction(pixel, vec4(1.0f, 0.0f, 1.0f, 1.0f));
+	}
+
+	std::vector<vec4> accumulated(static_cast<size_t>(size.square()));
+	IndexOfRefractionDeque iorDeque;
+
+	tracePrimaryRays(scene, origin, size, scene.options.samples, generateRay,
+		[&](const vec2i& pixel, const ray3d& r, const SceneIntersection& i)
+	{
+		iorDeque.clear();
+		iorDeque.push_back(1.0f);
+
+		size_t index = static_cast<size_t>((pixel.x - origin.x) + (pixel.y - origin.y) * size.x);
+		accumulated[index] += (scene.options.bounces > 0) ?
+			gatherBounces(scene, r, i, 0, scene.options.bounces, iorDeque, vec4(0.0f)) : vec4(0.0f);
+	});
+
+	for (pixel.y = origin.y; pixel.y < origin.y + size.y; ++pixel.y)
+	{
+		for (pixel.x = origin.x; pixel.x < origin.x + size.x; ++pixel.x)
+		{
+			vec4 result = accumulated[static_cast<size_t>((pixel.x - origin.x) + (pixel.y - origin.y) * size.x)];
+			result *= -scene.options.exposure / static_cast<float>(scene.options.samples);
+			result = vec4(1.0f) - vec4(std::exp(result.x), std::exp(result.y), std::exp(result.z), 0.0f);
+			outputFunction(pixel, result);
+		}
+	}
+}
+
+void rt::raytracePreview(const RaytraceScene& scene, const vec2i& imageSize, const vec2i& origin,
+	const vec2i& size, OutputFunction outputFunction)
+{
+	const size_t previewSamples = 4;
+	const size_t previewBounces = 2;
+
+	vec2 dudv = vec2(2.0f) / vector2ToFloat(imageSize);
+
+	auto generateRay = [&](const vec2i& pixel) -> ray3d
+	{
+		return scene.camera.castRay((vector2ToFloat(pixel) + vec2(0.5f)) * dudv - vec2(1.0f));
+	};
+
+	std::vector<vec4> accumulated(static_cast<size_t>(size.square()));
+	IndexOfRefractionDeque iorDeque;
+
+	tracePrimaryRays(scene, origin, size, previewSamples, generateRay,
+		[&](const vec2i& pixel, const ray3d& r, const SceneIntersection& i)
+	{
+		iorDeque.clear();
+		iorDeque.push_back(1.0f);
+
+		size_t index = static_cast<size_t>((pixel.x - origin.x) + (pixel.y - origin.y) * size.x);
+		accumulated[index] += gatherBounces(scene, r, i, 0, previewBounces, iorDeque, vec4(1.0f));
+	});
+
+	vec2i pixel;
+	for (pixel.y = origin.y; pixel.y < origin.y + size.y; ++pixel.y)
+	{
+		for (pixel.x = origin.x; pixel.x < origin.x + size.x; ++pixel.x)
+		{
+			size_t index = static_cast<size_t>((pixel.x - origin.x) + (pixel.y - origin.y) * size.x);
+			outputFunction(pixel, accumulated[index] / static_cast<float>(previewSamples));
+		}
+	}
+}
+
+float rt::ambientOcclusion(const RaytraceScene& scene, const vec3& point, const vec3& normal,
+	size_t samples, float maxDistance)
+{
+	if (samples == 0)
+		return 1.0f;
+
+	const float surfaceOffset = 0.001f;
+	vec3 origin = point + surfaceOffset * normal;
+
+	size_t occluded = 0;
+	PreferredRayPacket packet;
+	for (size_t processed = 0; processed < samples; processed += PreferredRayPacket::Size)
+	{
+		size_t lanes = etMin(samples - processed, size_t(PreferredRayPacket::Size));
+		for (size_t i = 0; i < PreferredRayPacket::Size; ++i)
+		{
+			if (i < lanes)
+				packet.set(i, ray3d(origin, randomDiffuseVector(normal)), maxDistance);
+			else
+				packet.disable(i);
+		}
+
+		uint32_t mask = scene.bvh().occluded(packet);
+		for (size_t i = 0; i < lanes; ++i)
+			occluded += (mask >> i) & 1;
+	}
+
+	return 1.0f - static_cast<float>(occluded) / static_cast<float>(samples);
+}
+
+/*
+ * TileRenderer
+ */
+TileRenderer::TileRenderer(JobSystem& js) :
+	_jobSystem(js)
+{
+}
+
+TileRenderer::~TileRenderer()
+{
+	cancel();
+}
+
+void TileRenderer::render(const RaytraceScene& scene, const vec2i& imageSize, const vec2i& tileSize,
+	bool preview, OutputFunction output, TileFinishedFunction tileFinished)
+{
+	ET_ASSERT((tileSize.x > 0) && (tileSize.y > 0));
+
+	cancel();
+
+	_state = IntrusivePtr<RenderState>::create();
+	_state->scene = &scene;
+	_state->imageSize = imageSize;
+	_state->preview = preview;
+	_state->output = output;
+	_state->tileFinished = tileFinished;
+
+	for (int y = 0; y < imageSize.y; y += tileSize.y)
+	{
+		for (int x = 0; x < imageSize.x; x += tileSize.x)
+		{
+			vec2i origin(x, y);
+			_state->tiles.push_back(recti(origin, vec2i(etMin(tileSize.x, imageSize.x - x),
+				etMin(tileSize.y, imageSize.y - y))));
+		}
+	}
+
+	vec2 center = 0.5f * vector2ToFloat(imageSize);
+	std::sort(_state->tiles.begin(), _state->tiles.end(), [center](const recti& l, const recti& r)
+		{ return (vector2ToFloat(l.center()) - center).dotSelf() < (vector2ToFloat(r.center()) - center).dotSelf(); });
+
+	/*
+	 * Each job pulls tiles until none left, so fast tiles do not leave workers idle
+	 */
+	size_t jobsCount = etMin(_state->tiles.size(), _jobSystem.workersCount() + 1);
+	for (size_t i = 0; i < jobsCount; ++i)
+	{
+		auto state = _state;
+		_jobs.push_back(_jobSystem.submit([state]() { renderTiles(state); }));
+	}
+}
+
+void TileRenderer::renderTiles(IntrusivePtr<RenderState> state)
+{
+	for (;;)
+	{
+		if (state->cancelled)
+			break;
+
+		size_t tileIndex = static_cast<size_t>(state->nextTile.retain() - 1);
+		if (tileIndex >= state->tiles.size())
+			break;
+
+		const recti& tile = state->tiles.at(tileIndex);
+		auto startTime = queryContiniousTimeInMilliSeconds();
+
+		if (state->preview)
+			raytracePreview(*state->scene, state->imageSize, tile.origin(), tile.size(), state->output);
+		else
+			raytrace(*state->scene, state->imageSize, tile.origin(), tile.size(), state->output);
+
+		state->completedTiles.retain();
+
+		if (state->tileFinished)
+			state->tileFinished(tile, queryContiniousTimeInMilliSeconds() - startTime);
+	}
+}
+
+void TileRenderer::cancel()
+{
+	if (_state.valid())
+		_state->cancelled = true;
+
+	wait();
+}
+
+void TileRenderer::wait()
+{
+	_jobSystem.wait(_jobs);
+	_jobs.clear();
+}
+
+size_t TileRenderer::totalTiles() const
+{
+	return _state.valid() ? _state->tiles.size() : 0;
+}
+
+size_t TileRenderer::remainingTiles() const
+{
+	if (_state.invalid() || _state->cancelled)
+		return 0;
+
+	return _state->tiles.size() - static_cast<size_t>(_state->completedTiles.atomicCounterValue());
+}
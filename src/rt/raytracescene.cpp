@@ -0,0 +1,95 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rt/raytracescene.h>
+
+using namespace et;
+using namespace et::rt;
+
+size_t RaytraceScene::addMaterial(const SceneMaterial& m)
+{
+	_materials.push_back(m);
+	return _materials.size() - 1;
+}
+
+void RaytraceScene::addTriangles(const triangle* triangles, size_t count, size_t materialIndex)
+{
+	ET_ASSERT(triangles != nullptr);
+
+	_triangles.fitToSize(count);
+	for (size_t i = 0; i < count; ++i)
+		_triangles.push_back(SceneTriangle(triangles[i], materialIndex));
+}
+
+void RaytraceScene::buildAccelerationStructure()
+{
+	_bvh.build(_triangles);
+}
+
+const SceneMaterial& RaytraceScene::materialAtIndex(size_t i) const
+{
+	if (i >= _materials.size())
+		ET_FAIL("Invalid material index");
+
+	return _materials.at(i);
+}
+
+SceneIntersection RaytraceScene::findNearestIntersection(const ray3d& inRay) const
+{
+	SceneIntersection result;
+
+	BVH::Hit hit;
+	if (_bvh.intersect(inRay, hit))
+	{
+		const SceneTriangle& t = _triangles[static_cast<size_t>(hit.triangleIndex)];
+		result.hitPoint = inRay.origin + hit.distance * inRay.direction;
+		result.hitNormal = t.tri.normalizedNormal();
+		result.rayDistance = hit.distance;
+		result.materialIndex = t.materialIndex;
+		result.triangleIndex = hit.triangleIndex;
+		result.objectHit = true;
+	}
+
+	return result;
+}
+
+bool RaytraceScene::occluded(const ray3d& r, float maxDistance) const
+{
+	return _bvh.occluded(r, maxDistance);
+}
+
+template <typename P>
+void RaytraceScene::resolvePacket(const P& packet, SceneIntersection* output) const
+{
+	for (size_t i = 0; i < P::Size; ++i)
+	{
+		output[i] = SceneIntersection();
+
+		if (packet.hit(i))
+		{
+			const SceneTriangle& t = _triangles[static_cast<size_t>(packet.triangleIndex[i])];
+			output[i].hitPoint = packet.ray(i).origin + packet.distance[i] * packet.ray(i).direction;
+			output[i].hitNormal = t.tri.normalizedNormal();
+			output[i].rayDistance = packet.distance[i];
+			output[i].materialIndex = t.materialIndex;
+			output[i].triangleIndex = packet.triangleIndex[i];
+			output[i].objectHit = true;
+		}
+	}
+}
+
+void RaytraceScene::findNearestIntersections(RayPacket4& packet, SceneIntersection* output) const
+{
+	_bvh.intersect(packet);
+	resolvePacket(packet, output);
+}
+
+void RaytraceScene::findNearestIntersections(RayPacket8& packet, SceneIntersection* output) const
+{
+	_bvh.intersect(packet);
+	resolvePacket(packet, output);
+}
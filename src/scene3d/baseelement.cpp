@@ -84,6 +84,28 @@ const mat4& Element::finalInverseTransform()
 	return _cachedFinalInverseTransform;
 }
 
+void Element::childAdded(Element* c)
+{
+	descendantAdded(c);
+}
+
+void Element::childRemoved(Element* c)
+{
+	descendantRemoved(c);
+}
+
+void Element::descendantAdded(Element* e)
+{
+	if (parent() != nullptr)
+		parent()->descendantAdded(e);
+}
+
+void Element::descendantRemoved(Element* e)
+{
+	if (parent() != nullptr)
+		parent()->descendantRemoved(e);
+}
+
 bool Element::isKindOf(ElementType t) const
 {
 	return (t == ElementType_Any) || (type() == t);
@@ -0,0 +1,130 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/scene3d/instancebatcher.h>
+
+using namespace et;
+using namespace et::s3d;
+
+size_t InstanceBatcher::GroupKeyHash::operator()(const GroupKey& k) const
+{
+	size_t result = std::hash<const void*>()(k.vao);
+	result ^= std::hash<const void*>()(k.material) + 0x9e3779b9 + (result << 6) + (result >> 2);
+	result ^= std::hash<uint64_t>()((static_cast<uint64_t>(k.startIndex) << 32) | k.numIndexes) +
+		0x9e3779b9 + (result << 6) + (result >> 2);
+	return result;
+}
+
+InstanceBatcher::InstanceBatcher(uint32_t maxInstancesPerBatch) :
+	_maxInstancesPerBatch(maxInstancesPerBatch)
+{
+	ET_ASSERT(maxInstancesPerBatch > 0);
+}
+
+void InstanceBatcher::add(Mesh* mesh, float depth)
+{
+	ET_ASSERT(mesh != nullptr);
+
+	GroupKey key;
+	key.vao = mesh->vertexArrayObject().ptr();
+	key.material = mesh->material().ptr();
+	key.startIndex = mesh->startIndex();
+	key.numIndexes = static_cast<uint32_t>(mesh->numIndexes());
+
+	Entry entry;
+	entry.transform = mesh->finalTransform();
+	entry.depth = depth;
+
+	auto i = _groupIndices.find(key);
+	if (i == _groupIndices.end())
+	{
+		entry.group = static_cast<uint32_t>(_groups.size());
+		_groupIndices.insert(std::make_pair(key, entry.group));
+
+		Group group;
+		group.vao = mesh->vertexArrayObject();
+		group.material = mesh->material();
+		group.startIndex = key.startIndex;
+		group.numIndexes = key.numIndexes;
+		_groups.push_back(group);
+	}
+	else
+	{
+		entry.group = i->second;
+	}
+
+	++_groups[entry.group].instancesCount;
+	_entries.push_back(entry);
+}
+
+void InstanceBatcher::build()
+{
+	_batches.clear();
+	_instanceTransforms.resize(_entries.size());
+	_instanceDepths.resize(_entries.size());
+
+	/*
+	 * Counting sort by group, groups are already numbered by the first addition
+	 */
+	_groupOffsets.resize(_groups.size());
+	uint32_t offset = 0;
+	for (size_t i = 0, e = _groups.size(); i < e; ++i)
+	{
+		_groupOffsets[i] = offset;
+		offset += _groups[i].instancesCount;
+	}
+
+	for (const auto& entry : _entries)
+	{
+		uint32_t index = _groupOffsets[entry.group]++;
+		_instanceTransforms[index] = entry.transform;
+		_instanceDepths[index] = entry.depth;
+	}
+
+	offset = 0;
+	for (const auto& group : _groups)
+	{
+		for (uint32_t first = 0; first < group.instancesCount; first += _maxInstancesPerBatch)
+		{
+			Batch batch;
+			batch.vao = group.vao;
+			batch.material = group.material;
+			batch.startIndex = group.startIndex;
+			batch.numIndexes = group.numIndexes;
+			batch.firstInstance = offset + first;
+			batch.instancesCount = etMin(_maxInstancesPerBatch, group.instancesCount - first);
+
+			auto depthBegin = _instanceDepths.begin() + batch.firstInstance;
+			batch.depth = *std::min_element(depthBegin, depthBegin + batch.instancesCount);
+
+			_batches.push_back(batch);
+		}
+		offset += group.instancesCount;
+	}
+}
+
+void InstanceBatcher::clear()
+{
+	_entries.clear();
+	_groups.clear();
+	_groupIndices.clear();
+	_batches.clear();
+	_instanceTransforms.clear();
+	_instanceDepths.clear();
+}
+
+void InstanceBatcher::record(RenderCommandBuffer& buffer, uint32_t pass, const Program::Pointer& program,
+	MaterialIdentifierFunction materialIdentifier)
+{
+	ET_ASSERT(materialIdentifier);
+
+	for (const auto& batch : _batches)
+	{
+		buffer.drawInstanced(pass, program, materialIdentifier(batch.material), batch.vao, batch.startIndex,
+			batch.numIndexes, _instanceTransforms.data() + batch.firstInstance, batch.instancesCount, batch.depth);
+	}
+}
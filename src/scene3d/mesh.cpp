@@ -6,6 +6,7 @@
  */
 
 #include <et/core/tools.h>
+#include <et/camera/camera.h>
 #include <et/scene3d/mesh.h>
 #include <et/scene3d/storage.h>
 
@@ -82,6 +83,10 @@ void Mesh::serialize(std::ostream& stream, SceneVersion version)
 	for (LodMap::iterator i = _lods.begin(), e = _lods.end(); i != e; ++i)
 	{
 		serializeInt(stream, i->first);
+		
+		if (version >= SceneVersion_1_0_6)
+			serializeFloat(stream, _lodScreenCoverage[i->first]);
+		
 		i->second->serialize(stream, version);
 	}
 
@@ -105,18 +110,21 @@ void Mesh::deserialize(std::istream& stream, ElementFactory* factory, SceneVersi
 	for (int i = 0; i < numLods; ++i)
 	{
 		size_t level = deserializeUInt(stream);
+		float coverage = (version >= SceneVersion_1_0_6) ? deserializeFloat(stream) : 0.0f;
+		
 		Mesh::Pointer p = factory->createElementOfType(ElementType_Mesh, 0);
 		p->deserialize(stream, factory, version);
-		attachLod(level, p);
+		attachLod(level, p, coverage);
 	}
 
 	deserializeGeneralParameters(stream, version);
 	deserializeChildren(stream, factory, version);
 }
 
-void Mesh::attachLod(size_t level, Mesh::Pointer mesh)
+void Mesh::attachLod(size_t level, Mesh::Pointer mesh, float screenCoverage)
 {
 	_lods[level] = mesh;
+	_lodScreenCoverage[level] = screenCoverage;
 	mesh->setActive(false);
 }
 
@@ -204,3 +212,31 @@ void Mesh::setLod(size_t level)
 	LodMap::iterator i = _lods.find(level);
 	_selectedLod = (i == _lods.end()) ? 0 : level;
 }
+
+void Mesh::selectLod(float screenCoverage)
+{
+	_selectedLod = 0;
+	for (const auto& lod : _lodScreenCoverage)
+	{
+		if (screenCoverage <= lod.second)
+			_selectedLod = lod.first;
+	}
+}
+
+float Mesh::screenCoverage(const Camera& camera, const vec3& center, float radius)
+{
+	const mat4& proj = camera.projectionMatrix();
+	
+	/*
+	 * Perspective projection divides by distance, orthogonal does not
+	 */
+	float w = 1.0f;
+	if (proj[3][3] == 0.0f)
+	{
+		w = (center - camera.position()).length();
+		if (w <= radius)
+			return std::numeric_limits<float>::max();
+	}
+	
+	return radius * std::abs(proj[1][1]) / w;
+}
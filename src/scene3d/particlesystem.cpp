@@ -9,6 +9,38 @@
 #include <et/rendering/rendercontext.h>
 #include <et/scene3d/particlesystem.h>
 
+namespace et
+{
+	namespace s3d
+	{
+		/*
+		 * Vertices are written on the main thread and uploaded on the thread owning render context
+		 */
+		class ParticlesUploadTask : public Task
+		{
+		public:
+			ParticlesUploadTask(RenderContext* rc, const VertexArrayObject& vao, size_t dataSize) :
+				_rc(rc), _vao(vao), _data(dataSize) { }
+			
+			BinaryDataStorage& data()
+				{ return _data; }
+			
+			void execute()
+			{
+				_rc->renderState().bindVertexArray(_vao);
+				void* bufferData = _vao->vertexBuffer()->map(0, _data.dataSize(), MapBufferMode::WriteOnly);
+				etCopyMemory(bufferData, _data.data(), _data.dataSize());
+				_vao->vertexBuffer()->unmap();
+			}
+			
+		private:
+			RenderContext* _rc = nullptr;
+			VertexArrayObject _vao;
+			BinaryDataStorage _data;
+		};
+	}
+}
+
 using namespace et;
 using namespace et::s3d;
 
@@ -23,14 +55,6 @@ ParticleSystem::ParticleSystem(RenderContext* rc, size_t maxSize, const std::str
 	 */
 	VertexArray::Pointer va = VertexArray::Pointer::create(_decl, maxSize);
 	IndexArray::Pointer ia = IndexArray::Pointer::create(IndexArrayFormat::Format_16bit, maxSize, PrimitiveType::Points);
-	auto pos = va->chunk(VertexAttributeUsage::Position).accessData<vec3>(0);
-	auto clr = va->chunk(VertexAttributeUsage::Color).accessData<vec4>(0);
-	for (size_t i = 0; i < pos.size(); ++i)
-	{
-		const auto& p = _emitter.particle(i);
-		pos[i] = p.position;
-		clr[i] = p.color;
-	}
 	ia->linearize(va->size());
 	
 	_vao = rc->vertexBufferFactory().createVertexArrayObject(name, va, BufferDrawType::Stream, ia, BufferDrawType::Static);
@@ -48,22 +72,21 @@ ParticleSystem* ParticleSystem::duplicate()
 
 void ParticleSystem::onTimerUpdated(NotifyTimer* timer)
 {
-	_emitter.update(timer->actualTime());
-	
-	_rc->renderState().bindVertexArray(_vao);
-	void* bufferData = bufferData = _vao->vertexBuffer()->map(0, _vertexData.data.dataSize(), MapBufferMode::WriteOnly);
-
-	auto posOffset = _decl.elementForUsage(VertexAttributeUsage::Position).offset();
-	auto clrOffset = _decl.elementForUsage(VertexAttributeUsage::Color).offset();
+	_emitter.update(timer->actualTime(), jobSystem());
 	
-	RawDataAcessor<vec3> pos(reinterpret_cast<char*>(bufferData), _vertexData.data.dataSize(), _decl.dataSize(), posOffset);
-	RawDataAcessor<vec4> clr(reinterpret_cast<char*>(bufferData), _vertexData.data.dataSize() + clrOffset, _decl.dataSize(), clrOffset);
+	size_t dataSize = _emitter.activeParticlesCount() * _decl.dataSize();
+	if (dataSize == 0) return;
 	
-	for (size_t i = 0; i < _emitter.activeParticlesCount(); ++i)
+	if (application().renderingOnSeparateThread())
 	{
-		const auto& p = _emitter.particle(i);
-		pos[i] = p.position;
-		clr[i] = p.color;
+		auto task = sharedObjectFactory().createObject<ParticlesUploadTask>(_rc, _vao, dataSize);
+		_emitter.writeVertices(_vertexData.declaration, task->data().data(), dataSize, jobSystem());
+		application().renderRunLoop().addTask(task, 0.0f);
+		return;
 	}
+	
+	_rc->renderState().bindVertexArray(_vao);
+	void* bufferData = _vao->vertexBuffer()->map(0, dataSize, MapBufferMode::WriteOnly);
+	_emitter.writeVertices(_vertexData.declaration, bufferData, dataSize, jobSystem());
 	_vao->vertexBuffer()->unmap();
 }
@@ -37,13 +37,13 @@ void Scene::serialize(std::ostream& stream, StorageFormat fmt, const std::string
 	{
 		serializeChunk(stream, HeaderMaterials);
 		serializeInt(stream, s->materials().size());
-		if (fmt == StorageFormat_Binary)
+		if ((fmt == StorageFormat_Binary) || (fmt == StorageFormat_MappedBinary))
 		{
 			for (auto& mi : s->materials())
 			{
                 size_t miPtr = reinterpret_cast<size_t>(mi.ptr());
 				serializeInt(stream, static_cast<int>(miPtr & 0xffffffff));
-				mi->serialize(stream, fmt);
+				mi->serialize(stream, StorageFormat_Binary);
 			}
 		}
 		else if (fmt == StorageFormat_HumanReadableMaterials)
@@ -79,6 +79,12 @@ void Scene::serialize(std::ostream& stream, StorageFormat fmt, const std::string
 			ET_FAIL("Invalid storage format specified.");
 		}
 
+		if (fmt == StorageFormat_MappedBinary)
+		{
+			serializeMappedArrays(stream, s);
+			continue;
+		}
+
 		serializeChunk(stream, HeaderVertexArrays);
 		serializeInt(stream, s->vertexArrays().size());
 		for (auto& vi : s->vertexArrays())
@@ -98,6 +104,84 @@ void Scene::serialize(std::ostream& stream, StorageFormat fmt, const std::string
 	ElementContainer::serialize(stream, SceneVersionLatest);
 }
 
+/*
+ * Mapped arrays layout:
+ *   table of vertex arrays (declaration, size, chunks with data offsets) and index array,
+ *   size of the data blob, padding to MappedArraysDataAlignment,
+ *   data blob with each block aligned to MappedArraysDataAlignment.
+ * Offsets are relative to the beginning of the blob.
+ */
+void Scene::serializeMappedArrays(std::ostream& stream, Scene3dStorage::Pointer s)
+{
+	struct Block
+	{
+		const char* data;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	std::vector<Block> blocks;
+	uint64_t blobSize = 0;
+
+	auto serializeBlock = [&](const char* data, size_t dataSize)
+	{
+		uint64_t offset = MappedArraysDataAlignment * ((blobSize + MappedArraysDataAlignment - 1) / MappedArraysDataAlignment);
+		blocks.push_back({ data, offset, dataSize });
+		serializeInt(stream, dataSize);
+		serializeUInt64(stream, offset);
+		blobSize = offset + dataSize;
+	};
+
+	auto serializeChunkData = [&](const VertexDataChunk& c)
+	{
+		serializeInt(stream, static_cast<uint32_t>(c->usage()));
+		serializeInt(stream, static_cast<uint32_t>(c->type()));
+		serializeInt(stream, c->offset());
+		serializeBlock(c->data(), c->dataSize());
+	};
+
+	serializeChunk(stream, HeaderMappedArrays);
+	serializeInt(stream, static_cast<uint32_t>(MappedArraysDataAlignment));
+
+	serializeInt(stream, s->vertexArrays().size());
+	for (auto& vi : s->vertexArrays())
+	{
+		serializeInt(stream, reinterpret_cast<size_t>(vi.ptr()) & 0xffffffff);
+		VertexDeclaration decl = vi->decl();
+		decl.serialize(stream);
+		serializeInt(stream, vi->size());
+		serializeInt(stream, vi->chunks().size());
+		for (const auto& c : vi->chunks())
+			serializeChunkData(c);
+		serializeChunkData(vi->smoothing());
+	}
+
+	IndexArray::Pointer ia = s->indexArray();
+	serializeInt(stream, reinterpret_cast<size_t>(ia.ptr()) & 0xffffffff);
+	serializeInt(stream, static_cast<uint32_t>(ia->format()));
+	serializeInt(stream, static_cast<uint32_t>(ia->primitiveType()));
+	serializeInt(stream, ia->actualSize());
+	serializeBlock(reinterpret_cast<const char*>(ia->data()), ia->dataSize());
+
+	serializeUInt64(stream, blobSize);
+
+	std::streamoff position = stream.tellp() + static_cast<std::streamoff>(sizeof(uint32_t));
+	uint32_t padding = (position < 0) ? 0 : static_cast<uint32_t>((MappedArraysDataAlignment -
+		position % MappedArraysDataAlignment) % MappedArraysDataAlignment);
+
+	const char zeros[MappedArraysDataAlignment] = { };
+	serializeInt(stream, padding);
+	stream.write(zeros, padding);
+
+	uint64_t written = 0;
+	for (const auto& block : blocks)
+	{
+		stream.write(zeros, static_cast<std::streamsize>(block.offset - written));
+		stream.write(block.data, static_cast<std::streamsize>(block.size));
+		written = block.offset + block.size;
+	}
+}
+
 void Scene::deserializeAsync(std::istream& stream, RenderContext* rc, ObjectsCache& tc,
 				ElementFactory* factory, const std::string& basePath)
 {
@@ -107,8 +191,12 @@ void Scene::deserializeAsync(std::istream& stream, RenderContext* rc, ObjectsCac
 void Scene::deserializeAsync(const std::string& filename, RenderContext* rc, ObjectsCache& tc, 
 	ElementFactory* factory)
 {
+	_mappedFile = MappedFile::Pointer::create(filename);
+
 	InputStream file(filename, StreamMode_Binary);
 	deserializeAsync(file.stream(), rc, tc, factory, getFilePath(filename));
+
+	_mappedFile.reset(nullptr);
 }
 
 bool Scene::deserialize(std::istream& stream, RenderContext* rc, ObjectsCache& tc,
@@ -136,7 +224,7 @@ Scene3dStorage::Pointer Scene::deserializeStorage(std::istream& stream, RenderCo
 			size_t numMaterials = deserializeUInt(stream);
 			_materialsToLoad.setValue(static_cast<AtomicCounterType>(numMaterials));
 			
-			if (fmt == StorageFormat_Binary)
+			if ((fmt == StorageFormat_Binary) || (fmt == StorageFormat_MappedBinary))
 			{
 				for (size_t i = 0; i < numMaterials; ++i)
 				{
@@ -195,6 +283,12 @@ Scene3dStorage::Pointer Scene::deserializeStorage(std::istream& stream, RenderCo
 			result->indexArray()->deserialize(stream);
 			indexArrayRead = true;
 		}
+		else if (chunkEqualTo(readChunk, HeaderMappedArrays))
+		{
+			deserializeMappedArrays(stream, result);
+			vertexArraysRead = true;
+			indexArrayRead = true;
+		}
 
 		if (stream.eof()) break;
 	}
@@ -203,6 +297,124 @@ Scene3dStorage::Pointer Scene::deserializeStorage(std::istream& stream, RenderCo
 	return result;
 }
 
+void Scene::deserializeMappedArrays(std::istream& stream, Scene3dStorage::Pointer s)
+{
+	struct ChunkEntry
+	{
+		VertexAttributeUsage usage;
+		VertexAttributeType type;
+		size_t offset;
+		size_t dataSize;
+		uint64_t blobOffset;
+	};
+
+	struct VertexArrayEntry
+	{
+		int tag;
+		VertexDeclaration decl;
+		size_t size;
+		std::vector<ChunkEntry> chunks;
+		ChunkEntry smoothing;
+	};
+
+	auto deserializeChunkEntry = [&stream]() -> ChunkEntry
+	{
+		ChunkEntry result;
+		result.usage = static_cast<VertexAttributeUsage>(deserializeUInt(stream));
+		result.type = static_cast<VertexAttributeType>(deserializeUInt(stream));
+		result.offset = deserializeUInt(stream);
+		result.dataSize = deserializeUInt(stream);
+		result.blobOffset = deserializeUInt64(stream);
+		return result;
+	};
+
+	uint32_t alignment = deserializeUInt(stream);
+	ET_ASSERT(alignment == MappedArraysDataAlignment);
+	(void)(alignment);
+
+	std::vector<VertexArrayEntry> vertexArrays(deserializeUInt(stream));
+	for (auto& va : vertexArrays)
+	{
+		va.tag = deserializeInt(stream);
+		va.decl.deserialize(stream);
+		va.size = deserializeUInt(stream);
+		va.chunks.resize(deserializeUInt(stream));
+		for (auto& c : va.chunks)
+			c = deserializeChunkEntry();
+		va.smoothing = deserializeChunkEntry();
+	}
+
+	int indexArrayTag = deserializeInt(stream);
+	IndexArrayFormat indexFormat = static_cast<IndexArrayFormat>(deserializeUInt(stream));
+	PrimitiveType primitiveType = static_cast<PrimitiveType>(deserializeUInt(stream));
+	size_t indexActualSize = deserializeUInt(stream);
+	size_t indexDataSize = deserializeUInt(stream);
+	uint64_t indexBlobOffset = deserializeUInt64(stream);
+
+	uint64_t blobSize = deserializeUInt64(stream);
+	stream.ignore(deserializeUInt(stream));
+
+	std::streamoff blobStart = stream.tellg();
+	bool mapped = _mappedFile.valid() && _mappedFile->valid() && (blobStart >= 0) &&
+		(static_cast<uint64_t>(blobStart) + blobSize <= _mappedFile->size());
+
+	/*
+	 * Without mapping blocks are read one by one in the order they were written
+	 */
+	uint64_t blobPosition = 0;
+	auto readBlock = [&](char* data, uint64_t blobOffset, size_t dataSize)
+	{
+		ET_ASSERT(blobOffset >= blobPosition);
+		stream.ignore(static_cast<std::streamsize>(blobOffset - blobPosition));
+		stream.read(data, static_cast<std::streamsize>(dataSize));
+		blobPosition = blobOffset + dataSize;
+	};
+
+	auto createChunk = [&](const ChunkEntry& e) -> VertexDataChunk
+	{
+		if (mapped)
+		{
+			return VertexDataChunk(e.usage, e.type, _mappedFile,
+				static_cast<size_t>(blobStart + e.blobOffset), e.dataSize, e.offset);
+		}
+
+		VertexDataChunk result(e.usage, e.type, e.dataSize / vertexAttributeTypeSize(e.type));
+		ET_ASSERT(result->dataSize() == e.dataSize);
+		readBlock(result->data(), e.blobOffset, e.dataSize);
+		result->setOffset(e.offset);
+		return result;
+	};
+
+	for (const auto& va : vertexArrays)
+	{
+		VertexDataChunkList chunks;
+		for (const auto& c : va.chunks)
+			chunks.push_back(createChunk(c));
+
+		VertexArray::Pointer vertexArray = VertexArray::Pointer::create(va.decl, va.size, chunks, createChunk(va.smoothing));
+		vertexArray->tag = va.tag;
+		s->addVertexArray(vertexArray);
+	}
+
+	IndexArray::Pointer indexArray;
+	if (mapped)
+	{
+		indexArray = IndexArray::Pointer::create(indexFormat, primitiveType, indexActualSize, _mappedFile,
+			static_cast<size_t>(blobStart + indexBlobOffset), indexDataSize);
+		stream.seekg(static_cast<std::streamoff>(blobSize), std::ios::cur);
+	}
+	else
+	{
+		indexArray = IndexArray::Pointer::create(indexFormat,
+			indexDataSize / static_cast<size_t>(indexFormat), primitiveType);
+		readBlock(indexArray->binary(), indexBlobOffset, indexDataSize);
+		indexArray->setActualSize(indexActualSize);
+		stream.ignore(static_cast<std::streamsize>(blobSize - blobPosition));
+	}
+	indexArray->tag = indexArrayTag;
+	s->setIndexArray(indexArray);
+}
+
 void Scene::buildAPIObjects(Scene3dStorage::Pointer p, RenderContext* rc)
 {
 	IndexBuffer ib;
@@ -240,12 +452,18 @@ void Scene::serialize(const std::string& filename, s3d::StorageFormat fmt)
 bool Scene::deserialize(const std::string& filename, RenderContext* rc, ObjectsCache& tc,
 	ElementFactory* factory)
 {
-	InputStream file(application().resolveFileName(filename), StreamMode_Binary);
+	std::string resolvedFileName = application().resolveFileName(filename);
+	InputStream file(resolvedFileName, StreamMode_Binary);
 	
 	if (file.invalid())
 		return false;
 	
+	/*
+	 * Vertex and index data stored in StorageFormat_MappedBinary are referenced from the mapping
+	 */
+	_mappedFile = MappedFile::Pointer::create(resolvedFileName);
 	bool success = deserialize(file.stream(), rc, tc, factory, getFilePath(filename));
+	_mappedFile.reset(nullptr);
 
 	if (!success)
 		log::error("Unable to load scene from file: %s", filename.c_str());
@@ -318,6 +536,16 @@ void Scene::allMaterialsLoaded()
 		deserializationFinished.invoke(true);
 }
 
+void Scene::descendantAdded(Element* e)
+{
+	_spatialIndex.add(e);
+}
+
+void Scene::descendantRemoved(Element* e)
+{
+	_spatialIndex.remove(e);
+}
+
 VertexArrayObject Scene::vaoWithIdentifiers(const std::string& vbid, const std::string& ibid)
 {
 	for (auto& i : _vaos)
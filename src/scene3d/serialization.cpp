@@ -11,7 +11,7 @@ namespace et
 {
 	namespace s3d
 	{
-		const SceneVersion SceneVersionLatest = SceneVersion_1_0_4;
+		const SceneVersion SceneVersionLatest = SceneVersion_1_0_6;
 		const StorageVersion StorageVersionLatest = StorageVersion_1_0_1;
 
 		ChunkId HeaderScene = "ETSCN";
@@ -20,6 +20,7 @@ namespace et
 		ChunkId HeaderMaterials = "MTRLS";
 		ChunkId HeaderVertexArrays = "VARRS";
 		ChunkId HeaderIndexArrays = "IARRS";
+		ChunkId HeaderMappedArrays = "MARRS";
 
 		bool chunkEqualTo(ChunkId chunk, ChunkId comp)
 		{
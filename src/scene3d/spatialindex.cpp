@@ -0,0 +1,263 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/scene3d/spatialindex.h>
+
+using namespace et;
+using namespace et::s3d;
+
+namespace
+{
+	const float fatBoxMargin = 0.1f;
+
+	inline bool boxesOverlap(const vec3& min0, const vec3& max0, const vec3& min1, const vec3& max1)
+	{
+		return (min0.x <= max1.x) && (max0.x >= min1.x) && (min0.y <= max1.y) &&
+			(max0.y >= min1.y) && (min0.z <= max1.z) && (max0.z >= min1.z);
+	}
+
+	inline bool sphereOverlapsBox(const vec3& center, float radius, const vec3& minVertex, const vec3& maxVertex)
+	{
+		vec3 closest = minv(maxv(center, minVertex), maxVertex);
+		return (closest - center).dotSelf() <= sqr(radius);
+	}
+
+	struct RayContext
+	{
+		vec3 origin;
+		vec3 inverseDirection;
+		float maxDistance;
+
+		RayContext(const ray3d& r, float aMaxDistance) :
+			origin(r.origin), maxDistance(aMaxDistance)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				inverseDirection[i] = (std::abs(r.direction[i]) > std::numeric_limits<float>::epsilon()) ?
+					1.0f / r.direction[i] : std::copysign(std::numeric_limits<float>::max(), r.direction[i]);
+			}
+		}
+
+		bool hits(const vec3& minVertex, const vec3& maxVertex) const
+		{
+			vec3 t0 = (minVertex - origin) * inverseDirection;
+			vec3 t1 = (maxVertex - origin) * inverseDirection;
+			vec3 tMin = minv(t0, t1);
+			vec3 tMax = maxv(t0, t1);
+			float entry = etMax(0.0f, etMax(tMin.x, etMax(tMin.y, tMin.z)));
+			float exit = etMin(maxDistance, etMin(tMax.x, etMin(tMax.y, tMax.z)));
+			return entry <= exit;
+		}
+	};
+}
+
+SpatialIndex::SpatialIndex() :
+	_tree(fatBoxMargin)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+	clear();
+}
+
+void SpatialIndex::clear()
+{
+	_tree.query([](const vec3&, const vec3&) { return true; }, [](uint32_t, void* userData)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(userData);
+		mesh->_spatialIndex = nullptr;
+		mesh->_spatialProxy = AABBTree::InvalidIndex;
+		mesh->_spatialProxyInvalidated = false;
+		return true;
+	});
+
+	_tree.clear();
+	_pendingElements.clear();
+	_invalidatedMeshes.clear();
+}
+
+void SpatialIndex::add(Element* e)
+{
+	_pendingElements.push_back(e);
+}
+
+void SpatialIndex::remove(Element* e)
+{
+	/*
+	 * Pending elements from the removed subtree could be destroyed before the next update
+	 */
+	auto i = std::remove_if(_pendingElements.begin(), _pendingElements.end(), [e](Element* pending)
+	{
+		for (Element* p = pending; p != nullptr; p = p->parent())
+		{
+			if (p == e)
+				return true;
+		}
+		return false;
+	});
+	_pendingElements.erase(i, _pendingElements.end());
+
+	removeSubtree(e);
+}
+
+void SpatialIndex::invalidate(SupportMesh* mesh)
+{
+	ET_ASSERT(mesh->_spatialIndex == this);
+
+	if (!mesh->_spatialProxyInvalidated)
+	{
+		mesh->_spatialProxyInvalidated = true;
+		_invalidatedMeshes.push_back(mesh);
+	}
+}
+
+void SpatialIndex::update()
+{
+	if (!_pendingElements.empty())
+	{
+		std::vector<Element*> pending;
+		pending.swap(_pendingElements);
+		
+		for (Element* e : pending)
+			addSubtree(e);
+	}
+
+	for (SupportMesh* mesh : _invalidatedMeshes)
+	{
+		ET_ASSERT(mesh->_spatialIndex == this);
+		_tree.update(mesh->_spatialProxy, mesh->aabb());
+		mesh->_spatialProxyInvalidated = false;
+	}
+	_invalidatedMeshes.clear();
+}
+
+void SpatialIndex::addSubtree(Element* e)
+{
+	if (e->isKindOf(ElementType_SupportMesh))
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(e);
+		if (mesh->_spatialIndex == nullptr)
+		{
+			mesh->_spatialIndex = this;
+			mesh->_spatialProxy = _tree.insert(mesh->aabb(), mesh);
+		}
+		ET_ASSERT(mesh->_spatialIndex == this);
+	}
+
+	for (auto& c : e->children())
+		addSubtree(c.ptr());
+}
+
+void SpatialIndex::removeSubtree(Element* e)
+{
+	if (e->isKindOf(ElementType_SupportMesh))
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(e);
+		if (mesh->_spatialIndex == this)
+			removeMesh(mesh);
+	}
+
+	for (auto& c : e->children())
+		removeSubtree(c.ptr());
+}
+
+void SpatialIndex::removeMesh(SupportMesh* mesh)
+{
+	if (mesh->_spatialProxyInvalidated)
+	{
+		auto i = std::find(_invalidatedMeshes.begin(), _invalidatedMeshes.end(), mesh);
+		ET_ASSERT(i != _invalidatedMeshes.end());
+		_invalidatedMeshes.erase(i);
+	}
+
+	_tree.remove(mesh->_spatialProxy);
+
+	mesh->_spatialIndex = nullptr;
+	mesh->_spatialProxy = AABBTree::InvalidIndex;
+	mesh->_spatialProxyInvalidated = false;
+}
+
+size_t SpatialIndex::queryFrustum(const Frustum& frustum, QueryResult& result)
+{
+	update();
+	result.clear();
+
+	_tree.query([&frustum](const vec3& minVertex, const vec3& maxVertex)
+		{ return frustum.containsBox(minVertex, maxVertex); },
+		[&frustum, &result](uint32_t, void* userData)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(userData);
+		if (frustum.containsAABB(mesh->aabb()))
+			result.push_back(mesh);
+		return true;
+	});
+
+	return result.size();
+}
+
+size_t SpatialIndex::queryAABB(const AABB& box, QueryResult& result)
+{
+	update();
+	result.clear();
+
+	vec3 boxMin = box.minVertex();
+	vec3 boxMax = box.maxVertex();
+	_tree.query([boxMin, boxMax](const vec3& minVertex, const vec3& maxVertex)
+		{ return boxesOverlap(minVertex, maxVertex, boxMin, boxMax); },
+		[boxMin, boxMax, &result](uint32_t, void* userData)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(userData);
+		const AABB& meshBox = mesh->aabb();
+		if (boxesOverlap(meshBox.minVertex(), meshBox.maxVertex(), boxMin, boxMax))
+			result.push_back(mesh);
+		return true;
+	});
+
+	return result.size();
+}
+
+size_t SpatialIndex::querySphere(const Sphere& sphere, QueryResult& result)
+{
+	update();
+	result.clear();
+
+	vec3 center = sphere.center();
+	float radius = sphere.radius();
+	_tree.query([center, radius](const vec3& minVertex, const vec3& maxVertex)
+		{ return sphereOverlapsBox(center, radius, minVertex, maxVertex); },
+		[center, radius, &result](uint32_t, void* userData)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(userData);
+		const AABB& meshBox = mesh->aabb();
+		if (sphereOverlapsBox(center, radius, meshBox.minVertex(), meshBox.maxVertex()))
+			result.push_back(mesh);
+		return true;
+	});
+
+	return result.size();
+}
+
+size_t SpatialIndex::queryRay(const ray3d& r, QueryResult& result, float maxDistance)
+{
+	update();
+	result.clear();
+
+	RayContext ray(r, maxDistance);
+	_tree.query([&ray](const vec3& minVertex, const vec3& maxVertex)
+		{ return ray.hits(minVertex, maxVertex); },
+		[&ray, &result](uint32_t, void* userData)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(userData);
+		const AABB& meshBox = mesh->aabb();
+		if (ray.hits(meshBox.minVertex(), meshBox.maxVertex()))
+			result.push_back(mesh);
+		return true;
+	});
+
+	return result.size();
+}
@@ -6,7 +6,7 @@
  */
 
 #include <et/primitives/primitives.h>
-#include <et/scene3d/supportmesh.h>
+#include <et/scene3d/spatialindex.h>
 
 using namespace et;
 using namespace et::s3d;
@@ -20,6 +20,12 @@ SupportMesh::SupportMesh(const std::string& name, const VertexArrayObject& ib, c
 {
 }
 
+SupportMesh::~SupportMesh()
+{
+	if (_spatialIndex != nullptr)
+		_spatialIndex->removeMesh(this);
+}
+
 void SupportMesh::setNumIndexes(size_t num)
 {
 	Mesh::setNumIndexes(num);
@@ -34,7 +40,6 @@ void SupportMesh::fillCollisionData(const VertexArray::Pointer& vertexArray, con
 	
 	vec3 minOffset;
 	vec3 maxOffset;
-	float distance = 0.0f;
 	uint32_t iStart = startIndex() / 3;
 	uint32_t iEnd = iStart + static_cast<uint32_t>(numIndexes()) / 3;
 	
@@ -54,7 +59,6 @@ void SupportMesh::fillCollisionData(const VertexArray::Pointer& vertexArray, con
 		{
 			minOffset = minv(p0, minv(p1, p2));
 			maxOffset = maxv(p0, maxv(p1, p2));
-			distance = etMax(p0.length(), etMax(p1.length(), p2.length()));
 			++index;
 		}
 		else
@@ -65,13 +69,25 @@ void SupportMesh::fillCollisionData(const VertexArray::Pointer& vertexArray, con
 			maxOffset = maxv(maxOffset, p0);
 			maxOffset = maxv(maxOffset, p1);
 			maxOffset = maxv(maxOffset, p2);
-			distance = etMax(p0.length(), etMax(p1.length(), p2.length()));
 		}
 	}
 	
 	_size = maxv(maxOffset - minOffset, vec3(std::numeric_limits<float>::epsilon()));
 	_center = 0.5f * (maxOffset + minOffset);
-	_radius = distance;
+
+	/*
+	 * Bounding sphere is centered at the bounding box center, it is used for the level of details selection
+	 */
+	_radius = 0.0f;
+	for (size_t i = 0, e = _data.lastElementIndex(); i < e; ++i)
+	{
+		const triangle& t = _data[i];
+		_radius = etMax(_radius, (t.v1() - _center).length());
+		_radius = etMax(_radius, (t.v2() - _center).length());
+		_radius = etMax(_radius, (t.v3() - _center).length());
+	}
+
+	_bvh.build(_data.data(), _data.lastElementIndex());
 }
 
 SupportMesh* SupportMesh::duplicate()
@@ -86,6 +102,7 @@ SupportMesh* SupportMesh::duplicate()
 	result->_center = _center;
 	result->_radius = _radius;
 	result->_data = _data;
+	result->_bvh = _bvh;
 	
 	return result;
 }
@@ -100,6 +117,12 @@ Sphere SupportMesh::sphere()
 	return Sphere(finalTransform() * _center, finalTransformScale() * _radius);
 }
 
+void SupportMesh::selectLod(const Camera& camera)
+{
+	Sphere s = sphere();
+	Mesh::selectLod(screenCoverage(camera, s.center(), s.radius()));
+}
+
 const AABB& SupportMesh::aabb()
 {
 	if (_shouldBuildAABB)
@@ -127,6 +150,10 @@ void SupportMesh::serialize(std::ostream& stream, SceneVersion version)
 	serializeVector(stream, _center);
 	serializeInt(stream, _data.size());
 	stream.write(_data.binary(), static_cast<std::streamsize>(_data.dataSize()));
+
+	if (version >= SceneVersion_1_0_5)
+		_bvh.serialize(stream);
+
 	Mesh::serialize(stream, version);
 }
 
@@ -151,10 +178,18 @@ void SupportMesh::deserialize(std::istream& stream, ElementFactory* factory, Sce
 		stream.read(_data.binary(), static_cast<std::streamsize>(_data.dataSize()));
 	}
 
+	if (version >= SceneVersion_1_0_5)
+		_bvh.deserialize(stream);
+	else
+		_bvh.build(_data.data(), _data.size());
+
 	Mesh::deserialize(stream, factory, version);
 }
 
 void SupportMesh::transformInvalidated()
 {
 	_shouldBuildAABB = true;
+
+	if (_spatialIndex != nullptr)
+		_spatialIndex->invalidate(this);
 }
@@ -5,7 +5,9 @@
  *
  */
 
+#include <deque>
 #include <et/app/application.h>
+#include <et/threading/criticalsection.h>
 #include <et/sound/sound.h>
 
 namespace et
@@ -18,6 +20,20 @@ namespace et
 			ALuint source = 0;
 			bool playingLooped = false;
 			int buffersProcessed = 0;
+			
+			/*
+			 * Samples in each of the buffers queued to the streamed source, in the order of queueing
+			 */
+			CriticalSection queueLock;
+			std::deque<ALint> queuedSamples;
+			uint64_t underruns = 0;
+			float queueLatency = 0.0f;
+			
+			/*
+			 * Set by stop under queueLock, so streaming thread does not treat
+			 * source stopped by user as underrun and does not restart it
+			 */
+			bool stopped = true;
 		};
     }
 }
@@ -28,6 +44,20 @@ using namespace et::audio;
 extern ALCdevice* getSharedDevice();
 extern ALCcontext* getSharedContext();
 
+static ALint samplesInBuffer(ALuint buffer)
+{
+	ALint size = 0;
+	ALint channels = 0;
+	ALint bits = 0;
+	alGetBufferi(buffer, AL_SIZE, &size);
+	alGetBufferi(buffer, AL_CHANNELS, &channels);
+	alGetBufferi(buffer, AL_BITS, &bits);
+	checkOpenALError("alGetBufferi(%u, ...)", buffer);
+	
+	ALint sampleSize = channels * bits / 8;
+	return (sampleSize > 0) ? (size / sampleSize) : 0;
+}
+
 Player::Player() :
 	_volumeAnimator(currentTimerPool())
 {
@@ -85,11 +115,20 @@ void Player::play(bool looped)
 	}
 	else if (state == AL_PAUSED)
 	{
+		{
+			CriticalSectionScope lock(_private->queueLock);
+			_private->stopped = false;
+		}
+		
 		alSourcePlay(_private->source);
 		checkOpenALError("alSourcePlay");
+		
+		manager().streamingThread().addPlayer(Player::Pointer(this));
 	}
 	else if ((state == AL_INITIAL) || (state == AL_STOPPED))
 	{
+		CriticalSectionScope lock(_private->queueLock);
+		
 		int queued = 0;
 		alGetSourcei(_private->source, AL_BUFFERS_QUEUED, &queued);
 		while (queued--)
@@ -101,6 +140,7 @@ void Player::play(bool looped)
 		alSourcei(_private->source, AL_BUFFER, 0);
 		checkOpenALError("alSourcei(%u, AL_BUFFER, 0)", _private->source);
 		
+		_private->queuedSamples.clear();
 		_private->buffersProcessed = 0;
 		_private->playingLooped = looped;
 		
@@ -110,6 +150,10 @@ void Player::play(bool looped)
 		{
 			alSourceQueueBuffers(_private->source, _track->actualBuffersCount(), _track->buffers());
 			checkOpenALError("alSourceQueueBuffers(%u, %d, %u)", _private->source, _track->actualBuffersCount(), _track->buffers());
+			
+			for (int i = 0; i < _track->actualBuffersCount(); ++i)
+				_private->queuedSamples.push_back(samplesInBuffer(_track->buffers()[i]));
+			
 			alSourcei(_private->source, AL_LOOPING, AL_FALSE);
 			checkOpenALError("alSourcei(%u, AL_LOOPING, AL_FALSE)", _private->source);
 		}
@@ -121,6 +165,7 @@ void Player::play(bool looped)
 			checkOpenALError("alSourcei(%u, AL_LOOPING, ...)", _private->source);
 		}
 		
+		_private->stopped = false;
 		alSourcePlay(_private->source);
 		checkOpenALError("alSourcePlay");
 		
@@ -145,11 +190,18 @@ void Player::stop()
 	if (atomicCounterValue() > 0)
 		manager().streamingThread().removePlayer(Player::Pointer(this));
 	
-	alSourceStop(_private->source);
-    checkOpenALError("alSourceStop");
-	
-	alSourcei(_private->source, AL_BUFFER, 0);
-	checkOpenALError("alSourcei(..., AL_BUFFER, 0)");
+	{
+		CriticalSectionScope lock(_private->queueLock);
+		_private->stopped = true;
+		
+		alSourceStop(_private->source);
+		checkOpenALError("alSourceStop");
+		
+		alSourcei(_private->source, AL_BUFFER, 0);
+		checkOpenALError("alSourcei(..., AL_BUFFER, 0)");
+		
+		_private->queuedSamples.clear();
+	}
 	
 	if (_track.valid())
 		_track->rewind();
@@ -216,37 +268,91 @@ unsigned int Player::source() const
 	return _private->source;
 }
 
-void Player::handleProcessedBuffers()
+uint64_t Player::underrunsCount() const
 {
-	int processed = 0;
-	alGetSourcei(_private->source, AL_BUFFERS_PROCESSED, &processed);
-	checkOpenALError("alGetSourcei(%d, AL_BUFFERS_PROCESSED, %d)", _private->source, processed);
+	CriticalSectionScope lock(_private->queueLock);
+	return _private->underruns;
+}
+
+float Player::queueLatency() const
+{
+	CriticalSectionScope lock(_private->queueLock);
+	return _private->queueLatency;
+}
+
+void Player::handleProcessedBuffers(StreamingStatistics& statistics)
+{
+	CriticalSectionScope lock(_private->queueLock);
 	
-	if (processed > 0)
+	/*
+	 * Player could be stopped after streaming thread took it for update
+	 */
+	if (_private->stopped) return;
+	
+	if (unqueueProcessedBuffers() > 0)
 	{
-		_private->buffersProcessed += processed;
-		
-		while (processed--)
-		{
-			ALuint buffer = 0;
-			alSourceUnqueueBuffers(_private->source, 1, &buffer);
-			checkOpenALError("alSourceUnqueueBuffers");
-		}
-		
 		int remaining = 0;
 		alGetSourcei(_private->source, AL_BUFFERS_QUEUED, &remaining);
 		
-		bool shouldLoadNextBuffer = _private->playingLooped ||
-			((_private->buffersProcessed + remaining) < _track->totalBuffersCount());
-		
-		if (shouldLoadNextBuffer)
+		bool underrun = false;
+		while ((remaining < _track->actualBuffersCount()) && (_private->playingLooped ||
+			((_private->buffersProcessed + remaining) < _track->totalBuffersCount())))
 		{
+			if (_track->decodedBuffersCount() == 0)
+				++statistics.decodeMisses;
+			
 			ALuint buffer = _track->loadNextBuffer();
-			if (buffer > 0)
+			if (buffer == 0) break;
+			
+			/*
+			 * Streamed source stops when all queued buffers are played before the next one
+			 * is queued, buffers played meanwhile should not be played again after restart
+			 */
+			if (!underrun)
+			{
+				ALint state = 0;
+				alGetSourcei(_private->source, AL_SOURCE_STATE, &state);
+				checkOpenALError("alGetSourcei(%u, AL_SOURCE_STATE, ...)", _private->source);
+				
+				if (state == AL_STOPPED)
+				{
+					underrun = true;
+					++_private->underruns;
+					++statistics.underruns;
+					
+					unqueueProcessedBuffers();
+					alGetSourcei(_private->source, AL_BUFFERS_QUEUED, &remaining);
+				}
+			}
+			
+			int sampleOffset = 0;
+			if (!underrun)
 			{
-				alSourceQueueBuffers(_private->source, 1, &buffer);
-				checkOpenALError("alSourceQueueBuffers");
+				alGetSourcei(_private->source, AL_SAMPLE_OFFSET, &sampleOffset);
+				checkOpenALError("alGetSourcei(%u, AL_SAMPLE_OFFSET, ...)", _private->source);
 			}
+			
+			ALint samplesAhead = -sampleOffset;
+			for (auto samples : _private->queuedSamples)
+				samplesAhead += samples;
+			
+			_private->queueLatency = static_cast<float>(etMax(0, samplesAhead)) /
+				static_cast<float>(_track->sampleRate());
+			
+			alSourceQueueBuffers(_private->source, 1, &buffer);
+			checkOpenALError("alSourceQueueBuffers");
+			_private->queuedSamples.push_back(samplesInBuffer(buffer));
+			++remaining;
+			
+			++statistics.buffersQueued;
+			statistics.totalQueueLatency += _private->queueLatency;
+			statistics.maximumQueueLatency = etMax(statistics.maximumQueueLatency, _private->queueLatency);
+		}
+		
+		if (underrun)
+		{
+			alSourcePlay(_private->source);
+			checkOpenALError("alSourcePlay");
 		}
 		else if (remaining == 0)
 		{
@@ -256,6 +362,27 @@ void Player::handleProcessedBuffers()
 	}
 }
 
+int Player::unqueueProcessedBuffers()
+{
+	int processed = 0;
+	alGetSourcei(_private->source, AL_BUFFERS_PROCESSED, &processed);
+	checkOpenALError("alGetSourcei(%d, AL_BUFFERS_PROCESSED, %d)", _private->source, processed);
+	
+	_private->buffersProcessed += processed;
+	
+	for (int i = 0; i < processed; ++i)
+	{
+		ALuint buffer = 0;
+		alSourceUnqueueBuffers(_private->source, 1, &buffer);
+		checkOpenALError("alSourceUnqueueBuffers");
+		
+		if (!_private->queuedSamples.empty())
+			_private->queuedSamples.pop_front();
+	}
+	
+	return processed;
+}
+
 void Player::setActualVolume(float v)
 {
 	alSourcef(_private->source, AL_GAIN, clamp(v, 0.0f, 1.0f));
@@ -276,3 +403,22 @@ void Player::handleProcessedSamples()
 		finished.invokeInMainRunLoop(this);
 	}
 }
+
+float Player::nextUpdateInterval() const
+{
+	if (_track.invalid() || !playing())
+		return std::numeric_limits<float>::max();
+	
+	int sampleOffset = 0;
+	alGetSourcei(_private->source, AL_SAMPLE_OFFSET, &sampleOffset);
+	checkOpenALError("alGetSourcei(%d, AL_SAMPLE_OFFSET, %d)", _private->source, sampleOffset);
+	
+	ALint samplesToPlay = static_cast<ALint>(_track->samples());
+	if (_track->streamed())
+	{
+		CriticalSectionScope lock(_private->queueLock);
+		samplesToPlay = _private->queuedSamples.empty() ? 0 : _private->queuedSamples.front();
+	}
+	
+	return static_cast<float>(samplesToPlay - sampleOffset) / static_cast<float>(_track->sampleRate());
+}
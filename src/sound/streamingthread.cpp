@@ -6,6 +6,7 @@
  */
 
 #include <et/core/et.h>
+#include <et/core/profiler.h>
 #include <et/threading/criticalsection.h>
 #include <et/sound/sound.h>
 
@@ -21,6 +22,8 @@ namespace et
 			std::list<Player::Pointer> playersList;
 			std::list<Player::Pointer> playersToAdd;
 			std::list<Player::Pointer> playersToRemove;
+			
+			StreamingStatistics statistics;
 		};
 	}
 }
@@ -42,8 +45,15 @@ void StreamingThread::release()
 
 ThreadResult StreamingThread::main()
 {
+	ET_PROFILE_THREAD("Audio streaming");
+	
 	while (running())
 	{
+		ET_PROFILE_SCOPE("StreamingThread::update");
+		
+		StreamingStatistics updateStatistics;
+		updateStatistics.wakeUps = 1;
+		
 		{
 			CriticalSectionScope scope(_private->csLock);
 
@@ -57,15 +67,44 @@ ThreadResult StreamingThread::main()
 			_private->playersToRemove.clear();
 		}
 
+		float nextUpdateInterval = 0.001f * static_cast<float>(MaximumWaitInterval);
 		for (auto player : _private->playersList)
 		{
 			if (player->track().valid() && player->track()->streamed())
-				player->handleProcessedBuffers();
+				player->handleProcessedBuffers(updateStatistics);
 			
 			player->handleProcessedSamples();
+			nextUpdateInterval = etMin(nextUpdateInterval, player->nextUpdateInterval());
+		}
+		
+		/*
+		 * Buffers are refilled from already decoded data, decoding of the next ones
+		 * goes after all players were served, one buffer per track at a time
+		 */
+		bool decodingPending = false;
+		for (auto player : _private->playersList)
+		{
+			if (player->track().valid() && player->track()->streamed())
+				decodingPending |= player->track()->decodeAhead();
+		}
+		
+		{
+			CriticalSectionScope scope(_private->csLock);
+			
+			auto& s = _private->statistics;
+			s.underruns += updateStatistics.underruns;
+			s.decodeMisses += updateStatistics.decodeMisses;
+			s.buffersQueued += updateStatistics.buffersQueued;
+			s.wakeUps += updateStatistics.wakeUps;
+			s.totalQueueLatency += updateStatistics.totalQueueLatency;
+			s.maximumQueueLatency = etMax(s.maximumQueueLatency, updateStatistics.maximumQueueLatency);
 		}
 		
-		sleepMSec(50);
+		if (!decodingPending)
+		{
+			uint64_t waitInterval = static_cast<uint64_t>(1000.0f * etMax(0.0f, nextUpdateInterval));
+			suspend(clamp(waitInterval, MinimumWaitInterval, MaximumWaitInterval));
+		}
 	}
 
 	CriticalSectionScope scope(_private->csLock);
@@ -93,6 +132,8 @@ void StreamingThread::addPlayer(Player::Pointer player)
 		if (i != _private->playersToRemove.end())
 			_private->playersToRemove.erase(i);
 	}
+	
+	resume();
 }
 
 void StreamingThread::removePlayer(Player::Pointer player)
@@ -112,4 +153,18 @@ void StreamingThread::removePlayer(Player::Pointer player)
 		if (i != _private->playersToAdd.end())
 			_private->playersToAdd.erase(i);
 	}
-};
+	
+	resume();
+}
+
+StreamingStatistics StreamingThread::statistics() const
+{
+	CriticalSectionScope scope(_private->csLock);
+	return _private->statistics;
+}
+
+void StreamingThread::resetStatistics()
+{
+	CriticalSectionScope scope(_private->csLock);
+	_private->statistics = StreamingStatistics();
+}
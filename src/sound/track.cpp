@@ -9,14 +9,16 @@
 #include <external/vorbis/vorbisfile.h>
 
 #include <et/core/containers.h>
+#include <et/threading/criticalsection.h>
 #include <et/sound/sound.h>
 
 namespace et
 {
     namespace audio
     {
-		const int BuffersCount = 3;
-		const int BufferDuration = 4;
+		const int BuffersCount = 4;
+		const int BufferDuration = 1;
+		const int DecodeAheadBuffers = 2;
 		
         class TrackPrivate
         {
@@ -32,8 +34,9 @@ namespace et
 			void rewindOGG();
 			
 			bool fillNextBuffer();
-			bool fillNextPCMBuffer();
-			bool fillNextOGGBuffer();
+			bool decodeNextChunk();
+			size_t decodePCM(BinaryDataStorage&);
+			size_t decodeOGG(BinaryDataStorage&);
 			
 			enum SourceFormat
 			{
@@ -72,6 +75,16 @@ namespace et
 			ov_callbacks oggCallbacks;
 			size_t oggStartPosition = 0;
 			
+			/*
+			 * Ring of chunks decoded ahead of uploading into the buffers,
+			 * guarded by decodeLock together with the source stream
+			 */
+			CriticalSection decodeLock;
+			BinaryDataStorage decodedChunks[DecodeAheadBuffers];
+			size_t decodedSizes[DecodeAheadBuffers] = { };
+			int decodedReadIndex = 0;
+			int decodedCount = 0;
+			
 			SourceFormat sourceFormat = SourceFormat_Undefined;
         };
     }
@@ -178,18 +191,40 @@ bool Track::streamed() const
 
 unsigned int Track::loadNextBuffer()
 {
+	CriticalSectionScope lock(_private->decodeLock);
+	
 	int bufferToLoad = _private->bufferIndex;
 	return _private->fillNextBuffer() ? _private->buffers[bufferToLoad] : 0;
 }
 
+bool Track::decodeAhead()
+{
+	CriticalSectionScope lock(_private->decodeLock);
+	
+	if (_private->decodedCount == DecodeAheadBuffers)
+		return false;
+	
+	return _private->decodeNextChunk() && (_private->decodedCount < DecodeAheadBuffers);
+}
+
+size_t Track::decodedBuffersCount() const
+{
+	CriticalSectionScope lock(_private->decodeLock);
+	return static_cast<size_t>(_private->decodedCount);
+}
+
 void Track::rewind()
 {
+	CriticalSectionScope lock(_private->decodeLock);
+	
 	_private->bufferIndex = 0;
 	_private->rewind();
 }
 
 void Track::preloadBuffers()
 {
+	CriticalSectionScope lock(_private->decodeLock);
+	
 	for (int i = 0; i < _private->buffersCount; ++i)
 		_private->fillNextBuffer();
 }
@@ -287,19 +322,69 @@ TrackPrivate::~TrackPrivate()
 
 bool TrackPrivate::fillNextBuffer()
 {
+	if (decodedCount == 0)
+		decodeNextChunk();
+	
+	if (decodedCount == 0)
+		return false;
+	
+	BinaryDataStorage& chunk = decodedChunks[decodedReadIndex];
+	
+	alBufferData(buffers[bufferIndex], static_cast<ALenum>(format), chunk.data(),
+		static_cast<ALsizei>(decodedSizes[decodedReadIndex]), sampleRate);
+	checkOpenALError("alBufferData");
+	
+	/*
+	 * Non-streamed track is uploaded once, there is no need to keep decoded data
+	 */
+	if (buffersCount == 1)
+		chunk = BinaryDataStorage();
+	
+	decodedReadIndex = (decodedReadIndex + 1) % DecodeAheadBuffers;
+	--decodedCount;
+	
+	bufferIndex = (bufferIndex + 1) % buffersCount;
+	return true;
+}
+
+bool TrackPrivate::decodeNextChunk()
+{
+	ET_ASSERT(decodedCount < DecodeAheadBuffers);
+	
+	int chunkIndex = (decodedReadIndex + decodedCount) % DecodeAheadBuffers;
+	BinaryDataStorage& chunk = decodedChunks[chunkIndex];
+	
+	if (chunk.size() < pcmBufferSize)
+		chunk.resize(pcmBufferSize);
+	
+	size_t bytesDecoded = 0;
 	switch (sourceFormat)
 	{
 		case SourceFormat_PCM:
-			return fillNextPCMBuffer();
+			bytesDecoded = decodePCM(chunk);
+			break;
+			
 		case SourceFormat_OGG:
-			return fillNextOGGBuffer();
+			bytesDecoded = decodeOGG(chunk);
+			break;
+			
 		default:
-			return false;
+			break;
 	}
+	
+	if (bytesDecoded == 0)
+		return false;
+	
+	decodedSizes[chunkIndex] = bytesDecoded;
+	++decodedCount;
+	return true;
 }
 
 void TrackPrivate::rewind()
 {
+	decodedReadIndex = 0;
+	decodedCount = 0;
+	
 	switch (sourceFormat)
 	{
 		case SourceFormat_PCM:
@@ -375,7 +460,7 @@ void TrackPrivate::loadWAVE()
 	pcmDataSize = numSamples * sampleSize;
 	pcmStartPosition = static_cast<size_t>(inStream.tellg());
 	pcmReadOffset = 0;
-	totalBuffers = static_cast<int>(1 + pcmDataSize / pcmBufferSize);
+	totalBuffers = static_cast<int>((pcmDataSize + pcmBufferSize - 1) / pcmBufferSize);
 	buffersCount = etMin(BuffersCount, totalBuffers);
 	alGenBuffers(buffersCount, buffers);
 	checkOpenALError("alGenBuffers(%d, ...)", buffersCount);
@@ -391,27 +476,18 @@ void TrackPrivate::rewindPCM()
 	pcmReadOffset = 0;
 }
 
-bool TrackPrivate::fillNextPCMBuffer()
+size_t TrackPrivate::decodePCM(BinaryDataStorage& data)
 {
-	checkOpenALError("fillNextPCMBuffer");
-	
-	BinaryDataStorage data(pcmBufferSize, 0);
 	auto& inStream = stream->stream();
 	inStream.read(data.binary(), etMin(pcmBufferSize, pcmDataSize - pcmReadOffset));
-	pcmReadOffset += static_cast<size_t>(inStream.gcount());
 	
-	ALsizei bytesRead = static_cast<ALsizei>(inStream.gcount());
-	if (bytesRead > 0)
-	{
-		alBufferData(buffers[bufferIndex], static_cast<ALenum>(format), data.data(), bytesRead, sampleRate);
-		checkOpenALError("alBufferData");
-		bufferIndex = (bufferIndex + 1) % buffersCount;
-	}
+	size_t bytesRead = static_cast<size_t>(inStream.gcount());
+	pcmReadOffset += bytesRead;
 	
 	if ((pcmReadOffset >= pcmDataSize) || inStream.eof())
 		rewindPCM();
 	
-	return (bytesRead > 0);
+	return bytesRead;
 }
 
 /*
@@ -454,7 +530,7 @@ void TrackPrivate::loadOGG()
 	oggStartPosition = static_cast<size_t>(ov_raw_tell(&oggFile));
 	pcmReadOffset = 0;
 	duration = static_cast<float>(pcmDataSize) / static_cast<float>(oneSecondSize);
-	totalBuffers = static_cast<int>(1 + pcmDataSize / pcmBufferSize);
+	totalBuffers = static_cast<int>((pcmDataSize + pcmBufferSize - 1) / pcmBufferSize);
 	buffersCount = etMin(BuffersCount, totalBuffers);
 	alGenBuffers(buffersCount, buffers);
 	checkOpenALError("alGenBuffers(%d, ...)", buffersCount);
@@ -462,12 +538,11 @@ void TrackPrivate::loadOGG()
 	sourceFormat = SourceFormat_OGG;
 }
 
-bool TrackPrivate::fillNextOGGBuffer()
+size_t TrackPrivate::decodeOGG(BinaryDataStorage& data)
 {
 	if (stream.invalid())
-		return false;
+		return 0;
 	
-	BinaryDataStorage data(pcmBufferSize, 0);
 	auto& inStream = stream->stream();
 	
 	size_t bytesRead = 0;
@@ -492,19 +567,11 @@ bool TrackPrivate::fillNextOGGBuffer()
 	}
 		
 	pcmReadOffset += bytesRead;
-	if (bytesRead > 0)
-	{
-		alBufferData(buffers[bufferIndex], static_cast<ALenum>(format), data.data(),
-			static_cast<ALsizei>(bytesRead), sampleRate);
-		checkOpenALError("alBufferData");
-		
-		bufferIndex = (bufferIndex + 1) % buffersCount;
-	}
 	
 	if ((pcmReadOffset >= pcmDataSize) || inStream.eof())
 		rewindOGG();
 	
-	return (bytesRead > 0);
+	return bytesRead;
 }
 
 void TrackPrivate::rewindOGG()
@@ -0,0 +1,327 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/core/profiler.h>
+#include <et/threading/threading.h>
+#include <et/tasks/jobsystem.h>
+
+namespace et
+{
+	class JobWorker : public Thread
+	{
+	public:
+		JobWorker(JobSystem* owner, size_t index) :
+			Thread(false), _owner(owner), _index(index) { }
+
+		ThreadResult main()
+		{
+			ET_PROFILE_THREAD("Job worker " + intToStr(_index));
+			
+			while (running())
+			{
+				if (!_owner->executeNextJob(_index))
+					suspend();
+			}
+			return 0;
+		}
+
+	private:
+		JobSystem* _owner = nullptr;
+		size_t _index = 0;
+	};
+}
+
+using namespace et;
+
+/*
+ * Job
+ */
+Job::Job(Function f) :
+	_function(f)
+{
+	_unresolvedDependencies.retain();
+}
+
+void Job::addContinuation(Job::Pointer job)
+{
+	ET_ASSERT(job.valid() && (job.ptr() != this));
+
+	job->_unresolvedDependencies.retain();
+	{
+		CriticalSectionScope lock(_csContinuations);
+		if (!_completed)
+		{
+			_continuations.push_back(job);
+			return;
+		}
+	}
+
+	if ((job->_unresolvedDependencies.release() == 0) && (job->_owner != nullptr))
+		job->_owner->schedule(job);
+}
+
+void Job::execute()
+{
+	if (_function)
+		_function();
+
+	JobList continuations;
+	{
+		CriticalSectionScope lock(_csContinuations);
+		continuations.swap(_continuations);
+		_completed = true;
+	}
+
+	for (auto& c : continuations)
+	{
+		if ((c->_unresolvedDependencies.release() == 0) && (c->_owner != nullptr))
+			c->_owner->schedule(c);
+	}
+}
+
+/*
+ * JobSystem
+ */
+JobSystem::JobSystem()
+{
+}
+
+JobSystem::~JobSystem()
+{
+	stop();
+}
+
+void JobSystem::start(size_t workersCount)
+{
+	if (running()) return;
+
+	if (workersCount == 0)
+		workersCount = etMax(size_t(2), Threading::coresCount()) - 1;
+
+	for (size_t i = 0; i < workersCount; ++i)
+		_queues.push_back(sharedObjectFactory().createObject<JobQueue>());
+
+	for (size_t i = 0; i < workersCount; ++i)
+		_workers.push_back(sharedObjectFactory().createObject<JobWorker>(this, i));
+
+	for (auto w : _workers)
+		w->run();
+}
+
+void JobSystem::stop()
+{
+	for (auto w : _workers)
+	{
+		w->stop();
+		w->waitForTermination();
+		sharedObjectFactory().deleteObject(w);
+	}
+	_workers.clear();
+
+	/*
+	 * Jobs left in the queues (and continuations scheduled by them) are executed
+	 * by the calling thread, so submitted tasks are deleted and waiting on them completes
+	 */
+	while (executeNextJob(_queues.size())) { }
+
+	for (auto q : _queues)
+		sharedObjectFactory().deleteObject(q);
+	_queues.clear();
+}
+
+bool JobSystem::isWorkerThread() const
+{
+	return currentWorkerIndex() < _workers.size();
+}
+
+size_t JobSystem::currentWorkerIndex() const
+{
+	auto currentThread = Threading::currentThread();
+	for (size_t i = 0, e = _workers.size(); i < e; ++i)
+	{
+		if (_workers.at(i)->id() == currentThread)
+			return i;
+	}
+	return _workers.size();
+}
+
+Job::Pointer JobSystem::createJob(Job::Function f)
+{
+	auto result = Job::Pointer::create(f);
+	result->_owner = this;
+	return result;
+}
+
+void JobSystem::addDependency(Job::Pointer job, Job::Pointer dependsOn)
+{
+	ET_ASSERT(job.valid() && dependsOn.valid());
+
+	if (job->_owner == nullptr)
+		job->_owner = this;
+
+	dependsOn->addContinuation(job);
+}
+
+void JobSystem::submit(Job::Pointer job)
+{
+	ET_ASSERT(job.valid());
+
+	if (job->_owner == nullptr)
+		job->_owner = this;
+
+	if (job->_unresolvedDependencies.release() == 0)
+		schedule(job);
+}
+
+Job::Pointer JobSystem::submit(Job::Function f)
+{
+	auto result = createJob(f);
+	submit(result);
+	return result;
+}
+
+Job::Pointer JobSystem::submit(Task* task)
+{
+	ET_ASSERT(task != nullptr);
+
+	return submit([task]()
+	{
+		task->execute();
+		sharedObjectFactory().deleteObject(task);
+	});
+}
+
+void JobSystem::schedule(Job::Pointer job)
+{
+	if (_queues.empty())
+	{
+		job->execute();
+		return;
+	}
+
+	size_t queueIndex = currentWorkerIndex();
+	if (queueIndex >= _queues.size())
+		queueIndex = static_cast<size_t>(_submitCounter.retain()) % _queues.size();
+
+	auto queue = _queues.at(queueIndex);
+	{
+		CriticalSectionScope lock(queue->lock);
+		queue->jobs.push_back(job);
+	}
+
+	wakeWorker(queueIndex);
+}
+
+void JobSystem::wakeWorker(size_t preferred)
+{
+	if (_workers.empty()) return;
+
+	for (auto w : _workers)
+	{
+		if (w->suspended())
+		{
+			w->resume();
+			return;
+		}
+	}
+
+	/*
+	 * All workers are busy or just about to suspend,
+	 * preferred one will not fall asleep and will pick the job
+	 */
+	_workers.at(preferred)->resume();
+}
+
+Job::Pointer JobSystem::takeJob(size_t preferredQueue)
+{
+	size_t queuesCount = _queues.size();
+
+	if (preferredQueue < queuesCount)
+	{
+		auto own = _queues.at(preferredQueue);
+		CriticalSectionScope lock(own->lock);
+		if (!own->jobs.empty())
+		{
+			auto result = own->jobs.back();
+			own->jobs.pop_back();
+			return result;
+		}
+	}
+	else
+	{
+		preferredQueue = static_cast<size_t>(_submitCounter.atomicCounterValue());
+	}
+
+	for (size_t i = 1; i <= queuesCount; ++i)
+	{
+		auto victim = _queues.at((preferredQueue + i) % queuesCount);
+		CriticalSectionScope lock(victim->lock);
+		if (!victim->jobs.empty())
+		{
+			auto result = victim->jobs.front();
+			victim->jobs.pop_front();
+			return result;
+		}
+	}
+
+	return Job::Pointer();
+}
+
+bool JobSystem::executeNextJob(size_t preferredQueue)
+{
+	auto job = takeJob(preferredQueue);
+	if (job.invalid())
+		return false;
+
+	ET_PROFILE_SCOPE("Job::execute");
+	job->execute();
+	return true;
+}
+
+void JobSystem::wait(Job::Pointer job)
+{
+	ET_ASSERT(job.valid());
+
+	size_t ownQueue = currentWorkerIndex();
+	while (!job->completed())
+	{
+		if (!executeNextJob(ownQueue))
+			Thread::sleepMSec(0);
+	}
+}
+
+void JobSystem::wait(const JobList& jobs)
+{
+	for (const auto& job : jobs)
+		wait(job);
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t minimumRange, RangeFunction func)
+{
+	if (end <= begin) return;
+
+	size_t count = end - begin;
+	size_t maximumJobs = 4 * (_workers.size() + 1);
+	size_t range = etMax(etMax(minimumRange, size_t(1)), (count + maximumJobs - 1) / maximumJobs);
+
+	if (!running() || (range >= count))
+	{
+		func(begin, end);
+		return;
+	}
+
+	JobList jobs;
+	jobs.reserve(count / range + 1);
+	for (size_t i = begin + range; i < end; i += range)
+	{
+		size_t rangeEnd = etMin(end, i + range);
+		jobs.push_back(submit([func, i, rangeEnd]() { func(i, rangeEnd); }));
+	}
+
+	func(begin, begin + range);
+	wait(jobs);
+}
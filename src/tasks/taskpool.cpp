@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/tasks/taskpool.h>
 
 using namespace et;
@@ -35,6 +36,8 @@ void TaskPool::addTask(Task* t, float delay)
 
 void TaskPool::update(float currentTime)
 {
+	ET_PROFILE_SCOPE("TaskPool::update");
+	
 	joinTasks();
 	
 	_lastTime = currentTime;
@@ -5,6 +5,7 @@
  *
  */
 
+#include <et/core/profiler.h>
 #include <et/app/application.h>
 #include <et/timers/timerpool.h>
 #include <et/timers/timedobject.h>
@@ -68,6 +69,8 @@ void TimerPool::detachTimedObject(TimedObject* obj)
 
 void TimerPool::update(float t)
 {
+	ET_PROFILE_SCOPE("TimerPool::update");
+	
 	CriticalSectionScope lock(_lock);
 
 	if (_queue.size() > 0)
@@ -36,6 +36,14 @@ IndexArray::IndexArray(IndexArrayFormat format, size_t size, PrimitiveType conte
 		linearize(size);
 }
 
+IndexArray::IndexArray(IndexArrayFormat format, PrimitiveType content, size_t actualSize,
+	MappedFile::Pointer file, size_t fileOffset, size_t dataSize) : tag(0),
+	_data(reinterpret_cast<unsigned char*>(file->data() + fileOffset), dataSize), _mappedFile(file),
+	_actualSize(actualSize), _format(format), _primitiveType(content)
+{
+	ET_ASSERT(fileOffset + dataSize <= file->size());
+}
+
 void IndexArray::linearize(size_t indexFrom, size_t indexTo, uint32_t startIndex)
 {
 	for (size_t i = indexFrom; i < indexTo; ++i)
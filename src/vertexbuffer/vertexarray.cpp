@@ -38,6 +38,12 @@ VertexArray::VertexArray(const VertexDeclaration& decl, int size) : tag(0), _dec
 	}
 }
 
+VertexArray::VertexArray(const VertexDeclaration& decl, size_t size, const VertexDataChunkList& chunks,
+	const VertexDataChunk& smoothing) : tag(0), _size(size), _decl(decl), _chunks(chunks), _smoothing(smoothing)
+{
+	ET_ASSERT(_decl.numElements() == _chunks.size());
+}
+
 VertexArray::Description VertexArray::generateDescription() const
 {
 	uint32_t dataSize = 0;
@@ -24,6 +24,16 @@ VertexDataChunkData::VertexDataChunkData(VertexAttributeUsage aUsage, VertexAttr
 	_data.fill(0);
 }
 
+VertexDataChunkData::VertexDataChunkData(VertexAttributeUsage aUsage, VertexAttributeType aType,
+	MappedFile::Pointer file, size_t fileOffset, size_t dataSize, size_t offset) : _usage(aUsage), _type(aType),
+	_data(reinterpret_cast<unsigned char*>(file->data() + fileOffset), dataSize), _mappedFile(file)
+{
+	ET_ASSERT(_type < VertexAttributeType::max);
+	ET_ASSERT(fileOffset + dataSize <= file->size());
+	
+	_data.setOffset(offset);
+}
+
 VertexDataChunkData::VertexDataChunkData(std::istream& stream)
 {
 	_usage = static_cast<VertexAttributeUsage>(deserializeInt(stream));
@@ -0,0 +1,254 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/json/json.h>
+#include <et/locale/locale.h>
+#include <et/threading/threading.h>
+#include "benchmark.h"
+
+using namespace et;
+using namespace et::benchmark;
+
+namespace
+{
+	struct RegisteredBenchmark
+	{
+		std::string name;
+		Function function = nullptr;
+	};
+
+	struct Result
+	{
+		std::string name;
+		std::string skipReason;
+		std::vector<double> samples;
+		size_t iterations = 0;
+		size_t itemsProcessed = 0;
+		size_t bytesProcessed = 0;
+		double mean = 0.0;
+		double median = 0.0;
+		double minimum = 0.0;
+		double deviation = 0.0;
+	};
+
+	std::vector<RegisteredBenchmark>& registeredBenchmarks()
+	{
+		static std::vector<RegisteredBenchmark> benchmarks;
+		return benchmarks;
+	}
+
+	std::string benchmarkDataFolder;
+	RenderContext* benchmarkRenderContext = nullptr;
+}
+
+Registration::Registration(const char* name, Function func)
+{
+	RegisteredBenchmark rb;
+	rb.name = name;
+	rb.function = func;
+	registeredBenchmarks().push_back(rb);
+}
+
+const std::string& benchmark::dataFolder()
+{
+	return benchmarkDataFolder;
+}
+
+RenderContext* benchmark::renderContext()
+{
+	return benchmarkRenderContext;
+}
+
+double runOnce(Function func, size_t iterations, Result& result)
+{
+	State state(iterations);
+	func(state);
+
+	result.skipReason = state.skipReason();
+	result.itemsProcessed = state.itemsProcessed();
+	result.bytesProcessed = state.bytesProcessed();
+
+	return state.elapsedNanoseconds();
+}
+
+void runBenchmark(const RegisteredBenchmark& rb, const Options& options, Result& result)
+{
+	const double minTime = 1.0e+9 * options.minTimeInSeconds;
+	const size_t maxIterations = 1000000000;
+
+	result.name = rb.name;
+
+	/*
+	 * find iterations count which takes at least minimal time
+	 */
+	size_t iterations = 1;
+	for (;;)
+	{
+		double elapsed = runOnce(rb.function, iterations, result);
+
+		if (!result.skipReason.empty())
+			return;
+
+		if ((elapsed >= minTime) || (iterations >= maxIterations))
+			break;
+
+		double multiplier = (elapsed > 0.0) ? 1.4 * minTime / elapsed : 10.0;
+		multiplier = std::min(10.0, std::max(2.0, multiplier));
+		iterations = std::min(maxIterations, static_cast<size_t>(static_cast<double>(iterations) * multiplier));
+	}
+
+	result.iterations = iterations;
+	for (size_t i = 0; i < options.repetitions; ++i)
+		result.samples.push_back(runOnce(rb.function, iterations, result) / static_cast<double>(iterations));
+
+	std::vector<double> sorted = result.samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	result.minimum = sorted.front();
+	result.median = (sorted.size() % 2 == 0) ? 0.5 * (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) :
+		sorted[sorted.size() / 2];
+
+	for (double s : sorted)
+		result.mean += s;
+	result.mean /= static_cast<double>(sorted.size());
+
+	for (double s : sorted)
+		result.deviation += (s - result.mean) * (s - result.mean);
+	result.deviation = std::sqrt(result.deviation / static_cast<double>(sorted.size()));
+}
+
+Dictionary resultToDictionary(const Result& result)
+{
+	Dictionary entry;
+	entry.setStringForKey("name", result.name);
+
+	if (!result.skipReason.empty())
+	{
+		entry.setStringForKey("skipped", result.skipReason);
+		return entry;
+	}
+
+	entry.setIntegerForKey("iterations", static_cast<int64_t>(result.iterations));
+	entry.setIntegerForKey("repetitions", static_cast<int64_t>(result.samples.size()));
+	entry.setFloatForKey("mean_ns", static_cast<float>(result.mean));
+	entry.setFloatForKey("median_ns", static_cast<float>(result.median));
+	entry.setFloatForKey("min_ns", static_cast<float>(result.minimum));
+	entry.setFloatForKey("stddev_ns", static_cast<float>(result.deviation));
+
+	if (result.itemsProcessed > 0)
+		entry.setFloatForKey("items_per_second", static_cast<float>(1.0e+9 * result.itemsProcessed / result.median));
+
+	if (result.bytesProcessed > 0)
+		entry.setFloatForKey("bytes_per_second", static_cast<float>(1.0e+9 * result.bytesProcessed / result.median));
+
+	return entry;
+}
+
+std::map<std::string, double> loadBaseline(const std::string& fileName)
+{
+	std::map<std::string, double> baseline;
+
+	std::string content = loadTextFile(fileName);
+	if (content.empty())
+	{
+		log::error("Unable to load baseline file: %s", fileName.c_str());
+		return baseline;
+	}
+
+	ValueClass vc = ValueClass_Invalid;
+	auto root = json::deserialize(content, vc);
+	if (vc != ValueClass_Dictionary)
+	{
+		log::error("Invalid baseline file: %s", fileName.c_str());
+		return baseline;
+	}
+
+	ArrayValue benchmarks = Dictionary(root).arrayForKey("benchmarks");
+	for (const auto& value : benchmarks->content)
+	{
+		if (value->valueClass() != ValueClass_Dictionary) continue;
+
+		Dictionary entry(value);
+		if (entry.hasKey("median_ns"))
+			baseline[entry.stringForKey("name")->content] = entry.floatForKey("median_ns")->content;
+	}
+
+	return baseline;
+}
+
+size_t benchmark::run(const Options& options)
+{
+	benchmarkDataFolder = options.dataFolder.empty() ? std::string() : addTrailingSlash(options.dataFolder);
+	benchmarkRenderContext = options.renderContext;
+
+	std::vector<RegisteredBenchmark> benchmarks = registeredBenchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end(), [](const RegisteredBenchmark& l, const RegisteredBenchmark& r)
+		{ return l.name < r.name; });
+
+	std::map<std::string, double> baseline;
+	if (!options.baselineFile.empty())
+		baseline = loadBaseline(options.baselineFile);
+
+	ArrayValue results;
+	size_t regressions = 0;
+
+	for (const auto& rb : benchmarks)
+	{
+		if (!options.filter.empty() && (rb.name.find(options.filter) == std::string::npos)) continue;
+
+		Result result;
+		runBenchmark(rb, options, result);
+		results->content.push_back(resultToDictionary(result));
+
+		if (!result.skipReason.empty())
+		{
+			log::info("%-48s skipped: %s", result.name.c_str(), result.skipReason.c_str());
+			continue;
+		}
+
+		log::info("%-48s %14.1f ns %12llu iterations", result.name.c_str(), result.median,
+			static_cast<unsigned long long>(result.iterations));
+
+		auto base = baseline.find(result.name);
+		if ((base != baseline.end()) && (base->second > 0.0))
+		{
+			double change = (result.median - base->second) / base->second;
+			if (change > options.regressionThreshold)
+			{
+				log::warning("%s regressed by %.1f%% (%.1f ns -> %.1f ns)", result.name.c_str(),
+					100.0 * change, base->second, result.median);
+				++regressions;
+			}
+		}
+	}
+
+	Dictionary context;
+	context.setStringForKey("date", locale::date() + " " + locale::time());
+	context.setIntegerForKey("platform", static_cast<int64_t>(CurrentPlatform));
+	context.setIntegerForKey("cores", static_cast<int64_t>(Threading::coresCount()));
+	context.setIntegerForKey("debug", static_cast<int64_t>(ET_DEBUG ? 1 : 0));
+	context.setFloatForKey("min_time_s", static_cast<float>(options.minTimeInSeconds));
+
+	Dictionary report;
+	report.setDictionaryForKey("context", context);
+	report.setArrayForKey("benchmarks", results);
+
+	std::string serialized = json::serialize(report, json::SerializationFlag_ReadableFormat);
+	if (options.outputFile.empty())
+	{
+		std::cout << serialized << std::endl;
+	}
+	else
+	{
+		std::ofstream output(options.outputFile, std::ios::out | std::ios::trunc);
+		output << serialized;
+		if (output.fail())
+			log::error("Unable to write benchmark results to %s", options.outputFile.c_str());
+	}
+
+	return regressions;
+}
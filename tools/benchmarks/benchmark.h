@@ -0,0 +1,142 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <et/core/et.h>
+
+namespace et
+{
+	class RenderContext;
+	
+	namespace benchmark
+	{
+		class State
+		{
+		public:
+			State(size_t iterations) :
+				_iterations(iterations) { }
+
+			/*
+			 * Usage: while (state.keepRunning()) { ... }
+			 */
+			bool keepRunning()
+			{
+				if (_completed == 0)
+					_startTime = std::chrono::steady_clock::now();
+
+				if (_completed++ < _iterations)
+					return true;
+
+				_elapsed += std::chrono::steady_clock::now() - _startTime;
+				return false;
+			}
+
+			/*
+			 * Excludes preparation code inside benchmark loop from measurement
+			 */
+			void pauseTiming()
+				{ _elapsed += std::chrono::steady_clock::now() - _startTime; }
+
+			void resumeTiming()
+				{ _startTime = std::chrono::steady_clock::now(); }
+
+			/*
+			 * Amount of work done by single iteration, reported as items (bytes) per second
+			 */
+			void setItemsProcessed(size_t items)
+				{ _itemsProcessed = items; }
+
+			void setBytesProcessed(size_t bytes)
+				{ _bytesProcessed = bytes; }
+
+			void skip(const std::string& reason)
+				{ _skipReason = reason; _iterations = 0; }
+
+			size_t iterations() const
+				{ return _iterations; }
+
+			size_t itemsProcessed() const
+				{ return _itemsProcessed; }
+
+			size_t bytesProcessed() const
+				{ return _bytesProcessed; }
+
+			const std::string& skipReason() const
+				{ return _skipReason; }
+
+			double elapsedNanoseconds() const
+				{ return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(_elapsed).count()); }
+
+		private:
+			std::chrono::steady_clock::time_point _startTime;
+			std::chrono::steady_clock::duration _elapsed = std::chrono::steady_clock::duration::zero();
+			std::string _skipReason;
+			size_t _iterations = 0;
+			size_t _completed = 0;
+			size_t _itemsProcessed = 0;
+			size_t _bytesProcessed = 0;
+		};
+
+		typedef void(*Function)(State&);
+
+		struct Registration
+		{
+			Registration(const char* name, Function func);
+		};
+
+		struct Options
+		{
+			std::string filter;
+			std::string outputFile;
+			std::string baselineFile;
+			std::string dataFolder;
+			RenderContext* renderContext = nullptr;
+			double minTimeInSeconds = 0.25;
+			double regressionThreshold = 0.1;
+			size_t repetitions = 5;
+		};
+
+		/*
+		 * Runs registered benchmarks which names contains filter,
+		 * returns number of regressions compared to the baseline file (if provided)
+		 */
+		size_t run(const Options&);
+
+		/*
+		 * Folder with optional input data for benchmarks (JPEG image, etc.)
+		 */
+		const std::string& dataFolder();
+
+		/*
+		 * Render context of the application running benchmarks, nullptr in console applications
+		 */
+		RenderContext* renderContext();
+
+		/*
+		 * Prevents compiler from removing computations which result is unused
+		 */
+		template <typename T>
+		inline void doNotOptimize(const T& value)
+		{
+#		if defined(_MSC_VER)
+			const volatile char* ptr = reinterpret_cast<const volatile char*>(&value);
+			(void)(*ptr);
+#		else
+			asm volatile("" : : "r,m"(value) : "memory");
+#		endif
+		}
+	}
+}
+
+#define ET_BENCHMARK_CONCAT_IMPL(A, B)		A##B
+#define ET_BENCHMARK_CONCAT(A, B)			ET_BENCHMARK_CONCAT_IMPL(A, B)
+
+#define ET_BENCHMARK(NAME)					static void NAME(et::benchmark::State&); \
+											static et::benchmark::Registration ET_BENCHMARK_CONCAT(NAME, _registration)(#NAME, NAME); \
+											static void NAME(et::benchmark::State& state)
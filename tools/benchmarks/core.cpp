@@ -0,0 +1,133 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/events.h>
+#include <et/tasks/taskpool.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const size_t allocationsPerIteration = 256;
+	
+	size_t allocationSize(size_t i)
+		{ return 16 + 24 * (i % 32); }
+
+	class BenchmarkObject : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(BenchmarkObject)
+
+	public:
+		int value = 0;
+	};
+
+	class BenchmarkReceiver : public EventReceiver
+	{
+	public:
+		void onEvent(int value)
+			{ sum += value; }
+
+	public:
+		int64_t sum = 0;
+	};
+
+	class BenchmarkTask : public Task
+	{
+	public:
+		BenchmarkTask(int64_t& counter) :
+			_counter(counter) { }
+
+		void execute()
+			{ ++_counter; }
+
+	private:
+		int64_t& _counter;
+	};
+}
+
+ET_BENCHMARK(core_BlockMemoryAllocator_allocateRelease)
+{
+	std::vector<void*> pointers(allocationsPerIteration);
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < allocationsPerIteration; ++i)
+			pointers[i] = sharedBlockAllocator().allocate(allocationSize(i));
+
+		for (size_t i = 0; i < allocationsPerIteration; ++i)
+			sharedBlockAllocator().release(pointers[i]);
+	}
+	state.setItemsProcessed(allocationsPerIteration);
+}
+
+ET_BENCHMARK(core_malloc_allocateRelease)
+{
+	std::vector<void*> pointers(allocationsPerIteration);
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < allocationsPerIteration; ++i)
+		{
+			pointers[i] = malloc(allocationSize(i));
+			benchmark::doNotOptimize(pointers[i]);
+		}
+
+		for (size_t i = 0; i < allocationsPerIteration; ++i)
+			free(pointers[i]);
+	}
+	state.setItemsProcessed(allocationsPerIteration);
+}
+
+ET_BENCHMARK(core_IntrusivePtr_retainRelease)
+{
+	BenchmarkObject::Pointer object = BenchmarkObject::Pointer::create();
+	while (state.keepRunning())
+	{
+		BenchmarkObject::Pointer copy = object;
+		benchmark::doNotOptimize(copy->value);
+	}
+	state.setItemsProcessed(1);
+}
+
+ET_BENCHMARK(core_Event1_invoke)
+{
+	const size_t receiversCount = 8;
+	
+	BenchmarkReceiver receivers[receiversCount];
+	Event1<int> event;
+	
+	for (size_t i = 0; i < receiversCount; ++i)
+		event.connect(receivers + i, &BenchmarkReceiver::onEvent);
+
+	int value = 0;
+	while (state.keepRunning())
+		event.invoke(++value);
+
+	benchmark::doNotOptimize(receivers[0].sum);
+	state.setItemsProcessed(receiversCount);
+}
+
+ET_BENCHMARK(core_TaskPool_throughput)
+{
+	const size_t tasksPerIteration = 256;
+	
+	TaskPool pool;
+	int64_t counter = 0;
+	float time = 0.0f;
+	
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < tasksPerIteration; ++i)
+			pool.addTask(sharedObjectFactory().createObject<BenchmarkTask>(counter));
+
+		time += 0.001f;
+		pool.update(time);
+	}
+
+	benchmark::doNotOptimize(counter);
+	state.setItemsProcessed(tasksPerIteration);
+}
@@ -0,0 +1,261 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/camera/camera.h>
+#include <et/collision/collision.h>
+#include <et/helpers/particles.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const size_t primitivesCount = 1024;
+	const size_t particlesCount = 65536;
+	
+	vec3 randomVector(float range)
+		{ return vec3(randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range)); }
+
+	triangle randomTriangle(float range)
+	{
+		vec3 center = randomVector(range);
+		return triangle(center + randomVector(1.0f), center + randomVector(1.0f), center + randomVector(1.0f));
+	}
+
+	std::vector<mat4> randomMatrices()
+	{
+		std::vector<mat4> result(primitivesCount);
+		for (auto& m : result)
+			m = rotationYXZMatrix(randomVector(PI)) * translationMatrix(randomVector(10.0f));
+		return result;
+	}
+
+	particles::PointSprite particlesBase()
+	{
+		particles::PointSprite base;
+		base.velocity = vec3(0.0f, 1.0f, 0.0f);
+		base.acceleration = vec3(0.0f, -9.8f, 0.0f);
+		base.lifeTime = 1.0f;
+		return base;
+	}
+
+	particles::PointSprite particlesVariation()
+	{
+		particles::PointSprite variation;
+		variation.position = vec3(1.0f);
+		variation.velocity = vec3(1.0f);
+		variation.color = vec4(0.0f);
+		variation.size = 0.0f;
+		variation.lifeTime = 0.5f;
+		return variation;
+	}
+
+	std::vector<AABB> randomBoxes()
+	{
+		std::vector<AABB> result(primitivesCount);
+		for (auto& b : result)
+			b = AABB(randomVector(100.0f), vec3(randomFloat(0.5f, 5.0f)));
+		return result;
+	}
+}
+
+ET_BENCHMARK(geometry_mat4_multiply)
+{
+	std::vector<mat4> matrices = randomMatrices();
+	while (state.keepRunning())
+	{
+		mat4 result = identityMatrix;
+		for (const auto& m : matrices)
+			result = result * m;
+		benchmark::doNotOptimize(result);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_mat4_inverse)
+{
+	std::vector<mat4> matrices = randomMatrices();
+	while (state.keepRunning())
+	{
+		for (const auto& m : matrices)
+		{
+			mat4 inverted = m.inverse();
+			benchmark::doNotOptimize(inverted);
+		}
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_Frustum_containsAABB)
+{
+	Camera camera;
+	camera.perspectiveProjection(QUARTER_PI, 16.0f / 9.0f, 1.0f, 200.0f);
+	camera.lookAt(vec3(0.0f, 10.0f, 50.0f));
+
+	Frustum frustum(camera.modelViewProjectionMatrix());
+	std::vector<AABB> boxes = randomBoxes();
+
+	while (state.keepRunning())
+	{
+		size_t visible = 0;
+		for (const auto& b : boxes)
+			visible += frustum.containsAABB(b) ? 1 : 0;
+		benchmark::doNotOptimize(visible);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_Frustum_cullAABBs)
+{
+	Camera camera;
+	camera.perspectiveProjection(QUARTER_PI, 16.0f / 9.0f, 1.0f, 200.0f);
+	camera.lookAt(vec3(0.0f, 10.0f, 50.0f));
+
+	Frustum frustum(camera.modelViewProjectionMatrix());
+	std::vector<AABB> boxes = randomBoxes();
+
+	AABBStream stream;
+	for (const auto& b : boxes)
+		stream.push_back(b);
+
+	VisibilityMask visibility;
+	while (state.keepRunning())
+	{
+		frustum.cullAABBs(stream, visibility);
+		benchmark::doNotOptimize(visibility);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_raySphere)
+{
+	std::vector<Sphere> spheres(primitivesCount);
+	for (auto& s : spheres)
+		s = Sphere(randomVector(50.0f), randomFloat(1.0f, 10.0f));
+
+	ray3d r(vec3(0.0f, 0.0f, 100.0f), normalize(vec3(0.1f, 0.1f, -1.0f)));
+	while (state.keepRunning())
+	{
+		vec3 point;
+		size_t hits = 0;
+		for (const auto& s : spheres)
+			hits += intersect::raySphere(r, s, &point) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_rayTriangle)
+{
+	std::vector<triangle> triangles(primitivesCount);
+	for (auto& t : triangles)
+		t = randomTriangle(10.0f);
+
+	ray3d r(vec3(0.0f, 0.0f, 100.0f), normalize(vec3(0.01f, 0.01f, -1.0f)));
+	while (state.keepRunning())
+	{
+		vec3 point;
+		size_t hits = 0;
+		for (const auto& t : triangles)
+			hits += intersect::rayTriangle(r, t, &point) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_sphereAABB)
+{
+	std::vector<AABB> boxes = randomBoxes();
+	Sphere s(vec3(0.0f), 50.0f);
+	while (state.keepRunning())
+	{
+		size_t hits = 0;
+		for (const auto& b : boxes)
+			hits += intersect::sphereAABB(s, b) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_aabbAABB)
+{
+	std::vector<AABB> boxes = randomBoxes();
+	AABB box(vec3(0.0f), vec3(50.0f));
+	while (state.keepRunning())
+	{
+		size_t hits = 0;
+		for (const auto& b : boxes)
+			hits += intersect::aabbAABB(box, b) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_sphereTriangle)
+{
+	std::vector<triangle> triangles(primitivesCount);
+	for (auto& t : triangles)
+		t = randomTriangle(10.0f);
+
+	Sphere s(vec3(0.0f), 2.5f);
+	while (state.keepRunning())
+	{
+		vec3 point;
+		vec3 normal;
+		float penetration = 0.0f;
+		size_t hits = 0;
+		for (const auto& t : triangles)
+			hits += intersect::sphereTriangle(s, t, point, normal, penetration) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_intersect_triangleTriangle)
+{
+	std::vector<triangle> triangles(primitivesCount);
+	for (auto& t : triangles)
+		t = randomTriangle(5.0f);
+
+	triangle reference = randomTriangle(1.0f);
+	while (state.keepRunning())
+	{
+		size_t hits = 0;
+		for (const auto& t : triangles)
+			hits += intersect::triangleTriangle(reference, t) ? 1 : 0;
+		benchmark::doNotOptimize(hits);
+	}
+	state.setItemsProcessed(primitivesCount);
+}
+
+ET_BENCHMARK(geometry_particles_Emitter_update)
+{
+	particles::PointSpriteEmitter emitter(particlesCount);
+	emitter.emit(particlesCount, 0.0f, particlesBase(), particlesVariation());
+
+	float t = 0.0f;
+	while (state.keepRunning())
+	{
+		emitter.update(t += 1.0f / 60.0f);
+		benchmark::doNotOptimize(emitter.activeParticlesCount());
+	}
+	state.setItemsProcessed(particlesCount);
+}
+
+ET_BENCHMARK(geometry_particles_PointSpriteStreamEmitter_update)
+{
+	particles::PointSpriteStreamEmitter emitter(particlesCount);
+	emitter.emit(particlesCount, 0.0f, particlesBase(), particlesVariation());
+
+	float t = 0.0f;
+	while (state.keepRunning())
+	{
+		emitter.update(t += 1.0f / 60.0f);
+		benchmark::doNotOptimize(emitter.activeParticlesCount());
+	}
+	state.setItemsProcessed(particlesCount);
+}
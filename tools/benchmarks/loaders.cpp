@@ -0,0 +1,389 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <sstream>
+#include <et/imaging/imagewriter.h>
+#include <et/imaging/pngloader.h>
+#include <et/imaging/jpegloader.h>
+#include <et/imaging/ddsloader.h>
+#include <et/imaging/hdrloader.h>
+#include <et/imaging/imageoperations.h>
+#include <et/json/json.h>
+#include <et/models/objloader.h>
+#include <et/primitives/primitives.h>
+#include <et/primitives/meshoptimizer.h>
+#include <et/primitives/meshsimplifier.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const vec2i imageSize(256, 256);
+	
+	BinaryDataStorage generateImageData(size_t components)
+	{
+		BinaryDataStorage result(imageSize.square() * components, 0);
+		for (size_t i = 0; i < result.size(); ++i)
+			result[i] = static_cast<unsigned char>((i * 7) ^ (i / components));
+		return result;
+	}
+
+	const std::string& pngData()
+	{
+		static std::string data;
+		if (data.empty())
+		{
+			BinaryDataStorage buffer;
+			writeImageToBuffer(buffer, generateImageData(4), imageSize, 4, 8, ImageFormat_PNG, false);
+			data.assign(buffer.binary(), buffer.size());
+		}
+		return data;
+	}
+
+	/*
+	 * Uncompressed 32-bit RGBA DDS: signature, 124 bytes of header, pixels
+	 */
+	const std::string& ddsData()
+	{
+		static std::string data;
+		if (data.empty())
+		{
+			uint32_t header[32] = { };
+			header[0] = ET_COMPOSE_UINT32(' ', 'S', 'D', 'D');
+			header[1] = 124;
+			header[2] = 0x100F;
+			header[3] = static_cast<uint32_t>(imageSize.y);
+			header[4] = static_cast<uint32_t>(imageSize.x);
+			header[5] = static_cast<uint32_t>(4 * imageSize.x);
+			header[7] = 1;
+			header[19] = 32;
+			header[20] = 0x41;
+			header[22] = 32;
+			header[23] = 0x000000ff;
+			header[24] = 0x0000ff00;
+			header[25] = 0x00ff0000;
+			header[26] = 0xff000000;
+			header[27] = 0x1000;
+
+			BinaryDataStorage pixels = generateImageData(4);
+			data.assign(reinterpret_cast<const char*>(header), sizeof(header));
+			data.append(pixels.binary(), pixels.size());
+		}
+		return data;
+	}
+
+	/*
+	 * Radiance RGBE with new-style RLE scanlines, every channel stored as literal runs
+	 */
+	const std::string& hdrData()
+	{
+		static std::string data;
+		if (data.empty())
+		{
+			data = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + intToStr(imageSize.y) +
+				" +X " + intToStr(imageSize.x) + "\n";
+
+			for (int y = 0; y < imageSize.y; ++y)
+			{
+				data.push_back(2);
+				data.push_back(2);
+				data.push_back(static_cast<char>((imageSize.x >> 8) & 0xff));
+				data.push_back(static_cast<char>(imageSize.x & 0xff));
+
+				for (int c = 0; c < 4; ++c)
+				{
+					for (int x = 0; x < imageSize.x; )
+					{
+						int count = std::min(128, imageSize.x - x);
+						data.push_back(static_cast<char>(count));
+						for (int i = 0; i < count; ++i, ++x)
+							data.push_back(static_cast<char>((c == 3) ? 128 : (x + y + 32 * c) & 0xff));
+					}
+				}
+			}
+		}
+		return data;
+	}
+
+	const std::string& jsonData()
+	{
+		static std::string data;
+		if (data.empty())
+		{
+			ArrayValue objects;
+			for (int64_t i = 0; i < 512; ++i)
+			{
+				Dictionary object;
+				object.setStringForKey("name", "object_" + intToStr(i));
+				object.setIntegerForKey("index", i);
+				object.setFloatForKey("weight", static_cast<float>(i) / 7.0f);
+
+				ArrayValue position;
+				position->content.push_back(FloatValue(static_cast<float>(i)));
+				position->content.push_back(FloatValue(static_cast<float>(2 * i)));
+				position->content.push_back(FloatValue(static_cast<float>(3 * i)));
+				object.setArrayForKey("position", position);
+
+				objects->content.push_back(object);
+			}
+
+			Dictionary root;
+			root.setArrayForKey("objects", objects);
+			data = json::serialize(root);
+		}
+		return data;
+	}
+
+	/*
+	 * Grid of quads with positions, texture coordinates and normals
+	 */
+	const std::string& objFileName()
+	{
+		static std::string fileName;
+		if (fileName.empty())
+		{
+			const int gridSize = 128;
+			fileName = addTrailingSlash(temporaryBaseFolder()) + "et-benchmark.obj";
+
+			std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+			for (int y = 0; y <= gridSize; ++y)
+			{
+				for (int x = 0; x <= gridSize; ++x)
+				{
+					file << "v " << x << " " << std::sin(0.1f * static_cast<float>(x + y)) << " " << y << "\n";
+					file << "vt " << static_cast<float>(x) / gridSize << " " << static_cast<float>(y) / gridSize << "\n";
+					file << "vn 0 1 0\n";
+				}
+			}
+
+			file << "g grid\n";
+			for (int y = 0; y < gridSize; ++y)
+			{
+				for (int x = 0; x < gridSize; ++x)
+				{
+					int i0 = 1 + x + y * (gridSize + 1);
+					int i1 = i0 + 1;
+					int i2 = i0 + gridSize + 1;
+					int i3 = i2 + 1;
+					file << "f " << i0 << "/" << i0 << "/" << i0 << " " << i1 << "/" << i1 << "/" << i1 << " " <<
+						i3 << "/" << i3 << "/" << i3 << " " << i2 << "/" << i2 << "/" << i2 << "\n";
+				}
+			}
+		}
+		return fileName;
+	}
+}
+
+ET_BENCHMARK(loaders_png_loadFromStream)
+{
+	const std::string& data = pngData();
+	while (state.keepRunning())
+	{
+		std::istringstream stream(data);
+		TextureDescription desc;
+		png::loadFromStream(stream, desc, false);
+		benchmark::doNotOptimize(desc.data.binary());
+	}
+	state.setBytesProcessed(data.size());
+}
+
+ET_BENCHMARK(loaders_jpeg_loadFromStream)
+{
+	std::string fileName = benchmark::dataFolder() + "benchmark.jpg";
+	if (benchmark::dataFolder().empty() || !fileExists(fileName))
+	{
+		state.skip("benchmark.jpg not found in data folder");
+		return;
+	}
+
+	std::string data = loadTextFile(fileName);
+	while (state.keepRunning())
+	{
+		std::istringstream stream(data);
+		TextureDescription desc;
+		jpeg::loadFromStream(stream, desc);
+		benchmark::doNotOptimize(desc.data.binary());
+	}
+	state.setBytesProcessed(data.size());
+}
+
+ET_BENCHMARK(loaders_dds_loadFromStream)
+{
+	const std::string& data = ddsData();
+	while (state.keepRunning())
+	{
+		std::istringstream stream(data);
+		TextureDescription desc;
+		dds::loadFromStream(stream, desc);
+		benchmark::doNotOptimize(desc.data.binary());
+	}
+	state.setBytesProcessed(data.size());
+}
+
+ET_BENCHMARK(loaders_hdr_loadFromStream)
+{
+	const std::string& data = hdrData();
+	while (state.keepRunning())
+	{
+		std::istringstream stream(data);
+		TextureDescription desc;
+		hdr::loadFromStream(stream, desc);
+		benchmark::doNotOptimize(desc.data.binary());
+	}
+	state.setBytesProcessed(data.size());
+}
+
+ET_BENCHMARK(loaders_json_deserialize)
+{
+	const std::string& data = jsonData();
+	while (state.keepRunning())
+	{
+		ValueClass vc = ValueClass_Invalid;
+		auto value = json::deserialize(data, vc);
+		benchmark::doNotOptimize(value.ptr());
+	}
+	state.setBytesProcessed(data.size());
+}
+
+ET_BENCHMARK(loaders_OBJLoader_load)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	const std::string& fileName = objFileName();
+	while (state.keepRunning())
+	{
+		ObjectsCache cache;
+		OBJLoader loader(rc, fileName);
+		auto container = loader.load(cache, OBJLoader::Option_SupportMeshes);
+		benchmark::doNotOptimize(container.ptr());
+	}
+}
+
+ET_BENCHMARK(primitives_buildLinearIndexArray)
+{
+	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+
+	VertexArray::Pointer vertices = VertexArray::Pointer::create(decl, 0);
+	primitives::createSphere(vertices, 1.0f, vec2i(64));
+
+	while (state.keepRunning())
+	{
+		IndexArray::Pointer indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit, 0, PrimitiveType::Triangles);
+		auto result = primitives::buildLinearIndexArray(vertices, indices);
+		benchmark::doNotOptimize(result.ptr());
+	}
+	state.setItemsProcessed(vertices->size());
+}
+
+ET_BENCHMARK(primitives_weldVertices)
+{
+	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
+
+	VertexArray::Pointer vertices = VertexArray::Pointer::create(decl, 0);
+	primitives::createSphere(vertices, 1.0f, vec2i(256));
+
+	while (state.keepRunning())
+	{
+		IndexArray::Pointer indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit, 0, PrimitiveType::Triangles);
+		auto result = primitives::weldVertices(vertices, indices);
+		benchmark::doNotOptimize(result.ptr());
+	}
+	state.setItemsProcessed(vertices->size());
+}
+
+ET_BENCHMARK(primitives_smoothNormals)
+{
+	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+
+	VertexArray::Pointer vertices = VertexArray::Pointer::create(decl, 0);
+	primitives::createSphere(vertices, 1.0f, vec2i(256));
+
+	while (state.keepRunning())
+	{
+		primitives::smoothNormals(vertices, 0, static_cast<uint32_t>(vertices->size()));
+		benchmark::doNotOptimize(vertices->chunk(VertexAttributeUsage::Normal)->data());
+	}
+	state.setItemsProcessed(vertices->size());
+}
+
+ET_BENCHMARK(primitives_optimizeVertexCache)
+{
+	const vec2i dim(128, 128);
+	IndexArray::Pointer indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit,
+		primitives::indexCountForRegularMesh(dim, PrimitiveType::Triangles), PrimitiveType::Triangles);
+	primitives::buildTrianglesIndexes(indices, dim, 0, 0);
+
+	while (state.keepRunning())
+	{
+		primitives::optimizeVertexCache(indices, 0, indices->actualSize());
+		benchmark::doNotOptimize(indices->data());
+	}
+	state.setItemsProcessed(indices->primitivesCount());
+}
+
+ET_BENCHMARK(primitives_simplify)
+{
+	VertexDeclaration decl(true, VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::Normal, VertexAttributeType::Vec3);
+	decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec2);
+
+	const vec2i dim(128, 128);
+	VertexArray::Pointer vertices = VertexArray::Pointer::create(decl, 0);
+	primitives::createSphere(vertices, 1.0f, dim);
+
+	IndexArray::Pointer indices = IndexArray::Pointer::create(IndexArrayFormat::Format_32bit,
+		primitives::indexCountForRegularMesh(dim, PrimitiveType::Triangles), PrimitiveType::Triangles);
+	primitives::buildTrianglesIndexes(indices, dim, 0, 0);
+
+	size_t sourceIndices = indices->actualSize();
+	primitives::IndexRangeList ranges(1, primitives::IndexRange(0, static_cast<uint32_t>(sourceIndices)));
+
+	while (state.keepRunning())
+	{
+		indices->setActualSize(sourceIndices);
+		auto result = primitives::simplify(vertices, indices, ranges, 0.25f);
+		benchmark::doNotOptimize(result.trianglesCount);
+	}
+	state.setItemsProcessed(sourceIndices / 3);
+}
+
+ET_BENCHMARK(imaging_ImageOperations_blur)
+{
+	BinaryDataStorage source = generateImageData(4);
+	BinaryDataStorage data(source.size(), 0);
+	while (state.keepRunning())
+	{
+		etCopyMemory(data.data(), source.data(), source.size());
+		ImageOperations::blur(data, imageSize, 4, vec2i(1, 0), 16, ImageBlurType_Gaussian);
+		ImageOperations::blur(data, imageSize, 4, vec2i(0, 1), 16, ImageBlurType_Gaussian);
+		benchmark::doNotOptimize(data.data());
+	}
+	state.setBytesProcessed(source.size());
+}
+
+ET_BENCHMARK(imaging_ImageOperations_median)
+{
+	BinaryDataStorage source = generateImageData(4);
+	BinaryDataStorage data(source.size(), 0);
+	while (state.keepRunning())
+	{
+		etCopyMemory(data.data(), source.data(), source.size());
+		ImageOperations::median(data, imageSize, 4, 8);
+		benchmark::doNotOptimize(data.data());
+	}
+	state.setBytesProcessed(source.size());
+}
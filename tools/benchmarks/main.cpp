@@ -0,0 +1,87 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/application.h>
+#include "benchmark.h"
+
+#if (ET_PLATFORM_LINUX)
+#	include <et/null/nullrenderdevice.h>
+#endif
+
+using namespace et;
+
+void printHelp()
+{
+	log::info("Using:\n"
+		"benchmarks [OPTIONS]\n"
+		"\t-filter <TEXT> - run only benchmarks which names contain TEXT\n"
+		"\t-out <FILE> - write JSON report to FILE instead of standard output\n"
+		"\t-baseline <FILE> - compare with previously saved JSON report, exit code is 1 on regressions\n"
+		"\t-threshold <VALUE>, default: 0.1 - relative slowdown treated as regression\n"
+		"\t-data <FOLDER> - folder with optional input data (benchmark.jpg, benchmark.obj)\n"
+		"\t-min-time <SECONDS>, default: 0.25 - minimal duration of a single repetition\n"
+		"\t-repetitions <COUNT>, default: 5");
+}
+
+class BenchmarksDelegate : public IApplicationDelegate
+{
+public:
+	ApplicationIdentifier applicationIdentifier() const
+		{ return ApplicationIdentifier("com.cheetek.et.benchmarks", "Cheetek", "et benchmarks"); }
+
+	void applicationDidLoad(RenderContext* rc)
+	{
+		benchmark::Options options;
+		options.renderContext = rc;
+
+#if (ET_PLATFORM_LINUX)
+		/*
+		 * Benchmarks run within one frame, null device should not keep commands of all iterations
+		 */
+		NullRenderDevice::instance().setRecordingEnabled(false);
+#endif
+
+		const Application& app = application();
+		for (size_t i = 1; i < app.launchParamtersCount(); ++i)
+		{
+			const std::string& param = app.launchParameter(i);
+			bool hasValue = (i + 1 < app.launchParamtersCount());
+
+			if ((param == "-filter") && hasValue)
+				options.filter = app.launchParameter(++i);
+			else if ((param == "-out") && hasValue)
+				options.outputFile = app.launchParameter(++i);
+			else if ((param == "-baseline") && hasValue)
+				options.baselineFile = app.launchParameter(++i);
+			else if ((param == "-data") && hasValue)
+				options.dataFolder = app.launchParameter(++i);
+			else if ((param == "-threshold") && hasValue)
+				options.regressionThreshold = strToFloat(app.launchParameter(++i));
+			else if ((param == "-min-time") && hasValue)
+				options.minTimeInSeconds = strToFloat(app.launchParameter(++i));
+			else if ((param == "-repetitions") && hasValue)
+				options.repetitions = std::max(1, strToInt(app.launchParameter(++i)));
+			else
+			{
+				printHelp();
+				application().quit(1);
+				return;
+			}
+		}
+
+		size_t regressions = benchmark::run(options);
+		application().quit((regressions > 0) ? 1 : 0);
+	}
+};
+
+IApplicationDelegate* et::Application::initApplicationDelegate()
+	{ return sharedObjectFactory().createObject<BenchmarksDelegate>(); }
+
+int main(int argc, char* argv[])
+{
+	return application().run(argc, argv);
+}
@@ -0,0 +1,304 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/application.h>
+#include <et/geometry/geometry.h>
+#include <et/rendering/rendercontext.h>
+#include <et/scene3d/instancebatcher.h>
+#include "benchmark.h"
+
+using namespace et;
+
+namespace
+{
+	const size_t packetsCount = 8192;
+	const size_t programsCount = 8;
+	const size_t materialsCount = 64;
+	const size_t vertexArraysCount = 128;
+
+	struct CommandBufferScene
+	{
+		std::vector<Program::Pointer> programs;
+		std::vector<VertexArrayObject> vertexArrays;
+		std::vector<mat4> transforms;
+		std::vector<float> depths;
+	};
+
+	CommandBufferScene createCommandBufferScene(RenderContext* rc)
+	{
+		CommandBufferScene scene;
+
+		for (size_t i = 0; i < programsCount; ++i)
+		{
+			scene.programs.push_back(rc->programFactory().genProgram("benchmark-program-" + intToStr(i),
+				emptyString, emptyString));
+		}
+
+		for (size_t i = 0; i < vertexArraysCount; ++i)
+		{
+			IndexArray::Pointer ia = IndexArray::Pointer::create(IndexArrayFormat::Format_16bit, 36, PrimitiveType::Triangles);
+			ia->linearize(36);
+
+			VertexArray::Pointer va = VertexArray::Pointer::create(VertexDeclaration(true,
+				VertexAttributeUsage::Position, VertexAttributeType::Vec3), 36);
+
+			scene.vertexArrays.push_back(rc->vertexBufferFactory().createVertexArrayObject("benchmark-vao-" + intToStr(i),
+				va, BufferDrawType::Static, ia, BufferDrawType::Static));
+		}
+
+		for (size_t i = 0; i < packetsCount; ++i)
+		{
+			scene.transforms.push_back(translationMatrix(randomFloat(-10.0f, 10.0f), 0.0f, randomFloat(-10.0f, 10.0f)));
+			scene.depths.push_back(randomFloat(0.0f, 100.0f));
+		}
+
+		return scene;
+	}
+
+	void recordCommandBufferScene(const CommandBufferScene& scene, RenderCommandBuffer& buffer, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			size_t material = (i * 7) % materialsCount;
+			buffer.draw(static_cast<uint32_t>(i % 2), scene.programs[material % programsCount],
+				static_cast<RenderCommandBuffer::Identifier>(material), scene.vertexArrays[(i * 13) % vertexArraysCount],
+				0, 36, scene.transforms[i], scene.depths[i]);
+		}
+	}
+
+	/*
+	 * Meshes duplicated from a few sources, as they come from scene with repeated objects
+	 */
+	void createInstancedMeshes(const CommandBufferScene& scene, s3d::ElementContainer::Pointer& root,
+		std::vector<s3d::Mesh::Pointer>& meshes)
+	{
+		std::vector<s3d::Mesh::Pointer> sources;
+		for (size_t i = 0; i < materialsCount; ++i)
+		{
+			s3d::Material::Pointer material(sharedObjectFactory().createObject<s3d::Material>());
+			sources.push_back(s3d::Mesh::Pointer::create("benchmark-mesh-" + intToStr(i),
+				scene.vertexArrays[i % vertexArraysCount], material, 0, 36, root.ptr()));
+		}
+
+		for (size_t i = 0; i < packetsCount; ++i)
+		{
+			s3d::Mesh::Pointer mesh(sources[(i * 7) % sources.size()]->duplicate());
+			mesh->setTransform(scene.transforms[i]);
+			meshes.push_back(mesh);
+		}
+	}
+}
+
+ET_BENCHMARK(rendering_RenderCommandBuffer_sort)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	CommandBufferScene scene = createCommandBufferScene(rc);
+
+	RenderCommandBuffer buffer;
+	buffer.setDepthOrder(1, RenderCommandBuffer::DepthOrder::BackToFront);
+	for (size_t i = 0; i < materialsCount; ++i)
+		buffer.addMaterial(RenderCommandBuffer::Material());
+
+	while (state.keepRunning())
+	{
+		state.pauseTiming();
+		buffer.clear();
+		recordCommandBufferScene(scene, buffer, 0, packetsCount);
+		state.resumeTiming();
+
+		buffer.sort();
+		benchmark::doNotOptimize(buffer.statistics().stateChanges());
+	}
+	state.setItemsProcessed(packetsCount);
+}
+
+ET_BENCHMARK(rendering_RenderCommandBuffer_recordSortSubmit)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	CommandBufferScene scene = createCommandBufferScene(rc);
+
+	RenderCommandBuffer buffer;
+	buffer.setDepthOrder(1, RenderCommandBuffer::DepthOrder::BackToFront);
+	for (size_t i = 0; i < materialsCount; ++i)
+		buffer.addMaterial(RenderCommandBuffer::Material());
+
+	while (state.keepRunning())
+	{
+		buffer.clear();
+		recordCommandBufferScene(scene, buffer, 0, packetsCount);
+		buffer.submit(rc);
+		benchmark::doNotOptimize(buffer.statistics().stateChanges());
+	}
+	state.setItemsProcessed(packetsCount);
+}
+
+ET_BENCHMARK(rendering_RenderCommandBuffer_recordParallel)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	CommandBufferScene scene = createCommandBufferScene(rc);
+
+	RenderCommandBuffer buffer;
+	for (size_t i = 0; i < materialsCount; ++i)
+		buffer.addMaterial(RenderCommandBuffer::Material());
+
+	while (state.keepRunning())
+	{
+		buffer.clear();
+		buffer.record(packetsCount, 512, jobSystem(), [&scene](RenderCommandBuffer& b, size_t begin, size_t end)
+			{ recordCommandBufferScene(scene, b, begin, end); });
+		benchmark::doNotOptimize(buffer.packetsCount());
+	}
+	state.setItemsProcessed(packetsCount);
+}
+
+ET_BENCHMARK(rendering_InstanceBatcher_batchSubmit)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	CommandBufferScene scene = createCommandBufferScene(rc);
+	s3d::ElementContainer::Pointer root = s3d::ElementContainer::Pointer::create("benchmark-root", nullptr);
+	std::vector<s3d::Mesh::Pointer> meshes;
+	createInstancedMeshes(scene, root, meshes);
+
+	RenderCommandBuffer buffer;
+	std::map<const s3d::Material*, RenderCommandBuffer::Identifier> materials;
+	auto materialIdentifier = [&buffer, &materials](const s3d::Material::Pointer& m)
+	{
+		auto i = materials.find(m.ptr());
+		if (i != materials.end())
+			return i->second;
+
+		auto identifier = buffer.addMaterial(RenderCommandBuffer::Material());
+		materials.insert(std::make_pair(m.ptr(), identifier));
+		return identifier;
+	};
+
+	s3d::InstanceBatcher batcher;
+	while (state.keepRunning())
+	{
+		batcher.clear();
+		for (size_t i = 0; i < packetsCount; ++i)
+			batcher.add(meshes[i].ptr(), scene.depths[i]);
+		batcher.build();
+
+		buffer.clear();
+		batcher.record(buffer, 0, scene.programs.front(), materialIdentifier);
+		buffer.submit(rc);
+		benchmark::doNotOptimize(buffer.packetsCount());
+	}
+	state.setItemsProcessed(packetsCount);
+}
+
+namespace
+{
+	const size_t uniformUpdatesCount = 4096;
+
+	const std::string uniformProgramSource =
+		"uniform vec2 texel; uniform vec2 clipPlanes; uniform vec2 texCoordScales; uniform vec4 diffuseColor;"
+		"uniform vec4 specularColor; uniform float roughness; uniform float metallness; uniform mat4 mProjection;"
+		"void main() { }";
+}
+
+ET_BENCHMARK(rendering_Program_setUniformByString)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	Program::Pointer program = rc->programFactory().genProgram("benchmark-uniforms", uniformProgramSource, emptyString);
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < uniformUpdatesCount; ++i)
+		{
+			float value = static_cast<float>(i % 4);
+			program->setUniform("texel", vec2(value));
+			program->setUniform("clipPlanes", vec2(1.0f, 100.0f));
+			program->setUniform("diffuseColor", vec4(value));
+			program->setUniform("roughness", 0.5f);
+		}
+	}
+	state.setItemsProcessed(4 * uniformUpdatesCount);
+}
+
+ET_BENCHMARK(rendering_Program_setUniformByName)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	Program::Pointer program = rc->programFactory().genProgram("benchmark-uniforms", uniformProgramSource, emptyString);
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < uniformUpdatesCount; ++i)
+		{
+			float value = static_cast<float>(i % 4);
+			program->setUniform(ET_UNIFORM_NAME("texel"), vec2(value));
+			program->setUniform(ET_UNIFORM_NAME("clipPlanes"), vec2(1.0f, 100.0f));
+			program->setUniform(ET_UNIFORM_NAME("diffuseColor"), vec4(value));
+			program->setUniform(ET_UNIFORM_NAME("roughness"), 0.5f);
+		}
+	}
+	state.setItemsProcessed(4 * uniformUpdatesCount);
+}
+
+ET_BENCHMARK(rendering_Program_setUniformBlock)
+{
+	RenderContext* rc = benchmark::renderContext();
+	if (rc == nullptr)
+	{
+		state.skip("render context is not available");
+		return;
+	}
+
+	Program::Pointer program = rc->programFactory().genProgram("benchmark-uniforms", uniformProgramSource, emptyString);
+
+	std::vector<UniformBlock> materials(materialsCount);
+	for (size_t i = 0; i < materialsCount; ++i)
+	{
+		float value = static_cast<float>(i % 4);
+		materials[i].set(ET_UNIFORM_NAME("diffuseColor"), vec4(value));
+		materials[i].set(ET_UNIFORM_NAME("specularColor"), vec4(1.0f));
+		materials[i].set(ET_UNIFORM_NAME("roughness"), 0.5f);
+		materials[i].set(ET_UNIFORM_NAME("metallness"), value);
+	}
+
+	while (state.keepRunning())
+	{
+		for (size_t i = 0; i < uniformUpdatesCount; ++i)
+			program->setUniforms(materials[i % materialsCount]);
+	}
+	state.setItemsProcessed(4 * uniformUpdatesCount);
+}
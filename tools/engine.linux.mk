@@ -0,0 +1,43 @@
+#
+# This file is part of `et engine`
+# Copyright 2009-2015 by Sergey Reznik
+# Please, modify content only if you know what are you doing.
+#
+# Builds engine as a static library for the headless Linux platform (null render device),
+# included by console tools (benchmarks, tests). Including makefile should define ET_ROOT.
+#
+# Variables:
+#   CONFIG=debug|release (default: release)
+#   LDLIBS - system libraries, could be overriden if jansson/libxml2 are installed differently
+#
+
+CONFIG ?= release
+CXX ?= g++
+
+ET_BUILD_DIR := $(ET_ROOT)/tools/build/$(CONFIG)
+ET_ENGINE_LIBRARY := $(ET_BUILD_DIR)/libet.a
+
+ET_ENGINE_MODULES := app camera collision core geometry helpers imaging input json locale models \
+	null platform-linux platform-unix primitives rendering rt scene3d tasks timers vertexbuffer
+
+ET_ENGINE_SOURCES := $(filter-out %/sound.openal.linux.cpp, \
+	$(wildcard $(addprefix $(ET_ROOT)/src/,$(addsuffix /*.cpp,$(ET_ENGINE_MODULES)))))
+ET_ENGINE_OBJECTS := $(patsubst $(ET_ROOT)/src/%.cpp,$(ET_BUILD_DIR)/engine/%.o,$(ET_ENGINE_SOURCES))
+
+ifeq ($(CONFIG),debug)
+	ET_CONFIG_FLAGS := -g -O0 -D_DEBUG
+else
+	ET_CONFIG_FLAGS := -O2 -DNDEBUG
+endif
+
+CXXFLAGS += -std=c++11 -pthread $(ET_CONFIG_FLAGS) -I$(ET_ROOT)/include
+LDLIBS ?= -lpng -ljpeg -lxml2 -ljansson -lz -pthread
+
+$(ET_ENGINE_LIBRARY): $(ET_ENGINE_OBJECTS)
+	$(AR) rcs $@ $^
+
+$(ET_BUILD_DIR)/engine/%.o: $(ET_ROOT)/src/%.cpp
+	@mkdir -p $(dir $@)
+	$(CXX) $(CXXFLAGS) -MMD -MP -c $< -o $@
+
+-include $(ET_ENGINE_OBJECTS:.o=.d)
@@ -0,0 +1,69 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <thread>
+#include <sstream>
+#include <et/core/profiler.h>
+#include "test.h"
+
+using namespace et;
+
+namespace
+{
+	size_t countOccurrences(const std::string& source, const std::string& value)
+	{
+		size_t result = 0;
+		for (size_t pos = source.find(value); pos != std::string::npos; pos = source.find(value, pos + 1))
+			++result;
+		return result;
+	}
+
+	std::string chromeTrace()
+	{
+		std::ostringstream stream;
+		Profiler::instance().writeChromeTrace(stream);
+		return stream.str();
+	}
+
+	void runNamedThread(const char* name, const char* scope)
+	{
+		std::thread thread([name, scope]()
+		{
+			Profiler::instance().setThreadName(name);
+			ProfilerScope profilerScope(scope);
+		});
+		thread.join();
+	}
+}
+
+ET_TEST(core_Profiler_reusesBuffersOfExitedThreads)
+{
+	runNamedThread("profiler.test", "profiler.scope");
+	size_t buffersCount = countOccurrences(chromeTrace(), "\"thread_name\"");
+
+	for (size_t i = 0; i < 16; ++i)
+		runNamedThread("profiler.test", "profiler.scope");
+
+	ET_EXPECT(countOccurrences(chromeTrace(), "\"thread_name\"") == buffersCount);
+}
+
+ET_TEST(core_Profiler_keepsCapturedEventsOfExitedThreads)
+{
+	Profiler::instance().beginCapture();
+	runNamedThread("profiler.first", "profiler.firstScope");
+	runNamedThread("profiler.second", "profiler.secondScope");
+	Profiler::instance().endCapture();
+
+	runNamedThread("profiler.third", "profiler.thirdScope");
+
+	std::string trace = chromeTrace();
+	ET_EXPECT(countOccurrences(trace, "\"profiler.first\"") == 1);
+	ET_EXPECT(countOccurrences(trace, "\"profiler.firstScope\"") == 1);
+	ET_EXPECT(countOccurrences(trace, "\"profiler.second\"") == 1);
+	ET_EXPECT(countOccurrences(trace, "\"profiler.secondScope\"") == 1);
+	ET_EXPECT(countOccurrences(trace, "\"profiler.thirdScope\"") == 0);
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/app/application.h>
+#include "test.h"
+
+using namespace et;
+
+void printHelp()
+{
+	log::info("Using:\n"
+		"tests [OPTIONS]\n"
+		"\t-filter <TEXT> - run only tests which names contain TEXT");
+}
+
+class TestsDelegate : public IApplicationDelegate
+{
+public:
+	ApplicationIdentifier applicationIdentifier() const
+		{ return ApplicationIdentifier("com.cheetek.et.tests", "Cheetek", "et tests"); }
+
+	void applicationDidLoad(RenderContext* rc)
+	{
+		std::string filter;
+
+		const Application& app = application();
+		for (size_t i = 1; i < app.launchParamtersCount(); ++i)
+		{
+			const std::string& param = app.launchParameter(i);
+			bool hasValue = (i + 1 < app.launchParamtersCount());
+
+			if ((param == "-filter") && hasValue)
+			{
+				filter = app.launchParameter(++i);
+			}
+			else
+			{
+				printHelp();
+				application().quit(1);
+				return;
+			}
+		}
+
+		size_t failed = test::run(filter, rc);
+		application().quit((failed > 0) ? 1 : 0);
+	}
+};
+
+IApplicationDelegate* et::Application::initApplicationDelegate()
+	{ return sharedObjectFactory().createObject<TestsDelegate>(); }
+
+int main(int argc, char* argv[])
+{
+	return application().run(argc, argv);
+}
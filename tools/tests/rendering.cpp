@@ -0,0 +1,435 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <numeric>
+#include <et/camera/camera.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/rendercommandbuffer.h>
+#include <et/null/nullrenderdevice.h>
+#include <et/rendering/textureresidency.h>
+#include <et/scene3d/instancebatcher.h>
+#include <et/scene3d/supportmesh.h>
+#include "test.h"
+
+using namespace et;
+
+namespace
+{
+	VertexArrayObject createVertexArray(RenderContext* rc, const std::string& name)
+	{
+		IndexArray::Pointer ia = IndexArray::Pointer::create(IndexArrayFormat::Format_16bit, 36, PrimitiveType::Triangles);
+		ia->linearize(36);
+
+		VertexArray::Pointer va = VertexArray::Pointer::create(VertexDeclaration(true,
+			VertexAttributeUsage::Position, VertexAttributeType::Vec3), 36);
+
+		return rc->vertexBufferFactory().createVertexArrayObject(name, va, BufferDrawType::Static,
+			ia, BufferDrawType::Static);
+	}
+
+	std::vector<NullCommand> recordedDraws()
+	{
+		std::vector<NullCommand> result;
+		for (const auto& cmd : NullRenderDevice::instance().commands())
+		{
+			if ((cmd.type == NullCommandType::Draw) || (cmd.type == NullCommandType::DrawInstanced))
+				result.push_back(cmd);
+		}
+		return result;
+	}
+
+	void completeLoads(TextureResidencyPolicy& policy, const TextureResidencyPolicy::ActionList& actions)
+	{
+		for (const auto& action : actions)
+		{
+			if (action.type == TextureResidencyPolicy::ActionType::Load)
+				policy.levelDidLoad(action.handle, action.level);
+		}
+	}
+}
+
+ET_TEST(rendering_RenderCommandBuffer_sortAndSubmit)
+{
+	RenderContext* rc = test::renderContext();
+	ET_EXPECT(rc != nullptr);
+	if (rc == nullptr) return;
+
+	Program::Pointer programA = rc->programFactory().genProgram("test-program-a", emptyString, emptyString);
+	Program::Pointer programB = rc->programFactory().genProgram("test-program-b", emptyString, emptyString);
+	VertexArrayObject vaoA = createVertexArray(rc, "test-vao-a");
+	VertexArrayObject vaoB = createVertexArray(rc, "test-vao-b");
+
+	RenderCommandBuffer buffer;
+	buffer.setDepthOrder(1, RenderCommandBuffer::DepthOrder::BackToFront);
+	auto material0 = buffer.addMaterial(RenderCommandBuffer::Material());
+	auto material1 = buffer.addMaterial(RenderCommandBuffer::Material());
+
+	/*
+	 * first index identifies packet in the recorded draw calls,
+	 * programs are ordered by the first use (B, A), depth is the last criterion in pass 0
+	 */
+	buffer.draw(0, programB, material1, vaoA, 0, 3, identityMatrix, 5.0f);
+	buffer.draw(0, programA, material0, vaoA, 3, 3, identityMatrix, 1.0f);
+	buffer.draw(0, programB, material1, vaoA, 6, 3, identityMatrix, 2.0f);
+	buffer.draw(0, programA, material0, vaoB, 9, 3, identityMatrix, 3.0f);
+
+	/*
+	 * pass 1 is sorted back to front, regardless of the state
+	 */
+	buffer.draw(1, programA, material0, vaoA, 12, 3, identityMatrix, 1.0f);
+	buffer.draw(1, programB, material1, vaoB, 15, 3, identityMatrix, 10.0f);
+
+	ET_EXPECT(buffer.packetsCount() == 6);
+
+	std::vector<uint32_t> expectedOrder = { 2, 0, 1, 3, 5, 4 };
+	ET_EXPECT(buffer.submissionOrder() == expectedOrder);
+	ET_EXPECT(buffer.statistics().packets == 6);
+	ET_EXPECT(buffer.statistics().stateChanges() <= buffer.statistics().unsortedStateChanges);
+
+	NullRenderDevice::instance().beginFrame();
+	buffer.submit(rc);
+
+	std::vector<NullCommand> draws = recordedDraws();
+	ET_EXPECT(draws.size() == expectedOrder.size());
+	for (size_t i = 0; (i < draws.size()) && (i < expectedOrder.size()); ++i)
+	{
+		ET_EXPECT(draws[i].type == NullCommandType::Draw);
+		ET_EXPECT(draws[i].first == 3 * expectedOrder[i]);
+		ET_EXPECT(draws[i].count == 3);
+	}
+
+	buffer.clear();
+	ET_EXPECT(buffer.packetsCount() == 0);
+}
+
+ET_TEST(rendering_RenderCommandBuffer_submitInstanced)
+{
+	RenderContext* rc = test::renderContext();
+	ET_EXPECT(rc != nullptr);
+	if (rc == nullptr) return;
+
+	Program::Pointer program = rc->programFactory().genProgram("test-program-instanced", emptyString, emptyString);
+	VertexArrayObject vao = createVertexArray(rc, "test-vao-instanced");
+
+	RenderCommandBuffer buffer;
+	auto material = buffer.addMaterial(RenderCommandBuffer::Material());
+
+	mat4 transforms[3] = { translationMatrix(1.0f, 0.0f, 0.0f), translationMatrix(2.0f, 0.0f, 0.0f),
+		translationMatrix(3.0f, 0.0f, 0.0f) };
+
+	buffer.drawInstanced(0, program, material, vao, 0, 36, transforms, 3, 0.0f);
+	buffer.draw(0, program, material, vao, 0, 36, identityMatrix, 1.0f);
+	ET_EXPECT(buffer.packetsCount() == 2);
+	ET_EXPECT(buffer.instancesCount() == 3);
+
+	NullRenderDevice::instance().beginFrame();
+	buffer.submit(rc);
+
+	std::vector<NullCommand> draws = recordedDraws();
+	ET_EXPECT(draws.size() == 2);
+	if (draws.size() == 2)
+	{
+		ET_EXPECT(draws[0].type == NullCommandType::DrawInstanced);
+		ET_EXPECT(draws[0].instances == 3);
+		ET_EXPECT(draws[1].type == NullCommandType::Draw);
+	}
+}
+
+ET_TEST(rendering_InstanceBatcher_groupAndSplit)
+{
+	RenderContext* rc = test::renderContext();
+	ET_EXPECT(rc != nullptr);
+	if (rc == nullptr) return;
+
+	const uint32_t maxInstances = s3d::InstanceBatcher::DefaultMaxInstancesPerBatch;
+	const uint32_t instancesA = 2 * maxInstances + 6;
+	const uint32_t instancesB = 5;
+
+	VertexArrayObject vao = createVertexArray(rc, "test-vao-batcher");
+	s3d::ElementContainer::Pointer root = s3d::ElementContainer::Pointer::create("test-root", nullptr);
+
+	s3d::Material::Pointer materialA(sharedObjectFactory().createObject<s3d::Material>());
+	s3d::Material::Pointer materialB(sharedObjectFactory().createObject<s3d::Material>());
+	s3d::Mesh::Pointer sourceA = s3d::Mesh::Pointer::create("test-mesh-a", vao, materialA, 0, 36, root.ptr());
+	s3d::Mesh::Pointer sourceB = s3d::Mesh::Pointer::create("test-mesh-b", vao, materialB, 0, 36, root.ptr());
+
+	/*
+	 * meshes of two groups are interleaved, translation identifies the order of addition,
+	 * depth decreases with the order of addition
+	 */
+	std::vector<s3d::Mesh::Pointer> meshes;
+	std::vector<float> translations[2];
+	for (uint32_t i = 0; i < instancesA + instancesB; ++i)
+	{
+		bool addToB = (i % 3 == 1) && (translations[1].size() < instancesB);
+		s3d::Mesh::Pointer mesh(addToB ? sourceB->duplicate() : sourceA->duplicate());
+		mesh->setTransform(translationMatrix(static_cast<float>(i), 0.0f, 0.0f));
+		translations[addToB ? 1 : 0].push_back(static_cast<float>(i));
+		meshes.push_back(mesh);
+	}
+
+	s3d::InstanceBatcher batcher;
+	for (size_t i = 0; i < meshes.size(); ++i)
+		batcher.add(meshes[i].ptr(), static_cast<float>(meshes.size() - i));
+	batcher.build();
+
+	ET_EXPECT(batcher.meshesCount() == instancesA + instancesB);
+	ET_EXPECT(batcher.instanceTransforms().size() == instancesA + instancesB);
+
+	const auto& batches = batcher.batches();
+	ET_EXPECT(batches.size() == 4);
+	if (batches.size() != 4) return;
+
+	uint32_t expectedCounts[4] = { maxInstances, maxInstances, 6, instancesB };
+	uint32_t expectedFirst[4] = { 0, maxInstances, 2 * maxInstances, instancesA };
+	for (size_t i = 0; i < 4; ++i)
+	{
+		ET_EXPECT(batches[i].instancesCount == expectedCounts[i]);
+		ET_EXPECT(batches[i].firstInstance == expectedFirst[i]);
+		ET_EXPECT(batches[i].material == ((i < 3) ? materialA : materialB));
+	}
+
+	/*
+	 * instances of the group are contiguous and keep the order of addition
+	 */
+	const auto& transforms = batcher.instanceTransforms();
+	for (uint32_t i = 0; i < instancesA; ++i)
+		ET_EXPECT(transforms[i][3][0] == translations[0][i]);
+	for (uint32_t i = 0; i < instancesB; ++i)
+		ET_EXPECT(transforms[instancesA + i][3][0] == translations[1][i]);
+
+	float expectedDepth = static_cast<float>(meshes.size()) - translations[0][2 * maxInstances + 5];
+	ET_EXPECT(batches[2].depth == expectedDepth);
+
+	RenderCommandBuffer buffer;
+	auto materialIdentifier = [&buffer](const s3d::Material::Pointer&)
+		{ return buffer.addMaterial(RenderCommandBuffer::Material()); };
+
+	Program::Pointer program = rc->programFactory().genProgram("test-program-batcher", emptyString, emptyString);
+	batcher.record(buffer, 0, program, materialIdentifier);
+	ET_EXPECT(buffer.packetsCount() == 4);
+	ET_EXPECT(buffer.instancesCount() == instancesA + instancesB);
+
+	NullRenderDevice::instance().beginFrame();
+	buffer.submit(rc);
+
+	size_t instancesDrawn = 0;
+	std::vector<NullCommand> draws = recordedDraws();
+	for (const auto& draw : draws)
+	{
+		ET_EXPECT(draw.instances <= maxInstances);
+		instancesDrawn += draw.instances;
+	}
+	ET_EXPECT(draws.size() == 4);
+	ET_EXPECT(instancesDrawn == instancesA + instancesB);
+
+	batcher.clear();
+	ET_EXPECT(batcher.meshesCount() == 0);
+	ET_EXPECT(batcher.batches().empty());
+}
+
+ET_TEST(rendering_SupportMesh_selectLod)
+{
+	RenderContext* rc = test::renderContext();
+	ET_EXPECT(rc != nullptr);
+	if (rc == nullptr) return;
+
+	/*
+	 * two triangles within the box of size 2 around (100, 0, 0), far from the origin
+	 */
+	const vec3 center(100.0f, 0.0f, 0.0f);
+	const vec3 vertices[] = { vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f), vec3(-1.0f, 1.0f, -1.0f),
+		vec3(1.0f, -1.0f, 1.0f), vec3(-1.0f, -1.0f, 1.0f), vec3(1.0f, 1.0f, -1.0f) };
+
+	VertexArray::Pointer va = VertexArray::Pointer::create(VertexDeclaration(true,
+		VertexAttributeUsage::Position, VertexAttributeType::Vec3), 6);
+
+	auto pos = va->chunk(VertexAttributeUsage::Position).accessData<vec3>(0);
+	for (size_t i = 0; i < 6; ++i)
+		pos[i] = center + vertices[i];
+
+	IndexArray::Pointer ia = IndexArray::Pointer::create(IndexArrayFormat::Format_16bit, 6, PrimitiveType::Triangles);
+	ia->linearize(6);
+
+	VertexArrayObject vao = rc->vertexBufferFactory().createVertexArrayObject("test-vao-support-mesh",
+		va, BufferDrawType::Static, ia, BufferDrawType::Static);
+
+	s3d::ElementContainer::Pointer root = s3d::ElementContainer::Pointer::create("test-root", nullptr);
+	s3d::Material::Pointer material(sharedObjectFactory().createObject<s3d::Material>());
+
+	s3d::SupportMesh::Pointer mesh = s3d::SupportMesh::Pointer::create("test-support-mesh", vao, material, 0, 6, root.ptr());
+	mesh->fillCollisionData(va, ia);
+
+	ET_EXPECT((mesh->center() - center).length() < 1.0e-5f);
+	ET_EXPECT(std::abs(mesh->radius() - std::sqrt(3.0f)) < 1.0e-5f);
+
+	s3d::Mesh::Pointer lod = s3d::Mesh::Pointer::create("test-support-mesh-lod", vao, material, 0, 3, root.ptr());
+	mesh->attachLod(1, lod, 0.1f);
+
+	/*
+	 * with 90 degrees field of view sphere covers radius / distance of the screen height
+	 */
+	Camera camera;
+	camera.perspectiveProjection(HALF_PI, 1.0f, 1.0f, 1000.0f);
+
+	camera.lookAt(center + vec3(0.0f, 0.0f, 10.0f), center);
+	mesh->selectLod(camera);
+	ET_EXPECT(mesh->selectedLod() == 0);
+
+	camera.lookAt(center + vec3(0.0f, 0.0f, 50.0f), center);
+	mesh->selectLod(camera);
+	ET_EXPECT(mesh->selectedLod() == 1);
+
+	/*
+	 * camera near the origin is far from the mesh
+	 */
+	camera.lookAt(vec3(0.0f, 0.0f, 1.0f), center);
+	mesh->selectLod(camera);
+	ET_EXPECT(mesh->selectedLod() == 1);
+}
+
+ET_TEST(rendering_TextureResidencyPolicy_streamsLevels)
+{
+	std::vector<size_t> levelSizes;
+	for (size_t dimension = 256; dimension > 0; dimension /= 2)
+		levelSizes.push_back(4 * dimension * dimension);
+
+	TextureResidencyPolicy policy(1 << 30);
+	auto handle = policy.add(vec2i(256), levelSizes);
+	ET_EXPECT(policy.levelsCount(handle) == 9);
+
+	/*
+	 * the coarsest level is loaded first, without reported screen size
+	 */
+	auto actions = policy.update(1);
+	ET_EXPECT(actions.size() == 1);
+	if (actions.size() != 1) return;
+
+	ET_EXPECT(actions.front().type == TextureResidencyPolicy::ActionType::Load);
+	ET_EXPECT(actions.front().level == 8);
+	ET_EXPECT(policy.hasPendingLoad(handle));
+	completeLoads(policy, actions);
+	ET_EXPECT(policy.residentLevel(handle) == 8);
+	ET_EXPECT(policy.residentSize() == levelSizes.back());
+
+	/*
+	 * 256 pixels texture displayed as 64 pixels requires level 2,
+	 * finer levels are loaded one by one
+	 */
+	uint64_t frame = 2;
+	policy.reportScreenSize(handle, 64.0f, frame);
+	ET_EXPECT(policy.desiredLevel(handle) == 2);
+
+	for (uint32_t expectedLevel = 7; expectedLevel >= 2; --expectedLevel, ++frame)
+	{
+		policy.reportScreenSize(handle, 64.0f, frame);
+		actions = policy.update(frame);
+		ET_EXPECT(actions.size() == 1);
+		if (actions.size() != 1) return;
+
+		ET_EXPECT(actions.front().type == TextureResidencyPolicy::ActionType::Load);
+		ET_EXPECT(actions.front().level == expectedLevel);
+		completeLoads(policy, actions);
+		ET_EXPECT(policy.residentLevel(handle) == expectedLevel);
+	}
+
+	policy.reportScreenSize(handle, 64.0f, frame);
+	ET_EXPECT(policy.update(frame).empty());
+	ET_EXPECT(policy.residentSize() == std::accumulate(levelSizes.begin() + 2, levelSizes.end(), size_t(0)));
+
+	policy.remove(handle);
+	ET_EXPECT(policy.residentSize() == 0);
+}
+
+ET_TEST(rendering_TextureResidencyPolicy_evictsLeastRecentlyUsed)
+{
+	std::vector<size_t> levelSizes = { 64, 16, 4, 1 };
+
+	TextureResidencyPolicy policy(90);
+	auto first = policy.add(vec2i(8), levelSizes);
+	auto second = policy.add(vec2i(8), levelSizes);
+
+	completeLoads(policy, policy.update(1));
+	ET_EXPECT(policy.residentSize() == 2);
+
+	for (uint64_t frame = 2; frame < 5; ++frame)
+	{
+		policy.reportScreenSize(first, 8.0f, frame);
+		completeLoads(policy, policy.update(frame));
+	}
+	ET_EXPECT(policy.residentLevel(first) == 0);
+	ET_EXPECT(policy.residentSize() == 86);
+
+	/*
+	 * second texture fits into the budget with one more level,
+	 * the next one requires eviction of the finest level of the first texture
+	 */
+	policy.reportScreenSize(second, 8.0f, 10);
+	completeLoads(policy, policy.update(10));
+	ET_EXPECT(policy.residentLevel(second) == 2);
+	ET_EXPECT(policy.residentSize() == 90);
+
+	policy.reportScreenSize(second, 8.0f, 11);
+	auto actions = policy.update(11);
+	ET_EXPECT(actions.size() == 2);
+	if (actions.size() != 2) return;
+
+	ET_EXPECT(actions[0].type == TextureResidencyPolicy::ActionType::Evict);
+	ET_EXPECT(actions[0].handle == first);
+	ET_EXPECT(actions[0].level == 0);
+	ET_EXPECT(actions[1].type == TextureResidencyPolicy::ActionType::Load);
+	ET_EXPECT(actions[1].handle == second);
+	ET_EXPECT(actions[1].level == 1);
+	completeLoads(policy, actions);
+
+	ET_EXPECT(policy.residentLevel(first) == 1);
+	ET_EXPECT(policy.residentLevel(second) == 1);
+	ET_EXPECT(policy.residentSize() == 42);
+
+	/*
+	 * decreased budget evicts everything except the coarsest levels
+	 */
+	policy.setBudget(0);
+	actions = policy.update(12);
+	ET_EXPECT(actions.size() == 4);
+	for (const auto& action : actions)
+		ET_EXPECT(action.type == TextureResidencyPolicy::ActionType::Evict);
+
+	ET_EXPECT(policy.residentLevel(first) == 3);
+	ET_EXPECT(policy.residentLevel(second) == 3);
+	ET_EXPECT(policy.residentSize() == 2);
+}
+
+ET_TEST(rendering_TextureResidencyPolicy_limitsPendingLoads)
+{
+	std::vector<size_t> levelSizes = { 4, 1 };
+
+	TextureResidencyPolicy policy(1024);
+	std::vector<TextureResidencyPolicy::Handle> handles;
+	for (size_t i = 0; i < 6; ++i)
+		handles.push_back(policy.add(vec2i(2), levelSizes));
+
+	auto actions = policy.update(1);
+	ET_EXPECT(actions.size() == policy.maxPendingLoads());
+	ET_EXPECT(policy.update(1).empty());
+	ET_EXPECT(policy.residentSize() == policy.maxPendingLoads());
+
+	/*
+	 * failed texture is not requested again
+	 */
+	if (actions.empty()) return;
+	policy.levelDidFailToLoad(actions.front().handle, actions.front().level);
+	for (size_t i = 1; i < actions.size(); ++i)
+		policy.levelDidLoad(actions[i].handle, actions[i].level);
+	ET_EXPECT(policy.residentSize() == policy.maxPendingLoads() - 1);
+
+	actions = policy.update(2);
+	ET_EXPECT(actions.size() == 2);
+	completeLoads(policy, actions);
+	ET_EXPECT(policy.update(3).empty());
+	ET_EXPECT(policy.residentSize() == 5);
+}
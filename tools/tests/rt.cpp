@@ -0,0 +1,77 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <et/rt/raytracebvh.h>
+#include "test.h"
+
+using namespace et;
+
+namespace
+{
+	/*
+	 * Stack of parallel quads along z axis, each quad is split into two triangles
+	 */
+	void fillQuads(rt::SceneTriangleList& triangles, size_t count)
+	{
+		triangles.fitToSize(2 * count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			float z = static_cast<float>(i + 1);
+			vec3 a(-1.0f, -1.0f, z);
+			vec3 b( 1.0f, -1.0f, z);
+			vec3 c( 1.0f,  1.0f, z);
+			vec3 d(-1.0f,  1.0f, z);
+			triangles.push_back(rt::SceneTriangle(triangle(a, b, c), i));
+			triangles.push_back(rt::SceneTriangle(triangle(a, c, d), i));
+		}
+	}
+}
+
+ET_TEST(rt_BVH_occludedMatchesIntersect)
+{
+	rt::SceneTriangleList triangles;
+	fillQuads(triangles, 32);
+
+	rt::BVH bvh;
+	bvh.build(triangles);
+	ET_EXPECT(!bvh.empty());
+
+	for (int y = -4; y <= 4; ++y)
+	{
+		for (int x = -4; x <= 4; ++x)
+		{
+			ray3d ray(vec3(0.4f * static_cast<float>(x), 0.4f * static_cast<float>(y), 0.0f), unitZ);
+
+			rt::BVH::Hit hit;
+			bool intersects = bvh.intersect(ray, hit);
+			ET_EXPECT(intersects == ((std::abs(x) < 3) && (std::abs(y) < 3)));
+
+			for (float maxDistance : { 0.5f, 1.5f, 20.0f, 100.0f })
+			{
+				bool expected = intersects && (hit.distance < maxDistance);
+				ET_EXPECT(bvh.occluded(ray, maxDistance) == expected);
+			}
+		}
+	}
+}
+
+ET_TEST(rt_BVH_buildUsesPushedTriangles)
+{
+	rt::SceneTriangleList triangles;
+	triangles.fitToSize(16);
+
+	rt::BVH bvh;
+	bvh.build(triangles);
+	ET_EXPECT(bvh.empty());
+
+	fillQuads(triangles, 1);
+	bvh.build(triangles);
+
+	rt::BVH::Hit hit;
+	ET_EXPECT(bvh.intersect(ray3d(vec3(0.0f), unitZ), hit));
+	ET_EXPECT(hit.triangleIndex < 2);
+}
@@ -0,0 +1,371 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <external/vorbis/vorbisfile.h>
+#include "fakeopenal.h"
+
+namespace
+{
+	struct FakeBuffer
+	{
+		ALsizei size = 0;
+		ALint channels = 1;
+		ALint bits = 16;
+		ALint frequency = 44100;
+	};
+
+	struct FakeSource
+	{
+		std::deque<ALuint> queue;
+		double startTime = 0.0;
+		double pausedTime = 0.0;
+		ALint state = AL_INITIAL;
+
+		/*
+		 * Samples of the buffers unqueued while playing, subtracted from the played samples
+		 */
+		ALint samplesOffset = 0;
+	};
+
+	std::mutex fakeLock;
+	std::map<ALuint, FakeBuffer> fakeBuffers;
+	std::map<ALuint, FakeSource> fakeSources;
+	ALuint fakeIdentifier = 1;
+
+	size_t bufferDataCalls = 0;
+	size_t stallCallIndex = 0;
+	uint64_t stallDuration = 0;
+
+	double currentTime()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	ALint bufferSamples(ALuint buffer)
+	{
+		const FakeBuffer& b = fakeBuffers[buffer];
+		return b.size / (b.channels * b.bits / 8);
+	}
+
+	/*
+	 * Updates state of the source, returns played samples since the first queued buffer
+	 */
+	ALint updateSource(FakeSource& s)
+	{
+		if ((s.state != AL_PLAYING) && (s.state != AL_PAUSED))
+			return 0;
+
+		ALint frequency = s.queue.empty() ? 44100 : fakeBuffers[s.queue.front()].frequency;
+		double time = (s.state == AL_PLAYING) ? currentTime() - s.startTime : s.pausedTime;
+		ALint played = static_cast<ALint>(time * frequency) + s.samplesOffset;
+
+		ALint queued = 0;
+		for (ALuint buffer : s.queue)
+			queued += bufferSamples(buffer);
+
+		if ((s.state == AL_PLAYING) && (played >= queued))
+			s.state = AL_STOPPED;
+
+		return played;
+	}
+
+	/*
+	 * All buffers of the stopped source are processed
+	 */
+	ALint processedBuffers(FakeSource& s, ALint& offset)
+	{
+		ALint played = updateSource(s);
+
+		offset = 0;
+		if (s.state == AL_STOPPED)
+			return static_cast<ALint>(s.queue.size());
+
+		ALint processed = 0;
+		for (ALuint buffer : s.queue)
+		{
+			ALint samples = bufferSamples(buffer);
+			if (played < samples) break;
+
+			played -= samples;
+			++processed;
+		}
+
+		offset = (s.state == AL_INITIAL) ? 0 : played;
+		return processed;
+	}
+}
+
+void et::test::stallFakeBufferData(size_t callIndex, uint64_t milliseconds)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	bufferDataCalls = 0;
+	stallCallIndex = callIndex;
+	stallDuration = milliseconds;
+}
+
+/*
+ * OpenAL
+ */
+const ALCchar* alcGetString(ALCdevice*, ALCenum)
+	{ return "fake"; }
+
+ALCdevice* alcOpenDevice(const ALCchar*)
+	{ return reinterpret_cast<ALCdevice*>(&fakeSources); }
+
+ALCcontext* alcCreateContext(ALCdevice*, const ALCint*)
+	{ return reinterpret_cast<ALCcontext*>(&fakeBuffers); }
+
+ALCboolean alcMakeContextCurrent(ALCcontext*)
+	{ return ALC_TRUE; }
+
+void alcDestroyContext(ALCcontext*)
+	{ }
+
+ALCboolean alcCloseDevice(ALCdevice*)
+	{ return ALC_TRUE; }
+
+ALCenum alcGetError(ALCdevice*)
+	{ return ALC_NO_ERROR; }
+
+ALenum alGetError()
+	{ return AL_NO_ERROR; }
+
+const ALchar* alGetString(ALenum)
+	{ return "fake"; }
+
+void alDistanceModel(ALenum)
+	{ }
+
+void alListenerfv(ALenum, const ALfloat*)
+	{ }
+
+void alGenBuffers(ALsizei n, ALuint* buffers)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	for (ALsizei i = 0; i < n; ++i)
+	{
+		buffers[i] = fakeIdentifier++;
+		fakeBuffers[buffers[i]] = FakeBuffer();
+	}
+}
+
+void alDeleteBuffers(ALsizei n, const ALuint* buffers)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	for (ALsizei i = 0; i < n; ++i)
+		fakeBuffers.erase(buffers[i]);
+}
+
+void alBufferData(ALuint buffer, ALenum format, const ALvoid*, ALsizei size, ALsizei frequency)
+{
+	uint64_t stall = 0;
+	{
+		std::lock_guard<std::mutex> lock(fakeLock);
+		if (++bufferDataCalls == stallCallIndex)
+			stall = stallDuration;
+	}
+
+	if (stall > 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(stall));
+
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeBuffer& b = fakeBuffers[buffer];
+	b.size = size;
+	b.frequency = frequency;
+	b.channels = ((format == AL_FORMAT_STEREO8) || (format == AL_FORMAT_STEREO16)) ? 2 : 1;
+	b.bits = ((format == AL_FORMAT_MONO8) || (format == AL_FORMAT_STEREO8)) ? 8 : 16;
+}
+
+void alGetBufferi(ALuint buffer, ALenum param, ALint* value)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	const FakeBuffer& b = fakeBuffers[buffer];
+
+	if (param == AL_SIZE)
+		*value = b.size;
+	else if (param == AL_CHANNELS)
+		*value = b.channels;
+	else if (param == AL_BITS)
+		*value = b.bits;
+	else if (param == AL_FREQUENCY)
+		*value = b.frequency;
+}
+
+void alGenSources(ALsizei n, ALuint* sources)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	for (ALsizei i = 0; i < n; ++i)
+	{
+		sources[i] = fakeIdentifier++;
+		fakeSources[sources[i]] = FakeSource();
+	}
+}
+
+void alDeleteSources(ALsizei n, const ALuint* sources)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	for (ALsizei i = 0; i < n; ++i)
+		fakeSources.erase(sources[i]);
+}
+
+void alSourcef(ALuint, ALenum, ALfloat)
+	{ }
+
+void alSourcefv(ALuint, ALenum, const ALfloat*)
+	{ }
+
+void alSource3f(ALuint, ALenum, ALfloat, ALfloat, ALfloat)
+	{ }
+
+void alSourcei(ALuint source, ALenum param, ALint value)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	if (param == AL_BUFFER)
+	{
+		s.queue.clear();
+		if (value != 0)
+			s.queue.push_back(static_cast<ALuint>(value));
+		s.samplesOffset = 0;
+	}
+}
+
+void alGetSourcei(ALuint source, ALenum param, ALint* value)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	ALint offset = 0;
+	ALint processed = processedBuffers(s, offset);
+
+	if (param == AL_SOURCE_STATE)
+		*value = s.state;
+	else if (param == AL_BUFFERS_PROCESSED)
+		*value = processed;
+	else if (param == AL_BUFFERS_QUEUED)
+		*value = static_cast<ALint>(s.queue.size());
+	else if (param == AL_SAMPLE_OFFSET)
+		*value = offset;
+}
+
+void alGetSourcef(ALuint source, ALenum param, ALfloat* value)
+{
+	ALint result = 0;
+	alGetSourcei(source, (param == AL_SEC_OFFSET) ? AL_SAMPLE_OFFSET : param, &result);
+	*value = static_cast<ALfloat>(result);
+
+	if (param == AL_SEC_OFFSET)
+	{
+		std::lock_guard<std::mutex> lock(fakeLock);
+		FakeSource& s = fakeSources[source];
+		*value /= static_cast<ALfloat>(s.queue.empty() ? 44100 : fakeBuffers[s.queue.front()].frequency);
+	}
+}
+
+void alSourcePlay(ALuint source)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	if (s.state == AL_PAUSED)
+	{
+		s.startTime = currentTime() - s.pausedTime;
+	}
+	else
+	{
+		s.startTime = currentTime();
+		s.samplesOffset = 0;
+	}
+
+	s.state = AL_PLAYING;
+}
+
+void alSourcePause(ALuint source)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	if (s.state == AL_PLAYING)
+	{
+		s.pausedTime = currentTime() - s.startTime;
+		s.state = AL_PAUSED;
+	}
+}
+
+void alSourceStop(ALuint source)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	fakeSources[source].state = AL_STOPPED;
+}
+
+void alSourceRewind(ALuint source)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	fakeSources[source].state = AL_INITIAL;
+}
+
+void alSourceQueueBuffers(ALuint source, ALsizei n, const ALuint* buffers)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	for (ALsizei i = 0; i < n; ++i)
+		s.queue.push_back(buffers[i]);
+}
+
+void alSourceUnqueueBuffers(ALuint source, ALsizei n, ALuint* buffers)
+{
+	std::lock_guard<std::mutex> lock(fakeLock);
+	FakeSource& s = fakeSources[source];
+
+	ALint offset = 0;
+	ALint processed = processedBuffers(s, offset);
+
+	for (ALsizei i = 0; (i < n) && (i < processed); ++i)
+	{
+		buffers[i] = s.queue.front();
+		s.samplesOffset -= bufferSamples(s.queue.front());
+		s.queue.pop_front();
+	}
+}
+
+/*
+ * Ogg Vorbis
+ */
+int ov_clear(OggVorbis_File*)
+	{ return 0; }
+
+int ov_open_callbacks(void*, OggVorbis_File*, const char*, long, ov_callbacks)
+	{ return OV_ENOTVORBIS; }
+
+vorbis_info* ov_info(OggVorbis_File*, int)
+	{ return nullptr; }
+
+ogg_int64_t ov_pcm_total(OggVorbis_File*, int)
+	{ return OV_EFAULT; }
+
+ogg_int64_t ov_pcm_tell(OggVorbis_File*)
+	{ return OV_EFAULT; }
+
+ogg_int64_t ov_raw_tell(OggVorbis_File*)
+	{ return OV_EFAULT; }
+
+long ov_read(OggVorbis_File*, char*, int, int, int, int, int*)
+	{ return OV_EFAULT; }
+
+long ov_seekable(OggVorbis_File*)
+	{ return 0; }
+
+int ov_raw_seek(OggVorbis_File*, ogg_int64_t)
+	{ return OV_EFAULT; }
@@ -0,0 +1,28 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	namespace test
+	{
+		/*
+		 * Sound tests are linked with the fake OpenAL, which does not output anything,
+		 * sources play queued buffers in real time according to their sample rate.
+		 * Ogg Vorbis decoding is not available, ov_open_callbacks always fails.
+		 */
+		
+		/*
+		 * Makes n-th (starting from 1) call to alBufferData since this call take
+		 * specified amount of time, simulating decoding or disk stall
+		 */
+		void stallFakeBufferData(size_t callIndex, uint64_t milliseconds);
+	}
+}
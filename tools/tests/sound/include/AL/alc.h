@@ -0,0 +1,13 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+/*
+ * Tests are linked with the fake OpenAL implementation, system headers are not required
+ */
+#pragma once
+
+#include <external/oal/alc.h>
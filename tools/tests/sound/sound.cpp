@@ -0,0 +1,153 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <fstream>
+#include <et/app/application.h>
+#include <et/sound/sound.h>
+#include "../test.h"
+#include "fakeopenal.h"
+
+using namespace et;
+
+namespace
+{
+	const uint32_t trackSampleRate = 8000;
+	const uint32_t trackDuration = 5;
+
+	template <typename T>
+	void writeValue(std::ofstream& stream, T value)
+		{ stream.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+	/*
+	 * 16-bit mono PCM, one second of the track is streamed per buffer
+	 */
+	std::string writeSilentTrack()
+	{
+		std::string fileName = application().environment().applicationDocumentsFolder() + "test-streaming.wav";
+
+		uint32_t dataSize = 2 * trackSampleRate * trackDuration;
+		std::ofstream stream(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		stream.write("RIFF", 4);
+		writeValue<uint32_t>(stream, 36 + dataSize);
+		stream.write("WAVE", 4);
+		stream.write("fmt ", 4);
+		writeValue<uint32_t>(stream, 16);
+		writeValue<uint16_t>(stream, 1);
+		writeValue<uint16_t>(stream, 1);
+		writeValue<uint32_t>(stream, trackSampleRate);
+		writeValue<uint32_t>(stream, 2 * trackSampleRate);
+		writeValue<uint16_t>(stream, 2);
+		writeValue<uint16_t>(stream, 16);
+		stream.write("data", 4);
+		writeValue<uint32_t>(stream, dataSize);
+
+		std::vector<char> silence(dataSize, 0);
+		stream.write(silence.data(), dataSize);
+
+		return fileName;
+	}
+
+	/*
+	 * Finished event is delivered in the main run loop, which is not running during the test
+	 */
+	bool playUntilFinished(audio::Player::Pointer player, uint64_t timeout)
+	{
+		bool finished = false;
+		player->finished.connect([&finished](audio::Player*) { finished = true; });
+		player->play();
+
+		uint64_t startTime = queryContiniousTimeInMilliSeconds();
+		while (!finished && (queryContiniousTimeInMilliSeconds() - startTime < timeout))
+		{
+			Thread::sleepMSec(10);
+			mainRunLoop().update(queryContiniousTimeInMilliSeconds());
+		}
+
+		return finished;
+	}
+}
+
+ET_TEST(sound_Player_streamsTrack)
+{
+	std::string fileName = writeSilentTrack();
+	auto track = audio::manager().loadTrack(fileName);
+	ET_EXPECT(track->streamed());
+	ET_EXPECT(track->totalBuffersCount() == trackDuration);
+	ET_EXPECT(track->actualBuffersCount() < track->totalBuffersCount());
+
+	auto player = audio::manager().genPlayer(track);
+	audio::manager().resetStreamingStatistics();
+
+	uint64_t startTime = queryContiniousTimeInMilliSeconds();
+	ET_EXPECT(playUntilFinished(player, 3000 * trackDuration));
+	ET_EXPECT(queryContiniousTimeInMilliSeconds() - startTime >= 900 * trackDuration);
+
+	/*
+	 * buffers which were not queued initially are streamed without stops
+	 */
+	auto statistics = audio::manager().streamingStatistics();
+	ET_EXPECT(player->underrunsCount() == 0);
+	ET_EXPECT(statistics.underruns == 0);
+	ET_EXPECT(statistics.buffersQueued == track->totalBuffersCount() - track->actualBuffersCount());
+
+	removeFile(fileName);
+}
+
+ET_TEST(sound_Player_recoversFromUnderrun)
+{
+	std::string fileName = writeSilentTrack();
+	auto track = audio::manager().loadTrack(fileName);
+	auto player = audio::manager().genPlayer(track);
+	audio::manager().resetStreamingStatistics();
+
+	/*
+	 * buffers are preloaded when playback starts, the first streamed one
+	 * is uploaded after all of the initially queued buffers were played
+	 */
+	size_t preloadedBuffers = static_cast<size_t>(track->actualBuffersCount());
+	uint64_t stall = 1000 * preloadedBuffers + 500;
+	test::stallFakeBufferData(preloadedBuffers + 1, stall);
+
+	uint64_t startTime = queryContiniousTimeInMilliSeconds();
+	ET_EXPECT(playUntilFinished(player, 3000 * trackDuration + stall));
+	ET_EXPECT(queryContiniousTimeInMilliSeconds() - startTime >= stall);
+	test::stallFakeBufferData(0, 0);
+
+	auto statistics = audio::manager().streamingStatistics();
+	ET_EXPECT(player->underrunsCount() == 1);
+	ET_EXPECT(statistics.underruns == 1);
+	ET_EXPECT(statistics.buffersQueued == track->totalBuffersCount() - track->actualBuffersCount());
+
+	removeFile(fileName);
+}
+
+ET_TEST(sound_Player_stopsWhileStreaming)
+{
+	std::string fileName = writeSilentTrack();
+	auto track = audio::manager().loadTrack(fileName);
+	auto player = audio::manager().genPlayer(track);
+	audio::manager().resetStreamingStatistics();
+
+	/*
+	 * player is stopped while streaming thread uploads the first streamed buffer
+	 */
+	size_t preloadedBuffers = static_cast<size_t>(track->actualBuffersCount());
+	test::stallFakeBufferData(preloadedBuffers + 1, 1000);
+
+	player->play();
+	Thread::sleepMSec(1500);
+	player->stop();
+	test::stallFakeBufferData(0, 0);
+
+	Thread::sleepMSec(500);
+	ET_EXPECT(!player->playing());
+	ET_EXPECT(player->underrunsCount() == 0);
+	ET_EXPECT(audio::manager().streamingStatistics().underruns == 0);
+
+	removeFile(fileName);
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include <thread>
+#include <et/tasks/jobsystem.h>
+#include "test.h"
+
+using namespace et;
+
+namespace
+{
+	class CountingTask : public Task
+	{
+	public:
+		CountingTask(AtomicCounter& executed, AtomicCounter& deleted) :
+			_executed(executed), _deleted(deleted) { }
+
+		~CountingTask()
+			{ _deleted.retain(); }
+
+		void execute()
+			{ _executed.retain(); }
+
+	private:
+		AtomicCounter& _executed;
+		AtomicCounter& _deleted;
+	};
+}
+
+ET_TEST(tasks_JobSystem_stopExecutesPendingJobs)
+{
+	const size_t jobsCount = 64;
+
+	JobSystem jobs;
+	jobs.start(1);
+
+	/*
+	 * the only worker is busy, so the following jobs stay in the queue
+	 */
+	AtomicBool blocked;
+	blocked = true;
+	jobs.submit([&blocked]() { while (blocked) Thread::sleepMSec(1); });
+
+	AtomicCounter executedJobs;
+	JobList submitted;
+	for (size_t i = 0; i < jobsCount; ++i)
+		submitted.push_back(jobs.submit([&executedJobs]() { executedJobs.retain(); }));
+
+	AtomicCounter executedTasks;
+	AtomicCounter deletedTasks;
+	for (size_t i = 0; i < jobsCount; ++i)
+		submitted.push_back(jobs.submit(sharedObjectFactory().createObject<CountingTask>(executedTasks, deletedTasks)));
+
+	AtomicCounter executedContinuations;
+	auto continuation = jobs.createJob([&executedContinuations]() { executedContinuations.retain(); });
+	jobs.addDependency(continuation, submitted.back());
+	jobs.submit(continuation);
+
+	/*
+	 * worker is released after it was asked to stop, so it leaves remaining jobs in the queue
+	 */
+	std::thread release([&blocked]() { Thread::sleepMSec(50); blocked = false; });
+	jobs.stop();
+	release.join();
+
+	ET_EXPECT(executedJobs.atomicCounterValue() == jobsCount);
+	ET_EXPECT(executedTasks.atomicCounterValue() == jobsCount);
+	ET_EXPECT(deletedTasks.atomicCounterValue() == jobsCount);
+	ET_EXPECT(executedContinuations.atomicCounterValue() == 1);
+
+	for (const auto& job : submitted)
+		ET_EXPECT(job->completed());
+
+	ET_EXPECT(continuation->completed());
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#include "test.h"
+
+using namespace et;
+using namespace et::test;
+
+namespace
+{
+	struct RegisteredTest
+	{
+		std::string name;
+		Function function = nullptr;
+	};
+
+	std::vector<RegisteredTest>& registeredTests()
+	{
+		static std::vector<RegisteredTest> tests;
+		return tests;
+	}
+
+	RenderContext* testRenderContext = nullptr;
+	size_t failedExpectations = 0;
+}
+
+Registration::Registration(const char* name, Function func)
+{
+	RegisteredTest rt;
+	rt.name = name;
+	rt.function = func;
+	registeredTests().push_back(rt);
+}
+
+void test::fail(const char* expression, const char* file, int line)
+{
+	log::error("%s:%d: expectation failed: %s", file, line, expression);
+	++failedExpectations;
+}
+
+RenderContext* test::renderContext()
+{
+	return testRenderContext;
+}
+
+size_t test::run(const std::string& filter, RenderContext* rc)
+{
+	testRenderContext = rc;
+
+	std::vector<RegisteredTest> tests = registeredTests();
+	std::sort(tests.begin(), tests.end(), [](const RegisteredTest& l, const RegisteredTest& r)
+		{ return l.name < r.name; });
+
+	size_t passed = 0;
+	size_t failed = 0;
+	for (const auto& rt : tests)
+	{
+		if (!filter.empty() && (rt.name.find(filter) == std::string::npos)) continue;
+
+		failedExpectations = 0;
+		rt.function();
+
+		if (failedExpectations == 0)
+		{
+			log::info("[  OK  ] %s", rt.name.c_str());
+			++passed;
+		}
+		else
+		{
+			log::info("[FAILED] %s", rt.name.c_str());
+			++failed;
+		}
+	}
+
+	log::info("%llu passed, %llu failed", static_cast<unsigned long long>(passed),
+		static_cast<unsigned long long>(failed));
+
+	return failed;
+}
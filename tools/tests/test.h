@@ -0,0 +1,50 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2015 by Sergey Reznik
+ * Please, modify content only if you know what are you doing.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	class RenderContext;
+	
+	namespace test
+	{
+		typedef void(*Function)();
+
+		struct Registration
+		{
+			Registration(const char* name, Function func);
+		};
+
+		/*
+		 * Reports failed expectation, test continues running
+		 */
+		void fail(const char* expression, const char* file, int line);
+
+		/*
+		 * Runs registered tests which names contains filter,
+		 * returns number of failed tests
+		 */
+		size_t run(const std::string& filter, RenderContext*);
+
+		/*
+		 * Render context of the application running tests, nullptr in console applications
+		 */
+		RenderContext* renderContext();
+	}
+}
+
+#define ET_TEST_CONCAT_IMPL(A, B)			A##B
+#define ET_TEST_CONCAT(A, B)				ET_TEST_CONCAT_IMPL(A, B)
+
+#define ET_TEST(NAME)						static void NAME(); \
+											static et::test::Registration ET_TEST_CONCAT(NAME, _registration)(#NAME, NAME); \
+											static void NAME()
+
+#define ET_EXPECT(COND)						do { if (!(COND)) et::test::fail(#COND, __FILE__, __LINE__); } while (0)